@@ -0,0 +1,325 @@
+/**
+ * Bayesian-Optimization PID Tuning using bayes_tune.hpp
+ *
+ * Screens PID gain sets in simulation, then runs step experiments on the
+ * motor one at a time, each chosen by constrained expected improvement on
+ * a Gaussian-process model of the hardware/simulation mismatch. Stops after
+ * --runs experiments or when no candidate is expected to improve on the best
+ * feasible run. Every run is logged to data/2-1/bayes_tune_<timestamp>.csv
+ * (NOT for Arduino).
+ *
+ * The board must run kp.cpp (python run.py kp): S, Z, G:<Kp>,<Ki>,<Kd>,
+ * R:<deg> and "Data:<t>,<position>,<reference>" every 10 ms.
+ *
+ * Compilation:
+ *   g++ -std=c++17 -O2 bayes_tune.cpp -o bayes_tune -pthread
+ *
+ * Usage:
+ *   ./bayes_tune                                  (τ, K from data/1-3, $COM_MEGA2560)
+ *   ./bayes_tune --runs 6 --max-os 10 --max-ts 0.4
+ *   ./bayes_tune --kp 1,50 --ki 0,5 --kd 0,1 --delay 0.02
+ *   ./bayes_tune --resume ../data/2-1/bayes_tune_20250101_120000.csv
+ *   ./bayes_tune --virtual 1.2,0.9,0.01           (no motor: mismatched simulation)
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include "bayes_tune.hpp"
+#include "serial_port.hpp"
+
+namespace {
+
+using Experiment = std::function<BayesTune::Outcome(const BayesTune::Gains&)>;
+
+bool parse_range(const char* text, BayesTune::Range& range) {
+    double low, high;
+    if (std::sscanf(text, "%lf,%lf", &low, &high) != 2 || !(high > low) || low < 0 ||
+        (range.log_scale && low <= 0)) {
+        return false;
+    }
+    range.low = low;
+    range.high = high;
+    return true;
+}
+
+bool parse_data(const std::string& line, double& t, double& position) {
+    return line.rfind("Data:", 0) == 0 && std::sscanf(line.c_str() + 5, "%lf,%lf", &t, &position) == 2;
+}
+
+// Reads Data: lines for `seconds`; returns false if the board went silent
+bool drain(SerialPort::Port& port, double seconds, double* position = nullptr) {
+    std::string line;
+    bool seen = false;
+    auto until = std::chrono::steady_clock::now() + std::chrono::duration<double>(seconds);
+    while (std::chrono::steady_clock::now() < until) {
+        double t, pos;
+        if (port.read_line(line, 50) && parse_data(line, t, pos)) {
+            seen = true;
+            if (position) {
+                *position = pos;
+            }
+        }
+    }
+    return seen;
+}
+
+/**
+ * One step run with the tune_kp.py protocol; the step starts from wherever
+ * the shaft is so a sketch without Z works too
+ */
+BayesTune::Outcome run_step(SerialPort::Port& port, const BayesTune::Gains& g, double step,
+                            double duration, double return_wait, const BayesTune::Requirements& req) {
+    char gains[64];
+    std::snprintf(gains, sizeof(gains), "G:%.4f,%.4f,%.4f", g.Kp, g.Ki, g.Kd);
+
+    port.write_line("S");
+    port.write_line("Z");
+    double p0 = 0.0;
+    if (!drain(port, 0.5, &p0)) {
+        throw std::runtime_error("No Data: lines from " + port.name() + " (is kp.cpp uploaded?)");
+    }
+    port.write_line(gains);
+    drain(port, 0.1, &p0);
+
+    char target[32];
+    std::snprintf(target, sizeof(target), "R:%.2f", p0 + step);
+    port.reset_input_buffer();
+    port.write_line(target);
+
+    std::vector<double> t, y;
+    std::string line;
+    double t0 = -1.0;
+    auto until = std::chrono::steady_clock::now() + std::chrono::duration<double>(duration + 1.0);
+    while (std::chrono::steady_clock::now() < until) {
+        double time, pos;
+        if (!port.read_line(line, 50) || !parse_data(line, time, pos)) {
+            continue;
+        }
+        if (t0 < 0) {
+            t0 = time;
+        }
+        if (time - t0 > duration) {
+            break;
+        }
+        t.push_back(time - t0);
+        y.push_back(pos - p0);
+        // Runaway: stop the motor, the rest of the run counts as unsettled
+        if (std::fabs(y.back()) > 2.0 * std::fabs(step)) {
+            port.write_line("S");
+            break;
+        }
+    }
+
+    char back[32];
+    std::snprintf(back, sizeof(back), "R:%.2f", p0);
+    port.write_line(back);
+    drain(port, return_wait);
+    port.write_line("S");
+
+    return BayesTune::evaluate(t, y, step, duration, req);
+}
+
+void print_outcome(const char* label, const BayesTune::Outcome& o) {
+    std::printf("  %-10s IAE %.4f s, overshoot %6.2f %%, settling %.3f s, late error %.2f %%\n", label,
+                o.iae, o.overshoot, o.settling, o.late_error);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    BayesTune::SearchSpace space;
+    BayesTune::Requirements req;
+    BayesTune::Settings settings;
+    BayesTune::SimModel model;
+    bool tau_given = false, K_given = false;
+    size_t runs = 8;
+    double min_ei = 0.01;          // stop when EI < 1% of the best IAE
+    double return_wait = 1.5;      // s at the start position between runs
+    std::string resume;
+    bool virtual_rig = false;
+    double rig_tau = 1.2, rig_K = 0.9, rig_delay = 0.01;
+
+    for (int i = 1; i < argc; ++i) {
+        bool has_value = i + 1 < argc;
+        if (std::strcmp(argv[i], "--tau") == 0 && has_value) {
+            model.tau = std::atof(argv[++i]);
+            tau_given = true;
+        } else if (std::strcmp(argv[i], "--K") == 0 && has_value) {
+            model.K = std::atof(argv[++i]);
+            K_given = true;
+        } else if (std::strcmp(argv[i], "--delay") == 0 && has_value) {
+            model.dead_time = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--deadzone") == 0 && has_value) {
+            model.deadzone = std::atof(argv[++i]);
+        } else if ((std::strcmp(argv[i], "--kp") == 0 || std::strcmp(argv[i], "--ki") == 0 ||
+                    std::strcmp(argv[i], "--kd") == 0) && has_value) {
+            auto& range = argv[i][3] == 'p' ? space.kp : argv[i][3] == 'i' ? space.ki : space.kd;
+            if (!parse_range(argv[++i], range)) {
+                std::cerr << "Expected " << argv[i - 1] << " <low>,<high>" << std::endl;
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--max-os") == 0 && has_value) {
+            req.max_overshoot = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--max-ts") == 0 && has_value) {
+            req.max_settling = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--runs") == 0 && has_value) {
+            runs = static_cast<size_t>(std::max(1, std::atoi(argv[++i])));
+        } else if (std::strcmp(argv[i], "--step") == 0 && has_value) {
+            settings.reference = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--duration") == 0 && has_value) {
+            settings.duration = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--candidates") == 0 && has_value) {
+            settings.candidates = static_cast<size_t>(std::max(16, std::atoi(argv[++i])));
+        } else if (std::strcmp(argv[i], "--slack") == 0 && has_value) {
+            settings.screen_slack = std::max(1.0, std::atof(argv[++i]));
+        } else if (std::strcmp(argv[i], "--threads") == 0 && has_value) {
+            settings.threads = static_cast<size_t>(std::max(1, std::atoi(argv[++i])));
+        } else if (std::strcmp(argv[i], "--min-ei") == 0 && has_value) {
+            min_ei = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--wait") == 0 && has_value) {
+            return_wait = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--resume") == 0 && has_value) {
+            resume = argv[++i];
+        } else if (std::strcmp(argv[i], "--virtual") == 0) {
+            virtual_rig = true;
+            if (has_value && argv[i + 1][0] != '-' &&
+                std::sscanf(argv[++i], "%lf,%lf,%lf", &rig_tau, &rig_K, &rig_delay) < 2) {
+                std::cerr << "Expected --virtual [<tau scale>,<K scale>[,<delay>]]" << std::endl;
+                return 1;
+            }
+        } else {
+            std::cerr << "Unknown option: " << argv[i] << std::endl;
+            return 1;
+        }
+    }
+
+    std::cout << "========================================" << std::endl;
+    std::cout << "Bayesian PID Tuning (p2-1 step)" << std::endl;
+    std::cout << "========================================" << std::endl;
+    std::cout << std::endl;
+
+    if (!tau_given || !K_given) {
+        try {
+            auto loaded = BayesTune::load_sim_model(false);
+            model.tau = tau_given ? model.tau : loaded.tau;
+            model.K = K_given ? model.K : loaded.K;
+            model.friction = loaded.friction;
+        } catch (const std::exception&) {
+            std::cout << "No 1-3 summary, using tau = " << model.tau << " s, K = " << model.K
+                      << std::endl;
+        }
+    }
+    if (!(model.tau > 0) || !(model.K > 0) || !(settings.duration > 0) || settings.reference == 0) {
+        std::cerr << "Error: tau, K and the run duration must be positive, the step non-zero" << std::endl;
+        return 1;
+    }
+
+    std::printf("Simulator: tau=%.4g s, K=%.4g (deg/s)/PWM, dead time %.3g s, deadzone %.0f%s\n",
+                model.tau, model.K, model.dead_time, model.deadzone,
+                model.friction.enabled() ? ", friction" : "");
+    std::printf("Search: Kp %.3g-%.3g (log), Ki %.3g-%.3g, Kd %.3g-%.3g\n", space.kp.low, space.kp.high,
+                space.ki.low, space.ki.high, space.kd.low, space.kd.high);
+    std::printf("Requirements: overshoot <= %.1f %%, settling (%.0f%% band) <= %.2f s; step %.0f deg for %.1f s\n",
+                req.max_overshoot, req.settling_band, req.max_settling, settings.reference, settings.duration);
+    std::cout << std::endl;
+
+    try {
+        BayesTune::Tuner tuner(space, model, req, settings);
+        auto start = std::chrono::steady_clock::now();
+        size_t kept = tuner.screen();
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::printf("Screened %zu gain sets in %.2f s: %zu within %.1fx the requirements in simulation\n",
+                    tuner.screened(), elapsed, kept, settings.screen_slack);
+        if (kept == 0) {
+            std::cerr << "Error: No candidate passes the simulation screen; widen the search space"
+                      << std::endl;
+            return 1;
+        }
+
+        if (!resume.empty()) {
+            auto previous = BayesTune::load_run_log(resume);
+            for (const auto& [gains, measured] : previous) {
+                tuner.observe(gains, measured);
+            }
+            std::cout << "Resumed " << previous.size() << " runs from " << resume << std::endl;
+        }
+        std::cout << std::endl;
+
+        // The motor, or a simulation with a different plant standing in for it
+        std::unique_ptr<SerialPort::Port> port;
+        Experiment experiment;
+        if (virtual_rig) {
+            BayesTune::SimModel rig = model;
+            rig.tau *= rig_tau;
+            rig.K *= rig_K;
+            rig.dead_time += rig_delay;
+            std::printf("Virtual rig: tau=%.4g s, K=%.4g, dead time %.3g s (no motor)\n\n", rig.tau,
+                        rig.K, rig.dead_time);
+            experiment = [rig, settings, req](const BayesTune::Gains& g) {
+                return BayesTune::simulate(rig, g, settings.reference, settings.duration, req);
+            };
+        } else {
+            port = std::make_unique<SerialPort::Port>(SerialPort::default_port_name(), 115200);
+            port->wait_for_reset();
+            std::cout << "Connected to " << port->name() << std::endl << std::endl;
+            experiment = [&](const BayesTune::Gains& g) {
+                return run_step(*port, g, settings.reference, settings.duration, return_wait, req);
+            };
+        }
+
+        BayesTune::RunLog log("2-1");
+        size_t run = 0;
+        for (const auto& obs : tuner.observations()) {
+            log.append(++run, obs, req);
+        }
+
+        for (size_t i = 0; i < runs; ++i) {
+            auto next = tuner.propose();
+            auto incumbent = tuner.best();
+            if (incumbent &&
+                next.acquisition < min_ei * tuner.observations()[*incumbent].measured.iae) {
+                std::printf("Expected improvement %.2g s is below %.0f%% of the best IAE; stopping\n",
+                            next.acquisition, min_ei * 100.0);
+                break;
+            }
+
+            std::printf("--- Run %zu: G:%.3f,%.3f,%.3f ---\n", ++run, next.gains.Kp, next.gains.Ki,
+                        next.gains.Kd);
+            print_outcome("simulated", next.sim);
+            std::printf("  %-10s IAE %.4f±%.4f s, overshoot %6.2f±%.2f %%, late error %.2f±%.2f %%\n",
+                        "predicted", next.iae.mean, next.iae.sd, next.overshoot.mean, next.overshoot.sd,
+                        next.late_error.mean, next.late_error.sd);
+            std::printf("  P(feasible) %.2f, constrained EI %.4f s\n", next.p_feasible, next.acquisition);
+
+            auto measured = experiment(next.gains);
+            const auto& obs = tuner.observe(next.gains, measured);
+            log.append(run, obs, req);
+            print_outcome("measured", measured);
+            std::cout << "  " << (measured.feasible(req) ? "Meets" : "Does NOT meet")
+                      << " the requirements" << std::endl << std::endl;
+        }
+
+        std::cout << "Runs: " << tuner.observations().size() << " on the motor" << std::endl;
+        if (auto best = tuner.best()) {
+            const auto& b = tuner.observations()[*best];
+            std::cout << "Best feasible run:" << std::endl;
+            print_outcome("measured", b.measured);
+            std::printf("\nSend: G:%.3f,%.3f,%.3f\n", b.gains.Kp, b.gains.Ki, b.gains.Kd);
+        } else {
+            std::cout << "No run met the requirements; continue with --resume or relax them" << std::endl;
+        }
+        std::cout << std::endl << "Saved: " << log.path().string() << std::endl;
+
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,698 @@
+/**
+ * Bayesian-Optimization PID Tuning - Header-Only C++ Version
+ *
+ * Finds a p2-1 gain set in a handful of hardware step runs instead of the
+ * fixed sweeps of tune_kp.py / tune_kd.py:
+ *
+ * 1. Screening: a Sobol set of (Kp, Ki, Kd) candidates is simulated with the
+ *    identified plant (τ, K, dead time, deadzone, friction). Candidates far
+ *    outside the requirements in simulation never reach the motor.
+ * 2. Surrogate: for each measured quantity (normalized IAE, overshoot,
+ *    late error) a Gaussian process models the difference between the
+ *    hardware and the simulation, so the simulator acts as the prior mean
+ *    and the GP learns only the model mismatch.
+ * 3. Acquisition: the next experiment maximizes the constrained expected
+ *    improvement EI(IAE) · P(overshoot <= limit) · P(late error <= band) over
+ *    the screened candidates.
+ *
+ * The settling requirement is modelled through the late error, the largest
+ * |r - y| from the settling limit on: it is within the band exactly when the
+ * response has settled in time, but unlike the settling time it does not
+ * jump to the run length when the band is missed by a hair.
+ *
+ * The GP uses a Matérn 5/2 kernel with one length scale per gain on the
+ * unit cube (Kp on a log scale); length scales and noise are fitted by
+ * maximizing the marginal likelihood (Nelder-Mead from plant_models.hpp).
+ *
+ * IMPORTANT:
+ * - This is a HEADER-ONLY library for PC-side tools (DO NOT include in Arduino code)
+ *
+ * Requirements:
+ * - C++17 or higher
+ * - -pthread (screening runs on all cores)
+ *
+ * Usage:
+ *   #include "bayes_tune.hpp"
+ *
+ *   BayesTune::SimModel model{tau, K};
+ *   BayesTune::Tuner tuner(BayesTune::SearchSpace{}, model, BayesTune::Requirements{});
+ *   tuner.screen();
+ *   auto next = tuner.propose();
+ *   tuner.observe(next.gains, measured);
+ */
+
+#ifndef BAYES_TUNE_HPP
+#define BAYES_TUNE_HPP
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <fstream>
+#include <limits>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "data_loader.hpp"
+#include "friction_id.hpp"
+#include "motor_sim.hpp"
+#include "plant_models.hpp"
+#include "sensitivity.hpp"
+#include "step_metrics.hpp"
+
+namespace BayesTune {
+
+constexpr double TICK = 0.01;   // p2-1.cpp / kp.cpp interval (10 ms)
+
+using Point = std::array<double, 3>;   // gains on the unit cube
+
+struct Gains {
+    double Kp = 0.0;
+    double Ki = 0.0;
+    double Kd = 0.0;
+};
+
+/**
+ * Gain interval; log-scaled intervals need low > 0
+ */
+struct Range {
+    double low;
+    double high;
+    bool log_scale = false;
+
+    double to_value(double u) const {
+        if (log_scale) {
+            return low * std::pow(high / low, u);
+        }
+        return low + u * (high - low);
+    }
+
+    double to_unit(double value) const {
+        double u = log_scale ? std::log(value / low) / std::log(high / low)
+                             : (value - low) / (high - low);
+        return std::clamp(u, 0.0, 1.0);
+    }
+};
+
+struct SearchSpace {
+    Range kp{0.5, 30.0, true};
+    Range ki{0.0, 10.0};
+    Range kd{0.0, 1.5};
+
+    Gains to_gains(const Point& u) const { return {kp.to_value(u[0]), ki.to_value(u[1]), kd.to_value(u[2])}; }
+    Point to_unit(const Gains& g) const { return {kp.to_unit(g.Kp), ki.to_unit(g.Ki), kd.to_unit(g.Kd)}; }
+};
+
+/**
+ * Step-response requirements of p2-1 (overshoot < 15%, settling <= 0.5 s)
+ */
+struct Requirements {
+    double max_overshoot = 15.0;   // %
+    double max_settling = 0.5;     // s
+    double settling_band = 2.0;    // % of the step
+};
+
+/**
+ * Result of one step run (simulated or measured)
+ *
+ * iae is ∫|r - y| dt / |r| in seconds; a response that never settles gets
+ * the run duration as settling time so it stays comparable. late_error is
+ * the largest |r - y| in % of the step from the settling limit on.
+ */
+struct Outcome {
+    double iae = 0.0;
+    double overshoot = 0.0;
+    double settling = 0.0;
+    double late_error = 0.0;
+
+    bool feasible(const Requirements& req) const {
+        return overshoot <= req.max_overshoot && settling <= req.max_settling;
+    }
+};
+
+/**
+ * Metrics of a step from 0 to `reference` sampled at t (t[0] = step instant)
+ */
+inline Outcome evaluate(const std::vector<double>& t, const std::vector<double>& y, double reference,
+                        double duration, const Requirements& req) {
+    Outcome o;
+    if (t.size() < 2 || reference == 0.0) {
+        o.iae = duration;
+        o.settling = duration;
+        o.late_error = 100.0;
+        return o;
+    }
+    auto m = StepMetrics::compute(t.data(), y.data(), t.size(), reference, req.settling_band / 100.0);
+    o.overshoot = m.overshoot;
+    o.settling = std::isnan(m.settling_time) ? duration : m.settling_time;
+    for (size_t i = 1; i < t.size(); ++i) {
+        o.iae += std::fabs(reference - y[i - 1]) * (t[i] - t[i - 1]);
+    }
+    for (size_t i = 0; i < t.size(); ++i) {
+        if (t[i] - t[0] >= req.max_settling - 1e-9) {
+            o.late_error = std::max(o.late_error, std::fabs(reference - y[i]));
+        }
+    }
+    // A run cut short keeps its last error for the remaining time
+    double recorded = t.back() - t.front();
+    if (recorded < duration - 2 * TICK) {
+        o.iae += std::fabs(reference - y.back()) * (duration - recorded);
+        o.late_error = std::max(o.late_error, std::fabs(reference - y.back()));
+        o.settling = duration;
+    }
+    o.iae /= std::fabs(reference);
+    o.late_error *= 100.0 / std::fabs(reference);
+    return o;
+}
+
+/**
+ * Plant used for screening and as the GP prior mean
+ */
+struct SimModel {
+    double tau = 0.1;
+    double K = 12.0;
+    double dead_time = 0.0;                      // s
+    double deadzone = MotorSim::PWM_DEADZONE;    // PWM counts
+    MotorSim::FrictionParams friction{};
+};
+
+/**
+ * Simulated step of the kp.cpp / p2-1.cpp PID loop
+ */
+inline Outcome simulate(const SimModel& model, const Gains& g, double reference, double duration,
+                        const Requirements& req = {}) {
+    const double sim_dt = 0.001;
+    const int steps_per_tick = static_cast<int>(std::lround(TICK / sim_dt));
+    MotorSim::MotorModel motor(model.tau, model.K, sim_dt, model.friction);
+    motor.set_dead_time(model.dead_time);
+    MotorSim::PIDController pid(g.Kp, g.Ki, g.Kd, TICK);
+
+    int n_ticks = static_cast<int>(std::lround(duration / TICK));
+    std::vector<double> t, y;
+    t.reserve(n_ticks);
+    y.reserve(n_ticks);
+    for (int k = 0; k < n_ticks; ++k) {
+        double pos = motor.get_position();
+        t.push_back(k * TICK);
+        y.push_back(pos);
+        double u = MotorSim::apply_pwm_limits(pid.update(reference - pos), model.deadzone);
+        for (int s = 0; s < steps_per_tick; ++s) {
+            motor.update(u);
+        }
+    }
+    return evaluate(t, y, reference, duration, req);
+}
+
+inline double normal_pdf(double z) {
+    return std::exp(-0.5 * z * z) / std::sqrt(2.0 * M_PI);
+}
+
+inline double normal_cdf(double z) {
+    return 0.5 * std::erfc(-z / std::sqrt(2.0));
+}
+
+/**
+ * Expected improvement of a minimization below `best`
+ */
+inline double expected_improvement(double mean, double sd, double best) {
+    if (sd <= 0.0) {
+        return std::max(0.0, best - mean);
+    }
+    double z = (best - mean) / sd;
+    return (best - mean) * normal_cdf(z) + sd * normal_pdf(z);
+}
+
+struct Prediction {
+    double mean = 0.0;
+    double sd = 0.0;
+};
+
+/**
+ * Gaussian process with a Matérn 5/2 ARD kernel on the unit cube
+ *
+ * The signal variance is profiled out of the likelihood; length scales and
+ * the noise ratio are fitted once there are enough points. `prior_sd` is the
+ * spread expected before any data and the least signal deviation assumed
+ * afterwards, so a few agreeing points do not make the model overconfident
+ * away from them.
+ */
+class GaussianProcess {
+public:
+    explicit GaussianProcess(double prior_sd = 0.0) : prior_sd_(prior_sd) {}
+
+    void fit(const std::vector<Point>& x, const std::vector<double>& y) {
+        x_ = x;
+        size_t n = x.size();
+        offset_ = 0.0;
+        for (double v : y) {
+            offset_ += v;
+        }
+        offset_ = n ? offset_ / n : 0.0;
+        r_.resize(n);
+        for (size_t i = 0; i < n; ++i) {
+            r_[i] = y[i] - offset_;
+        }
+
+        params_ = {std::log(0.3), std::log(0.3), std::log(0.3), std::log(1e-3)};
+        if (n >= MIN_FIT_POINTS) {
+            auto cost = [&](const std::vector<double>& p) { return neg_log_likelihood(clamp_params(p)); };
+            params_ = clamp_params(PlantModels::nelder_mead(cost, params_, 0.5, 300, 1e-6));
+        }
+        factor(params_);
+    }
+
+    Prediction predict(const Point& p) const {
+        size_t n = x_.size();
+        Prediction pred{offset_, prior_sd_};
+        if (n == 0) {
+            return pred;
+        }
+        std::vector<double> k(n);
+        for (size_t i = 0; i < n; ++i) {
+            k[i] = correlation(p, x_[i], params_);
+        }
+        double mean = offset_;
+        for (size_t i = 0; i < n; ++i) {
+            mean += k[i] * alpha_[i];
+        }
+        // v = L⁻¹ k; latent variance σ² (1 - vᵀv)
+        std::vector<double> v(k);
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t j = 0; j < i; ++j) {
+                v[i] -= L_[i * n + j] * v[j];
+            }
+            v[i] /= L_[i * n + i];
+        }
+        double reduction = 0.0;
+        for (double vi : v) {
+            reduction += vi * vi;
+        }
+        double var = variance_ * std::max(0.0, 1.0 - reduction);
+        pred.mean = mean;
+        pred.sd = std::sqrt(std::max(var, 1e-12));
+        return pred;
+    }
+
+    std::array<double, 3> length_scales() const {
+        return {std::exp(params_[0]), std::exp(params_[1]), std::exp(params_[2])};
+    }
+
+private:
+    static constexpr size_t MIN_FIT_POINTS = 4;
+
+    static std::vector<double> clamp_params(std::vector<double> p) {
+        for (size_t d = 0; d < 3; ++d) {
+            p[d] = std::clamp(p[d], std::log(0.05), std::log(3.0));
+        }
+        p[3] = std::clamp(p[3], std::log(1e-6), std::log(0.3));
+        return p;
+    }
+
+    static double correlation(const Point& a, const Point& b, const std::vector<double>& p) {
+        double r2 = 0.0;
+        for (size_t d = 0; d < 3; ++d) {
+            double diff = (a[d] - b[d]) / std::exp(p[d]);
+            r2 += diff * diff;
+        }
+        double s = std::sqrt(5.0 * r2);
+        return (1.0 + s + 5.0 * r2 / 3.0) * std::exp(-s);
+    }
+
+    // Cholesky of R = C + g I; false if not positive definite
+    bool cholesky(const std::vector<double>& p, std::vector<double>& L) const {
+        size_t n = x_.size();
+        double g = std::exp(p[3]);
+        L.assign(n * n, 0.0);
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t j = 0; j <= i; ++j) {
+                double sum = correlation(x_[i], x_[j], p) + (i == j ? g : 0.0);
+                for (size_t k = 0; k < j; ++k) {
+                    sum -= L[i * n + k] * L[j * n + k];
+                }
+                if (i == j) {
+                    if (sum <= 0.0) {
+                        return false;
+                    }
+                    L[i * n + i] = std::sqrt(sum);
+                } else {
+                    L[i * n + j] = sum / L[j * n + j];
+                }
+            }
+        }
+        return true;
+    }
+
+    // R⁻¹ r by forward and back substitution
+    std::vector<double> solve(const std::vector<double>& L) const {
+        size_t n = x_.size();
+        std::vector<double> z(r_);
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t j = 0; j < i; ++j) {
+                z[i] -= L[i * n + j] * z[j];
+            }
+            z[i] /= L[i * n + i];
+        }
+        for (size_t i = n; i-- > 0;) {
+            for (size_t j = i + 1; j < n; ++j) {
+                z[i] -= L[j * n + i] * z[j];
+            }
+            z[i] /= L[i * n + i];
+        }
+        return z;
+    }
+
+    double neg_log_likelihood(const std::vector<double>& p) const {
+        std::vector<double> L;
+        if (!cholesky(p, L)) {
+            return std::numeric_limits<double>::max();
+        }
+        size_t n = x_.size();
+        auto z = solve(L);
+        double quad = 0.0, log_det = 0.0;
+        for (size_t i = 0; i < n; ++i) {
+            quad += r_[i] * z[i];
+            log_det += std::log(L[i * n + i]);
+        }
+        double s2 = std::max(quad / n, 1e-12);
+        return 0.5 * n * std::log(s2) + log_det;
+    }
+
+    void factor(const std::vector<double>& p) {
+        size_t n = x_.size();
+        variance_ = 0.0;
+        alpha_.clear();
+        if (n == 0) {
+            return;
+        }
+        auto q = p;
+        while (!cholesky(q, L_)) {
+            q[3] += std::log(10.0);   // add jitter until R is positive definite
+        }
+        params_ = q;
+        alpha_ = solve(L_);
+        double quad = 0.0;
+        for (size_t i = 0; i < n; ++i) {
+            quad += r_[i] * alpha_[i];
+        }
+        variance_ = std::max(quad / n, prior_sd_ * prior_sd_);
+    }
+
+    double prior_sd_;
+    std::vector<Point> x_;
+    std::vector<double> r_;
+    double offset_ = 0.0;
+    std::vector<double> params_{std::log(0.3), std::log(0.3), std::log(0.3), std::log(1e-3)};
+    std::vector<double> L_;
+    std::vector<double> alpha_;
+    double variance_ = 0.0;
+};
+
+struct Candidate {
+    Gains gains;
+    Point u;
+    Outcome sim;
+};
+
+/**
+ * Hardware run with the simulation at the same gains
+ */
+struct Observation {
+    Gains gains;
+    Point u;
+    Outcome sim;
+    Outcome measured;
+};
+
+/**
+ * Next experiment and what the surrogate expects from it
+ */
+struct Proposal {
+    size_t index = 0;          // into Tuner::candidates()
+    Gains gains;
+    Outcome sim;
+    Prediction iae, overshoot, late_error;
+    double p_feasible = 0.0;
+    double acquisition = 0.0;  // constrained EI (0 before the first feasible run)
+};
+
+struct Settings {
+    double reference = 200.0;    // deg step
+    double duration = 2.0;       // s recorded per run
+    size_t candidates = 4096;    // Sobol points simulated
+    double screen_slack = 2.0;   // keep candidates within slack × requirements in simulation
+    size_t threads = 0;          // 0 = all cores
+};
+
+class Tuner {
+public:
+    Tuner(const SearchSpace& space, const SimModel& model, const Requirements& req,
+          const Settings& settings = {})
+        : space_(space), model_(model), req_(req), settings_(settings),
+          gp_iae_(0.05), gp_overshoot_(5.0), gp_late_(1.0) {}
+
+    /**
+     * Simulate the Sobol candidates; returns how many pass the screen
+     */
+    size_t screen() {
+        Sensitivity::SobolSequence seq(3);
+        std::vector<std::vector<double>> points(settings_.candidates);
+        for (auto& p : points) {
+            p = seq.next();
+        }
+        auto model = [&](const std::vector<double>& p) {
+            auto o = simulate(model_, space_.to_gains({p[0], p[1], p[2]}), settings_.reference,
+                              settings_.duration, req_);
+            return std::vector<double>{o.iae, o.overshoot, o.settling, o.late_error};
+        };
+        auto values = Sensitivity::evaluate_all(points, model, settings_.threads);
+
+        candidates_.clear();
+        for (size_t i = 0; i < points.size(); ++i) {
+            Outcome o{values[i][0], values[i][1], values[i][2], values[i][3]};
+            if (o.overshoot <= req_.max_overshoot * settings_.screen_slack &&
+                o.settling <= req_.max_settling * settings_.screen_slack) {
+                Point u{points[i][0], points[i][1], points[i][2]};
+                candidates_.push_back({space_.to_gains(u), u, o});
+            }
+        }
+        screened_ = points.size();
+        return candidates_.size();
+    }
+
+    size_t screened() const { return screened_; }
+    const std::vector<Candidate>& candidates() const { return candidates_; }
+    const std::vector<Observation>& observations() const { return observations_; }
+    const Requirements& requirements() const { return req_; }
+
+    /**
+     * Record a hardware run (gains need not be a candidate, e.g. from a log)
+     */
+    const Observation& observe(const Gains& gains, const Outcome& measured) {
+        Observation obs{gains, space_.to_unit(gains),
+                        simulate(model_, gains, settings_.reference, settings_.duration, req_),
+                        measured};
+        observations_.push_back(obs);
+        refit();
+        return observations_.back();
+    }
+
+    /**
+     * Best feasible hardware run so far
+     */
+    std::optional<size_t> best() const {
+        std::optional<size_t> best;
+        for (size_t i = 0; i < observations_.size(); ++i) {
+            const auto& m = observations_[i].measured;
+            if (m.feasible(req_) && (!best || m.iae < observations_[*best].measured.iae)) {
+                best = i;
+            }
+        }
+        return best;
+    }
+
+    /**
+     * Candidate with the highest constrained EI; before any feasible run,
+     * the one most likely to be feasible (ties: lowest predicted IAE)
+     */
+    Proposal propose() const {
+        if (candidates_.empty()) {
+            throw std::runtime_error("No candidate passes the simulation screen; widen the search space");
+        }
+        bool incumbent = best().has_value();
+        Proposal result;
+        bool found = false;
+        double best_score = -1.0, best_mean = 0.0;
+        for (size_t i = 0; i < candidates_.size(); ++i) {
+            const auto& c = candidates_[i];
+            if (already_run(c.u)) {
+                continue;
+            }
+            Proposal p = predict(i);
+            double score = incumbent ? p.acquisition : p.p_feasible;
+            // Equal scores (e.g. several sure-feasible sets) go to the lower IAE
+            bool better = score > best_score * (1.0 + 1e-9) ||
+                          (score >= best_score * (1.0 - 1e-9) && p.iae.mean < best_mean);
+            if (!found || better) {
+                result = p;
+                best_score = score;
+                best_mean = p.iae.mean;
+                found = true;
+            }
+        }
+        if (!found) {
+            throw std::runtime_error("Every screened candidate has been run");
+        }
+        return result;
+    }
+
+    /**
+     * Surrogate prediction for candidate `index`
+     */
+    Proposal predict(size_t index) const {
+        const auto& c = candidates_[index];
+        Proposal p;
+        p.index = index;
+        p.gains = c.gains;
+        p.sim = c.sim;
+        p.iae = shifted(gp_iae_.predict(c.u), c.sim.iae);
+        p.overshoot = shifted(gp_overshoot_.predict(c.u), c.sim.overshoot);
+        p.late_error = shifted(gp_late_.predict(c.u), c.sim.late_error);
+        p.p_feasible = normal_cdf((req_.max_overshoot - p.overshoot.mean) / p.overshoot.sd) *
+                       normal_cdf((req_.settling_band - p.late_error.mean) / p.late_error.sd);
+        auto incumbent = best();
+        if (incumbent) {
+            p.acquisition = expected_improvement(p.iae.mean, p.iae.sd,
+                                                 observations_[*incumbent].measured.iae) *
+                            p.p_feasible;
+        }
+        return p;
+    }
+
+    const GaussianProcess& iae_model() const { return gp_iae_; }
+
+private:
+    static Prediction shifted(Prediction residual, double sim) {
+        residual.mean += sim;
+        return residual;
+    }
+
+    bool already_run(const Point& u) const {
+        for (const auto& obs : observations_) {
+            double d2 = 0.0;
+            for (size_t d = 0; d < 3; ++d) {
+                d2 += (obs.u[d] - u[d]) * (obs.u[d] - u[d]);
+            }
+            if (d2 < 1e-10) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // GPs on hardware - simulation
+    void refit() {
+        std::vector<Point> x;
+        std::vector<double> iae, overshoot, late;
+        for (const auto& obs : observations_) {
+            x.push_back(obs.u);
+            iae.push_back(obs.measured.iae - obs.sim.iae);
+            overshoot.push_back(obs.measured.overshoot - obs.sim.overshoot);
+            late.push_back(obs.measured.late_error - obs.sim.late_error);
+        }
+        gp_iae_.fit(x, iae);
+        gp_overshoot_.fit(x, overshoot);
+        gp_late_.fit(x, late);
+    }
+
+    SearchSpace space_;
+    SimModel model_;
+    Requirements req_;
+    Settings settings_;
+    std::vector<Candidate> candidates_;
+    std::vector<Observation> observations_;
+    size_t screened_ = 0;
+    GaussianProcess gp_iae_, gp_overshoot_, gp_late_;
+};
+
+/**
+ * Load the plant for screening: τ, K from the 1-3 summary, friction from
+ * the latest friction_*.json if present
+ */
+inline SimModel load_sim_model(bool verbose = true) {
+    SimModel model;
+    auto [tau, K] = DataLoader::load_system_parameters("1-3", verbose);
+    model.tau = tau;
+    model.K = K;
+    try {
+        model.friction = FrictionId::load_latest_friction("1-3", false);
+        if (verbose) {
+            std::cout << "Using friction from the latest 1-3 friction_*.json" << std::endl;
+        }
+    } catch (const std::exception&) {
+        // Frictionless model
+    }
+    return model;
+}
+
+/**
+ * Run log: data/<task>/bayes_tune_<timestamp>.csv, one row per hardware run,
+ * flushed as it goes so an interrupted session can be resumed
+ */
+class RunLog {
+public:
+    explicit RunLog(const std::string& task_name) {
+        fs::path data_dir = DataLoader::get_task_data_dir(task_name);
+        fs::create_directories(data_dir);
+        path_ = data_dir / ("bayes_tune_" + FrictionId::make_timestamp() + ".csv");
+        out_.open(path_);
+        if (!out_.is_open()) {
+            throw std::runtime_error("Failed to open file: " + path_.string());
+        }
+        out_ << "run,Kp,Ki,Kd,iae,overshoot,settling,late_error,sim_iae,sim_overshoot,sim_settling,feasible\n";
+        out_.flush();
+    }
+
+    void append(size_t run, const Observation& obs, const Requirements& req) {
+        out_ << run << "," << obs.gains.Kp << "," << obs.gains.Ki << "," << obs.gains.Kd << ","
+             << obs.measured.iae << "," << obs.measured.overshoot << "," << obs.measured.settling << ","
+             << obs.measured.late_error << ","
+             << obs.sim.iae << "," << obs.sim.overshoot << "," << obs.sim.settling << ","
+             << (obs.measured.feasible(req) ? 1 : 0) << "\n";
+        out_.flush();
+    }
+
+    const fs::path& path() const { return path_; }
+
+private:
+    fs::path path_;
+    std::ofstream out_;
+};
+
+/**
+ * Hardware runs of an earlier bayes_tune_*.csv as (gains, measured) pairs
+ */
+inline std::vector<std::pair<Gains, Outcome>> load_run_log(const fs::path& path) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to open file: " + path.string());
+    }
+    std::vector<std::pair<Gains, Outcome>> runs;
+    std::string line;
+    std::getline(file, line);   // header
+    while (std::getline(file, line)) {
+        std::stringstream ss(line);
+        std::string cell;
+        std::vector<double> v;
+        while (std::getline(ss, cell, ',')) {
+            v.push_back(std::atof(cell.c_str()));
+        }
+        if (v.size() >= 8) {
+            runs.push_back({{v[1], v[2], v[3]}, {v[4], v[5], v[6], v[7]}});
+        }
+    }
+    return runs;
+}
+
+} // namespace BayesTune
+
+#endif // BAYES_TUNE_HPP
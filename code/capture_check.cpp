@@ -0,0 +1,163 @@
+/**
+ * Capture Quality Scan using capture_check.hpp
+ *
+ * Checks every raw_data_*.csv and pid_data_*.csv under data/ (or one task,
+ * or given files) for duplicated/backwards timestamps, gaps, NaN values,
+ * encoder jumps beyond the identified model and stuck PWM saturation, and
+ * prints one line per capture. With --quarantine, failing captures are
+ * moved to data/<task>/quarantine/ so no analysis loads them (NOT for Arduino).
+ *
+ * Compilation:
+ *   g++ -std=c++17 -O2 -march=native capture_check.cpp -o capture_check
+ *
+ * Usage:
+ *   ./capture_check                         (all tasks, report only)
+ *   ./capture_check --task 1-3 --quarantine
+ *   ./capture_check --margin 2.0 --gap 5 --saturation 3.0
+ *   ./capture_check path/to/raw_data_20250101_120000.csv
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include "capture_check.hpp"
+
+namespace {
+
+bool is_capture(const fs::path& path) {
+    std::string name = path.filename().string();
+    return path.extension() == ".csv" &&
+           (name.rfind("raw_data_", 0) == 0 || name.rfind("pid_data_", 0) == 0);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    fs::path root = DataLoader::get_project_root() / "data";
+    std::string task;
+    std::vector<fs::path> files;
+    bool move = false;
+    bool verbose = false;
+    double margin = 1.5;
+    CaptureCheck::Bounds bounds;
+
+    for (int i = 1; i < argc; ++i) {
+        bool has_value = i + 1 < argc;
+        if (std::strcmp(argv[i], "--task") == 0 && has_value) {
+            task = argv[++i];
+        } else if (std::strcmp(argv[i], "--root") == 0 && has_value) {
+            root = argv[++i];
+        } else if (std::strcmp(argv[i], "--margin") == 0 && has_value) {
+            margin = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--gap") == 0 && has_value) {
+            bounds.gap_factor = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--saturation") == 0 && has_value) {
+            bounds.max_saturation_time = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--quarantine") == 0) {
+            move = true;
+        } else if (std::strcmp(argv[i], "--verbose") == 0) {
+            verbose = true;
+        } else if (argv[i][0] != '-') {
+            files.emplace_back(argv[i]);
+        } else {
+            std::cerr << "Unknown option: " << argv[i] << std::endl;
+            return 1;
+        }
+    }
+
+    std::cout << "========================================" << std::endl;
+    std::cout << "Capture Quality Scan (" << CaptureCheck::simd::name() << ")" << std::endl;
+    std::cout << "========================================" << std::endl;
+
+    if (CaptureCheck::load_model_bounds(root, bounds, margin)) {
+        std::printf("Model bounds (margin %.2f): |v| <= %.1f deg/s, |a| <= %.0f deg/s^2\n", margin,
+                    bounds.max_speed, bounds.max_accel);
+    } else {
+        std::cout << "No 1-3 summary: checking timestamps and values only" << std::endl;
+    }
+    std::cout << std::endl;
+
+    try {
+        if (files.empty()) {
+            if (!fs::exists(root)) {
+                throw std::runtime_error("Directory not found: " + root.string());
+            }
+            for (const auto& dir : fs::directory_iterator(root)) {
+                if (!dir.is_directory() || (!task.empty() && dir.path().filename() != task)) {
+                    continue;
+                }
+                for (const auto& entry : fs::directory_iterator(dir.path())) {
+                    if (entry.is_regular_file() && is_capture(entry.path())) {
+                        files.push_back(entry.path());
+                    }
+                }
+            }
+            std::sort(files.begin(), files.end());
+        }
+
+        size_t bad = 0, failed = 0, samples = 0;
+        uintmax_t bytes = 0;
+        double scan_seconds = 0.0;
+        auto start = std::chrono::steady_clock::now();
+
+        for (const auto& path : files) {
+            std::string label = "[" + path.parent_path().filename().string() + "] " +
+                                path.filename().string();
+            try {
+                bytes += fs::file_size(path);
+                std::string name = path.filename().string();
+                CaptureCheck::Report report;
+                if (name.rfind("raw_data_", 0) == 0) {
+                    auto data = DataLoader::load_raw_data(path);
+                    auto t0 = std::chrono::steady_clock::now();
+                    report = CaptureCheck::check(data, bounds);
+                    scan_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+                } else {
+                    auto data = DataLoader::load_pid_data(path);
+                    auto t0 = std::chrono::steady_clock::now();
+                    report = CaptureCheck::check(data, bounds);
+                    scan_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+                }
+                samples += report.samples;
+
+                if (report.quarantine()) {
+                    ++bad;
+                    std::cout << label << ": BAD (" << report.summary() << ")";
+                    if (move) {
+                        CaptureCheck::quarantine(path, report);
+                        std::cout << " -> quarantine/";
+                    }
+                    std::cout << std::endl;
+                } else {
+                    std::cout << label << ": ok" << (report.issues.empty() ? "" : " (warnings)")
+                              << std::endl;
+                }
+                if (verbose || report.quarantine()) {
+                    for (const auto& issue : report.issues) {
+                        std::printf("    %-17s %6zu  first at %.3f s  %s%s\n", issue.code.c_str(),
+                                    issue.count, issue.first_time, issue.detail.c_str(),
+                                    issue.fatal ? "" : " (warning)");
+                    }
+                }
+            } catch (const std::exception& e) {
+                ++failed;
+                std::cout << label << ": failed (" << e.what() << ")" << std::endl;
+            }
+        }
+
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << std::endl;
+        std::cout << "Captures: " << files.size() << ", bad: " << bad << ", unreadable: " << failed
+                  << (move && bad ? " (bad ones moved to quarantine/)" : "") << std::endl;
+        std::printf("Read %.1f MB, %zu samples in %.3f s (checks %.3f s, %.0f Msamples/s)\n",
+                    bytes / 1e6, samples, elapsed, scan_seconds,
+                    scan_seconds > 0 ? samples / scan_seconds / 1e6 : 0.0);
+        return bad > 0 ? 2 : 0;
+
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,592 @@
+/**
+ * Capture Check - Header-Only C++ Version
+ *
+ * Data-quality scan of raw_data_*.csv and pid_data_*.csv before their τ, K
+ * or step metrics are used:
+ * - time:       duplicated or backwards timestamps, gaps (> gap_factor × the
+ *               median sample period)
+ * - values:     NaN/inf, malformed lines the loader skipped, |duty| > 255
+ *               (raw_data; pid_data logs the unclamped controller output)
+ * - encoder:    jumps no motor of the identified model can make
+ *               (raw_data: |ω| above the top speed or |Δω| above the
+ *               full-reversal acceleration; pid_data: |Δθ| above top speed × Δt)
+ * - saturation: controller output pinned at ±255 for longer than
+ *               max_saturation_time (pid_data)
+ *
+ * The plausibility bounds come from the 1-3 model (Bounds::from_model):
+ *   top speed  ω_max = margin · K · 255
+ *   top accel  a_max = margin · 2 · K · 255 / τ    (full reversal)
+ * plus one encoder count of quantization per sample.
+ *
+ * Each check is a single pass over a column using AVX (4 doubles) or SSE2
+ * (2 doubles) when the compiler targets them, scalar code otherwise. Build
+ * with -march=native to get the AVX path.
+ *
+ * IMPORTANT:
+ * - This is a HEADER-ONLY library for PC-side tools (DO NOT include in Arduino code)
+ *
+ * Requirements:
+ * - C++17 or higher
+ *
+ * Usage:
+ *   #include "capture_check.hpp"
+ *
+ *   auto [tau, K] = DataLoader::load_system_parameters("1-3");
+ *   auto bounds = CaptureCheck::Bounds::from_model(tau, K);
+ *   auto report = CaptureCheck::check(DataLoader::load_raw_data(path), bounds);
+ *   if (report.quarantine()) { CaptureCheck::quarantine(path, report); }
+ */
+
+#ifndef CAPTURE_CHECK_HPP
+#define CAPTURE_CHECK_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+#include "data_loader.hpp"
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+namespace CaptureCheck {
+
+constexpr double PWM_MAX = 255.0;
+constexpr double ENCODER_STEP = 360.0 / 374.0;  // deg per count (PPR in p1-3.cpp)
+
+/**
+ * Plausibility bounds (infinite = check disabled)
+ */
+struct Bounds {
+    double max_speed = std::numeric_limits<double>::infinity();  // deg/s
+    double max_accel = std::numeric_limits<double>::infinity();  // deg/s²
+    double encoder_step = ENCODER_STEP;    // deg, quantization allowed per sample
+    double gap_factor = 3.0;               // gap: Δt > gap_factor × median Δt
+    double max_gap_fraction = 0.05;        // quarantine when gaps exceed this share of the run
+    double saturation_level = PWM_MAX;     // |u| at or above this is saturated
+    double max_saturation_time = 2.0;      // s
+
+    /**
+     * Bounds of the identified first-order model ω = K·u/(τs+1)
+     *
+     * @param margin headroom over the model (1.5 = 50%)
+     */
+    static Bounds from_model(double tau, double K, double margin = 1.5) {
+        Bounds b;
+        if (K > 0) {
+            b.max_speed = margin * K * PWM_MAX;
+            if (tau > 0) {
+                b.max_accel = margin * 2.0 * K * PWM_MAX / tau;
+            }
+        }
+        return b;
+    }
+};
+
+/**
+ * Count of flagged samples and the first one (npos if none)
+ */
+struct Hits {
+    static constexpr size_t npos = static_cast<size_t>(-1);
+    size_t count = 0;
+    size_t first = npos;
+
+    void add(size_t index) {
+        if (count++ == 0) {
+            first = index;
+        }
+    }
+};
+
+namespace simd {
+
+/**
+ * Lane operations; the compares return a bit mask with one bit per lane
+ */
+#if defined(__AVX__)
+struct Lanes {
+    using V = __m256d;
+    static constexpr size_t width = 4;
+    static V load(const double* p) { return _mm256_loadu_pd(p); }
+    static V set1(double x) { return _mm256_set1_pd(x); }
+    static V sub(V a, V b) { return _mm256_sub_pd(a, b); }
+    static V add(V a, V b) { return _mm256_add_pd(a, b); }
+    static V mul(V a, V b) { return _mm256_mul_pd(a, b); }
+    static V abs(V a) { return _mm256_andnot_pd(_mm256_set1_pd(-0.0), a); }
+    // !(a <= b): true for a > b and for NaN
+    static int not_le(V a, V b) { return _mm256_movemask_pd(_mm256_cmp_pd(a, b, _CMP_NLE_UQ)); }
+    static int le(V a, V b) { return _mm256_movemask_pd(_mm256_cmp_pd(a, b, _CMP_LE_OQ)); }
+    static int ge(V a, V b) { return _mm256_movemask_pd(_mm256_cmp_pd(a, b, _CMP_GE_OQ)); }
+};
+#elif defined(__SSE2__) || defined(_M_X64)
+struct Lanes {
+    using V = __m128d;
+    static constexpr size_t width = 2;
+    static V load(const double* p) { return _mm_loadu_pd(p); }
+    static V set1(double x) { return _mm_set1_pd(x); }
+    static V sub(V a, V b) { return _mm_sub_pd(a, b); }
+    static V add(V a, V b) { return _mm_add_pd(a, b); }
+    static V mul(V a, V b) { return _mm_mul_pd(a, b); }
+    static V abs(V a) { return _mm_andnot_pd(_mm_set1_pd(-0.0), a); }
+    static int not_le(V a, V b) { return _mm_movemask_pd(_mm_cmpnle_pd(a, b)); }
+    static int le(V a, V b) { return _mm_movemask_pd(_mm_cmple_pd(a, b)); }
+    static int ge(V a, V b) { return _mm_movemask_pd(_mm_cmpge_pd(a, b)); }
+};
+#else
+struct Lanes {
+    using V = double;
+    static constexpr size_t width = 1;
+    static V load(const double* p) { return *p; }
+    static V set1(double x) { return x; }
+    static V sub(V a, V b) { return a - b; }
+    static V add(V a, V b) { return a + b; }
+    static V mul(V a, V b) { return a * b; }
+    static V abs(V a) { return std::fabs(a); }
+    static int not_le(V a, V b) { return !(a <= b); }
+    static int le(V a, V b) { return a <= b; }
+    static int ge(V a, V b) { return a >= b; }
+};
+#endif
+
+inline const char* name() {
+    switch (Lanes::width) {
+        case 4: return "AVX";
+        case 2: return "SSE2";
+        default: return "scalar";
+    }
+}
+
+inline void add_mask(Hits& hits, int mask, size_t base) {
+    for (size_t lane = 0; mask != 0; ++lane, mask >>= 1) {
+        if (mask & 1) {
+            hits.add(base + lane);
+        }
+    }
+}
+
+/**
+ * Samples with |x[i]| > limit or NaN
+ */
+inline Hits magnitude_above(const double* x, size_t n, double limit) {
+    Hits hits;
+    const auto lim = Lanes::set1(limit);
+    size_t i = 0;
+    for (; i + Lanes::width <= n; i += Lanes::width) {
+        int mask = Lanes::not_le(Lanes::abs(Lanes::load(x + i)), lim);
+        if (mask) {
+            add_mask(hits, mask, i);
+        }
+    }
+    for (; i < n; ++i) {
+        if (!(std::fabs(x[i]) <= limit)) {
+            hits.add(i);
+        }
+    }
+    return hits;
+}
+
+/**
+ * Steps i -> i+1 with |x[i+1] - x[i]| > base + rate·(t[i+1] - t[i]) (index i+1)
+ */
+inline Hits step_above(const double* x, const double* t, size_t n, double base, double rate) {
+    Hits hits;
+    if (n < 2) {
+        return hits;
+    }
+    const auto b = Lanes::set1(base);
+    const auto r = Lanes::set1(rate);
+    size_t m = n - 1;  // Number of steps
+    size_t i = 0;
+    for (; i + Lanes::width <= m; i += Lanes::width) {
+        auto dx = Lanes::abs(Lanes::sub(Lanes::load(x + i + 1), Lanes::load(x + i)));
+        auto dt = Lanes::sub(Lanes::load(t + i + 1), Lanes::load(t + i));
+        int mask = Lanes::not_le(dx, Lanes::add(b, Lanes::mul(r, dt)));
+        if (mask) {
+            add_mask(hits, mask, i + 1);
+        }
+    }
+    for (; i < m; ++i) {
+        if (!(std::fabs(x[i + 1] - x[i]) <= base + rate * (t[i + 1] - t[i]))) {
+            hits.add(i + 1);
+        }
+    }
+    return hits;
+}
+
+/**
+ * Timestamp faults in one pass (index i+1 of the offending step)
+ */
+struct TimeHits {
+    Hits duplicate;   // Δt == 0
+    Hits backwards;   // Δt < 0
+    Hits gap;         // Δt > gap_limit
+    double gap_time = 0.0;  // s, sum of Δt over the gaps
+};
+
+inline TimeHits time_steps(const double* t, size_t n, double gap_limit) {
+    TimeHits th;
+    if (n < 2) {
+        return th;
+    }
+    const auto zero = Lanes::set1(0.0);
+    const auto lim = Lanes::set1(gap_limit);
+    size_t m = n - 1;
+    size_t i = 0;
+    auto scalar = [&](size_t k) {
+        double dt = t[k + 1] - t[k];
+        if (dt == 0.0) {
+            th.duplicate.add(k + 1);
+        } else if (dt < 0.0) {
+            th.backwards.add(k + 1);
+        } else if (dt > gap_limit) {
+            th.gap.add(k + 1);
+            th.gap_time += dt;
+        }
+    };
+    for (; i + Lanes::width <= m; i += Lanes::width) {
+        auto dt = Lanes::sub(Lanes::load(t + i + 1), Lanes::load(t + i));
+        // Good steps are 0 < Δt <= limit; revisit the (rare) blocks with a bad lane
+        if (Lanes::le(dt, zero) | Lanes::not_le(dt, lim)) {
+            for (size_t k = i; k < i + Lanes::width; ++k) {
+                scalar(k);
+            }
+        }
+    }
+    for (; i < m; ++i) {
+        scalar(i);
+    }
+    return th;
+}
+
+/**
+ * Longest run of |x| >= level, in samples (start index in `start`)
+ */
+inline size_t longest_run(const double* x, size_t n, double level, size_t& start) {
+    const auto lev = Lanes::set1(level);
+    const int full = (1 << Lanes::width) - 1;
+    size_t best = 0, run = 0, run_start = 0;
+    start = 0;
+    auto step = [&](bool on, size_t k) {
+        if (on) {
+            if (run++ == 0) {
+                run_start = k;
+            }
+            if (run > best) {
+                best = run;
+                start = run_start;
+            }
+        } else {
+            run = 0;
+        }
+    };
+    size_t i = 0;
+    for (; i + Lanes::width <= n; i += Lanes::width) {
+        int mask = Lanes::ge(Lanes::abs(Lanes::load(x + i)), lev);
+        if (mask == 0) {
+            run = 0;
+        } else if (mask == full && run > 0) {
+            run += Lanes::width;  // Run continues through the block
+            if (run > best) {
+                best = run;
+                start = run_start;
+            }
+        } else {
+            for (size_t lane = 0; lane < Lanes::width; ++lane) {
+                step((mask >> lane) & 1, i + lane);
+            }
+        }
+    }
+    for (; i < n; ++i) {
+        step(std::fabs(x[i]) >= level, i);
+    }
+    return best;
+}
+
+} // namespace simd
+
+/**
+ * Median sample period (from up to 4096 evenly spread steps)
+ */
+inline double median_period(const std::vector<double>& t) {
+    if (t.size() < 2) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    size_t m = t.size() - 1;
+    size_t stride = std::max<size_t>(1, m / 4096);
+    std::vector<double> dt;
+    dt.reserve(m / stride + 1);
+    for (size_t i = 0; i < m; i += stride) {
+        dt.push_back(t[i + 1] - t[i]);
+    }
+    auto mid = dt.begin() + dt.size() / 2;
+    std::nth_element(dt.begin(), mid, dt.end());
+    return *mid;
+}
+
+/**
+ * One anomaly class found in a capture
+ */
+struct Issue {
+    std::string code;        // e.g. "encoder_jump"
+    size_t count = 0;        // flagged samples
+    double first_time = 0.0; // s, time of the first one
+    bool fatal = false;      // makes the capture unusable
+    std::string detail;
+};
+
+struct Report {
+    std::string kind;
+    size_t samples = 0;
+    double period = std::numeric_limits<double>::quiet_NaN();  // s, median
+    double duration = 0.0;
+    std::vector<Issue> issues;
+
+    bool quarantine() const {
+        return std::any_of(issues.begin(), issues.end(), [](const Issue& i) { return i.fatal; });
+    }
+
+    /**
+     * One-line description of the fatal issues (or "ok")
+     */
+    std::string summary() const {
+        std::string out;
+        for (const auto& issue : issues) {
+            if (issue.fatal) {
+                out += (out.empty() ? "" : ", ") + issue.code + " x" + std::to_string(issue.count);
+            }
+        }
+        return out.empty() ? "ok" : out;
+    }
+
+    /**
+     * JSON object for the catalog ({"quarantine": ..., "issues": [...]})
+     */
+    std::string json() const {
+        auto number = [](double v) {
+            if (!std::isfinite(v)) {
+                return std::string("null");
+            }
+            std::ostringstream oss;
+            oss << std::setprecision(6) << v;
+            return oss.str();
+        };
+        std::ostringstream os;
+        os << "{\"quarantine\": " << (quarantine() ? "true" : "false") << ", \"samples\": " << samples
+           << ", \"period\": " << number(period) << ", \"issues\": [";
+        for (size_t i = 0; i < issues.size(); ++i) {
+            const auto& is = issues[i];
+            os << (i ? ", " : "") << "{\"code\": \"" << is.code << "\", \"count\": " << is.count
+               << ", \"first_time\": " << number(is.first_time)
+               << ", \"fatal\": " << (is.fatal ? "true" : "false") << ", \"detail\": \"" << is.detail
+               << "\"}";
+        }
+        os << "]}";
+        return os.str();
+    }
+};
+
+namespace detail {
+
+inline std::string fmt(double v) {
+    std::ostringstream oss;
+    oss << std::setprecision(4) << v;
+    return oss.str();
+}
+
+inline void add_issue(Report& r, const std::vector<double>& t, const std::string& code,
+                      const Hits& hits, bool fatal, const std::string& detail) {
+    if (hits.count == 0) {
+        return;
+    }
+    r.issues.push_back({code, hits.count, t.empty() ? 0.0 : t[std::min(hits.first, t.size() - 1)],
+                        fatal, detail});
+}
+
+/**
+ * Checks shared by both capture kinds: timestamps, non-finite values, skipped lines
+ */
+inline void check_common(Report& r, const std::vector<double>& t,
+                         const std::vector<std::pair<const char*, const std::vector<double>*>>& columns,
+                         size_t skipped_rows, const Bounds& bounds) {
+    r.samples = t.size();
+    if (t.size() < 2) {
+        r.issues.push_back({"too_short", t.size(), 0.0, true, "fewer than 2 samples"});
+        return;
+    }
+    r.period = median_period(t);
+    r.duration = t.back() - t.front();
+
+    for (const auto& [name, col] : columns) {
+        add_issue(r, t, "non_finite", simd::magnitude_above(col->data(), col->size(),
+                                                            std::numeric_limits<double>::max()),
+                  true, std::string("NaN or inf ") + name);
+    }
+    if (skipped_rows > 0) {
+        r.issues.push_back({"malformed_lines", skipped_rows, 0.0, false, "lines the loader skipped"});
+    }
+
+    double gap_limit = r.period > 0 ? bounds.gap_factor * r.period
+                                    : std::numeric_limits<double>::infinity();
+    auto th = simd::time_steps(t.data(), t.size(), gap_limit);
+    add_issue(r, t, "duplicate_time", th.duplicate, true, "repeated timestamp");
+    add_issue(r, t, "backwards_time", th.backwards, true, "timestamp went backwards");
+    bool long_gaps = r.duration > 0 && th.gap_time > bounds.max_gap_fraction * r.duration;
+    add_issue(r, t, "gap", th.gap, long_gaps,
+              fmt(th.gap_time) + " s missing (period " + fmt(r.period) + " s)");
+}
+
+} // namespace detail
+
+/**
+ * Scan a velocity capture (raw_data_*.csv)
+ */
+inline Report check(const DataLoader::RawData& data, const Bounds& bounds) {
+    Report r;
+    r.kind = "raw_data";
+    const auto& t = data.time;
+    detail::check_common(r, t,
+                         {{"time", &data.time}, {"velocity", &data.velocity}, {"duty", &data.duty}},
+                         data.skipped_rows, bounds);
+    if (t.size() < 2) {
+        return r;
+    }
+
+    detail::add_issue(r, t, "duty_range", simd::magnitude_above(data.duty.data(), data.duty.size(), PWM_MAX),
+                      true, "|duty| > 255");
+
+    // One encoder count per sample period is the velocity resolution
+    double quantum = r.period > 0 ? bounds.encoder_step / r.period : 0.0;
+    if (std::isfinite(bounds.max_speed)) {
+        detail::add_issue(r, t, "speed_limit",
+                          simd::magnitude_above(data.velocity.data(), data.velocity.size(),
+                                                bounds.max_speed + quantum),
+                          true, "|velocity| > " + detail::fmt(bounds.max_speed) + " deg/s");
+    }
+    if (std::isfinite(bounds.max_accel)) {
+        detail::add_issue(r, t, "encoder_jump",
+                          simd::step_above(data.velocity.data(), t.data(), t.size(), 2.0 * quantum,
+                                           bounds.max_accel),
+                          true, "|dv/dt| > " + detail::fmt(bounds.max_accel) + " deg/s^2");
+    }
+    return r;
+}
+
+/**
+ * Scan a position-loop capture (pid_data_*.csv)
+ */
+inline Report check(const DataLoader::PidData& data, const Bounds& bounds) {
+    Report r;
+    r.kind = "pid_data";
+    const auto& t = data.time;
+    detail::check_common(r, t,
+                         {{"time", &data.time}, {"position", &data.position},
+                          {"reference", &data.reference}, {"control", &data.control}},
+                         data.skipped_rows, bounds);
+    if (t.size() < 2) {
+        return r;
+    }
+
+    // No range check on control: p2-1 logs the PID output before clamping,
+    // so |control| > 255 is normal during a step (see stuck_saturation)
+
+    if (std::isfinite(bounds.max_speed)) {
+        detail::add_issue(r, t, "encoder_jump",
+                          simd::step_above(data.position.data(), t.data(), t.size(),
+                                           2.0 * bounds.encoder_step, bounds.max_speed),
+                          true, "|dpos/dt| > " + detail::fmt(bounds.max_speed) + " deg/s");
+    }
+
+    size_t start = 0;
+    size_t run = simd::longest_run(data.control.data(), data.control.size(), bounds.saturation_level,
+                                   start);
+    if (run > 1) {
+        double seconds = t[std::min(start + run - 1, t.size() - 1)] - t[start];
+        if (seconds > bounds.max_saturation_time) {
+            r.issues.push_back({"stuck_saturation", run, t[start], true,
+                                "control at the limit for " + detail::fmt(seconds) + " s"});
+        }
+    }
+    return r;
+}
+
+/**
+ * Load and scan any supported capture (raw_data_* or pid_data_*)
+ */
+inline Report check_file(const fs::path& path, const Bounds& bounds) {
+    std::string name = path.filename().string();
+    if (name.rfind("raw_data_", 0) == 0) {
+        return check(DataLoader::load_raw_data(path), bounds);
+    }
+    if (name.rfind("pid_data_", 0) == 0) {
+        return check(DataLoader::load_pid_data(path), bounds);
+    }
+    throw std::runtime_error("Not a raw_data or pid_data capture: " + name);
+}
+
+/**
+ * Model bounds from the latest <task>/summary_*.json under a data root
+ *
+ * @return false (bounds untouched) if there is no usable summary
+ */
+inline bool load_model_bounds(const fs::path& data_root, Bounds& bounds, double margin = 1.5,
+                              const std::string& task = "1-3") {
+    try {
+        fs::path summary = DataLoader::find_latest_file(data_root / task, "summary_");
+        std::ifstream file(summary);
+        std::string json((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        double tau = DataLoader::extract_json_number(json, "tau_average");
+        double K = DataLoader::extract_json_number(json, "K_average");
+        if (!(tau > 0) || !(K > 0)) {
+            return false;
+        }
+        Bounds model = Bounds::from_model(tau, K, margin);
+        bounds.max_speed = model.max_speed;
+        bounds.max_accel = model.max_accel;
+        return true;
+    } catch (const std::exception&) {
+        return false;
+    }
+}
+
+/**
+ * Folder quarantined captures are moved to (data/<task>/quarantine)
+ */
+inline fs::path quarantine_dir(const fs::path& capture) {
+    return capture.parent_path() / "quarantine";
+}
+
+/**
+ * Move a capture out of its task folder so no loader picks it up again;
+ * the report is kept next to it as <stem>.json
+ *
+ * @return new path of the capture
+ */
+inline fs::path quarantine(const fs::path& capture, const Report& report) {
+    fs::path dir = quarantine_dir(capture);
+    fs::create_directories(dir);
+    fs::path target = dir / capture.filename();
+    {
+        fs::path note = dir / (capture.stem().string() + ".json");
+        std::ofstream out(note);
+        if (!out.is_open()) {
+            throw std::runtime_error("Failed to open file: " + note.string());
+        }
+        out << "{\"file\": \"" << capture.filename().string() << "\", \"quality\": " << report.json()
+            << "}\n";
+    }
+    fs::rename(capture, target);
+    return target;
+}
+
+} // namespace CaptureCheck
+
+#endif // CAPTURE_CHECK_HPP
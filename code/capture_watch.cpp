@@ -0,0 +1,221 @@
+/**
+ * Capture Watcher using capture_watch.hpp
+ *
+ * Watches data/<task>/ with inotify and analyzes every capture the plotters
+ * save (raw_data_*, pid_data_*, summary_*) on a worker pool, then refreshes
+ * data/<task>/index.json and data/index.json (NOT for Arduino).
+ *
+ * On start, captures without an up-to-date analysis are processed first.
+ *
+ * raw_data/pid_data captures go through the quality scan of capture_check.hpp
+ * (bounds from the latest 1-3 summary) before they are analyzed; failing
+ * ones are flagged "quarantined" in the index, or moved to
+ * data/<task>/quarantine/ with --quarantine.
+ *
+ * Compilation:
+ *   g++ -std=c++17 -O2 capture_watch.cpp -o capture_watch -pthread
+ *
+ * Usage:
+ *   ./capture_watch                 (watch until Ctrl+C)
+ *   ./capture_watch --once          (catch up and exit; works on any OS)
+ *   ./capture_watch --threads 4 --root /path/to/data
+ *   ./capture_watch --once --quarantine --margin 2.0
+ *   ./capture_watch --no-check      (analyze everything as before)
+ */
+
+#include <atomic>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include "capture_watch.hpp"
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+std::atomic<bool> stop_requested{false};
+
+void on_signal(int) {
+    stop_requested = true;
+}
+
+std::mutex print_mutex;
+
+void report(const CaptureWatch::RunResult& r) {
+    std::lock_guard<std::mutex> lock(print_mutex);
+    std::cout << "[" << r.task << "] " << r.file << ": "
+              << (r.ok ? "analyzed" : r.quarantined ? r.error : "failed (" + r.error + ")") << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    bool once = false;
+    size_t threads = std::max(1u, std::thread::hardware_concurrency());
+    fs::path root = DataLoader::get_project_root() / "data";
+    bool quality_check = true;
+    bool move_quarantined = false;
+    double margin = 1.5;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--once") == 0) {
+            once = true;
+        } else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = static_cast<size_t>(std::max(1, std::atoi(argv[++i])));
+        } else if (std::strcmp(argv[i], "--root") == 0 && i + 1 < argc) {
+            root = argv[++i];
+        } else if (std::strcmp(argv[i], "--no-check") == 0) {
+            quality_check = false;
+        } else if (std::strcmp(argv[i], "--quarantine") == 0) {
+            move_quarantined = true;
+        } else if (std::strcmp(argv[i], "--margin") == 0 && i + 1 < argc) {
+            margin = std::atof(argv[++i]);
+        } else {
+            std::cerr << "Unknown option: " << argv[i] << std::endl;
+            return 1;
+        }
+    }
+
+    std::cout << "========================================" << std::endl;
+    std::cout << "Capture Watcher" << std::endl;
+    std::cout << "========================================" << std::endl;
+    std::cout << "Data root: " << root.string() << " (" << threads << " workers)" << std::endl;
+    std::cout << std::endl;
+
+    try {
+        fs::create_directories(root);
+        CaptureWatch::Catalog catalog(root);
+        if (quality_check) {
+            CaptureCheck::Bounds bounds;
+            if (CaptureCheck::load_model_bounds(root, bounds, margin)) {
+                std::cout << "Quality check: |v| <= " << bounds.max_speed << " deg/s, |a| <= "
+                          << bounds.max_accel << " deg/s^2" << std::endl;
+            } else {
+                std::cout << "Quality check: no 1-3 summary, timestamps and values only" << std::endl;
+            }
+            catalog.set_quality_check(bounds, move_quarantined);
+        }
+        CaptureWatch::WorkerPool pool(threads, [&](const fs::path& capture) {
+            // An exception must not leave the worker thread (std::terminate):
+            // a filesystem error (analysis dir, index, quarantine move) is
+            // reported like any other failed analysis
+            try {
+                if (!fs::exists(capture)) {
+                    catalog.remove(capture);
+                    return;
+                }
+                report(catalog.analyze(capture));
+            } catch (const std::exception& e) {
+                CaptureWatch::RunResult r;
+                r.task = capture.parent_path().filename().string();
+                r.file = capture.filename().string();
+                r.error = e.what();
+                report(r);
+            }
+        });
+
+        auto stale = catalog.scan();
+        std::cout << "Catching up: " << stale.size() << " capture(s) to analyze" << std::endl;
+        for (const auto& capture : stale) {
+            pool.submit(capture);
+        }
+        pool.wait_idle();
+        catalog.write_indexes(true);
+
+        if (once) {
+            std::cout << "Indexes written" << std::endl;
+            return 0;
+        }
+
+#ifdef __linux__
+        int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (fd < 0) {
+            throw std::runtime_error(std::string("inotify_init1 failed: ") + std::strerror(errno));
+        }
+
+        const uint32_t task_mask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_DELETE | IN_MOVED_FROM;
+        std::map<int, fs::path> watches;
+        auto watch_task = [&](const fs::path& dir) {
+            int wd = inotify_add_watch(fd, dir.c_str(), task_mask);
+            if (wd >= 0) {
+                watches[wd] = dir;
+            }
+        };
+        // New task directories appear under the root
+        int root_wd = inotify_add_watch(fd, root.c_str(), IN_CREATE | IN_MOVED_TO | IN_ONLYDIR);
+        for (const auto& entry : fs::directory_iterator(root)) {
+            if (entry.is_directory()) {
+                watch_task(entry.path());
+            }
+        }
+
+        std::signal(SIGINT, on_signal);
+        std::signal(SIGTERM, on_signal);
+        std::cout << "Watching " << watches.size() << " task folder(s), Ctrl+C to stop" << std::endl;
+
+        alignas(inotify_event) char buf[16 * 1024];
+        while (!stop_requested) {
+            pollfd p{fd, POLLIN, 0};
+            int ready = ::poll(&p, 1, 200);
+            if (ready > 0) {
+                ssize_t len;
+                while ((len = ::read(fd, buf, sizeof(buf))) > 0) {
+                    for (char* ptr = buf; ptr < buf + len;) {
+                        auto* ev = reinterpret_cast<inotify_event*>(ptr);
+                        ptr += sizeof(inotify_event) + ev->len;
+                        if (ev->len == 0) {
+                            continue;
+                        }
+                        std::string name = ev->name;
+
+                        if (ev->wd == root_wd) {
+                            if (ev->mask & IN_ISDIR) {
+                                fs::path dir = root / name;
+                                watch_task(dir);
+                                // Files may have landed before the watch existed
+                                for (const auto& capture : catalog.scan()) {
+                                    pool.submit(capture);
+                                }
+                            }
+                            continue;
+                        }
+
+                        auto it = watches.find(ev->wd);
+                        if (it == watches.end() ||
+                            CaptureWatch::classify(name) == CaptureWatch::Kind::Other) {
+                            continue;  // Plots, index.json, our own temp files, ...
+                        }
+                        pool.submit(it->second / name);
+                    }
+                }
+            }
+
+            // Publish indexes once the burst of saves has been analyzed
+            pool.wait_idle();
+            size_t written = catalog.write_indexes();
+            if (written > 0) {
+                std::lock_guard<std::mutex> lock(print_mutex);
+                std::cout << "Updated " << written << " task index(es)" << std::endl;
+            }
+        }
+
+        ::close(fd);
+        std::cout << "\nWatcher stopped" << std::endl;
+#else
+        std::cerr << "Watch mode needs inotify (Linux); use --once on this platform" << std::endl;
+        return 1;
+#endif
+
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,648 @@
+/**
+ * Capture Watch - Header-Only C++ Version
+ *
+ * Incremental analysis of the captures saved by the plotters:
+ * - raw_data_*.csv  (plotter.py)      -> per-duty τ and K (same 63.2% / ω_ss/d
+ *                                        definitions as p1-3.cpp) and, for
+ *                                        sweeps with enough levels, the
+ *                                        friction fit of friction_id.hpp
+ * - pid_data_*.csv  (plotter_pid.py)  -> step metrics (step_metrics.hpp)
+ * - summary_*.json  (plotter.py)      -> τ and K averages
+ *
+ * Each capture gets data/<task>/analysis/<capture stem>.json. An analysis is
+ * redone only when its capture is newer than it, so restarts are cheap.
+ * data/<task>/index.json lists every run of a task with its key results and
+ * data/index.json lists the tasks with their latest summary.
+ *
+ * The summary_*.json files themselves are never written here, so
+ * load_latest_summary() keeps returning what the plotter saved.
+ *
+ * With set_quality_check(), raw_data and pid_data captures are first scanned
+ * by capture_check.hpp. A capture with a fatal issue is not analyzed: its
+ * entry gets "quarantined": true and no τ/K or step metrics, or it is moved
+ * to data/<task>/quarantine/ and dropped from the index.
+ *
+ * IMPORTANT:
+ * - This is a HEADER-ONLY library for PC-side tools (DO NOT include in Arduino code)
+ *
+ * Requirements:
+ * - C++17 or higher
+ *
+ * Usage:
+ *   #include "capture_watch.hpp"
+ *
+ *   CaptureWatch::Catalog catalog(DataLoader::get_project_root() / "data");
+ *   for (auto& file : catalog.scan()) { catalog.analyze(file); }
+ *   catalog.write_indexes();
+ */
+
+#ifndef CAPTURE_WATCH_HPP
+#define CAPTURE_WATCH_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "capture_check.hpp"
+#include "data_loader.hpp"
+#include "friction_id.hpp"
+#include "step_metrics.hpp"
+
+namespace CaptureWatch {
+
+enum class Kind { RawData, PidData, Summary, Other };
+
+inline bool starts_with(const std::string& s, const std::string& prefix) {
+    return s.compare(0, prefix.size(), prefix) == 0;
+}
+
+inline bool ends_with(const std::string& s, const std::string& suffix) {
+    return s.size() >= suffix.size() && s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+/**
+ * Capture kind from a file name (anything else, including our own outputs, is Other)
+ */
+inline Kind classify(const std::string& filename) {
+    if (starts_with(filename, "raw_data_") && ends_with(filename, ".csv")) {
+        return Kind::RawData;
+    }
+    if (starts_with(filename, "pid_data_") && ends_with(filename, ".csv")) {
+        return Kind::PidData;
+    }
+    if (starts_with(filename, "summary_") && ends_with(filename, ".json")) {
+        return Kind::Summary;
+    }
+    return Kind::Other;
+}
+
+inline const char* kind_name(Kind kind) {
+    switch (kind) {
+        case Kind::RawData: return "raw_data";
+        case Kind::PidData: return "pid_data";
+        case Kind::Summary: return "summary";
+        default: return "other";
+    }
+}
+
+/**
+ * Timestamp part of "<prefix><timestamp>.<ext>"
+ */
+inline std::string capture_timestamp(const std::string& filename) {
+    size_t start = filename.find('_', filename.find('_') + 1);
+    if (classify(filename) == Kind::Summary) {
+        start = filename.find('_');
+    }
+    size_t dot = filename.rfind('.');
+    if (start == std::string::npos || dot == std::string::npos || dot <= start) {
+        return "";
+    }
+    return filename.substr(start + 1, dot - start - 1);
+}
+
+/**
+ * JSON number (NaN/inf become null)
+ */
+inline std::string json_number(double v) {
+    if (!std::isfinite(v)) {
+        return "null";
+    }
+    std::ostringstream oss;
+    oss << std::setprecision(6) << v;
+    return oss.str();
+}
+
+inline std::string json_string(const std::string& s) {
+    std::string out = "\"";
+    for (char c : s) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+        }
+        out += c;
+    }
+    return out + "\"";
+}
+
+/**
+ * Per-duty step identification (as p1-3.cpp does online)
+ */
+struct StepFit {
+    double duty;
+    double tau;       // s, NaN if the 63.2% level was never reached
+    double K;         // (deg/s)/PWM
+    double steady_velocity;
+};
+
+/**
+ * τ and K of every constant-duty segment that reached a moving steady state
+ */
+inline std::vector<StepFit> identify_steps(const DataLoader::RawData& data,
+                                           const FrictionId::Options& opt = {}) {
+    std::vector<StepFit> fits;
+    for (const auto& seg : FrictionId::split_segments(data, opt)) {
+        if (!seg.moving) {
+            continue;
+        }
+        // Locate the segment samples again (split_segments keeps only times)
+        auto first = std::lower_bound(data.time.begin(), data.time.end(), seg.t_start);
+        size_t begin = static_cast<size_t>(first - data.time.begin());
+        size_t end = begin + seg.samples;
+
+        double start_velocity = std::fabs(data.velocity[begin]);
+        double threshold = start_velocity + (seg.steady_velocity - start_velocity) * 0.632;
+        StepFit fit{seg.duty, std::numeric_limits<double>::quiet_NaN(),
+                    seg.steady_velocity / std::fabs(seg.duty), seg.steady_velocity};
+        for (size_t i = begin; i < end; ++i) {
+            if (std::fabs(data.velocity[i]) >= threshold) {
+                fit.tau = data.time[i] - seg.t_start;
+                break;
+            }
+        }
+        fits.push_back(fit);
+    }
+    return fits;
+}
+
+inline void mean_std(const std::vector<double>& v, double& mean, double& stdev) {
+    mean = stdev = std::numeric_limits<double>::quiet_NaN();
+    if (v.empty()) {
+        return;
+    }
+    double sum = 0.0;
+    for (double x : v) {
+        sum += x;
+    }
+    mean = sum / v.size();
+    double var = 0.0;
+    for (double x : v) {
+        var += (x - mean) * (x - mean);
+    }
+    stdev = std::sqrt(var / v.size());
+}
+
+/**
+ * Analysis of one capture
+ *
+ * `fields` is the JSON body (without braces) shared by the analysis file
+ * and the task index entry.
+ */
+struct RunResult {
+    std::string task;
+    std::string file;
+    Kind kind = Kind::Other;
+    std::string timestamp;
+    bool ok = false;
+    bool quarantined = false;  // Failed the quality check
+    std::string error;
+    std::string fields;
+};
+
+inline std::string analyze_raw_data(const DataLoader::RawData& data) {
+    auto steps = identify_steps(data);
+    std::vector<double> taus, Ks;
+    for (const auto& s : steps) {
+        if (std::isfinite(s.tau)) {
+            taus.push_back(s.tau);
+        }
+        if (s.duty > 0) {
+            Ks.push_back(s.K);  // p1-3.cpp reports K for positive duties only
+        }
+    }
+    double tau_mean, tau_std, K_mean, K_std;
+    mean_std(taus, tau_mean, tau_std);
+    mean_std(Ks, K_mean, K_std);
+
+    std::ostringstream os;
+    os << "\"data_points\": " << data.time.size()
+       << ", \"steps\": " << steps.size()
+       << ", \"tau_average\": " << json_number(tau_mean)
+       << ", \"tau_std\": " << json_number(tau_std)
+       << ", \"K_average\": " << json_number(K_mean)
+       << ", \"K_std\": " << json_number(K_std);
+
+    try {
+        auto friction = FrictionId::identify(data);
+        auto p = friction.params();
+        os << ", \"friction\": {\"coulomb_fwd\": " << json_number(p.coulomb_fwd)
+           << ", \"coulomb_rev\": " << json_number(p.coulomb_rev)
+           << ", \"stiction_fwd\": " << json_number(p.stiction_fwd)
+           << ", \"stiction_rev\": " << json_number(p.stiction_rev) << "}";
+    } catch (const std::exception&) {
+        os << ", \"friction\": null";  // Not a friction sweep
+    }
+    return os.str();
+}
+
+inline std::string analyze_pid_data(const DataLoader::PidData& data) {
+    const auto& t = data.time;
+    const auto& pos = data.position;
+    const auto& ref = data.reference;
+    if (t.size() < 10) {
+        throw std::runtime_error("Not enough data for performance calculation");
+    }
+    double reference = ref.back();  // Same choice as plotter_pid.py
+    auto m = StepMetrics::compute(t.data(), pos.data(), t.size(), reference);
+
+    std::ostringstream os;
+    os << "\"data_points\": " << t.size()
+       << ", \"reference\": " << json_number(reference)
+       << ", \"overshoot_percent\": " << json_number(m.overshoot)
+       << ", \"settling_time\": " << json_number(m.settling_time)
+       << ", \"rise_time\": " << json_number(m.rise_time)
+       << ", \"steady_state_error\": " << json_number(m.steady_state_error)
+       << ", \"peak_position\": " << json_number(m.peak);
+    return os.str();
+}
+
+inline std::string analyze_summary(const fs::path& path) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to open file: " + path.string());
+    }
+    std::string json((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    auto number = [&](const std::string& key) {
+        try {
+            return DataLoader::extract_json_number(json, key);
+        } catch (const std::exception&) {
+            return std::numeric_limits<double>::quiet_NaN();  // null or missing
+        }
+    };
+    std::ostringstream os;
+    os << "\"tau_average\": " << json_number(number("tau_average"))
+       << ", \"K_average\": " << json_number(number("K_average"))
+       << ", \"data_points\": " << json_number(number("data_points"));
+    return os.str();
+}
+
+/**
+ * Captures of every task under data/, with cached analyses and indexes
+ *
+ * Thread-safe: analyze() may run on several workers at once.
+ */
+class Catalog {
+public:
+    explicit Catalog(fs::path data_root) : root_(std::move(data_root)) {}
+
+    const fs::path& root() const { return root_; }
+
+    /**
+     * Scan raw_data/pid_data captures before analyzing them
+     *
+     * @param move move failing captures to data/<task>/quarantine/ instead
+     *             of only flagging them in the index
+     */
+    void set_quality_check(const CaptureCheck::Bounds& bounds, bool move = false) {
+        quality_ = bounds;
+        move_quarantined_ = move;
+    }
+
+    /**
+     * Register all captures; returns those whose analysis is missing or stale
+     */
+    std::vector<fs::path> scan() {
+        std::vector<fs::path> stale;
+        if (!fs::exists(root_)) {
+            return stale;
+        }
+        for (const auto& task : fs::directory_iterator(root_)) {
+            if (!task.is_directory()) {
+                continue;
+            }
+            for (const auto& entry : fs::directory_iterator(task.path())) {
+                if (!entry.is_regular_file() || classify(entry.path().filename().string()) == Kind::Other) {
+                    continue;
+                }
+                if (!load_cached(entry.path())) {
+                    stale.push_back(entry.path());
+                }
+            }
+        }
+        return stale;
+    }
+
+    /**
+     * Analyze one capture, save its analysis file and refresh the cache
+     */
+    RunResult analyze(const fs::path& capture) {
+        RunResult r = describe(capture);
+        std::optional<CaptureCheck::Report> report;
+        try {
+            switch (r.kind) {
+                case Kind::RawData: {
+                    auto data = DataLoader::load_raw_data(capture);
+                    if (quality_) {
+                        report = CaptureCheck::check(data, *quality_);
+                    }
+                    if (!report || !report->quarantine()) {
+                        r.fields = analyze_raw_data(data);
+                    }
+                    break;
+                }
+                case Kind::PidData: {
+                    auto data = DataLoader::load_pid_data(capture);
+                    if (quality_) {
+                        report = CaptureCheck::check(data, *quality_);
+                    }
+                    if (!report || !report->quarantine()) {
+                        r.fields = analyze_pid_data(data);
+                    }
+                    break;
+                }
+                case Kind::Summary: r.fields = analyze_summary(capture); break;
+                default: throw std::runtime_error("Not a capture: " + r.file);
+            }
+            r.ok = true;
+        } catch (const std::exception& e) {
+            r.ok = false;
+            r.error = e.what();
+            r.fields = "\"error\": " + json_string(r.error);
+        }
+
+        if (report && r.ok) {
+            if (report->quarantine()) {
+                r.ok = false;
+                r.quarantined = true;
+                r.error = "quarantined: " + report->summary();
+                r.fields = "\"quarantined\": true, \"error\": " + json_string(r.error);
+            } else {
+                r.fields = "\"quarantined\": false, " + r.fields;
+            }
+            r.fields += ", \"quality\": " + report->json();
+
+            if (r.quarantined && move_quarantined_) {
+                CaptureCheck::quarantine(capture, *report);
+                remove(capture);
+                return r;
+            }
+        }
+
+        fs::path out = analysis_path(capture);
+        fs::create_directories(out.parent_path());
+        write_atomic(out, "{\"file\": " + json_string(r.file) + ", \"kind\": \"" + kind_name(r.kind) +
+                              "\", \"timestamp\": " + json_string(r.timestamp) +
+                              ", \"ok\": " + (r.ok ? "true" : "false") + ", " + r.fields + "}\n");
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        runs_[capture] = r;
+        dirty_.insert(r.task);
+        return r;
+    }
+
+    /**
+     * Forget a deleted capture (and its analysis file)
+     */
+    void remove(const fs::path& capture) {
+        std::error_code ec;
+        fs::remove(analysis_path(capture), ec);
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (runs_.erase(capture)) {
+            dirty_.insert(capture.parent_path().filename().string());
+        }
+    }
+
+    /**
+     * Rewrite the indexes of tasks that changed since the last call
+     *
+     * @return number of task indexes written
+     */
+    size_t write_indexes(bool all = false) {
+        std::lock_guard<std::mutex> index_lock(index_mutex_);
+        std::map<std::string, std::vector<RunResult>> by_task;
+        std::set<std::string> dirty;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (const auto& [path, r] : runs_) {
+                by_task[r.task].push_back(r);
+            }
+            dirty.swap(dirty_);
+        }
+        if (all) {
+            for (const auto& [task, runs] : by_task) {
+                dirty.insert(task);
+            }
+        }
+        if (dirty.empty()) {
+            return 0;
+        }
+
+        size_t written = 0;
+        for (const auto& task : dirty) {
+            auto& runs = by_task[task];
+            std::sort(runs.begin(), runs.end(),
+                      [](const RunResult& a, const RunResult& b) { return a.file < b.file; });
+            std::ostringstream os;
+            os << "{\n  \"task\": " << json_string(task) << ",\n  \"runs\": [";
+            for (size_t i = 0; i < runs.size(); ++i) {
+                const auto& r = runs[i];
+                os << (i ? ",\n" : "\n") << "    {\"file\": " << json_string(r.file)
+                   << ", \"kind\": \"" << kind_name(r.kind) << "\", \"timestamp\": "
+                   << json_string(r.timestamp) << ", \"ok\": " << (r.ok ? "true" : "false")
+                   << ", " << r.fields << "}";
+            }
+            os << "\n  ]\n}\n";
+            if (fs::exists(root_ / task)) {
+                write_atomic(root_ / task / "index.json", os.str());
+                ++written;
+            }
+        }
+
+        // Top-level index: one line per task with its latest summary
+        std::ostringstream top;
+        top << "{\n  \"tasks\": [";
+        bool first = true;
+        for (const auto& [task, runs] : by_task) {
+            size_t counts[3] = {0, 0, 0};
+            const RunResult* latest_summary = nullptr;
+            for (const auto& r : runs) {
+                if (r.kind != Kind::Other) {
+                    ++counts[static_cast<int>(r.kind)];
+                }
+                if (r.kind == Kind::Summary && r.ok &&
+                    (!latest_summary || r.timestamp > latest_summary->timestamp)) {
+                    latest_summary = &r;
+                }
+            }
+            top << (first ? "\n" : ",\n") << "    {\"task\": " << json_string(task)
+                << ", \"raw_data\": " << counts[0] << ", \"pid_data\": " << counts[1]
+                << ", \"summaries\": " << counts[2] << ", \"latest_summary\": ";
+            if (latest_summary) {
+                top << "{\"file\": " << json_string(latest_summary->file) << ", "
+                    << latest_summary->fields << "}";
+            } else {
+                top << "null";
+            }
+            top << "}";
+            first = false;
+        }
+        top << "\n  ]\n}\n";
+        write_atomic(root_ / "index.json", top.str());
+        return written;
+    }
+
+    static fs::path analysis_path(const fs::path& capture) {
+        return capture.parent_path() / "analysis" / (capture.stem().string() + ".json");
+    }
+
+private:
+    RunResult describe(const fs::path& capture) const {
+        RunResult r;
+        r.task = capture.parent_path().filename().string();
+        r.file = capture.filename().string();
+        r.kind = classify(r.file);
+        r.timestamp = capture_timestamp(r.file);
+        return r;
+    }
+
+    /**
+     * Reuse an up-to-date analysis file; false if the capture must be analyzed
+     */
+    bool load_cached(const fs::path& capture) {
+        fs::path out = analysis_path(capture);
+        std::error_code ec;
+        if (!fs::exists(out, ec) || fs::last_write_time(out, ec) < fs::last_write_time(capture, ec)) {
+            return false;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (runs_.count(capture)) {
+                return true;  // Already known and unchanged
+            }
+        }
+        std::ifstream file(out);
+        std::string json((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        std::string ok_key = "\"ok\": ";
+        size_t ok_pos = json.find(ok_key);
+        size_t body = json.find(", ", ok_pos);
+        size_t close = json.rfind('}');
+        if (ok_pos == std::string::npos || body == std::string::npos || close == std::string::npos ||
+            close <= body) {
+            return false;
+        }
+
+        RunResult r = describe(capture);
+        r.ok = json.compare(ok_pos + ok_key.size(), 4, "true") == 0;
+        r.fields = json.substr(body + 2, close - body - 2);
+        std::lock_guard<std::mutex> lock(mutex_);
+        runs_[capture] = r;
+        dirty_.insert(r.task);
+        return true;
+    }
+
+    static void write_atomic(const fs::path& path, const std::string& content) {
+        fs::path tmp = path;
+        tmp += ".tmp";
+        {
+            std::ofstream out(tmp);
+            if (!out.is_open()) {
+                throw std::runtime_error("Failed to open file: " + tmp.string());
+            }
+            out << content;
+        }
+        fs::rename(tmp, path);
+    }
+
+    fs::path root_;
+    std::optional<CaptureCheck::Bounds> quality_;
+    bool move_quarantined_ = false;
+    std::mutex mutex_;
+    std::mutex index_mutex_;
+    std::map<fs::path, RunResult> runs_;
+    std::set<std::string> dirty_;
+};
+
+/**
+ * Fixed-size worker pool; a capture already waiting in the queue is not queued twice
+ */
+class WorkerPool {
+public:
+    using Job = std::function<void(const fs::path&)>;
+
+    WorkerPool(size_t threads, Job job) : job_(std::move(job)) {
+        for (size_t i = 0; i < std::max<size_t>(1, threads); ++i) {
+            workers_.emplace_back([this]() { run(); });
+        }
+    }
+
+    ~WorkerPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        cv_.notify_all();
+        for (auto& w : workers_) {
+            w.join();
+        }
+    }
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    void submit(const fs::path& capture) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!queued_.insert(capture).second) {
+                return;
+            }
+            queue_.push_back(capture);
+        }
+        cv_.notify_one();
+    }
+
+    /**
+     * Block until the queue is empty and no job is running
+     */
+    void wait_idle() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        idle_cv_.wait(lock, [this]() { return queue_.empty() && active_ == 0; });
+    }
+
+private:
+    void run() {
+        for (;;) {
+            fs::path capture;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                cv_.wait(lock, [this]() { return stopping_ || !queue_.empty(); });
+                if (queue_.empty()) {
+                    return;
+                }
+                capture = queue_.front();
+                queue_.pop_front();
+                queued_.erase(capture);
+                ++active_;
+            }
+            job_(capture);
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                --active_;
+            }
+            idle_cv_.notify_all();
+        }
+    }
+
+    Job job_;
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::condition_variable idle_cv_;
+    std::deque<fs::path> queue_;
+    std::set<fs::path> queued_;
+    size_t active_ = 0;
+    bool stopping_ = false;
+};
+
+} // namespace CaptureWatch
+
+#endif // CAPTURE_WATCH_HPP
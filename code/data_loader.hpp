@@ -10,7 +10,9 @@
  * - If not included, this file won't be compiled → no errors!
  *
  * Requirements:
- * - C++17 or higher (for std::filesystem)
+ * - C++17 or higher (for std::filesystem); numbers are parsed with
+ *   std::from_chars, or strtod where the library lacks the floating-point
+ *   overload (older libc++ / Apple clang)
  * - nlohmann/json library: https://github.com/nlohmann/json
  *   Download single header: https://raw.githubusercontent.com/nlohmann/json/develop/single_include/nlohmann/json.hpp
  *
@@ -20,6 +22,9 @@
  *   auto [tau, K, metadata] = DataLoader::load_latest_summary("1-3");
  *   std::cout << "τ = " << tau << ", K = " << K << std::endl;
  *
+ *   auto table = DataLoader::load_table(path);   // schema from the file name
+ *   const auto& position = table.get<double>("position");
+ *
  * Compilation:
  *   g++ -std=c++17 my_simulation.cpp -o sim
  *
@@ -37,6 +42,16 @@
 #include <stdexcept>
 #include <tuple>
 #include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <charconv>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <iterator>
+#include <string_view>
+#include <type_traits>
+#include <variant>
 
 // You need to download nlohmann/json.hpp and place it in the include path
 // Download: https://github.com/nlohmann/json/releases
@@ -227,6 +242,359 @@ inline std::pair<double, double> load_system_parameters(const std::string& task_
     return {tau, K};
 }
 
+/**
+ * Typed column tables (schema-driven CSV loading)
+ *
+ * A Schema names the columns a capture layout provides and the type each
+ * one is stored as. load_table() maps the file's header onto the schema in
+ * one pass: header cells match by name or alias after normalization
+ * ("Position(deg)" -> "position"), so column order and units in the header
+ * don't matter and extra columns are ignored. A file without a header row
+ * is read positionally in schema order. Blank lines and "# ..." comment
+ * lines are ignored; rows with a missing or unparsable field are skipped
+ * and counted.
+ *
+ * Built-in schemas cover every capture the tools write:
+ *   raw_data_schema()   raw_data_*.csv   (plotter.py)
+ *   pid_data_schema()   pid_data_*.csv   (plotter_pid.py)
+ *   stat_data_schema()  stat_data_*.csv  (plotter_pid.py, W: mode)
+ *   p2_1_line_schema()  eight-column p2-1.cpp "Data:" lines, e.g. a serial log
+ */
+enum class ColumnType { Float64, Float32, Int64, Text };
+
+struct ColumnSpec {
+    std::string name;                    // Canonical name, lower case
+    ColumnType type = ColumnType::Float64;
+    bool required = true;
+    std::vector<std::string> aliases;    // Other header names (normalized)
+};
+
+struct Schema {
+    std::string name;
+    std::vector<ColumnSpec> columns;
+    std::string line_prefix;             // Only lines with this prefix (stripped)
+};
+
+using Column = std::variant<std::vector<double>, std::vector<float>,
+                            std::vector<int64_t>, std::vector<std::string>>;
+
+struct Table {
+    std::string file;
+    std::string schema;
+    std::vector<std::string> names;      // Columns present, schema order
+    std::vector<Column> columns;
+    size_t rows = 0;
+    size_t skipped_rows = 0;
+
+    bool has(const std::string& name) const {
+        return std::find(names.begin(), names.end(), name) != names.end();
+    }
+
+    size_t index(const std::string& name) const {
+        auto it = std::find(names.begin(), names.end(), name);
+        if (it == names.end()) {
+            throw std::runtime_error("No column '" + name + "' in " + file);
+        }
+        return static_cast<size_t>(it - names.begin());
+    }
+
+    template <typename T>
+    const std::vector<T>& get(const std::string& name) const {
+        const auto* col = std::get_if<std::vector<T>>(&columns[index(name)]);
+        if (!col) {
+            throw std::runtime_error("Column '" + name + "' has a different type in " + file);
+        }
+        return *col;
+    }
+
+    template <typename T>
+    std::vector<T>& get(const std::string& name) {
+        return const_cast<std::vector<T>&>(static_cast<const Table&>(*this).get<T>(name));
+    }
+
+    /**
+     * Any numeric column as doubles (copy)
+     */
+    std::vector<double> as_double(const std::string& name) const {
+        return std::visit([&](const auto& col) {
+            using V = typename std::decay_t<decltype(col)>::value_type;
+            if constexpr (std::is_same_v<V, std::string>) {
+                throw std::runtime_error("Column '" + name + "' is text in " + file);
+                return std::vector<double>{};
+            } else {
+                return std::vector<double>(col.begin(), col.end());
+            }
+        }, columns[index(name)]);
+    }
+};
+
+inline ColumnSpec column(const std::string& name, ColumnType type = ColumnType::Float64,
+                         std::vector<std::string> aliases = {}, bool required = true) {
+    return {name, type, required, std::move(aliases)};
+}
+
+inline Schema raw_data_schema() {
+    return {"raw_data", {column("time"), column("velocity"), column("duty")}, ""};
+}
+
+inline Schema pid_data_schema() {
+    return {"pid_data",
+            {column("time"), column("position"), column("reference"), column("error"),
+             column("control", ColumnType::Float64, {"controlsignal"})},
+            ""};
+}
+
+inline Schema p2_1_line_schema() {
+    Schema s = pid_data_schema();
+    s.name = "p2_1_line";
+    s.columns.push_back(column("limit_overshoot", ColumnType::Float32, {"ref+15%"}));
+    s.columns.push_back(column("settle_upper", ColumnType::Float32, {"ref+2%"}));
+    s.columns.push_back(column("settle_lower", ColumnType::Float32, {"ref-2%"}));
+    s.line_prefix = "Data:";
+    return s;
+}
+
+inline Schema stat_data_schema() {
+    Schema s{"stat_data", {column("t_start"), column("t_end"), column("samples", ColumnType::Int64)}, ""};
+    for (const char* signal : {"position", "velocity", "error", "control"}) {
+        for (const char* stat : {"min", "max", "mean", "var"}) {
+            s.columns.push_back(column(std::string(signal) + "_" + stat));
+        }
+    }
+    return s;
+}
+
+/**
+ * Schema of a capture from its file name prefix
+ */
+inline Schema schema_for_file(const fs::path& path) {
+    std::string name = path.filename().string();
+    if (name.rfind("raw_data_", 0) == 0) return raw_data_schema();
+    if (name.rfind("pid_data_", 0) == 0) return pid_data_schema();
+    if (name.rfind("stat_data_", 0) == 0) return stat_data_schema();
+    throw std::runtime_error("No schema for " + name);
+}
+
+/**
+ * Header cell to a comparable name: lower case, no units, no spaces
+ */
+inline std::string normalize_header(std::string_view cell) {
+    std::string out;
+    int depth = 0;
+    for (char c : cell) {
+        if (c == '(') {
+            ++depth;
+        } else if (c == ')') {
+            depth = std::max(0, depth - 1);
+        } else if (depth == 0 && !std::isspace(static_cast<unsigned char>(c)) && c != '"') {
+            out += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        }
+    }
+    return out;
+}
+
+namespace detail {
+
+inline std::string_view trim(std::string_view s) {
+    while (!s.empty() && std::isspace(static_cast<unsigned char>(s.front()))) s.remove_prefix(1);
+    while (!s.empty() && std::isspace(static_cast<unsigned char>(s.back()))) s.remove_suffix(1);
+    return s;
+}
+
+inline void split(std::string_view line, std::vector<std::string_view>& fields) {
+    fields.clear();
+    size_t start = 0;
+    while (true) {
+        size_t comma = line.find(',', start);
+        fields.push_back(trim(line.substr(start, comma - start)));
+        if (comma == std::string_view::npos) {
+            break;
+        }
+        start = comma + 1;
+    }
+}
+
+inline bool parse_number(std::string_view s, double& value) {
+    if (!s.empty() && s.front() == '+') s.remove_prefix(1);
+#ifdef __cpp_lib_to_chars
+    auto [end, ec] = std::from_chars(s.data(), s.data() + s.size(), value);
+    return ec == std::errc() && end == s.data() + s.size() && !s.empty();
+#else
+    // No floating-point std::from_chars (libc++ before LLVM 20, i.e. Apple
+    // clang): strtod on a NUL-terminated copy, same accept/reject rules
+    char buffer[64];
+    if (s.empty() || s.size() >= sizeof(buffer) || std::isspace(static_cast<unsigned char>(s.front()))) {
+        return false;
+    }
+    std::memcpy(buffer, s.data(), s.size());
+    buffer[s.size()] = '\0';
+    char* end = nullptr;
+    errno = 0;
+    value = std::strtod(buffer, &end);
+    return end == buffer + s.size() && errno != ERANGE;
+#endif
+}
+
+inline bool parse_number(std::string_view s, int64_t& value) {
+    if (!s.empty() && s.front() == '+') s.remove_prefix(1);
+    auto [end, ec] = std::from_chars(s.data(), s.data() + s.size(), value);
+    if (ec == std::errc() && end == s.data() + s.size() && !s.empty()) {
+        return true;
+    }
+    double d;  // "12.0" from a float formatter
+    if (parse_number(s, d) && d == static_cast<double>(static_cast<int64_t>(d))) {
+        value = static_cast<int64_t>(d);
+        return true;
+    }
+    return false;
+}
+
+} // namespace detail
+
+/**
+ * Load a CSV into typed columns according to a schema
+ *
+ * @param path CSV file
+ * @param schema Columns to extract (see the built-in schemas above)
+ * @return Table with one column per schema column found in the file
+ */
+inline Table load_table(const fs::path& path, const Schema& schema) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to open file: " + path.string());
+    }
+    std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    Table table;
+    table.file = path.filename().string();
+    table.schema = schema.name;
+
+    // Field index in the file for each schema column (npos = absent)
+    std::vector<size_t> source(schema.columns.size(), std::string::npos);
+    bool mapped = false;
+    std::vector<std::string_view> fields;
+    std::vector<double> numbers(schema.columns.size());
+    std::vector<int64_t> integers(schema.columns.size());
+
+    size_t pos = 0;
+    while (pos < content.size()) {
+        size_t eol = content.find('\n', pos);
+        std::string_view line(content.data() + pos,
+                              (eol == std::string::npos ? content.size() : eol) - pos);
+        pos = (eol == std::string::npos) ? content.size() : eol + 1;
+        if (!line.empty() && line.back() == '\r') {
+            line.remove_suffix(1);
+        }
+        if (!schema.line_prefix.empty()) {
+            if (line.substr(0, schema.line_prefix.size()) != schema.line_prefix) {
+                continue;  // Other serial output
+            }
+            line.remove_prefix(schema.line_prefix.size());
+        }
+        std::string_view trimmed = detail::trim(line);
+        if (trimmed.empty() || trimmed.front() == '#') {
+            continue;  // Blank or "# ..." comment (CsvWriter::comment)
+        }
+        detail::split(line, fields);
+
+        if (!mapped) {
+            mapped = true;
+            double probe;
+            bool header = !detail::parse_number(fields[0], probe);
+            if (!header) {
+                // No header: schema order
+                for (size_t c = 0; c < source.size(); ++c) {
+                    source[c] = c;
+                }
+            } else {
+                for (size_t f = 0; f < fields.size(); ++f) {
+                    std::string cell = normalize_header(fields[f]);
+                    for (size_t c = 0; c < schema.columns.size(); ++c) {
+                        const auto& spec = schema.columns[c];
+                        bool match = cell == spec.name ||
+                                     std::find(spec.aliases.begin(), spec.aliases.end(), cell) !=
+                                         spec.aliases.end();
+                        if (match && source[c] == std::string::npos) {
+                            source[c] = f;
+                            break;
+                        }
+                    }
+                }
+            }
+            std::string missing;
+            for (size_t c = 0; c < schema.columns.size(); ++c) {
+                const auto& spec = schema.columns[c];
+                if (source[c] == std::string::npos) {
+                    if (spec.required) {
+                        missing += (missing.empty() ? "" : ", ") + spec.name;
+                    }
+                    continue;
+                }
+                table.names.push_back(spec.name);
+                switch (spec.type) {
+                    case ColumnType::Float64: table.columns.emplace_back(std::vector<double>{}); break;
+                    case ColumnType::Float32: table.columns.emplace_back(std::vector<float>{}); break;
+                    case ColumnType::Int64: table.columns.emplace_back(std::vector<int64_t>{}); break;
+                    case ColumnType::Text: table.columns.emplace_back(std::vector<std::string>{}); break;
+                }
+            }
+            if (!missing.empty()) {
+                throw std::runtime_error(table.file + " is not a " + schema.name +
+                                         " capture (missing: " + missing + ")");
+            }
+            if (header) {
+                continue;
+            }
+        }
+
+        // Parse the whole row first so a bad field doesn't leave ragged columns
+        bool ok = true;
+        for (size_t c = 0, k = 0; c < schema.columns.size() && ok; ++c) {
+            if (source[c] == std::string::npos) {
+                continue;
+            }
+            if (source[c] >= fields.size()) {
+                ok = false;
+            } else if (schema.columns[c].type == ColumnType::Int64) {
+                ok = detail::parse_number(fields[source[c]], integers[k]);
+            } else if (schema.columns[c].type != ColumnType::Text) {
+                ok = detail::parse_number(fields[source[c]], numbers[k]);
+            }
+            ++k;
+        }
+        if (!ok) {
+            ++table.skipped_rows;
+            continue;
+        }
+        for (size_t c = 0, k = 0; c < schema.columns.size(); ++c) {
+            if (source[c] == std::string::npos) {
+                continue;
+            }
+            auto& col = table.columns[k];
+            switch (schema.columns[c].type) {
+                case ColumnType::Float64: std::get<0>(col).push_back(numbers[k]); break;
+                case ColumnType::Float32: std::get<1>(col).push_back(static_cast<float>(numbers[k])); break;
+                case ColumnType::Int64: std::get<2>(col).push_back(integers[k]); break;
+                case ColumnType::Text: std::get<3>(col).emplace_back(fields[source[c]]); break;
+            }
+            ++k;
+        }
+        ++table.rows;
+    }
+
+    if (!mapped) {
+        throw std::runtime_error("Empty capture: " + path.string());
+    }
+    return table;
+}
+
+/**
+ * Load a capture with the schema its file name implies
+ */
+inline Table load_table(const fs::path& path) {
+    return load_table(path, schema_for_file(path));
+}
+
 /**
  * CSV data structure
  */
@@ -234,8 +602,43 @@ struct RawData {
     std::vector<double> time;
     std::vector<double> velocity;
     std::vector<double> duty;
+    size_t skipped_rows = 0;  // Malformed lines left out
 };
 
+/**
+ * PID capture structure (pid_data_*.csv)
+ */
+struct PidData {
+    std::vector<double> time;
+    std::vector<double> position;
+    std::vector<double> reference;
+    std::vector<double> error;
+    std::vector<double> control;
+    size_t skipped_rows = 0;
+};
+
+inline RawData load_raw_data(const fs::path& path) {
+    Table table = load_table(path, raw_data_schema());
+    RawData data;
+    data.time = std::move(table.get<double>("time"));
+    data.velocity = std::move(table.get<double>("velocity"));
+    data.duty = std::move(table.get<double>("duty"));
+    data.skipped_rows = table.skipped_rows;
+    return data;
+}
+
+inline PidData load_pid_data(const fs::path& path) {
+    Table table = load_table(path, pid_data_schema());
+    PidData data;
+    data.time = std::move(table.get<double>("time"));
+    data.position = std::move(table.get<double>("position"));
+    data.reference = std::move(table.get<double>("reference"));
+    data.error = std::move(table.get<double>("error"));
+    data.control = std::move(table.get<double>("control"));
+    data.skipped_rows = table.skipped_rows;
+    return data;
+}
+
 /**
  * Load the latest raw data CSV file
  *
@@ -252,31 +655,33 @@ inline RawData load_latest_raw_data(const std::string& task_name, bool verbose =
                   << " ===" << std::endl;
     }
 
-    std::ifstream file(latest_file);
-    if (!file.is_open()) {
-        throw std::runtime_error("Failed to open file: " + latest_file.string());
-    }
+    RawData data = load_raw_data(latest_file);
 
-    RawData data;
-    std::string line;
+    if (verbose) {
+        std::cout << "Loaded " << data.time.size() << " data points" << std::endl;
+        std::cout << std::endl;
+    }
 
-    // Skip header
-    std::getline(file, line);
+    return data;
+}
 
-    // Read data
-    while (std::getline(file, line)) {
-        double t, v, d;
-        char comma;
-        std::istringstream iss(line);
+/**
+ * Load the latest PID data CSV file (same as load_latest_pid_data in Python)
+ *
+ * @param task_name Task identifier (e.g., "2-1")
+ * @param verbose Print loading information
+ * @return PidData structure with time, position, reference, error, control
+ */
+inline PidData load_latest_pid_data(const std::string& task_name, bool verbose = true) {
+    fs::path data_dir = get_task_data_dir(task_name);
+    fs::path latest_file = find_latest_file(data_dir, "pid_data_");
 
-        if (iss >> t >> comma >> v >> comma >> d) {
-            data.time.push_back(t);
-            data.velocity.push_back(v);
-            data.duty.push_back(d);
-        }
+    if (verbose) {
+        std::cout << "=== Loading PID data from " << latest_file.filename().string()
+                  << " ===" << std::endl;
     }
 
-    file.close();
+    PidData data = load_pid_data(latest_file);
 
     if (verbose) {
         std::cout << "Loaded " << data.time.size() << " data points" << std::endl;
@@ -310,6 +715,11 @@ inline RawData load_latest_raw_data(const std::string& task_name, bool verbose =
  *         auto data = DataLoader::load_latest_raw_data("1-3");
  *         std::cout << "First time point: " << data.time[0] << " s" << std::endl;
  *
+ *         // Load a PID capture, or any capture as typed columns
+ *         auto pid = DataLoader::load_latest_pid_data("2-1");
+ *         auto table = DataLoader::load_table("serial_log.txt", DataLoader::p2_1_line_schema());
+ *         const auto& upper = table.get<float>("settle_upper");
+ *
  *     } catch (const std::exception& e) {
  *         std::cerr << "Error: " << e.what() << std::endl;
  *         return 1;
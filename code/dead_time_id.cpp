@@ -0,0 +1,144 @@
+/**
+ * Loop Dead-Time Identification using dead_time_id.hpp
+ *
+ * Fits τ, K and the loop dead time to the latest p2-1 step captures
+ * (data/2-1/pid_data_*.csv), compares the PID step response with and without
+ * the Smith predictor in simulation and prints (or uploads) the serial
+ * commands for p2-1.cpp (NOT for Arduino).
+ *
+ * Compilation:
+ *   g++ -std=c++17 -O2 dead_time_id.cpp -o dead_time_id
+ *
+ * Usage:
+ *   ./dead_time_id
+ *   ./dead_time_id --last 5 --kp 10 --ki 0 --kd 0.5
+ *   ./dead_time_id --upload          (sends T:/D: to $COM_MEGA2560)
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include "dead_time_id.hpp"
+#include "serial_port.hpp"
+
+int main(int argc, char** argv) {
+    std::string task = "2-1";
+    size_t last = 3;
+    double Kp = 10.0, Ki = 0.0, Kd = 0.0;
+    double reference = 200.0;
+    bool upload = false;
+
+    for (int i = 1; i < argc; ++i) {
+        auto next = [&]() { return i + 1 < argc ? std::atof(argv[++i]) : 0.0; };
+        if (std::strcmp(argv[i], "--last") == 0) {
+            last = static_cast<size_t>(std::max(1.0, next()));
+        } else if (std::strcmp(argv[i], "--kp") == 0) {
+            Kp = next();
+        } else if (std::strcmp(argv[i], "--ki") == 0) {
+            Ki = next();
+        } else if (std::strcmp(argv[i], "--kd") == 0) {
+            Kd = next();
+        } else if (std::strcmp(argv[i], "--ref") == 0) {
+            reference = next();
+        } else if (std::strcmp(argv[i], "--upload") == 0) {
+            upload = true;
+        } else if (argv[i][0] != '-') {
+            task = argv[i];
+        } else {
+            std::cerr << "Unknown option: " << argv[i] << std::endl;
+            return 1;
+        }
+    }
+
+    std::cout << "========================================" << std::endl;
+    std::cout << "Loop Dead-Time Identification" << std::endl;
+    std::cout << "========================================" << std::endl;
+    std::cout << std::endl;
+
+    try {
+        auto files = DeadTimeId::list_pid_captures(task);
+        if (files.empty()) {
+            std::cerr << "Error: No pid_data_*.csv in data/" << task << std::endl;
+            return 1;
+        }
+        if (files.size() > last) {
+            files.erase(files.begin(), files.end() - last);
+        }
+
+        std::vector<DeadTimeId::PidCapture> captures;
+        for (const auto& f : files) {
+            captures.push_back(DeadTimeId::load_pid_capture(f));
+            std::cout << "Loaded: " << captures.back().file << " ("
+                      << captures.back().time.size() << " samples)" << std::endl;
+        }
+
+        // Start from the open-loop identification when there is one
+        double tau0 = 0.1, K0 = 10.0;
+        try {
+            std::tie(tau0, K0) = DataLoader::load_system_parameters("1-3");
+        } catch (const std::exception&) {
+        }
+
+        auto fit = DeadTimeId::identify(captures, tau0, K0);
+        int ticks = fit.delay_ticks();
+        std::cout << std::endl;
+        std::cout << "Fitted model (" << fit.samples << " samples):" << std::endl;
+        std::cout << "  tau = " << fit.tau << " s" << std::endl;
+        std::cout << "  K = " << fit.K << " (deg/s)/PWM" << std::endl;
+        std::cout << "  Dead time = " << fit.dead_time * 1000.0 << " ms beyond the "
+                  << DeadTimeId::TICK * 1000.0 << " ms tick (" << ticks << " ticks)" << std::endl;
+        std::cout << "  RMS error = " << fit.rms << " deg" << std::endl;
+        std::cout << std::endl;
+
+        std::cout << "Simulated step to " << reference << " deg (Kp=" << Kp
+                  << ", Ki=" << Ki << ", Kd=" << Kd << "):" << std::endl;
+        for (int d : {0, ticks}) {
+            auto m = DeadTimeId::simulate_pid(fit, Kp, Ki, Kd, d, reference);
+            std::cout << "  " << (d > 0 ? "Smith predictor" : "Plain PID      ")
+                      << ": overshoot " << m.overshoot << " %, settling " << m.settling_time
+                      << " s, steady-state error " << m.steady_state_error << " deg" << std::endl;
+            if (ticks == 0) {
+                break;
+            }
+        }
+        std::cout << std::endl;
+
+        std::vector<std::string> commands;
+        std::ostringstream model;
+        model << "T:" << fit.tau << "," << fit.K;
+        commands.push_back(model.str());
+        commands.push_back("D:" + std::to_string(ticks));
+        std::cout << "Serial commands for p2-1.cpp:" << std::endl;
+        for (const auto& c : commands) {
+            std::cout << "  " << c << std::endl;
+        }
+        if (ticks == 0) {
+            std::cout << "  (dead time below half a tick; predictor stays off)" << std::endl;
+        }
+
+        if (upload) {
+            SerialPort::Port port(SerialPort::default_port_name(), 115200);
+            port.wait_for_reset();
+            for (const auto& c : commands) {
+                port.write_line(c);
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            }
+            std::string line;
+            auto until = std::chrono::steady_clock::now() + std::chrono::milliseconds(500);
+            while (std::chrono::steady_clock::now() < until) {
+                if (port.read_line(line, 50) && line.rfind("Data:", 0) != 0) {
+                    std::cout << "  < " << line << std::endl;
+                }
+            }
+            std::cout << "Uploaded to " << port.name() << std::endl;
+        }
+
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,230 @@
+/**
+ * Loop Dead-Time Identification - Header-Only C++ Version
+ *
+ * Estimates the total delay of the p2-1.cpp position loop (encoder sampling,
+ * 10 ms tick, PWM update, driver response) from step captures
+ * (pid_data_*.csv: time, position, reference, error, control).
+ *
+ * The logged control signal is passed through the firmware deadzone and
+ * saturation, held for one tick, delayed by θ and fed to
+ * K e^(-θs)/(τs+1) integrated to position; (τ, K, θ) minimize the squared
+ * position error (Nelder-Mead from plant_models.hpp).
+ *
+ * The result configures the Smith predictor of p2-1.cpp ("T:<tau>,<K>" and
+ * "D:<ticks>"). simulate_pid() reproduces that controller so the benefit can
+ * be checked before uploading.
+ *
+ * IMPORTANT:
+ * - This is a HEADER-ONLY library for PC-side tools (DO NOT include in Arduino code)
+ *
+ * Requirements:
+ * - C++17 or higher
+ *
+ * Usage:
+ *   #include "dead_time_id.hpp"
+ *
+ *   auto capture = DeadTimeId::load_pid_capture(path);
+ *   auto fit = DeadTimeId::identify({capture});
+ *   int ticks = fit.delay_ticks();
+ */
+
+#ifndef DEAD_TIME_ID_HPP
+#define DEAD_TIME_ID_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <limits>
+#include <string>
+#include <vector>
+#include "data_loader.hpp"
+#include "motor_sim.hpp"
+#include "plant_models.hpp"
+#include "step_metrics.hpp"
+
+namespace DeadTimeId {
+
+constexpr double TICK = 0.01;         // p2-1.cpp interval (10 ms)
+constexpr int MAX_DELAY_TICKS = 20;   // SMITH_MAX_DELAY in p2-1.cpp
+
+/**
+ * One p2-1 step capture
+ */
+struct PidCapture {
+    std::vector<double> time;
+    std::vector<double> position;
+    std::vector<double> reference;
+    std::vector<double> control;   // controller output before limits
+    std::string file;
+};
+
+inline PidCapture load_pid_capture(const fs::path& path) {
+    auto data = DataLoader::load_pid_data(path);
+    PidCapture c;
+    c.file = path.filename().string();
+    c.time = std::move(data.time);
+    c.position = std::move(data.position);
+    c.reference = std::move(data.reference);
+    c.control = std::move(data.control);
+    return c;
+}
+
+/**
+ * All pid_data_*.csv of a task, oldest first
+ */
+inline std::vector<fs::path> list_pid_captures(const std::string& task_name) {
+    fs::path dir = DataLoader::get_task_data_dir(task_name);
+    if (!fs::exists(dir)) {
+        throw std::runtime_error("Directory not found: " + dir.string());
+    }
+    std::vector<fs::path> files;
+    for (const auto& entry : fs::directory_iterator(dir)) {
+        std::string name = entry.path().filename().string();
+        if (entry.is_regular_file() && name.rfind("pid_data_", 0) == 0) {
+            files.push_back(entry.path());
+        }
+    }
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+struct DelayFit {
+    double tau = 0.0;
+    double K = 0.0;
+    double dead_time = 0.0;   // s, beyond the one-tick hold
+    double rms = 0.0;         // deg
+    size_t samples = 0;
+
+    int delay_ticks() const {
+        return std::min(MAX_DELAY_TICKS, static_cast<int>(std::lround(dead_time / TICK)));
+    }
+};
+
+/**
+ * Predicted position for a model driven by the logged control
+ */
+inline std::vector<double> predict_position(const PidCapture& c, double tau, double K,
+                                            double dead_time, double deadzone,
+                                            double sim_dt = 0.001) {
+    size_t n = c.time.size();
+    std::vector<double> y(n, 0.0);
+    if (n == 0) {
+        return y;
+    }
+    MotorSim::MotorModel motor(tau, K, sim_dt);
+    motor.set_dead_time(dead_time);
+    y[0] = c.position[0];
+    for (size_t k = 1; k < n; ++k) {
+        // control[k-1] was applied right after sample k-1 was taken
+        double u = MotorSim::apply_pwm_limits(c.control[k - 1], deadzone);
+        int steps = std::max(1, static_cast<int>(std::lround((c.time[k] - c.time[k - 1]) / sim_dt)));
+        for (int s = 0; s < steps; ++s) {
+            motor.update(u);
+        }
+        y[k] = c.position[0] + motor.get_position();
+    }
+    return y;
+}
+
+/**
+ * Fit (τ, K, θ) to one or more step captures
+ */
+inline DelayFit identify(const std::vector<PidCapture>& captures, double tau0 = 0.1,
+                         double K0 = 10.0, double deadzone = MotorSim::PWM_DEADZONE) {
+    size_t total = 0;
+    for (const auto& c : captures) {
+        total += c.time.size();
+    }
+    if (total < 20) {
+        throw std::runtime_error("Not enough samples for dead-time identification");
+    }
+
+    auto cost = [&](const std::vector<double>& x) {
+        double tau = std::exp(x[0]), K = std::exp(x[1]);
+        double theta = std::max(0.0, std::exp(x[2]) - 1e-4);
+        double sum = 0.0;
+        for (const auto& c : captures) {
+            auto y = predict_position(c, tau, K, theta, deadzone);
+            for (size_t k = 1; k < y.size(); ++k) {
+                double r = c.position[k] - y[k];
+                sum += r * r;
+            }
+        }
+        return sum;
+    };
+
+    // Several starting delays: the cost has local minima one tick apart
+    std::vector<double> best;
+    double best_cost = std::numeric_limits<double>::infinity();
+    for (double theta0 : {0.002, 0.01, 0.03, 0.06}) {
+        auto x = PlantModels::nelder_mead(cost, {std::log(tau0), std::log(K0), std::log(theta0 + 1e-4)},
+                                          0.3, 400, 1e-8);
+        double c = cost(x);
+        if (c < best_cost) {
+            best_cost = c;
+            best = x;
+        }
+    }
+
+    DelayFit fit;
+    fit.tau = std::exp(best[0]);
+    fit.K = std::exp(best[1]);
+    fit.dead_time = std::max(0.0, std::exp(best[2]) - 1e-4);
+    fit.samples = total - captures.size();
+    fit.rms = std::sqrt(best_cost / std::max<size_t>(1, fit.samples));
+    return fit;
+}
+
+/**
+ * p2-1.cpp PID loop on a delayed plant, with or without the Smith predictor
+ *
+ * The predictor runs the delay-free model (discretized like the "T:" command)
+ * on the applied PWM and feeds back y + θ_model - θ_model(k - d).
+ */
+inline StepMetrics::Metrics simulate_pid(const DelayFit& plant, double Kp, double Ki, double Kd,
+                                         int smith_ticks, double reference = 200.0,
+                                         double t_max = 2.0) {
+    const double sim_dt = 0.001;
+    const int steps_per_tick = static_cast<int>(std::lround(TICK / sim_dt));
+    MotorSim::MotorModel motor(plant.tau, plant.K, sim_dt);
+    motor.set_dead_time(plant.dead_time);
+    MotorSim::PIDController pid(Kp, Ki, Kd, TICK);
+
+    double a22 = std::exp(-TICK / plant.tau);
+    double a12 = plant.tau * (1 - a22);
+    double b2 = plant.K * (1 - a22);
+    double b1 = plant.K * (TICK - a12);
+    double th_m = 0.0, w_m = 0.0, u_prev = 0.0;
+    std::deque<double> history;
+
+    std::vector<double> t, y;
+    int n_ticks = static_cast<int>(t_max / TICK);
+    for (int k = 0; k < n_ticks; ++k) {
+        double pos = motor.get_position();
+        double feedback = pos;
+        if (smith_ticks > 0) {
+            double th_next = th_m + a12 * w_m + b1 * u_prev;
+            w_m = a22 * w_m + b2 * u_prev;
+            th_m = th_next;
+            history.push_back(th_m);
+            double delayed = history.size() > static_cast<size_t>(smith_ticks) ? history.front() : 0.0;
+            if (history.size() > static_cast<size_t>(smith_ticks)) {
+                history.pop_front();
+            }
+            feedback = pos + th_m - delayed;
+        }
+        double u = MotorSim::apply_pwm_limits(pid.update(reference - feedback));
+        u_prev = u;
+
+        t.push_back(k * TICK);
+        y.push_back(pos);
+        for (int s = 0; s < steps_per_tick; ++s) {
+            motor.update(u);
+        }
+    }
+    return StepMetrics::compute(t.data(), y.data(), t.size(), reference);
+}
+
+} // namespace DeadTimeId
+
+#endif // DEAD_TIME_ID_HPP
@@ -0,0 +1,108 @@
+/**
+ * Device Server using device_server.hpp
+ *
+ * Keeps the serial connection to the Mega open and shares it with the
+ * tools over a Unix socket (/tmp/motor_<device>.sock by default). While it
+ * runs, the C++ tools (serial_port.hpp) and the Python tools
+ * (src/device_link.py) connect to it automatically: they start at once,
+ * the board is not reset, and the sketch keeps its state (gains, model,
+ * reference) between tool runs. Several tools can listen at the same time
+ * (NOT for Arduino).
+ *
+ * run.py releases the port around uploads and reattaches afterwards.
+ *
+ * Compilation:
+ *   g++ -std=c++17 -O2 device_server.cpp -o device_server
+ *
+ * Usage:
+ *   ./device_server                    (serve $COM_MEGA2560, Ctrl+C to stop)
+ *   ./device_server --baud 230400 --socket /tmp/mega.sock
+ *   ./device_server --status           (query a running server)
+ *   ./device_server --reset            (restart the sketch through the server)
+ *   ./device_server --shutdown
+ */
+
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include "device_server.hpp"
+
+namespace {
+
+DeviceServer::Server* active_server = nullptr;
+
+void on_signal(int) {
+    if (active_server) {
+        active_server->stop();
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+#ifdef _WIN32
+    (void)argc;
+    (void)argv;
+    std::cerr << "Error: The device server is POSIX only" << std::endl;
+    return 1;
+#else
+    std::string socket_path;
+    long baud = 115200;
+    std::string command;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--socket") == 0 && i + 1 < argc) {
+            socket_path = argv[++i];
+        } else if (std::strcmp(argv[i], "--baud") == 0 && i + 1 < argc) {
+            baud = std::atol(argv[++i]);
+        } else if (std::strcmp(argv[i], "--status") == 0) {
+            command = "#status";
+        } else if (std::strcmp(argv[i], "--reset") == 0) {
+            command = "#reset";
+        } else if (std::strcmp(argv[i], "--release") == 0) {
+            command = "#release";
+        } else if (std::strcmp(argv[i], "--attach") == 0) {
+            command = "#attach";
+        } else if (std::strcmp(argv[i], "--shutdown") == 0) {
+            command = "#shutdown";
+        } else {
+            std::cerr << "Unknown option: " << argv[i] << std::endl;
+            return 1;
+        }
+    }
+
+    try {
+        std::string device = SerialPort::device_name();
+        if (socket_path.empty()) {
+            socket_path = SerialPort::server_socket_path(device);
+        }
+
+        if (!command.empty()) {
+            std::string reply = DeviceServer::control(socket_path, command);
+            std::cout << reply << std::endl;
+            return reply.rfind("#error", 0) == 0 ? 1 : 0;
+        }
+
+        std::cout << "========================================" << std::endl;
+        std::cout << "Device Server" << std::endl;
+        std::cout << "========================================" << std::endl;
+        std::cout << "Device: " << device << " (" << baud << " baud)" << std::endl;
+        std::cout << "Socket: " << socket_path << std::endl;
+        std::cout << "Press Ctrl+C to stop" << std::endl;
+
+        DeviceServer::Server server(device, socket_path, baud);
+        active_server = &server;
+        std::signal(SIGINT, on_signal);
+        std::signal(SIGTERM, on_signal);
+        server.run();
+        active_server = nullptr;
+
+        std::cout << "Server stopped" << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+#endif
+}
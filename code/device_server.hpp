@@ -0,0 +1,464 @@
+/**
+ * Device Server - Header-Only C++ Version
+ *
+ * Owns the serial connection to the Mega and shares it with any number of
+ * local clients over a Unix socket, so tools start without reopening the
+ * port (which resets the board via DTR and costs the 2 s boot wait).
+ *
+ * Protocol (text lines, both directions):
+ * - Every line from the board is sent to every client (optionally only
+ *   lines with subscribed prefixes).
+ * - A client line not starting with '#' is a sketch command and goes to the
+ *   board unchanged ("R:200", "G:10,0,0", "S", ...).
+ * - Lines starting with '#' are for the server; replies start with '#':
+ *     #status             -> #status port=.. baud=.. attached=.. clients=.. rx=.. tx=.. dropped=.. task=..
+ *     #sub Data:,Stat:    -> only these prefixes to this client (#sub alone = all)
+ *     #baud <rate>        -> change the serial baud rate
+ *     #reset              -> restart the sketch (DTR pulse)
+ *     #release / #attach  -> close / reopen the serial port (for uploads)
+ *     #shutdown           -> stop the server
+ *
+ * A client that doesn't read fast enough loses lines (counted as dropped)
+ * instead of stalling the board or the other clients. When the board
+ * disappears the server keeps running and reattaches once it is back.
+ *
+ * IMPORTANT:
+ * - This is a HEADER-ONLY library for PC-side tools (DO NOT include in Arduino code)
+ * - POSIX only, like serial_port.hpp
+ *
+ * Requirements:
+ * - C++17 or higher
+ *
+ * Usage:
+ *   #include "device_server.hpp"
+ *
+ *   DeviceServer::Server server(SerialPort::device_name(),
+ *                               SerialPort::server_socket_path(SerialPort::device_name()));
+ *   server.run();                          // until #shutdown or stop()
+ *
+ *   std::string reply = DeviceServer::control(socket_path, "#status");
+ */
+
+#ifndef DEVICE_SERVER_HPP
+#define DEVICE_SERVER_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+#include "serial_port.hpp"
+
+namespace DeviceServer {
+
+#ifndef _WIN32
+
+constexpr size_t MAX_CLIENT_BACKLOG = 256 * 1024;   // Bytes queued per client
+constexpr size_t MAX_LINE = 4096;                   // Longer client lines are cut
+constexpr int REATTACH_MS = 1000;
+
+struct Client {
+    int fd = -1;
+    std::string in;                  // Partial line from the client
+    std::string out;                 // Queued for the client
+    std::vector<std::string> prefixes;  // Empty = everything
+    size_t dropped = 0;
+
+    bool wants(const std::string& line) const {
+        if (prefixes.empty() || line.empty() || line[0] == '#') {
+            return true;
+        }
+        for (const auto& p : prefixes) {
+            if (line.compare(0, p.size(), p) == 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+class Server {
+public:
+    Server(const std::string& device, const std::string& socket_path, long baud = 115200,
+           bool reset_on_start = false)
+        : device_(device), socket_path_(socket_path), baud_(baud), reset_on_start_(reset_on_start) {}
+
+    ~Server() { close_listener(); }
+
+    Server(const Server&) = delete;
+    Server& operator=(const Server&) = delete;
+
+    /**
+     * Serve until #shutdown or stop(); throws if the socket can't be created
+     */
+    void run() {
+        open_listener();
+        attach();
+        if (port_ && reset_on_start_) {
+            port_->pulse_dtr();
+        }
+
+        auto last_attempt = std::chrono::steady_clock::now();
+        while (!stop_) {
+            std::vector<pollfd> fds;
+            fds.push_back({listen_fd_, POLLIN, 0});
+            fds.push_back({port_ ? port_->fd() : -1, POLLIN, 0});
+            for (const auto& c : clients_) {
+                short events = POLLIN;
+                if (!c->out.empty()) {
+                    events |= POLLOUT;
+                }
+                fds.push_back({c->fd, events, 0});
+            }
+
+            int r = ::poll(fds.data(), fds.size(), port_ ? 200 : 100);
+            if (r < 0 && errno != EINTR) {
+                throw std::runtime_error(std::string("poll failed: ") + std::strerror(errno));
+            }
+
+            if (r > 0 && (fds[0].revents & POLLIN)) {
+                accept_client();
+            }
+            if (r > 0 && port_ && fds[1].revents) {
+                read_board();
+            }
+            // Clients accepted above have no pollfd yet
+            for (size_t i = 0; i + 2 < fds.size() && r > 0; ++i) {
+                short rev = fds[2 + i].revents;
+                if (rev & POLLOUT) {
+                    flush(*clients_[i]);
+                }
+                if (rev & (POLLIN | POLLHUP | POLLERR)) {
+                    read_client(*clients_[i]);
+                }
+            }
+            // Drop closed clients (fd set to -1 while handling them)
+            clients_.erase(std::remove_if(clients_.begin(), clients_.end(),
+                                          [](const auto& c) { return c->fd < 0; }),
+                           clients_.end());
+
+            // Board gone (unplugged): keep serving, retry once a second
+            auto now = std::chrono::steady_clock::now();
+            if (!port_ && !released_ &&
+                now - last_attempt > std::chrono::milliseconds(REATTACH_MS)) {
+                last_attempt = now;
+                attach();
+            }
+        }
+
+        for (auto& c : clients_) {
+            ::close(c->fd);
+        }
+        clients_.clear();
+        port_.reset();
+        close_listener();
+    }
+
+    void stop() { stop_ = true; }
+
+    size_t client_count() const { return clients_.size(); }
+
+private:
+    void open_listener() {
+        // A socket file nobody listens on is left over from a crash
+        if (SerialPort::is_socket(socket_path_)) {
+            int fd = SerialPort::connect_unix(socket_path_);
+            if (fd >= 0) {
+                ::close(fd);
+                throw std::runtime_error("A device server is already running at " + socket_path_);
+            }
+            ::unlink(socket_path_.c_str());
+        }
+
+        sockaddr_un addr{};
+        if (socket_path_.size() >= sizeof(addr.sun_path)) {
+            throw std::runtime_error("Socket path too long: " + socket_path_);
+        }
+        addr.sun_family = AF_UNIX;
+        std::strncpy(addr.sun_path, socket_path_.c_str(), sizeof(addr.sun_path) - 1);
+
+        listen_fd_ = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (listen_fd_ < 0 ||
+            ::bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+            ::listen(listen_fd_, 8) != 0) {
+            std::string err = std::strerror(errno);
+            close_listener();
+            throw std::runtime_error("Failed to listen on " + socket_path_ + ": " + err);
+        }
+        ::fcntl(listen_fd_, F_SETFL, ::fcntl(listen_fd_, F_GETFL) | O_NONBLOCK);
+    }
+
+    void close_listener() {
+        if (listen_fd_ >= 0) {
+            ::close(listen_fd_);
+            ::unlink(socket_path_.c_str());
+            listen_fd_ = -1;
+        }
+    }
+
+    bool attach() {
+        try {
+            // HUPCL cleared: our later reopen (#attach) doesn't reset the board
+            port_ = std::make_unique<SerialPort::Port>(device_, baud_, false);
+            broadcast("#attached " + device_);
+            return true;
+        } catch (const std::exception&) {
+            port_.reset();
+            return false;
+        }
+    }
+
+    void detach(const std::string& why) {
+        port_.reset();
+        broadcast("#detached " + why);
+    }
+
+    void accept_client() {
+        while (true) {
+            int fd = ::accept(listen_fd_, nullptr, nullptr);
+            if (fd < 0) {
+                return;
+            }
+            ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+            auto c = std::make_unique<Client>();
+            c->fd = fd;
+            clients_.push_back(std::move(c));
+        }
+    }
+
+    void read_board() {
+        if (!port_->fill(0)) {
+            detach("serial port closed");
+            return;
+        }
+        std::string& buf = port_->buffer();
+        size_t start = 0;
+        for (size_t pos = buf.find('\n'); pos != std::string::npos; pos = buf.find('\n', start)) {
+            std::string line = buf.substr(start, pos - start);
+            start = pos + 1;
+            if (!line.empty() && line.back() == '\r') {
+                line.pop_back();
+            }
+            ++rx_lines_;
+            if (line.rfind("TASK:", 0) == 0) {
+                task_ = line.substr(5);  // Sketch identity survives client restarts
+            }
+            broadcast(line);
+        }
+        buf.erase(0, start);
+    }
+
+    void read_client(Client& c) {
+        char chunk[1024];
+        while (true) {
+            ssize_t n = ::read(c.fd, chunk, sizeof(chunk));
+            if (n > 0) {
+                c.in.append(chunk, static_cast<size_t>(n));
+                continue;
+            }
+            if (n == 0 || (errno != EAGAIN && errno != EINTR)) {
+                drop(c);
+                return;
+            }
+            break;
+        }
+        size_t pos;
+        while ((pos = c.in.find('\n')) != std::string::npos) {
+            std::string line = c.in.substr(0, std::min(pos, MAX_LINE));
+            c.in.erase(0, pos + 1);
+            if (!line.empty() && line.back() == '\r') {
+                line.pop_back();
+            }
+            handle_line(c, line);
+            if (c.fd < 0) {
+                return;
+            }
+        }
+        if (c.in.size() > MAX_LINE) {
+            c.in.clear();  // No newline in sight: garbage
+        }
+    }
+
+    void handle_line(Client& c, const std::string& line) {
+        if (line.empty() || line[0] != '#') {
+            if (!port_) {
+                send(c, "#error not attached");
+                return;
+            }
+            try {
+                port_->write_line(line);
+                ++tx_lines_;
+            } catch (const std::exception& e) {
+                detach(e.what());
+            }
+            return;
+        }
+
+        std::string cmd = line.substr(1, line.find(' ') == std::string::npos
+                                              ? std::string::npos : line.find(' ') - 1);
+        std::string arg = line.find(' ') == std::string::npos ? "" : line.substr(line.find(' ') + 1);
+
+        if (cmd == "status") {
+            size_t dropped = 0;
+            for (const auto& other : clients_) {
+                dropped += other->dropped;
+            }
+            send(c, "#status port=" + device_ + " baud=" + std::to_string(baud_) +
+                        " attached=" + (port_ ? "1" : "0") +
+                        " clients=" + std::to_string(clients_.size()) +
+                        " rx=" + std::to_string(rx_lines_) + " tx=" + std::to_string(tx_lines_) +
+                        " dropped=" + std::to_string(dropped) +
+                        " task=" + (task_.empty() ? "?" : task_));
+        } else if (cmd == "sub") {
+            c.prefixes.clear();
+            size_t start = 0;
+            while (start < arg.size()) {
+                size_t comma = arg.find(',', start);
+                std::string p = arg.substr(start, comma == std::string::npos ? std::string::npos : comma - start);
+                if (!p.empty()) {
+                    c.prefixes.push_back(p);
+                }
+                start = comma == std::string::npos ? arg.size() : comma + 1;
+            }
+            send(c, "#ok sub");
+        } else if (cmd == "baud") {
+            long baud = std::atol(arg.c_str());
+            try {
+                if (port_) {
+                    port_->set_baud(baud);
+                } else {
+                    SerialPort::to_speed(baud);  // Validate only
+                }
+                baud_ = baud;
+                send(c, "#ok baud " + std::to_string(baud_));
+            } catch (const std::exception& e) {
+                send(c, std::string("#error ") + e.what());
+            }
+        } else if (cmd == "reset") {
+            if (port_) {
+                port_->pulse_dtr();
+                send(c, "#ok reset");
+            } else {
+                send(c, "#error not attached");
+            }
+        } else if (cmd == "release") {
+            released_ = true;
+            detach("released");
+            send(c, "#ok released");
+        } else if (cmd == "attach") {
+            released_ = false;
+            if (port_ || attach()) {
+                send(c, "#ok attached");
+            } else {
+                send(c, "#error cannot open " + device_);
+            }
+        } else if (cmd == "shutdown") {
+            send(c, "#ok shutdown");
+            flush(c);
+            stop_ = true;
+        } else {
+            send(c, "#error unknown command: " + cmd);
+        }
+    }
+
+    void broadcast(const std::string& line) {
+        for (auto& c : clients_) {
+            if (c->fd >= 0 && c->wants(line)) {
+                send(*c, line);
+            }
+        }
+    }
+
+    void send(Client& c, const std::string& line) {
+        if (c.out.size() + line.size() + 1 > MAX_CLIENT_BACKLOG) {
+            ++c.dropped;  // Slow reader: lose lines, never stall the board
+            return;
+        }
+        c.out += line;
+        c.out += '\n';
+        flush(c);
+    }
+
+    void flush(Client& c) {
+        while (c.fd >= 0 && !c.out.empty()) {
+            ssize_t n = ::send(c.fd, c.out.data(), c.out.size(), MSG_NOSIGNAL);
+            if (n > 0) {
+                c.out.erase(0, static_cast<size_t>(n));
+            } else if (n < 0 && (errno == EAGAIN || errno == EINTR)) {
+                return;
+            } else {
+                drop(c);
+            }
+        }
+    }
+
+    void drop(Client& c) {
+        if (c.fd >= 0) {
+            ::close(c.fd);
+            c.fd = -1;
+        }
+    }
+
+    std::string device_;
+    std::string socket_path_;
+    long baud_;
+    bool reset_on_start_;
+    int listen_fd_ = -1;
+    std::unique_ptr<SerialPort::Port> port_;
+    std::vector<std::unique_ptr<Client>> clients_;
+    std::atomic<bool> stop_{false};
+    bool released_ = false;
+    std::string task_;
+    size_t rx_lines_ = 0;
+    size_t tx_lines_ = 0;
+};
+
+/**
+ * Send one '#' command to a running server and return its reply
+ */
+inline std::string control(const std::string& socket_path, const std::string& command,
+                           int timeout_ms = 2000) {
+    int fd = SerialPort::connect_unix(socket_path);
+    if (fd < 0) {
+        throw std::runtime_error("No device server at " + socket_path);
+    }
+    std::string msg = command + "\n";
+    ::send(fd, msg.data(), msg.size(), MSG_NOSIGNAL);
+
+    // The reply is the first '#' line other than attach/detach notices
+    std::string buf;
+    auto until = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    while (std::chrono::steady_clock::now() < until) {
+        pollfd p{fd, POLLIN, 0};
+        if (::poll(&p, 1, 50) <= 0) {
+            continue;
+        }
+        char chunk[512];
+        ssize_t n = ::read(fd, chunk, sizeof(chunk));
+        if (n <= 0) {
+            break;
+        }
+        buf.append(chunk, static_cast<size_t>(n));
+        size_t pos;
+        while ((pos = buf.find('\n')) != std::string::npos) {
+            std::string line = buf.substr(0, pos);
+            buf.erase(0, pos + 1);
+            if (line.rfind("#ok", 0) == 0 || line.rfind("#error", 0) == 0 ||
+                line.rfind("#status", 0) == 0) {
+                ::close(fd);
+                return line;
+            }
+        }
+    }
+    ::close(fd);
+    throw std::runtime_error("No reply from device server to " + command);
+}
+
+#endif
+
+} // namespace DeviceServer
+
+#endif // DEVICE_SERVER_HPP
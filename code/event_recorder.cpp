@@ -0,0 +1,150 @@
+/**
+ * Event-Triggered Recorder using event_recorder.hpp
+ *
+ * Listens to p2-1 telemetry on the board (or the device server) and saves
+ * only the windows around events: reference changes, overshoot beyond the
+ * limit, error spikes, gaps in the sample times and long PWM saturation.
+ * Windows go to data/<task>/events/ with an events_<session>.csv index.
+ * --replay runs the same triggers over a saved pid_data_*.csv, e.g. to cut
+ * a long session down to its events (NOT for Arduino).
+ *
+ * Compilation:
+ *   g++ -std=c++17 -O2 event_recorder.cpp -o event_recorder
+ *
+ * Usage:
+ *   ./event_recorder                          (until Ctrl+C)
+ *   ./event_recorder --duration 600 --pre 1.0 --post 2.0
+ *   ./event_recorder --overshoot 10 --spike 5 --saturation 0.5 --no-reference
+ *   ./event_recorder --replay ../data/2-1/pid_data_20250101_120000.csv
+ */
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include "event_recorder.hpp"
+#include "serial_port.hpp"
+
+namespace {
+
+std::atomic<bool> stop_requested{false};
+
+void on_signal(int) {
+    stop_requested = true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string task = "2-1";
+    EventRecorder::Options opt;
+    double duration = 0.0;
+    fs::path replay;
+
+    for (int i = 1; i < argc; ++i) {
+        bool has_value = i + 1 < argc;
+        if (std::strcmp(argv[i], "--task") == 0 && has_value) {
+            task = argv[++i];
+        } else if (std::strcmp(argv[i], "--pre") == 0 && has_value) {
+            opt.pre = std::max(0.0, std::atof(argv[++i]));
+        } else if (std::strcmp(argv[i], "--post") == 0 && has_value) {
+            opt.post = std::max(0.0, std::atof(argv[++i]));
+        } else if (std::strcmp(argv[i], "--max-window") == 0 && has_value) {
+            opt.max_window = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--period") == 0 && has_value) {
+            opt.period = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--no-reference") == 0) {
+            opt.triggers.reference_change = false;
+        } else if (std::strcmp(argv[i], "--overshoot") == 0 && has_value) {
+            opt.triggers.overshoot_percent = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--spike") == 0 && has_value) {
+            opt.triggers.error_spike = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--gap") == 0 && has_value) {
+            opt.triggers.gap_factor = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--saturation") == 0 && has_value) {
+            opt.triggers.saturation_time = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--duration") == 0 && has_value) {
+            duration = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--replay") == 0 && has_value) {
+            replay = argv[++i];
+        } else {
+            std::cerr << "Unknown option: " << argv[i] << std::endl;
+            return 1;
+        }
+    }
+    if (opt.period <= 0 || opt.max_window <= opt.pre) {
+        std::cerr << "Error: --period must be > 0 and --max-window longer than --pre" << std::endl;
+        return 1;
+    }
+
+    std::cout << "========================================" << std::endl;
+    std::cout << "Event-Triggered Recorder (task " << task << ")" << std::endl;
+    std::cout << "========================================" << std::endl;
+    std::cout << "Window: " << opt.pre << " s before, " << opt.post << " s after (max "
+              << opt.max_window << " s)" << std::endl;
+    std::cout << "Triggers:";
+    if (opt.triggers.reference_change) std::cout << " reference";
+    if (opt.triggers.overshoot_percent > 0) std::cout << " overshoot>" << opt.triggers.overshoot_percent << "%";
+    if (opt.triggers.error_spike > 0) std::cout << " spike>" << opt.triggers.error_spike << "deg";
+    if (opt.triggers.gap_factor > 0) std::cout << " gap>" << opt.triggers.gap_factor << "T";
+    if (opt.triggers.saturation_time > 0) std::cout << " saturation>" << opt.triggers.saturation_time << "s";
+    std::cout << std::endl << std::endl;
+
+    try {
+        EventRecorder::EventWriter writer(DataLoader::get_task_data_dir(task) / "events");
+        EventRecorder::Recorder recorder(opt, [&](const EventRecorder::Event& e) {
+            fs::path path = writer.write(e);
+            std::printf("Event %zu at %.3f s: %s (%zu samples) -> %s\n", e.index, e.trigger_time(),
+                        EventRecorder::trigger_names(e.triggers).c_str(), e.samples.size(),
+                        path.filename().string().c_str());
+        });
+
+        if (!replay.empty()) {
+            auto data = DataLoader::load_pid_data(replay);
+            std::cout << "Replaying " << replay.filename().string() << " (" << data.time.size()
+                      << " samples)" << std::endl;
+            for (size_t i = 0; i < data.time.size(); ++i) {
+                recorder.add({data.time[i], data.position[i], data.reference[i], data.error[i],
+                              data.control[i]});
+            }
+        } else {
+            SerialPort::Port port(SerialPort::default_port_name(), 115200, false);
+            std::cout << "Listening on " << port.name() << (duration > 0 ? "" : ", Ctrl+C to stop")
+                      << std::endl;
+            std::signal(SIGINT, on_signal);
+            std::signal(SIGTERM, on_signal);
+
+            auto start = std::chrono::steady_clock::now();
+            std::string line;
+            EventRecorder::Sample sample;
+            while (!stop_requested) {
+                double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                if (duration > 0 && elapsed >= duration) {
+                    break;
+                }
+                if (port.read_line(line, 200) && EventRecorder::parse_data_line(line, sample)) {
+                    recorder.add(sample);
+                }
+            }
+        }
+        recorder.finish();
+
+        std::cout << std::endl;
+        std::cout << "Samples: " << recorder.samples_seen() << " seen, " << recorder.samples_saved()
+                  << " saved in " << recorder.events() << " event(s)";
+        if (recorder.samples_seen() > 0) {
+            std::printf(" (%.1f%%)", 100.0 * recorder.samples_saved() / recorder.samples_seen());
+        }
+        std::cout << std::endl;
+        std::cout << "Index: " << writer.index_path().string() << std::endl;
+
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,392 @@
+/**
+ * Event Recorder - Header-Only C++ Version
+ *
+ * Event-triggered recording of p2-1 telemetry ("Data:" lines). The last
+ * `pre` seconds are kept in a fixed-size ring; only windows around events
+ * are written, from `pre` before the first trigger to `post` after the
+ * last one (triggers during a window extend it, up to `max_window`):
+ *
+ * - reference change:  the reference column differs from the last sample
+ * - overshoot:         position beyond the last step's target by more than
+ *                      overshoot_percent of the step (once per step)
+ * - error spike:       error changes by more than error_spike deg in one
+ *                      sample, not within spike_holdoff of a reference
+ *                      change (the step transient itself)
+ * - sequence gap:      time step above gap_factor × the sample period, or
+ *                      time going backwards (lost lines, board reset)
+ * - saturation:        |control| >= 255 for longer than saturation_time
+ *
+ * Each window is saved as data/<task>/events/event_<session>_<n>.csv with
+ * the pid_data_*.csv columns (DataLoader::load_pid_data reads it), and a
+ * row in events_<session>.csv lists its triggers. The windows sit below
+ * data/<task>/, so capture_watch.hpp does not index them as step captures.
+ *
+ * IMPORTANT:
+ * - This is a HEADER-ONLY library for PC-side tools (DO NOT include in Arduino code)
+ *
+ * Requirements:
+ * - C++17 or higher
+ *
+ * Usage:
+ *   #include "event_recorder.hpp"
+ *
+ *   EventRecorder::EventWriter writer(DataLoader::get_task_data_dir("2-1") / "events");
+ *   EventRecorder::Recorder recorder({}, [&](const EventRecorder::Event& e) { writer.write(e); });
+ *   EventRecorder::Sample s;
+ *   if (EventRecorder::parse_data_line(line, s)) { recorder.add(s); }
+ *   recorder.finish();
+ */
+
+#ifndef EVENT_RECORDER_HPP
+#define EVENT_RECORDER_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include "data_loader.hpp"
+#include "output_writer.hpp"
+
+namespace EventRecorder {
+
+// Trigger bits
+constexpr unsigned REFERENCE_CHANGE = 1;
+constexpr unsigned OVERSHOOT = 2;
+constexpr unsigned ERROR_SPIKE = 4;
+constexpr unsigned SEQUENCE_GAP = 8;
+constexpr unsigned SATURATION = 16;
+
+constexpr double PWM_MAX = 255.0;
+
+/**
+ * Trigger names joined by '+' ("reference+overshoot")
+ */
+inline std::string trigger_names(unsigned triggers) {
+    static const std::pair<unsigned, const char*> names[] = {
+        {REFERENCE_CHANGE, "reference"}, {OVERSHOOT, "overshoot"}, {ERROR_SPIKE, "error_spike"},
+        {SEQUENCE_GAP, "gap"}, {SATURATION, "saturation"}};
+    std::string out;
+    for (const auto& [bit, name] : names) {
+        if (triggers & bit) {
+            out += (out.empty() ? "" : "+") + std::string(name);
+        }
+    }
+    return out;
+}
+
+/**
+ * One telemetry sample (the first five fields of a p2-1 "Data:" line)
+ */
+struct Sample {
+    double time = 0.0;
+    double position = 0.0;
+    double reference = 0.0;
+    double error = 0.0;
+    double control = 0.0;
+};
+
+/**
+ * "Data:t,pos,ref,err,ctrl[,limits...]" -> sample; false for any other line
+ */
+inline bool parse_data_line(const std::string& line, Sample& s) {
+    if (line.compare(0, 5, "Data:") != 0) {
+        return false;
+    }
+    double values[5];
+    const char* p = line.c_str() + 5;
+    for (int i = 0; i < 5; ++i) {
+        char* end;
+        values[i] = std::strtod(p, &end);
+        if (end == p || !std::isfinite(values[i]) || (i < 4 && *end != ',')) {
+            return false;
+        }
+        p = end + 1;
+    }
+    s = {values[0], values[1], values[2], values[3], values[4]};
+    return true;
+}
+
+/**
+ * Trigger thresholds (a threshold <= 0 turns its trigger off)
+ */
+struct Triggers {
+    bool reference_change = true;
+    double overshoot_percent = 15.0;  // p2-1 requirement
+    double error_spike = 20.0;        // deg in one sample
+    double spike_holdoff = 0.5;       // s after a reference change
+    double gap_factor = 3.0;          // × sample period
+    double saturation_time = 0.3;     // s
+};
+
+struct Options {
+    Triggers triggers;
+    double pre = 0.5;          // s before the first trigger
+    double post = 1.0;         // s after the last trigger
+    double max_window = 10.0;  // s, longest window
+    double period = 0.01;      // s, p2-1 10 ms tick (sizes the ring, gap threshold)
+};
+
+/**
+ * Fixed-capacity ring, oldest element first
+ */
+template <typename T>
+class Ring {
+public:
+    explicit Ring(size_t capacity) : data_(std::max<size_t>(capacity, 1)) {}
+
+    void push(const T& value) {
+        data_[(head_ + size_) % data_.size()] = value;
+        if (size_ < data_.size()) {
+            ++size_;
+        } else {
+            head_ = (head_ + 1) % data_.size();
+        }
+    }
+
+    size_t size() const { return size_; }
+    size_t capacity() const { return data_.size(); }
+    const T& operator[](size_t i) const { return data_[(head_ + i) % data_.size()]; }
+
+    void clear() {
+        head_ = 0;
+        size_ = 0;
+    }
+
+private:
+    std::vector<T> data_;
+    size_t head_ = 0;
+    size_t size_ = 0;
+};
+
+/**
+ * Per-sample trigger evaluation
+ */
+class Detector {
+public:
+    explicit Detector(const Options& opt) : opt_(opt) {}
+
+    /**
+     * Trigger bits raised by this sample
+     */
+    unsigned update(const Sample& s) {
+        const Triggers& trig = opt_.triggers;
+        unsigned fired = 0;
+        if (!have_prev_) {
+            have_prev_ = true;
+            step_from_ = step_to_ = s.reference;
+            prev_ = s;
+            return 0;
+        }
+
+        double dt = s.time - prev_.time;
+        if (trig.gap_factor > 0 && (dt <= 0 || dt > trig.gap_factor * opt_.period)) {
+            fired |= SEQUENCE_GAP;
+            saturated_since_ = -1.0;  // Saturation time spans the gap otherwise
+        }
+
+        bool reference_changed = s.reference != prev_.reference;
+        if (reference_changed) {
+            step_from_ = prev_.reference;
+            step_to_ = s.reference;
+            step_time_ = s.time;
+            overshoot_fired_ = false;
+            if (trig.reference_change) {
+                fired |= REFERENCE_CHANGE;
+            }
+        }
+
+        double step = step_to_ - step_from_;
+        if (trig.overshoot_percent > 0 && !overshoot_fired_ && step != 0.0 &&
+            (s.position - step_to_) / step * 100.0 > trig.overshoot_percent) {
+            fired |= OVERSHOOT;
+            overshoot_fired_ = true;
+        }
+
+        if (trig.error_spike > 0 && s.time - step_time_ >= trig.spike_holdoff &&
+            std::fabs(s.error - prev_.error) > trig.error_spike) {
+            fired |= ERROR_SPIKE;
+        }
+
+        if (std::fabs(s.control) >= PWM_MAX) {
+            if (saturated_since_ < 0) {
+                saturated_since_ = s.time;
+                saturation_fired_ = false;
+            }
+            if (trig.saturation_time > 0 && !saturation_fired_ &&
+                s.time - saturated_since_ >= trig.saturation_time) {
+                fired |= SATURATION;
+                saturation_fired_ = true;
+            }
+        } else {
+            saturated_since_ = -1.0;
+        }
+
+        prev_ = s;
+        return fired;
+    }
+
+private:
+    Options opt_;
+    bool have_prev_ = false;
+    Sample prev_;
+    double step_from_ = 0.0;
+    double step_to_ = 0.0;
+    double step_time_ = -1e300;
+    bool overshoot_fired_ = true;  // No step seen yet
+    double saturated_since_ = -1.0;
+    bool saturation_fired_ = false;
+};
+
+/**
+ * A saved window: its samples and the triggers inside it
+ */
+struct Event {
+    size_t index = 0;                                  // 1, 2, ... per recorder
+    unsigned triggers = 0;                             // Union of all hits
+    std::vector<std::pair<double, unsigned>> hits;     // (time, bits)
+    std::vector<Sample> samples;
+
+    double trigger_time() const { return hits.empty() ? 0.0 : hits.front().first; }
+};
+
+/**
+ * Pre-trigger ring plus the open window; finished windows go to the sink
+ */
+class Recorder {
+public:
+    using Sink = std::function<void(const Event&)>;
+
+    Recorder(const Options& opt, Sink sink)
+        : opt_(opt), detector_(opt),
+          ring_(static_cast<size_t>(std::ceil(opt.pre / opt.period)) + 1), sink_(std::move(sink)) {}
+
+    void add(const Sample& s) {
+        unsigned fired = detector_.update(s);
+        ++samples_seen_;
+
+        // Time going backwards is a board reset: close the open window at the
+        // last sample before it and keep the ring from reaching across it, so
+        // the sample (a sequence gap) can open a window of its own
+        if (ring_.size() > 0 && s.time < ring_[ring_.size() - 1].time) {
+            ring_.clear();
+            finish();
+        }
+        ring_.push(s);
+
+        if (recording_) {
+            event_.samples.push_back(s);
+            if (fired) {
+                event_.triggers |= fired;
+                event_.hits.emplace_back(s.time, fired);
+                end_time_ = std::min(std::max(end_time_, s.time + opt_.post),
+                                     event_.samples.front().time + opt_.max_window);
+            }
+            if (s.time >= end_time_) {
+                finish();
+            }
+            return;
+        }
+
+        if (fired) {
+            recording_ = true;
+            event_ = Event{};
+            event_.index = ++events_;
+            event_.triggers = fired;
+            event_.hits.emplace_back(s.time, fired);
+            for (size_t i = 0; i < ring_.size(); ++i) {
+                if (ring_[i].time >= s.time - opt_.pre - 1e-9) {
+                    event_.samples.push_back(ring_[i]);
+                }
+            }
+            end_time_ = std::min(s.time + opt_.post, event_.samples.front().time + opt_.max_window);
+        }
+    }
+
+    /**
+     * Close the open window (end of session)
+     */
+    void finish() {
+        if (!recording_) {
+            return;
+        }
+        recording_ = false;
+        samples_saved_ += event_.samples.size();
+        if (sink_) {
+            sink_(event_);
+        }
+    }
+
+    bool recording() const { return recording_; }
+    size_t events() const { return events_; }
+    size_t samples_seen() const { return samples_seen_; }
+    size_t samples_saved() const { return samples_saved_; }
+
+private:
+    Options opt_;
+    Detector detector_;
+    Ring<Sample> ring_;
+    Sink sink_;
+    bool recording_ = false;
+    Event event_;
+    double end_time_ = 0.0;
+    size_t events_ = 0;
+    size_t samples_seen_ = 0;
+    size_t samples_saved_ = 0;
+};
+
+/**
+ * Writes windows as event_<session>_<n>.csv plus one events_<session>.csv index
+ */
+class EventWriter {
+public:
+    explicit EventWriter(const fs::path& dir, const std::string& session = FrictionId::make_timestamp())
+        : dir_(dir), session_(session) {
+        fs::create_directories(dir_);
+        index_ = std::make_unique<OutputWriter::CsvWriter>(
+            dir_ / ("events_" + session_ + ".csv"),
+            std::vector<std::string>{"Event", "File", "Trigger(s)", "Start(s)", "End(s)", "Samples",
+                                     "Triggers", "Hits"});
+    }
+
+    fs::path write(const Event& e) {
+        char name[32];
+        std::snprintf(name, sizeof(name), "_%03zu.csv", e.index);
+        fs::path path = dir_ / ("event_" + session_ + name);
+        {
+            OutputWriter::CsvWriter csv(path, {"Time(s)", "Position(deg)", "Reference(deg)",
+                                               "Error(deg)", "Control(PWM)"});
+            for (const auto& s : e.samples) {
+                csv.row(s.time, s.position, s.reference, s.error, s.control);
+            }
+            csv.close();
+        }
+
+        // Every hit as <time>:<names>, separated by ';'
+        std::string hits;
+        for (const auto& [t, bits] : e.hits) {
+            char stamp[32];
+            std::snprintf(stamp, sizeof(stamp), "%.3f:", t);
+            hits += (hits.empty() ? "" : ";") + std::string(stamp) + trigger_names(bits);
+        }
+        index_->row(e.index, path.filename().string(), e.trigger_time(), e.samples.front().time,
+                    e.samples.back().time, e.samples.size(), trigger_names(e.triggers), hits);
+        index_->flush();  // The index stays readable while a session runs
+        return path;
+    }
+
+    fs::path index_path() const { return index_->path(); }
+
+private:
+    fs::path dir_;
+    std::string session_;
+    std::unique_ptr<OutputWriter::CsvWriter> index_;
+};
+
+} // namespace EventRecorder
+
+#endif // EVENT_RECORDER_HPP
@@ -15,66 +15,10 @@
 #include <cmath>
 #include <vector>
 #include "data_loader.hpp"
-
-// Simple PID Controller
-class PIDController {
-public:
-    PIDController(double Kp, double Ki, double Kd, double dt)
-        : Kp_(Kp), Ki_(Ki), Kd_(Kd), dt_(dt),
-          error_integral_(0.0), error_prev_(0.0) {}
-
-    double update(double error) {
-        // Proportional
-        double P = Kp_ * error;
-
-        // Integral
-        error_integral_ += error * dt_;
-        double I = Ki_ * error_integral_;
-
-        // Derivative
-        double D = Kd_ * (error - error_prev_) / dt_;
-
-        error_prev_ = error;
-
-        return P + I + D;
-    }
-
-    void reset() {
-        error_integral_ = 0.0;
-        error_prev_ = 0.0;
-    }
-
-private:
-    double Kp_, Ki_, Kd_, dt_;
-    double error_integral_;
-    double error_prev_;
-};
-
-// Simple motor model
-class MotorModel {
-public:
-    MotorModel(double tau, double K, double dt)
-        : tau_(tau), K_(K), dt_(dt), velocity_(0.0), position_(0.0) {}
-
-    void update(double control) {
-        // Motor dynamics: dω/dt = (K*u - ω) / τ
-        double dv = (K_ * control - velocity_) / tau_;
-        velocity_ += dv * dt_;
-        position_ += velocity_ * dt_;
-    }
-
-    double get_position() const { return position_; }
-    double get_velocity() const { return velocity_; }
-
-    void reset() {
-        velocity_ = 0.0;
-        position_ = 0.0;
-    }
-
-private:
-    double tau_, K_, dt_;
-    double velocity_, position_;
-};
+#include "friction_id.hpp"
+#include "motor_sim.hpp"
+#include "output_writer.hpp"
+#include "plant_models.hpp"
 
 int main() {
     std::cout << "========================================" << std::endl;
@@ -91,6 +35,15 @@ int main() {
         std::cout << "  K = " << K << " (deg/s)/PWM" << std::endl;
         std::cout << std::endl;
 
+        // Friction terms are optional (run ./friction_id after a 1-3 sweep)
+        MotorSim::FrictionParams friction;
+        try {
+            friction = FrictionId::load_latest_friction("1-3");
+        } catch (const std::exception&) {
+            std::cout << "No friction_*.json found, using the pure first-order model" << std::endl;
+            std::cout << std::endl;
+        }
+
         // Simulation parameters
         double dt = 0.001;  // 1ms
         double t_max = 2.0;  // 2 seconds
@@ -108,8 +61,16 @@ int main() {
         std::cout << std::endl;
 
         // Create controller and plant
-        PIDController pid(Kp, Ki, Kd, dt);
-        MotorModel motor(tau, K, dt);
+        MotorSim::PIDController pid(Kp, Ki, Kd, dt);
+        MotorSim::MotorModel motor(tau, K, dt, friction);
+
+        // A model chosen by ./model_select replaces the first-order plant
+        try {
+            motor = PlantModels::load_latest_model("1-3").make_motor(dt);
+        } catch (const std::exception&) {
+            std::cout << "No model_*.json found, using tau/K from the summary" << std::endl;
+            std::cout << std::endl;
+        }
 
         // Simulate
         std::cout << "Running simulation..." << std::endl;
@@ -153,11 +114,9 @@ int main() {
 
         // Save results to CSV
         std::cout << "Saving results to cpp_simulation_results.csv..." << std::endl;
-        std::ofstream outfile("cpp_simulation_results.csv");
-        outfile << "Time(s),Position(deg),Error(deg)" << std::endl;
-        for (size_t i = 0; i < time_vec.size(); ++i) {
-            outfile << time_vec[i] << "," << position_vec[i] << "," << error_vec[i] << std::endl;
-        }
+        OutputWriter::CsvWriter outfile("cpp_simulation_results.csv",
+                                        {"Time(s)", "Position(deg)", "Error(deg)"});
+        outfile.columns({&time_vec, &position_vec, &error_vec});
         outfile.close();
 
         std::cout << "Results saved!" << std::endl;
@@ -0,0 +1,72 @@
+/**
+ * Friction Identification using friction_id.hpp
+ *
+ * Loads the latest duty sweep of a task, fits Coulomb/viscous/stiction terms
+ * per direction, saves data/<task>/friction_<timestamp>.json for the simulator
+ * and prints the constants for the compensation block in p2-1.cpp
+ * (NOT for Arduino).
+ *
+ * Compilation:
+ *   g++ -std=c++17 -O2 friction_id.cpp -o friction_id
+ *
+ * Usage:
+ *   ./friction_id          (uses data/1-3/)
+ *   ./friction_id 1-2
+ */
+
+#include <iostream>
+#include "friction_id.hpp"
+
+int main(int argc, char** argv) {
+    std::string task = argc > 1 ? argv[1] : "1-3";
+
+    std::cout << "========================================" << std::endl;
+    std::cout << "Friction Identification (task " << task << ")" << std::endl;
+    std::cout << "========================================" << std::endl;
+    std::cout << std::endl;
+
+    try {
+        fs::path source = DataLoader::find_latest_file(DataLoader::get_task_data_dir(task),
+                                                       "raw_data_");
+        auto data = DataLoader::load_latest_raw_data(task);
+        auto result = FrictionId::identify(data);
+
+        std::cout << "Segments:" << std::endl;
+        for (const auto& seg : result.segments) {
+            std::cout << "  d=" << seg.duty << "  ω_ss=" << seg.steady_velocity << " deg/s"
+                      << (seg.moving ? "" : "  (stalled)") << std::endl;
+        }
+        std::cout << std::endl;
+
+        auto print_dir = [](const char* name, const FrictionId::DirectionFit& f) {
+            std::cout << name << ":" << std::endl;
+            if (!f.identified) {
+                std::cout << "  not identified (" << f.levels << " moving duty levels)" << std::endl;
+                return;
+            }
+            std::cout << "  Coulomb  = " << f.coulomb << " PWM" << std::endl;
+            std::cout << "  Viscous  = " << f.viscous << " PWM/(deg/s)  (K_v = " << f.gain << ")" << std::endl;
+            std::cout << "  Stiction " << (f.stiction_bounded ? "<= " : "= ") << f.stiction << " PWM" << std::endl;
+            std::cout << "  RMS residual = " << f.rms_residual << " PWM" << std::endl;
+        };
+        print_dir("Forward", result.fwd);
+        print_dir("Reverse", result.rev);
+        std::cout << std::endl;
+
+        fs::path saved = FrictionId::save_friction(task, result, source.filename().string());
+        std::cout << "Saved: " << saved << std::endl;
+        std::cout << std::endl;
+
+        std::cout << "Paste into p2-1.cpp:" << std::endl;
+        std::cout << FrictionId::firmware_table(result) << std::endl;
+
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        std::cerr << std::endl;
+        std::cerr << "Please run: python run.py " << task << std::endl;
+        std::cerr << "Then press 'p' to save data" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,353 @@
+/**
+ * Friction Identification - Header-Only C++ Version
+ *
+ * Fits Coulomb, viscous and stiction terms per direction from the duty sweeps
+ * recorded by p1-2.cpp / p1-3.cpp (raw_data_*.csv: time, velocity, duty).
+ *
+ * Each constant-duty segment contributes one steady-state point (d, ω_ss).
+ * For every direction the moving points are fitted with
+ *
+ *   |d| = coulomb + viscous * |ω_ss|      (viscous = 1/K_v)
+ *
+ * and the breakaway duty (stiction) is bracketed between the largest duty that
+ * left the motor standing and the smallest duty that moved it.
+ *
+ * The result feeds:
+ * - MotorSim::MotorModel (via load_latest_friction)
+ * - the firmware compensation constants in p2-1.cpp (via firmware_table)
+ *
+ * IMPORTANT:
+ * - This is a HEADER-ONLY library for PC-side tools (DO NOT include in Arduino code)
+ * - Only forward duties are recorded by default; set FRICTION_SWEEP = true in
+ *   p1-3.cpp to add low duties and the reverse direction
+ *
+ * Requirements:
+ * - C++17 or higher
+ *
+ * Usage:
+ *   #include "friction_id.hpp"
+ *
+ *   auto data = DataLoader::load_latest_raw_data("1-3");
+ *   auto result = FrictionId::identify(data);
+ *   FrictionId::save_friction("1-3", result);
+ */
+
+#ifndef FRICTION_ID_HPP
+#define FRICTION_ID_HPP
+
+#include <chrono>
+#include <cmath>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "data_loader.hpp"
+#include "motor_sim.hpp"
+
+namespace FrictionId {
+
+/**
+ * Identification settings
+ */
+struct Options {
+    double steady_fraction = 0.4;    // tail of each segment treated as steady state
+    double moving_velocity = 30.0;   // deg/s; one encoder count per 50 ms is ~19 deg/s
+    size_t min_samples = 5;          // shorter segments are ignored
+};
+
+/**
+ * One constant-duty segment of a sweep
+ */
+struct DutySegment {
+    double duty;              // signed PWM duty
+    double t_start;
+    double t_end;
+    double steady_velocity;   // mean |ω| over the steady tail (deg/s)
+    size_t samples;
+    bool moving;
+};
+
+/**
+ * Fit for one direction
+ */
+struct DirectionFit {
+    bool identified = false;      // at least two moving duty levels
+    int levels = 0;               // moving duty levels used in the fit
+    double coulomb = 0.0;         // PWM
+    double viscous = 0.0;         // PWM per deg/s
+    double gain = 0.0;            // 1/viscous, (deg/s)/PWM
+    double stiction = 0.0;        // PWM
+    bool stiction_bounded = false;  // true if no stalled duty was seen (stiction <= value)
+    double rms_residual = 0.0;    // PWM
+};
+
+struct FrictionResult {
+    DirectionFit fwd;
+    DirectionFit rev;
+    std::vector<DutySegment> segments;
+
+    MotorSim::FrictionParams params() const {
+        MotorSim::FrictionParams p;
+        const DirectionFit& f = fwd.identified ? fwd : rev;
+        const DirectionFit& r = rev.identified ? rev : fwd;
+        p.coulomb_fwd = f.coulomb;
+        p.coulomb_rev = r.coulomb;
+        p.stiction_fwd = f.stiction;
+        p.stiction_rev = r.stiction;
+        p.gain_fwd = f.gain;
+        p.gain_rev = r.gain;
+        return p;
+    }
+};
+
+/**
+ * Split a sweep into constant-duty segments (duty = 0 segments are skipped)
+ */
+inline std::vector<DutySegment> split_segments(const DataLoader::RawData& data,
+                                               const Options& opt = {}) {
+    std::vector<DutySegment> segments;
+    size_t n = data.time.size();
+    size_t start = 0;
+
+    while (start < n) {
+        size_t end = start + 1;
+        while (end < n && std::fabs(data.duty[end] - data.duty[start]) < 0.5) {
+            ++end;
+        }
+
+        size_t count = end - start;
+        if (data.duty[start] != 0.0 && count >= opt.min_samples) {
+            size_t tail = std::max<size_t>(1, static_cast<size_t>(count * opt.steady_fraction));
+            double sum = 0.0;
+            for (size_t i = end - tail; i < end; ++i) {
+                sum += std::fabs(data.velocity[i]);
+            }
+
+            DutySegment seg;
+            seg.duty = data.duty[start];
+            seg.t_start = data.time[start];
+            seg.t_end = data.time[end - 1];
+            seg.steady_velocity = sum / tail;
+            seg.samples = count;
+            seg.moving = seg.steady_velocity > opt.moving_velocity;
+            segments.push_back(seg);
+        }
+
+        start = end;
+    }
+
+    return segments;
+}
+
+/**
+ * Least-squares fit of |d| = coulomb + viscous * |ω| for one direction
+ */
+inline DirectionFit fit_direction(const std::vector<DutySegment>& segments, bool forward) {
+    DirectionFit fit;
+    double sx = 0, sy = 0, sxx = 0, sxy = 0;
+    double min_moving = std::numeric_limits<double>::infinity();
+    double max_stalled = 0.0;
+    bool any_stalled = false;
+    std::vector<std::pair<double, double>> points;
+
+    for (const auto& seg : segments) {
+        if ((seg.duty > 0) != forward) {
+            continue;
+        }
+        double d = std::fabs(seg.duty);
+        if (seg.moving) {
+            points.emplace_back(seg.steady_velocity, d);
+            min_moving = std::min(min_moving, d);
+        } else {
+            any_stalled = true;
+            max_stalled = std::max(max_stalled, d);
+        }
+    }
+
+    for (const auto& [x, y] : points) {
+        sx += x;
+        sy += y;
+        sxx += x * x;
+        sxy += x * y;
+    }
+
+    // Distinct duty levels (repeated cycles give several points per level)
+    std::vector<double> levels;
+    for (const auto& p : points) {
+        bool seen = false;
+        for (double l : levels) {
+            seen = seen || std::fabs(l - p.second) < 0.5;
+        }
+        if (!seen) {
+            levels.push_back(p.second);
+        }
+    }
+    fit.levels = static_cast<int>(levels.size());
+
+    double n = static_cast<double>(points.size());
+    double denom = n * sxx - sx * sx;
+    if (fit.levels < 2 || std::fabs(denom) < 1e-12) {
+        return fit;
+    }
+
+    fit.viscous = (n * sxy - sx * sy) / denom;
+    fit.coulomb = (sy - fit.viscous * sx) / n;
+    if (fit.viscous <= 0) {
+        return fit;
+    }
+    fit.identified = true;
+    fit.coulomb = std::max(0.0, fit.coulomb);
+    fit.gain = 1.0 / fit.viscous;
+
+    double ss = 0.0;
+    for (const auto& [x, y] : points) {
+        double r = y - (fit.coulomb + fit.viscous * x);
+        ss += r * r;
+    }
+    fit.rms_residual = std::sqrt(ss / n);
+
+    // Breakaway lies between the largest stalled and the smallest moving duty
+    if (any_stalled && max_stalled < min_moving) {
+        fit.stiction = 0.5 * (max_stalled + min_moving);
+    } else {
+        fit.stiction = min_moving;
+        fit.stiction_bounded = true;
+    }
+    fit.stiction = std::max(fit.stiction, fit.coulomb);
+
+    return fit;
+}
+
+/**
+ * Identify friction terms from a duty sweep
+ */
+inline FrictionResult identify(const DataLoader::RawData& data, const Options& opt = {}) {
+    FrictionResult result;
+    result.segments = split_segments(data, opt);
+    result.fwd = fit_direction(result.segments, true);
+    result.rev = fit_direction(result.segments, false);
+
+    if (!result.fwd.identified && !result.rev.identified) {
+        throw std::runtime_error(
+            "Friction identification needs at least two moving duty levels per direction");
+    }
+    return result;
+}
+
+/**
+ * Current time formatted like the plotters ("%Y%m%d_%H%M%S")
+ */
+inline std::string make_timestamp() {
+    std::time_t now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+    std::tm tm_now{};
+#ifdef _WIN32
+    localtime_s(&tm_now, &now);
+#else
+    localtime_r(&now, &tm_now);
+#endif
+    std::ostringstream oss;
+    oss << std::put_time(&tm_now, "%Y%m%d_%H%M%S");
+    return oss.str();
+}
+
+/**
+ * Save the result as data/<task>/friction_<timestamp>.json
+ */
+inline fs::path save_friction(const std::string& task_name, const FrictionResult& result,
+                              const std::string& source = "") {
+    fs::path data_dir = DataLoader::get_task_data_dir(task_name);
+    fs::create_directories(data_dir);
+
+    std::string timestamp = make_timestamp();
+    fs::path filename = data_dir / ("friction_" + timestamp + ".json");
+
+    auto write_dir = [](std::ostream& os, const std::string& prefix, const DirectionFit& f) {
+        os << "  \"" << prefix << "_identified\": " << (f.identified ? "true" : "false") << ",\n";
+        os << "  \"" << prefix << "_levels\": " << f.levels << ",\n";
+        os << "  \"" << prefix << "_coulomb_pwm\": " << f.coulomb << ",\n";
+        os << "  \"" << prefix << "_viscous_pwm_per_dps\": " << f.viscous << ",\n";
+        os << "  \"" << prefix << "_gain\": " << f.gain << ",\n";
+        os << "  \"" << prefix << "_stiction_pwm\": " << f.stiction << ",\n";
+        os << "  \"" << prefix << "_stiction_bounded\": "
+           << (f.stiction_bounded ? "true" : "false") << ",\n";
+        os << "  \"" << prefix << "_rms_residual_pwm\": " << f.rms_residual << ",\n";
+    };
+
+    std::ofstream out(filename);
+    if (!out.is_open()) {
+        throw std::runtime_error("Failed to open file: " + filename.string());
+    }
+
+    out << std::setprecision(6);
+    out << "{\n";
+    out << "  \"timestamp\": \"" << timestamp << "\",\n";
+    out << "  \"task\": \"" << task_name << "\",\n";
+    out << "  \"source\": \"" << source << "\",\n";
+    write_dir(out, "fwd", result.fwd);
+    write_dir(out, "rev", result.rev);
+    out << "  \"segments\": " << result.segments.size() << "\n";
+    out << "}\n";
+
+    return filename;
+}
+
+/**
+ * Load the latest friction_*.json of a task into simulator parameters
+ *
+ * A direction that was not identified mirrors the other one.
+ */
+inline MotorSim::FrictionParams load_latest_friction(const std::string& task_name = "1-3",
+                                                     bool verbose = true) {
+    fs::path latest_file = DataLoader::find_latest_file(
+        DataLoader::get_task_data_dir(task_name), "friction_");
+
+    std::ifstream file(latest_file);
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to open file: " + latest_file.string());
+    }
+    std::string json((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    auto read_dir = [&](const std::string& prefix) {
+        DirectionFit f;
+        f.identified = json.find("\"" + prefix + "_identified\": true") != std::string::npos;
+        f.coulomb = DataLoader::extract_json_number(json, prefix + "_coulomb_pwm");
+        f.gain = DataLoader::extract_json_number(json, prefix + "_gain");
+        f.stiction = DataLoader::extract_json_number(json, prefix + "_stiction_pwm");
+        return f;
+    };
+
+    FrictionResult result;
+    result.fwd = read_dir("fwd");
+    result.rev = read_dir("rev");
+    MotorSim::FrictionParams params = result.params();
+
+    if (verbose) {
+        std::cout << "=== Friction loaded from " << latest_file.filename().string() << " ===" << std::endl;
+        std::cout << "Coulomb  fwd/rev = " << params.coulomb_fwd << " / " << params.coulomb_rev << " PWM" << std::endl;
+        std::cout << "Stiction fwd/rev = " << params.stiction_fwd << " / " << params.stiction_rev << " PWM" << std::endl;
+        std::cout << std::endl;
+    }
+
+    return params;
+}
+
+/**
+ * Firmware constants for the friction compensation block in p2-1.cpp
+ */
+inline std::string firmware_table(const FrictionResult& result) {
+    MotorSim::FrictionParams p = result.params();
+    std::ostringstream os;
+    os << "// Friction compensation (generated by friction_id)\n";
+    os << "const int FRICTION_COULOMB_FWD = " << std::lround(p.coulomb_fwd) << ";\n";
+    os << "const int FRICTION_COULOMB_REV = " << std::lround(p.coulomb_rev) << ";\n";
+    os << "const int FRICTION_STICTION_FWD = " << std::lround(p.stiction_fwd) << ";\n";
+    os << "const int FRICTION_STICTION_REV = " << std::lround(p.stiction_rev) << ";\n";
+    return os.str();
+}
+
+} // namespace FrictionId
+
+#endif // FRICTION_ID_HPP
@@ -0,0 +1,181 @@
+/**
+ * Golden-Capture Comparison using golden_compare.hpp
+ *
+ * Compares captures of a task against the goldens in data/<task>/golden/
+ * (onset alignment, metric deltas, deviation envelope, DTW) and prints
+ * pass/fail per capture. The report goes to
+ * data/<task>/golden/compare_<timestamp>.csv; the exit code is 1 if any
+ * capture fails, so it can gate a firmware change (NOT for Arduino).
+ *
+ * Tolerances: defaults in GoldenCompare::Tolerances, overridden by
+ * data/<task>/golden/tolerances.json and then by --tol key=value.
+ *
+ * Compilation:
+ *   g++ -std=c++17 -O3 golden_compare.cpp -o golden_compare -pthread
+ *
+ * Usage:
+ *   ./golden_compare promote data/2-1/pid_data_20251120_143022.csv
+ *   ./golden_compare 2-1                        (every capture of the task)
+ *   ./golden_compare 2-1 --latest 3 --envelope  (also write envelope_*.csv)
+ *   ./golden_compare 2-1 --files a.csv b.csv --tol overshoot_pp=5
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include "golden_compare.hpp"
+
+int main(int argc, char** argv) {
+    std::string task = "2-1";
+    size_t latest = 0;
+    size_t threads = 0;
+    bool envelope = false;
+    std::vector<fs::path> files;
+    std::vector<std::pair<std::string, double>> overrides;
+
+    if (argc >= 3 && std::strcmp(argv[1], "promote") == 0) {
+        try {
+            fs::path capture = argv[2];
+            std::string owner = argc >= 4 ? argv[3] : capture.parent_path().filename().string();
+            auto target = GoldenCompare::promote(capture, owner);
+            std::cout << "Golden saved: " << target.string() << std::endl;
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--latest") == 0 && i + 1 < argc) {
+            latest = static_cast<size_t>(std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = static_cast<size_t>(std::max(1, std::atoi(argv[++i])));
+        } else if (std::strcmp(argv[i], "--envelope") == 0) {
+            envelope = true;
+        } else if (std::strcmp(argv[i], "--tol") == 0 && i + 1 < argc) {
+            std::string kv = argv[++i];
+            size_t eq = kv.find('=');
+            if (eq == std::string::npos) {
+                std::cerr << "Expected --tol key=value, got: " << kv << std::endl;
+                return 1;
+            }
+            overrides.emplace_back(kv.substr(0, eq), std::atof(kv.c_str() + eq + 1));
+        } else if (std::strcmp(argv[i], "--files") == 0) {
+            while (i + 1 < argc && argv[i + 1][0] != '-') {
+                files.emplace_back(argv[++i]);
+            }
+        } else if (argv[i][0] != '-') {
+            task = argv[i];
+        } else {
+            std::cerr << "Unknown option: " << argv[i] << std::endl;
+            return 1;
+        }
+    }
+
+    std::cout << "========================================" << std::endl;
+    std::cout << "Golden-Capture Comparison" << std::endl;
+    std::cout << "========================================" << std::endl;
+    std::cout << std::endl;
+
+    try {
+        GoldenCompare::Tolerances tol;
+        tol.load(GoldenCompare::golden_dir(task) / "tolerances.json");
+        for (const auto& [key, value] : overrides) {
+            if (!tol.set(key, value)) {
+                std::cerr << "Unknown tolerance: " << key << std::endl;
+                return 1;
+            }
+        }
+
+        auto goldens = GoldenCompare::load_goldens(task);
+        if (goldens.empty()) {
+            std::cerr << "Error: No goldens in " << GoldenCompare::golden_dir(task).string()
+                      << " (use: ./golden_compare promote <capture>)" << std::endl;
+            return 1;
+        }
+        for (const auto& g : goldens) {
+            std::cout << "Golden: " << g.file << " (" << CaptureWatch::kind_name(g.kind)
+                      << ", " << g.t.size() << " samples)" << std::endl;
+        }
+
+        if (files.empty()) {
+            fs::path dir = DataLoader::get_task_data_dir(task);
+            for (const auto& entry : fs::directory_iterator(dir)) {
+                GoldenCompare::Trace probe;
+                probe.kind = CaptureWatch::classify(entry.path().filename().string());
+                if (entry.is_regular_file() && GoldenCompare::match_golden(goldens, probe)) {
+                    files.push_back(entry.path());
+                }
+            }
+            std::sort(files.begin(), files.end());
+            if (latest > 0 && files.size() > latest) {
+                files.erase(files.begin(), files.end() - latest);
+            }
+        }
+        if (files.empty()) {
+            std::cerr << "Error: No captures to compare" << std::endl;
+            return 1;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        auto results = GoldenCompare::compare_all(files, goldens, tol, threads);
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        std::cout << std::endl;
+        std::printf("%-32s %5s %8s %8s %8s %8s %8s %7s  %s\n", "Capture", "", "dOS pp", "dTs s",
+                    "max dev", "out %", "DTW", "warp s", "Failed checks");
+        size_t failed = 0;
+        for (const auto& c : results) {
+            if (!c.error.empty()) {
+                std::printf("%-32s %5s  %s\n", c.file.c_str(), "ERROR", c.error.c_str());
+                ++failed;
+                continue;
+            }
+            std::string checks;
+            for (const auto& f : c.failures) {
+                checks += (checks.empty() ? "" : ",") + f;
+            }
+            failed += c.pass ? 0 : 1;
+            std::printf("%-32s %5s %8.2f %8.3f %8.2f %8.1f %8.2f %7.3f  %s\n", c.file.c_str(),
+                        c.pass ? "PASS" : "FAIL", c.d_overshoot, c.d_settling, c.max_deviation,
+                        c.outside_fraction * 100.0, c.dtw_rms, c.max_warp_s, checks.c_str());
+        }
+        std::cout << std::endl;
+        std::cout << results.size() - failed << "/" << results.size() << " passed ("
+                  << elapsed * 1000.0 << " ms)" << std::endl;
+
+        // Report and optional envelopes next to the goldens
+        fs::path dir = GoldenCompare::golden_dir(task);
+        fs::path report = dir / ("compare_" + FrictionId::make_timestamp() + ".csv");
+        std::ofstream out(report);
+        if (!out.is_open()) {
+            throw std::runtime_error("Failed to open file: " + report.string());
+        }
+        out << "Capture,Golden,Pass,Failed,dOvershoot,dSettling,dRise,dSteadyState,"
+               "MaxDeviation,RmsDeviation,OutsideFraction,DtwRms,MaxWarp,Error\n";
+        for (const auto& c : results) {
+            std::string checks;
+            for (const auto& f : c.failures) {
+                checks += (checks.empty() ? "" : ";") + f;
+            }
+            out << c.file << "," << c.golden << "," << (c.pass ? 1 : 0) << "," << checks << ","
+                << c.d_overshoot << "," << c.d_settling << "," << c.d_rise << ","
+                << c.d_steady_state << "," << c.max_deviation << "," << c.rms_deviation << ","
+                << c.outside_fraction << "," << c.dtw_rms << "," << c.max_warp_s << ","
+                << c.error << "\n";
+            if (envelope && c.error.empty()) {
+                fs::path stem = fs::path(c.file).stem();
+                GoldenCompare::save_envelope(c, dir / ("envelope_" + stem.string() + ".csv"));
+            }
+        }
+        std::cout << "Report saved: " << report.string() << std::endl;
+
+        return failed > 0 ? 1 : 0;
+
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+}
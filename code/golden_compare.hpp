@@ -0,0 +1,593 @@
+/**
+ * Golden-Capture Comparison - Header-Only C++ Version
+ *
+ * Regression check of a capture against a stored reference ("golden")
+ * capture of the same kind, so firmware or hardware changes are judged by
+ * numbers instead of eyeballed plots:
+ *
+ * 1. Onset alignment: both responses are shifted so the motion starts at
+ *    t = 0 (first sample 5% of the way to the final value), then resampled
+ *    on the golden sample grid.
+ * 2. Metric deltas (pid_data): overshoot, settling, rise time and
+ *    steady-state error from step_metrics.hpp.
+ * 3. Deviation envelope: pointwise |capture - golden| against a band of
+ *    band_abs + band_rel * |step|, reported as max/RMS deviation and the
+ *    fraction of samples outside.
+ * 4. Dynamic time warping inside a Sakoe-Chiba band: the shape distance
+ *    after timing differences are removed, and the largest time shift the
+ *    warp needed (a slower or faster response moves the shift, not the
+ *    distance).
+ *
+ * Goldens live in data/<task>/golden/ (copies of pid_data_* / raw_data_*).
+ * Signals are position (pid_data) and velocity (raw_data).
+ *
+ * Throughput: the envelope and DTW row loops run on non-aliasing
+ * (__restrict) contiguous arrays without branches; the DTW row is split into
+ * a vectorizable part (local cost, min of the previous row) and one scalar
+ * scan, and the envelope sums into independent lanes instead of one serial
+ * accumulator. Build with -O3 (GCC 12 at plain -O2 only vectorizes loops
+ * whose trip count needs no epilogue, which leaves just the envelope lanes;
+ * -O2 -ftree-vectorize -fvect-cost-model=dynamic is equivalent to -O3 here).
+ * Check with -fopt-info-vec-optimized. compare_all() spreads a suite of
+ * captures over all cores.
+ *
+ * IMPORTANT:
+ * - This is a HEADER-ONLY library for PC-side tools (DO NOT include in Arduino code)
+ *
+ * Requirements:
+ * - C++17 or higher
+ *
+ * Usage:
+ *   #include "golden_compare.hpp"
+ *
+ *   auto golden = GoldenCompare::load_trace(golden_path);
+ *   auto capture = GoldenCompare::load_trace(capture_path);
+ *   auto c = GoldenCompare::compare(golden, capture, GoldenCompare::Tolerances{});
+ *   if (!c.pass) { ... c.failures ... }
+ */
+
+#ifndef GOLDEN_COMPARE_HPP
+#define GOLDEN_COMPARE_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <string>
+#include <thread>
+#include <vector>
+#include "capture_watch.hpp"
+#include "step_metrics.hpp"
+
+namespace GoldenCompare {
+
+using CaptureWatch::Kind;
+
+/**
+ * One response signal of a capture
+ */
+struct Trace {
+    std::string file;
+    Kind kind = Kind::Other;
+    std::vector<double> t;
+    std::vector<double> y;
+    double reference = 0.0;    // Final reference (pid_data) or final level (raw_data)
+};
+
+inline Trace load_trace(const fs::path& path) {
+    Trace tr;
+    tr.file = path.filename().string();
+    tr.kind = CaptureWatch::classify(tr.file);
+    if (tr.kind == Kind::PidData) {
+        auto data = DataLoader::load_pid_data(path);
+        tr.t = std::move(data.time);
+        tr.y = std::move(data.position);
+        tr.reference = data.reference.empty() ? 0.0 : data.reference.back();
+    } else if (tr.kind == Kind::RawData) {
+        auto data = DataLoader::load_raw_data(path);
+        tr.t = std::move(data.time);
+        tr.y = std::move(data.velocity);
+        size_t n = tr.y.size(), tail = std::max<size_t>(1, n / 10);
+        double sum = 0.0;
+        for (size_t i = n - std::min(n, tail); i < n; ++i) {
+            sum += tr.y[i];
+        }
+        tr.reference = n > 0 ? sum / std::min(n, tail) : 0.0;
+    } else {
+        throw std::runtime_error("Not a pid_data/raw_data capture: " + tr.file);
+    }
+    if (tr.t.size() < 10) {
+        throw std::runtime_error("Not enough samples in " + tr.file);
+    }
+    return tr;
+}
+
+/**
+ * Time of the first sample `fraction` of the way from y[0] to the reference
+ */
+inline double onset_time(const Trace& tr, double fraction = 0.05) {
+    double step = tr.reference - tr.y[0];
+    if (step == 0.0) {
+        return tr.t[0];
+    }
+    double threshold = std::fabs(step) * fraction;
+    for (size_t i = 0; i < tr.y.size(); ++i) {
+        if ((tr.y[i] - tr.y[0]) * (step > 0 ? 1.0 : -1.0) >= threshold) {
+            return tr.t[i];
+        }
+    }
+    return tr.t[0];
+}
+
+/**
+ * Linear interpolation of y at t0 + k*dt, k = 0..n-1 (held at the ends)
+ */
+inline std::vector<double> resample(const Trace& tr, double t0, double dt, size_t n) {
+    std::vector<double> out(n);
+    size_t j = 0;
+    for (size_t k = 0; k < n; ++k) {
+        double t = t0 + k * dt;
+        while (j + 1 < tr.t.size() && tr.t[j + 1] < t) {
+            ++j;
+        }
+        if (t <= tr.t.front()) {
+            out[k] = tr.y.front();
+        } else if (j + 1 >= tr.t.size()) {
+            out[k] = tr.y.back();
+        } else {
+            double span = tr.t[j + 1] - tr.t[j];
+            double w = span > 0 ? (t - tr.t[j]) / span : 0.0;
+            out[k] = tr.y[j] + w * (tr.y[j + 1] - tr.y[j]);
+        }
+    }
+    return out;
+}
+
+struct DtwResult {
+    double rms = 0.0;          // sqrt(mean squared cost along the warping path)
+    size_t max_shift = 0;      // largest |i - j| on the path for i < shift_until (samples)
+};
+
+/**
+ * Dynamic time warping of equally sampled a and b inside a band of ±w samples
+ *
+ * On flat stretches any warp is free, so the shift is only taken where `a`
+ * is still moving (i < shift_until).
+ */
+inline DtwResult dtw(const std::vector<double>& a, const std::vector<double>& b, size_t w,
+                     size_t shift_until = std::numeric_limits<size_t>::max()) {
+    const double inf = std::numeric_limits<double>::infinity();
+    size_t n = a.size(), m = b.size();
+    DtwResult r;
+    if (n == 0 || m == 0) {
+        return r;
+    }
+    w = std::max(w, n > m ? n - m : m - n);
+    size_t width = 2 * w + 1;
+
+    // D[i][j] for j in [i - w, i + w], stored as D[i * width + (j - i + w)]
+    std::vector<double> D(n * width, inf);
+    std::vector<double> cost(width), best_prev(width);
+    // b padded by the band on both sides so the cost loop needs no bounds checks
+    std::vector<double> padded(w + m + n + w + 1, 0.0);
+    std::copy(b.begin(), b.end(), padded.begin() + w);
+    for (size_t i = 0; i < n; ++i) {
+        double ai = a[i];
+        double* row = &D[i * width];
+        const double* prev = i > 0 ? &D[(i - 1) * width] : nullptr;
+
+        // Vectorized: local cost and min(D[i-1][j], D[i-1][j-1]) for the whole band.
+        // __restrict: the rows never overlap, so no runtime alias checks
+        const double* __restrict bi = &padded[i];  // bi[k] = b[i + k - w]
+        double* __restrict cst = cost.data();
+        for (size_t k = 0; k < width; ++k) {
+            double d = ai - bi[k];
+            cst[k] = d * d;
+        }
+        if (prev) {
+            // Band index k in row i is k + 1 in row i-1 for the same j
+            const double* __restrict pv = prev;
+            double* __restrict bp = best_prev.data();
+            for (size_t k = 0; k + 1 < width; ++k) {
+                bp[k] = pv[k + 1] < pv[k] ? pv[k + 1] : pv[k];
+            }
+            bp[width - 1] = pv[width - 1];
+        }
+
+        // Scalar scan along the row: D[i][j-1]
+        double left = inf;
+        for (size_t k = 0; k < width; ++k) {
+            long j = static_cast<long>(i + k) - static_cast<long>(w);
+            if (j < 0 || j >= static_cast<long>(m)) {
+                left = inf;
+                continue;
+            }
+            double from = (i == 0 && j == 0) ? 0.0 : std::min(left, prev ? best_prev[k] : inf);
+            row[k] = cost[k] + from;
+            left = row[k];
+        }
+    }
+
+    // Backtrack from (n-1, m-1) for the path length and the largest shift
+    size_t i = n - 1, j = m - 1, length = 1;
+    auto at = [&](size_t ii, size_t jj) {
+        long k = static_cast<long>(jj) - static_cast<long>(ii) + static_cast<long>(w);
+        return (k < 0 || k >= static_cast<long>(width)) ? inf : D[ii * width + static_cast<size_t>(k)];
+    };
+    double total = at(i, j);
+    r.max_shift = 0;
+    while (i > 0 || j > 0) {
+        double diag = (i > 0 && j > 0) ? at(i - 1, j - 1) : inf;
+        double up = i > 0 ? at(i - 1, j) : inf;
+        double left = j > 0 ? at(i, j - 1) : inf;
+        if (diag <= up && diag <= left) {
+            --i;
+            --j;
+        } else if (up <= left) {
+            --i;
+        } else {
+            --j;
+        }
+        ++length;
+        if (i < shift_until) {
+            r.max_shift = std::max(r.max_shift, i > j ? i - j : j - i);
+        }
+    }
+    r.rms = std::sqrt(total / length);
+    return r;
+}
+
+/**
+ * Pass/fail limits (metric deltas are capture - golden, compared by magnitude)
+ */
+struct Tolerances {
+    double overshoot_pp = 3.0;        // percentage points
+    double settling_s = 0.1;
+    double rise_s = 0.05;
+    double steady_state = 2.0;        // deg (pid_data)
+    double band_abs = 5.0;            // envelope half-width: abs + rel * |step|
+    double band_rel = 0.03;
+    double outside_fraction = 0.02;   // allowed share of samples outside the envelope
+    double dtw_rms = 3.0;             // signal units
+    double max_warp_s = 0.1;
+    double dtw_window_s = 0.2;        // Sakoe-Chiba band
+
+    /**
+     * Override from data/<task>/golden/tolerances.json (missing keys keep defaults)
+     */
+    void load(const fs::path& path) {
+        std::ifstream file(path);
+        if (!file.is_open()) {
+            return;
+        }
+        std::string json((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        for (auto& [key, value] : fields()) {
+            try {
+                *value = DataLoader::extract_json_number(json, key);
+            } catch (const std::exception&) {
+            }
+        }
+    }
+
+    /**
+     * key=value override from the command line; false for an unknown key
+     */
+    bool set(const std::string& key, double value) {
+        for (auto& [name, field] : fields()) {
+            if (name == key) {
+                *field = value;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    std::vector<std::pair<std::string, double*>> fields() {
+        return {{"overshoot_pp", &overshoot_pp}, {"settling_s", &settling_s},
+                {"rise_s", &rise_s}, {"steady_state", &steady_state},
+                {"band_abs", &band_abs}, {"band_rel", &band_rel},
+                {"outside_fraction", &outside_fraction}, {"dtw_rms", &dtw_rms},
+                {"max_warp_s", &max_warp_s}, {"dtw_window_s", &dtw_window_s}};
+    }
+};
+
+struct Comparison {
+    std::string file;
+    std::string golden;
+    bool pass = false;
+    std::vector<std::string> failures;
+    std::string error;                 // Set if the comparison could not run
+
+    bool has_metrics = false;
+    StepMetrics::Metrics golden_metrics, capture_metrics;
+    double d_overshoot = 0, d_settling = 0, d_rise = 0, d_steady_state = 0;
+
+    double max_deviation = 0;
+    double rms_deviation = 0;
+    double outside_fraction = 0;
+    double dtw_rms = 0;
+    double max_warp_s = 0;
+
+    // Onset-aligned envelope on the golden grid (t = 0 at onset)
+    std::vector<double> t, golden_y, capture_y, band;
+};
+
+namespace detail {
+
+inline double median_dt(const std::vector<double>& t) {
+    std::vector<double> d(t.size() - 1);
+    for (size_t i = 1; i < t.size(); ++i) {
+        d[i - 1] = t[i] - t[i - 1];
+    }
+    std::nth_element(d.begin(), d.begin() + d.size() / 2, d.end());
+    return d[d.size() / 2];
+}
+
+// NaN-aware delta check (a metric that became NaN or stopped being NaN fails)
+inline bool within(double golden, double capture, double tol, double& delta) {
+    if (std::isnan(golden) && std::isnan(capture)) {
+        delta = 0.0;
+        return true;
+    }
+    delta = capture - golden;
+    return std::isfinite(delta) && std::fabs(delta) <= tol;
+}
+
+} // namespace detail
+
+/**
+ * Compare a capture against its golden
+ */
+inline Comparison compare(const Trace& golden, const Trace& capture, const Tolerances& tol) {
+    Comparison c;
+    c.file = capture.file;
+    c.golden = golden.file;
+    if (golden.kind != capture.kind) {
+        throw std::runtime_error("Capture kinds differ: " + golden.file + " vs " + capture.file);
+    }
+
+    // Common onset-aligned window on the golden grid, with 10% pre-onset context
+    double dt = detail::median_dt(golden.t);
+    if (!(dt > 0)) {
+        throw std::runtime_error("Invalid sample interval in " + golden.file);
+    }
+    double on_g = onset_time(golden), on_c = onset_time(capture);
+    double pre = std::min(on_g - golden.t.front(), on_c - capture.t.front());
+    double post = std::min(golden.t.back() - on_g, capture.t.back() - on_c);
+    pre = std::min(pre, 0.1 * (pre + post));
+    size_t n = static_cast<size_t>((pre + post) / dt) + 1;
+    if (n < 10) {
+        throw std::runtime_error("Captures overlap for less than 10 samples");
+    }
+    c.golden_y = resample(golden, on_g - pre, dt, n);
+    c.capture_y = resample(capture, on_c - pre, dt, n);
+    c.t.resize(n);
+    c.band.resize(n);
+
+    // Envelope: an element-wise pass for the deviation, then sum, max and
+    // count over DEV_LANES independent accumulators (an in-order double sum
+    // or max does not vectorize without -ffast-math; separate lanes do)
+    double step = std::fabs(golden.reference - golden.y.front());
+    double half_width = tol.band_abs + tol.band_rel * step;
+    for (size_t k = 0; k < n; ++k) {
+        c.t[k] = k * dt - pre;  // size_t -> double has no SSE2/AVX2 form: scalar
+    }
+    std::fill(c.band.begin(), c.band.end(), half_width);
+    std::vector<double> deviation(n);
+    {
+        const double* __restrict gy = c.golden_y.data();
+        const double* __restrict cy = c.capture_y.data();
+        double* __restrict dev = deviation.data();
+        for (size_t k = 0; k < n; ++k) {
+            dev[k] = std::fabs(cy[k] - gy[k]);
+        }
+    }
+
+    constexpr size_t DEV_LANES = 4;
+    double lane_sq[DEV_LANES] = {}, lane_max[DEV_LANES] = {}, lane_out[DEV_LANES] = {};
+    const double* dev = deviation.data();
+    size_t k = 0;
+    for (; k + DEV_LANES <= n; k += DEV_LANES) {
+        // Kept as a loop so it vectorizes lane-wise (no reduction inside);
+        // -O3 would otherwise unroll it first and then miss the max
+#pragma GCC unroll 1
+        for (size_t l = 0; l < DEV_LANES; ++l) {
+            double d = dev[k + l];
+            lane_sq[l] += d * d;
+            lane_max[l] = lane_max[l] > d ? lane_max[l] : d;
+            lane_out[l] += d > half_width ? 1.0 : 0.0;
+        }
+    }
+    for (; k < n; ++k) {
+        double d = dev[k];
+        lane_sq[0] += d * d;
+        lane_max[0] = lane_max[0] > d ? lane_max[0] : d;
+        lane_out[0] += d > half_width ? 1.0 : 0.0;
+    }
+    double sum_sq = 0.0, max_dev = 0.0, outside = 0.0;
+    for (size_t l = 0; l < DEV_LANES; ++l) {
+        sum_sq += lane_sq[l];
+        max_dev = std::max(max_dev, lane_max[l]);
+        outside += lane_out[l];
+    }
+    c.max_deviation = max_dev;
+    c.rms_deviation = std::sqrt(sum_sq / n);
+    c.outside_fraction = outside / n;
+    if (c.outside_fraction > tol.outside_fraction) {
+        c.failures.push_back("envelope");
+    }
+
+    // Golden transient: up to the last sample outside 2% of the step from where
+    // it actually ends (a P-only loop stalls short of the reference)
+    size_t transient = 0;
+    size_t tail = std::max<size_t>(1, n / 10);
+    double final_value = 0.0;
+    for (size_t k = n - tail; k < n; ++k) {
+        final_value += c.golden_y[k] / tail;
+    }
+    for (size_t k = 0; k < n; ++k) {
+        if (std::fabs(c.golden_y[k] - final_value) > 0.02 * step) {
+            transient = k + 1;
+        }
+    }
+    auto warp = dtw(c.golden_y, c.capture_y, static_cast<size_t>(tol.dtw_window_s / dt), transient);
+    c.dtw_rms = warp.rms;
+    c.max_warp_s = warp.max_shift * dt;
+    if (c.dtw_rms > tol.dtw_rms) {
+        c.failures.push_back("dtw");
+    }
+    if (c.max_warp_s > tol.max_warp_s) {
+        c.failures.push_back("warp");
+    }
+
+    // Step metrics from the onset-aligned responses (pid_data only)
+    if (golden.kind == Kind::PidData && golden.reference != 0.0 && capture.reference != 0.0) {
+        c.has_metrics = true;
+        std::vector<double> t0(n);
+        for (size_t k = 0; k < n; ++k) {
+            t0[k] = k * dt;
+        }
+        c.golden_metrics = StepMetrics::compute(t0.data(), c.golden_y.data(), n, golden.reference);
+        c.capture_metrics = StepMetrics::compute(t0.data(), c.capture_y.data(), n, capture.reference);
+        const auto& g = c.golden_metrics;
+        const auto& m = c.capture_metrics;
+        if (!detail::within(g.overshoot, m.overshoot, tol.overshoot_pp, c.d_overshoot)) {
+            c.failures.push_back("overshoot");
+        }
+        if (!detail::within(g.settling_time, m.settling_time, tol.settling_s, c.d_settling)) {
+            c.failures.push_back("settling");
+        }
+        if (!detail::within(g.rise_time, m.rise_time, tol.rise_s, c.d_rise)) {
+            c.failures.push_back("rise");
+        }
+        if (!detail::within(g.steady_state_error, m.steady_state_error, tol.steady_state,
+                            c.d_steady_state)) {
+            c.failures.push_back("steady_state");
+        }
+    }
+
+    c.pass = c.failures.empty();
+    return c;
+}
+
+inline fs::path golden_dir(const std::string& task_name) {
+    return DataLoader::get_task_data_dir(task_name) / "golden";
+}
+
+/**
+ * Copy a capture into data/<task>/golden/
+ */
+inline fs::path promote(const fs::path& capture, const std::string& task_name) {
+    if (CaptureWatch::classify(capture.filename().string()) == Kind::Other ||
+        CaptureWatch::classify(capture.filename().string()) == Kind::Summary) {
+        throw std::runtime_error("Only pid_data_*/raw_data_* captures can be goldens");
+    }
+    fs::path dir = golden_dir(task_name);
+    fs::create_directories(dir);
+    fs::path target = dir / capture.filename();
+    fs::copy_file(capture, target, fs::copy_options::overwrite_existing);
+    return target;
+}
+
+/**
+ * Goldens of a task
+ */
+inline std::vector<Trace> load_goldens(const std::string& task_name) {
+    std::vector<Trace> goldens;
+    fs::path dir = golden_dir(task_name);
+    if (!fs::exists(dir)) {
+        return goldens;
+    }
+    std::vector<fs::path> files;
+    for (const auto& entry : fs::directory_iterator(dir)) {
+        Kind kind = CaptureWatch::classify(entry.path().filename().string());
+        if (entry.is_regular_file() && (kind == Kind::PidData || kind == Kind::RawData)) {
+            files.push_back(entry.path());
+        }
+    }
+    std::sort(files.begin(), files.end());
+    for (const auto& f : files) {
+        goldens.push_back(load_trace(f));
+    }
+    return goldens;
+}
+
+/**
+ * Golden of the same kind with the closest reference (latest on ties)
+ */
+inline const Trace* match_golden(const std::vector<Trace>& goldens, const Trace& capture) {
+    const Trace* best = nullptr;
+    for (const auto& g : goldens) {
+        if (g.kind != capture.kind) {
+            continue;
+        }
+        if (!best || std::fabs(g.reference - capture.reference) <=
+                         std::fabs(best->reference - capture.reference)) {
+            best = &g;
+        }
+    }
+    return best;
+}
+
+/**
+ * Compare a suite of captures on all cores (order of `captures` is kept)
+ */
+inline std::vector<Comparison> compare_all(const std::vector<fs::path>& captures,
+                                           const std::vector<Trace>& goldens,
+                                           const Tolerances& tol, size_t threads = 0) {
+    std::vector<Comparison> results(captures.size());
+    std::atomic<size_t> next{0};
+    auto worker = [&]() {
+        for (size_t i = next++; i < captures.size(); i = next++) {
+            Comparison& c = results[i];
+            c.file = captures[i].filename().string();
+            try {
+                Trace capture = load_trace(captures[i]);
+                const Trace* golden = match_golden(goldens, capture);
+                if (!golden) {
+                    throw std::runtime_error("No golden of this kind");
+                }
+                c = compare(*golden, capture, tol);
+            } catch (const std::exception& e) {
+                c.pass = false;
+                c.error = e.what();
+            }
+        }
+    };
+
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    threads = std::min(threads, std::max<size_t>(1, captures.size()));
+    std::vector<std::thread> pool;
+    for (size_t i = 1; i < threads; ++i) {
+        pool.emplace_back(worker);
+    }
+    worker();
+    for (auto& th : pool) {
+        th.join();
+    }
+    return results;
+}
+
+/**
+ * Envelope CSV for plotting: Time,Golden,Lower,Upper,Capture,Deviation
+ */
+inline void save_envelope(const Comparison& c, const fs::path& path) {
+    std::ofstream out(path);
+    if (!out.is_open()) {
+        throw std::runtime_error("Failed to open file: " + path.string());
+    }
+    out << "Time,Golden,Lower,Upper,Capture,Deviation\n";
+    for (size_t k = 0; k < c.t.size(); ++k) {
+        out << c.t[k] << "," << c.golden_y[k] << "," << c.golden_y[k] - c.band[k] << ","
+            << c.golden_y[k] + c.band[k] << "," << c.capture_y[k] << ","
+            << c.capture_y[k] - c.golden_y[k] << "\n";
+    }
+}
+
+} // namespace GoldenCompare
+
+#endif // GOLDEN_COMPARE_HPP
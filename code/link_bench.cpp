@@ -0,0 +1,147 @@
+/**
+ * Serial Link Benchmark using link_bench.hpp
+ *
+ * Drives the test_link.cpp self-benchmark: for each baud rate and telemetry
+ * format, steps the line rate up until lines are lost, corrupted, or the
+ * dummy control task misses deadlines, and reports the highest clean rate.
+ * All steps are saved to data/link/link_bench_<timestamp>.csv (NOT for Arduino).
+ *
+ * Compilation:
+ *   g++ -std=c++17 -O2 link_bench.cpp -o link_bench
+ *
+ * Usage:
+ *   python run.py link               (upload test_link.cpp first)
+ *   ./link_bench
+ *   ./link_bench --bauds 57600,115200,230400 --formats 0,3
+ *   ./link_bench --rates 100,200,400,800 --duration 5000 --all
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include "link_bench.hpp"
+
+namespace {
+
+std::vector<long> parse_list(const char* text) {
+    std::vector<long> values;
+    std::stringstream ss(text);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        values.push_back(std::atol(item.c_str()));
+    }
+    return values;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::vector<long> bauds = {115200};
+    std::vector<long> formats = {LinkBench::FORMAT_P2_1, LinkBench::FORMAT_P1_3,
+                                 LinkBench::FORMAT_KP, LinkBench::FORMAT_STAT};
+    std::vector<long> rates = {50, 100, 200, 400, 600, 800, 1000, 1500, 2000};
+    long duration_ms = 3000;
+    bool all = false;
+
+    for (int i = 1; i < argc; ++i) {
+        bool has_value = i + 1 < argc;
+        if (std::strcmp(argv[i], "--bauds") == 0 && has_value) {
+            bauds = parse_list(argv[++i]);
+        } else if (std::strcmp(argv[i], "--formats") == 0 && has_value) {
+            formats = parse_list(argv[++i]);
+        } else if (std::strcmp(argv[i], "--rates") == 0 && has_value) {
+            rates = parse_list(argv[++i]);
+        } else if (std::strcmp(argv[i], "--duration") == 0 && has_value) {
+            duration_ms = std::atol(argv[++i]);
+        } else if (std::strcmp(argv[i], "--all") == 0) {
+            all = true;
+        } else {
+            std::cerr << "Unknown option: " << argv[i] << std::endl;
+            return 1;
+        }
+    }
+
+    std::cout << "========================================" << std::endl;
+    std::cout << "Serial Link Benchmark" << std::endl;
+    std::cout << "========================================" << std::endl;
+    std::cout << std::endl;
+
+    std::vector<LinkBench::StepResult> results;
+    try {
+        SerialPort::Port port(SerialPort::default_port_name(), 115200, false);
+        port.wait_for_reset();
+        port.reset_input_buffer();
+        long current_baud = 115200;
+
+        for (long baud : bauds) {
+            LinkBench::set_baud(port, current_baud, baud);
+            current_baud = baud;
+
+            for (long format : formats) {
+                std::cout << "--- " << baud << " baud, " << LinkBench::format_name(format)
+                          << " ---" << std::endl;
+                std::printf("%7s %9s %9s %6s %6s %8s %8s %8s %7s %9s\n", "Rate", "Lines/s",
+                            "Bytes/s", "Frame", "Lost", "p50 ms", "p99 ms", "max ms", "Misses",
+                            "Late us");
+
+                for (long rate : rates) {
+                    auto r = LinkBench::run_step(port, baud, {static_cast<int>(format), rate, duration_ms});
+                    results.push_back(r);
+                    std::printf("%7ld %9.1f %9.0f %6ld %6ld %8.2f %8.2f %8.2f %7ld %9ld%s\n",
+                                r.rate, r.lines_per_s, r.throughput_bps, r.framing_errors,
+                                r.lines_lost, r.latency_p50_ms, r.latency_p99_ms,
+                                r.latency_max_ms, r.misses, r.max_late_us,
+                                r.reported ? "" : "  (no report)");
+                    if (!r.clean() && !all) {
+                        break;  // Higher rates only get worse
+                    }
+                }
+                std::cout << std::endl;
+            }
+        }
+
+        // Back to the default so the next tool finds the board at 115200
+        LinkBench::set_baud(port, current_baud, 115200);
+
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        if (results.empty()) {
+            return 1;
+        }
+    }
+
+    // Telemetry limits: highest clean rate per baud and format
+    std::map<std::pair<long, int>, const LinkBench::StepResult*> best;
+    for (const auto& r : results) {
+        auto key = std::make_pair(r.baud, r.format);
+        if (r.clean() && (!best.count(key) || r.rate > best[key]->rate)) {
+            best[key] = &r;
+        }
+    }
+    std::cout << "Highest clean rate (no loss, no framing errors, no deadline misses):" << std::endl;
+    for (long baud : bauds) {
+        for (long format : formats) {
+            auto it = best.find(std::make_pair(baud, static_cast<int>(format)));
+            std::cout << "  " << baud << " baud, " << LinkBench::format_name(format) << ": ";
+            if (it == best.end()) {
+                std::cout << "none" << std::endl;
+            } else {
+                std::cout << it->second->rate << " lines/s (" << static_cast<long>(it->second->throughput_bps)
+                          << " bytes/s, p99 latency " << it->second->latency_p99_ms << " ms)" << std::endl;
+            }
+        }
+    }
+
+    try {
+        auto path = LinkBench::save_results(results);
+        std::cout << std::endl << "Saved: " << path.string() << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,359 @@
+/**
+ * Serial Link Benchmark - Header-Only C++ Version
+ *
+ * Host side of the test_link.cpp self-benchmark: commands one step
+ * (format, lines per second, duration), receives the synthetic telemetry and
+ * measures what actually made it across the link:
+ *
+ * - throughput in bytes/s and lines/s
+ * - framing errors (wrong prefix, field count or unparsable numbers)
+ * - lost lines (gaps in the sequence numbers, against the firmware count)
+ * - latency percentiles from the firmware micros() stamp to the host read
+ * - deadline misses and lateness of the dummy 10 ms control task, as reported
+ *   by the firmware
+ *
+ * The two clocks are not synchronized, so latency is measured above the
+ * fastest line: the offset is the minimum of (host - firmware) time in each
+ * half of the step, interpolated linearly to cancel resonator drift.
+ *
+ * IMPORTANT:
+ * - This is a HEADER-ONLY library for PC-side tools (DO NOT include in Arduino code)
+ *
+ * Requirements:
+ * - C++17 or higher
+ *
+ * Usage:
+ *   #include "link_bench.hpp"
+ *
+ *   SerialPort::Port port(SerialPort::default_port_name(), 115200, false);
+ *   auto r = LinkBench::run_step(port, 115200, {LinkBench::FORMAT_P2_1, 200, 3000});
+ *   std::cout << r.throughput_bps << std::endl;
+ */
+
+#ifndef LINK_BENCH_HPP
+#define LINK_BENCH_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "data_loader.hpp"
+#include "friction_id.hpp"
+#include "link_sim.hpp"
+#include "serial_port.hpp"
+
+namespace LinkBench {
+
+// Formats of test_link.cpp
+constexpr int FORMAT_P2_1 = 0;
+constexpr int FORMAT_P1_3 = 1;
+constexpr int FORMAT_KP = 2;
+constexpr int FORMAT_STAT = 3;
+constexpr int FORMAT_COUNT = 4;
+
+inline const char* format_name(int format) {
+    switch (format) {
+        case FORMAT_P2_1: return "p2-1";
+        case FORMAT_P1_3: return "p1-3";
+        case FORMAT_KP: return "kp";
+        case FORMAT_STAT: return "stat";
+        default: return "?";
+    }
+}
+
+inline const char* format_prefix(int format) {
+    return format == FORMAT_STAT ? "Stat:" : "Data:";
+}
+
+/**
+ * Fields per line: "<seq>,<t_us>" plus the payload of the format
+ */
+inline size_t format_fields(int format) {
+    switch (format) {
+        case FORMAT_P2_1: return 2 + 7;
+        case FORMAT_P1_3: return 2 + 2;
+        case FORMAT_KP: return 2 + 2;
+        case FORMAT_STAT: return 2 + 2 + 16;
+        default: return 0;
+    }
+}
+
+struct StepConfig {
+    int format = FORMAT_P2_1;
+    long rate = 100;            // lines per second
+    long duration_ms = 3000;
+};
+
+struct StepResult {
+    int format = 0;
+    long baud = 0;
+    long rate = 0;
+    double duration_s = 0;
+
+    // Host measurements
+    long lines_ok = 0;
+    long framing_errors = 0;
+    long lines_lost = 0;
+    double bytes = 0;             // incl. "\r\n" and bad lines
+    double throughput_bps = 0;    // bytes per second
+    double lines_per_s = 0;
+    double latency_p50_ms = 0;
+    double latency_p95_ms = 0;
+    double latency_p99_ms = 0;
+    double latency_max_ms = 0;
+
+    // Firmware report (Bench: line)
+    bool reported = false;
+    long sent = 0;
+    long ticks = 0;
+    long misses = 0;
+    long max_late_us = 0;
+    long max_tick_us = 0;
+
+    /**
+     * Everything arrived intact and the control task kept its deadlines
+     */
+    bool clean() const {
+        return reported && framing_errors == 0 && lines_lost == 0 && misses == 0;
+    }
+};
+
+/**
+ * A received line and the host time it was read at (µs since step start)
+ */
+struct RxLine {
+    std::string text;
+    double host_us;
+};
+
+/**
+ * Split a benchmark line into numbers; false on any framing problem
+ */
+inline bool parse_line(const std::string& line, int format, std::vector<double>& values) {
+    const char* prefix = format_prefix(format);
+    size_t plen = std::char_traits<char>::length(prefix);
+    if (line.compare(0, plen, prefix) != 0) {
+        return false;
+    }
+    values.clear();
+    const char* p = line.c_str() + plen;
+    while (true) {
+        char* end = nullptr;
+        double v = std::strtod(p, &end);
+        if (end == p) {
+            return false;
+        }
+        values.push_back(v);
+        if (*end == '\0') {
+            break;
+        }
+        if (*end != ',') {
+            return false;
+        }
+        p = end + 1;
+    }
+    return values.size() == format_fields(format);
+}
+
+/**
+ * Parse "Bench:<format>,<rate>,<sent>,<ticks>,<misses>,<max_late_us>,<max_tick_us>"
+ */
+inline bool parse_summary(const std::string& line, StepResult& r) {
+    if (line.rfind("Bench:", 0) != 0) {
+        return false;
+    }
+    long v[7];
+    const char* p = line.c_str() + 6;
+    for (int i = 0; i < 7; ++i) {
+        char* end = nullptr;
+        v[i] = std::strtol(p, &end, 10);
+        if (end == p || (i < 6 && *end != ',')) {
+            return false;
+        }
+        p = end + 1;
+    }
+    r.sent = v[2];
+    r.ticks = v[3];
+    r.misses = v[4];
+    r.max_late_us = v[5];
+    r.max_tick_us = v[6];
+    r.reported = true;
+    return true;
+}
+
+/**
+ * Host measurements of one step from the received lines
+ */
+inline void analyze(const std::vector<RxLine>& rx, int format, double duration_s, StepResult& r) {
+    std::vector<double> values;
+    std::vector<double> fw_us, host_us;
+    long expected_seq = 0;
+    double wrap = 0;              // micros() overflows every ~71 minutes
+    r.bytes = 0;
+    r.lines_ok = r.framing_errors = r.lines_lost = 0;
+
+    for (const auto& line : rx) {
+        r.bytes += line.text.size() + 2;
+        if (!parse_line(line.text, format, values)) {
+            ++r.framing_errors;
+            continue;
+        }
+        long seq = static_cast<long>(values[0]);
+        if (seq > expected_seq) {
+            r.lines_lost += seq - expected_seq;
+        }
+        expected_seq = std::max(expected_seq, seq + 1);
+        ++r.lines_ok;
+        if (!fw_us.empty() && values[1] + wrap + 2147483648.0 < fw_us.back()) {
+            wrap += 4294967296.0;
+        }
+        fw_us.push_back(values[1] + wrap);
+        host_us.push_back(line.host_us);
+    }
+    // Lines sent after the last one received
+    if (r.reported && r.sent > expected_seq) {
+        r.lines_lost += r.sent - expected_seq;
+    }
+
+    r.duration_s = duration_s;
+    r.throughput_bps = duration_s > 0 ? r.bytes / duration_s : 0;
+    r.lines_per_s = duration_s > 0 ? r.lines_ok / duration_s : 0;
+
+    if (fw_us.size() < 2) {
+        return;
+    }
+
+    // Offset host - firmware: minimum per half, linear in firmware time
+    size_t n = fw_us.size(), half = n / 2;
+    double off_a = 1e300, off_b = 1e300;
+    for (size_t i = 0; i < n; ++i) {
+        double d = host_us[i] - fw_us[i];
+        if (i < half) {
+            off_a = std::min(off_a, d);
+        } else {
+            off_b = std::min(off_b, d);
+        }
+    }
+    double t_a = fw_us[half / 2], t_b = fw_us[half + (n - half) / 2];
+    double slope = t_b > t_a ? (off_b - off_a) / (t_b - t_a) : 0.0;
+
+    std::vector<double> latency(n);
+    for (size_t i = 0; i < n; ++i) {
+        double offset = off_a + slope * (fw_us[i] - t_a);
+        latency[i] = std::max(0.0, host_us[i] - fw_us[i] - offset) / 1000.0;
+    }
+    r.latency_p50_ms = LinkSim::percentile(latency, 0.50);
+    r.latency_p95_ms = LinkSim::percentile(latency, 0.95);
+    r.latency_p99_ms = LinkSim::percentile(latency, 0.99);
+    r.latency_max_ms = *std::max_element(latency.begin(), latency.end());
+}
+
+/**
+ * Switch both ends to a new baud rate
+ */
+inline void set_baud(SerialPort::Port& port, long current, long baud) {
+    if (current == baud) {
+        return;
+    }
+#ifndef _WIN32
+    // Check the host side first (the device server uses the same table): once
+    // the board acknowledges B: it only listens at the new rate
+    SerialPort::to_speed(baud);
+#endif
+    port.write_line("B:" + std::to_string(baud));
+    std::string line;
+    auto until = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    bool acked = false;
+    while (!acked && std::chrono::steady_clock::now() < until) {
+        acked = port.read_line(line, 50) && line == "Baud:" + std::to_string(baud);
+    }
+    if (!acked) {
+        throw std::runtime_error("No acknowledgement for baud rate " + std::to_string(baud));
+    }
+    port.set_baud(baud);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    port.reset_input_buffer();
+}
+
+/**
+ * Run one step and measure it
+ */
+inline StepResult run_step(SerialPort::Port& port, long baud, const StepConfig& cfg) {
+    using clock = std::chrono::steady_clock;
+
+    StepResult r;
+    r.format = cfg.format;
+    r.baud = baud;
+    r.rate = cfg.rate;
+
+    port.reset_input_buffer();
+    port.write_line("X:" + std::to_string(cfg.format) + "," + std::to_string(cfg.rate) + "," +
+                    std::to_string(cfg.duration_ms));
+
+    std::string line;
+    auto until = clock::now() + std::chrono::seconds(2);
+    bool started = false;
+    while (!started && clock::now() < until) {
+        if (port.read_line(line, 50)) {
+            if (line.rfind("Error", 0) == 0) {
+                throw std::runtime_error("Firmware rejected step: " + line);
+            }
+            started = line.rfind("Start:", 0) == 0;
+        }
+    }
+    if (!started) {
+        throw std::runtime_error("Benchmark firmware not responding (is test_link.cpp uploaded?)");
+    }
+
+    // Read as fast as possible so host cadence doesn't add latency
+    std::vector<RxLine> rx;
+    rx.reserve(static_cast<size_t>(cfg.rate * cfg.duration_ms / 1000 + 16));
+    auto start = clock::now();
+    until = start + std::chrono::milliseconds(cfg.duration_ms + 3000);
+    while (clock::now() < until) {
+        if (!port.read_line(line, 2)) {
+            continue;
+        }
+        if (parse_summary(line, r)) {
+            break;
+        }
+        double t = std::chrono::duration<double, std::micro>(clock::now() - start).count();
+        rx.push_back({line, t});
+    }
+
+    analyze(rx, cfg.format, cfg.duration_ms / 1000.0, r);
+    return r;
+}
+
+/**
+ * Save all steps as data/link/link_bench_<timestamp>.csv
+ */
+inline fs::path save_results(const std::vector<StepResult>& results) {
+    fs::path data_dir = DataLoader::get_task_data_dir("link");
+    fs::create_directories(data_dir);
+    fs::path filename = data_dir / ("link_bench_" + FrictionId::make_timestamp() + ".csv");
+
+    std::ofstream out(filename);
+    if (!out.is_open()) {
+        throw std::runtime_error("Failed to open file: " + filename.string());
+    }
+    out << "Baud,Format,Rate,LinesPerSec,BytesPerSec,LinesOk,FramingErrors,LinesLost,"
+           "LatencyP50ms,LatencyP95ms,LatencyP99ms,LatencyMaxms,Sent,Ticks,DeadlineMisses,"
+           "MaxLateUs,MaxTickUs\n";
+    for (const auto& r : results) {
+        out << r.baud << "," << format_name(r.format) << "," << r.rate << ","
+            << r.lines_per_s << "," << r.throughput_bps << "," << r.lines_ok << ","
+            << r.framing_errors << "," << r.lines_lost << "," << r.latency_p50_ms << ","
+            << r.latency_p95_ms << "," << r.latency_p99_ms << "," << r.latency_max_ms << ","
+            << r.sent << "," << r.ticks << "," << r.misses << "," << r.max_late_us << ","
+            << r.max_tick_us << "\n";
+    }
+    return filename;
+}
+
+} // namespace LinkBench
+
+#endif // LINK_BENCH_HPP
@@ -0,0 +1,83 @@
+/**
+ * Serial Link Simulation using link_sim.hpp
+ *
+ * Predicts control-loop blocking, skipped ticks and lost samples for the
+ * telemetry formats of p2-1.cpp, p1-3.cpp and kp.cpp at each baud rate,
+ * so a format/rate change can be checked before flashing (NOT for Arduino).
+ *
+ * Compilation:
+ *   g++ -std=c++17 -O2 link_sim.cpp -o link_sim
+ *
+ * Usage:
+ *   ./link_sim                     (plotter cadence, 20 ms host reads)
+ *   ./link_sim --host-ms 1         (tune_kp.py / tune_kd.py busy-read loop)
+ *   ./link_sim --interval-ms 5     (override the sketch tick interval)
+ *   ./link_sim --duration 30
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include "link_sim.hpp"
+
+int main(int argc, char** argv) {
+    LinkSim::LinkConfig base;
+    long interval_override = 0;
+
+    for (int i = 1; i < argc; ++i) {
+        bool has_value = i + 1 < argc;
+        if (std::strcmp(argv[i], "--host-ms") == 0 && has_value) {
+            base.host_read_ms = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--interval-ms") == 0 && has_value) {
+            interval_override = std::atol(argv[++i]);
+        } else if (std::strcmp(argv[i], "--duration") == 0 && has_value) {
+            base.duration_s = std::atof(argv[++i]);
+        } else {
+            std::cerr << "Unknown option: " << argv[i] << std::endl;
+            return 1;
+        }
+    }
+
+    const long bauds[] = {9600, 57600, 115200, 230400, 250000, 500000, 1000000};
+    std::vector<LinkSim::TelemetryFormat> formats = {
+        LinkSim::format_p2_1(), LinkSim::format_p1_3(), LinkSim::format_kp()
+    };
+
+    std::cout << "========================================" << std::endl;
+    std::cout << "Serial Link Simulation" << std::endl;
+    std::cout << "========================================" << std::endl;
+    std::cout << "Host read every " << base.host_read_ms << " ms, "
+              << base.duration_s << " s per run" << std::endl;
+    std::cout << std::endl;
+
+    for (auto& fmt : formats) {
+        if (interval_override > 0) {
+            fmt.interval_ms = interval_override;
+        }
+
+        std::cout << "=== " << fmt.name << " (" << fmt.fields.size() << " fields every "
+                  << fmt.interval_ms << " ms) ===" << std::endl;
+        std::printf("%8s %6s %8s %9s %9s %9s %7s %6s %9s %9s\n",
+                    "baud", "bytes", "print_us", "block_us", "blk99_us", "tick_max",
+                    "missed", "uart%", "lost", "lat99_ms");
+
+        for (long baud : bauds) {
+            LinkSim::LinkConfig cfg = base;
+            cfg.baud = baud;
+            LinkSim::LinkResult r = LinkSim::simulate(fmt, cfg);
+
+            std::printf("%8ld %6.1f %8.0f %9.0f %9.0f %9.0f %7ld %6.1f %9ld %9.1f\n",
+                        r.baud, r.line_bytes, r.print_cpu_us, r.mean_block_us,
+                        r.p99_block_us, r.max_tick_us, r.ticks_missed,
+                        r.uart_utilization * 100.0, r.samples_dropped, r.p99_latency_ms);
+        }
+        std::cout << std::endl;
+    }
+
+    std::cout << "block_us: time loop() spends stalled in Serial.print() on a full TX buffer" << std::endl;
+    std::cout << "missed:   control ticks skipped because a tick overran its interval" << std::endl;
+    std::cout << "lost:     samples that never reached the host as a complete line" << std::endl;
+
+    return 0;
+}
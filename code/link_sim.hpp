@@ -0,0 +1,563 @@
+/**
+ * Serial Link Simulator - Header-Only C++ Version
+ *
+ * Discrete-event model of the telemetry path from the firmware control loop
+ * to the host tools:
+ *
+ *   loop() tick -> Serial.print() cost -> 64-byte TX ring -> UART shift register
+ *   -> USB-serial bridge (ATmega16U2) -> host OS buffer -> host read cadence
+ *
+ * It is driven by the real "Data:" line layouts of the sketches (p2-1.cpp,
+ * p1-3.cpp, kp.cpp) and predicts how long the control loop is blocked on a
+ * full TX buffer, how many control ticks are skipped because of it, and how
+ * many samples never reach the host, so telemetry formats and rates can be
+ * checked before flashing.
+ *
+ * IMPORTANT:
+ * - This is a HEADER-ONLY library for PC-side tools (DO NOT include in Arduino code)
+ * - The CPU cost constants are cycle estimates for an ATmega2560 @ 16 MHz
+ *   running the stock Arduino Print/HardwareSerial code; calibrate them against
+ *   hardware when absolute numbers matter
+ *
+ * Requirements:
+ * - C++17 or higher
+ *
+ * Usage:
+ *   #include "link_sim.hpp"
+ *
+ *   LinkSim::LinkConfig cfg;
+ *   cfg.baud = 115200;
+ *   auto result = LinkSim::simulate(LinkSim::format_p2_1(), cfg);
+ *   std::cout << result.mean_block_us << std::endl;
+ */
+
+#ifndef LINK_SIM_HPP
+#define LINK_SIM_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <deque>
+#include <queue>
+#include <string>
+#include <vector>
+
+namespace LinkSim {
+
+/**
+ * Kind of a printed field
+ */
+enum class FieldKind {
+    Time,    // currentTime / 1000.0 printed with `decimals` digits
+    Float,   // Serial.print(float, decimals)
+    Int      // Serial.print(int / long)
+};
+
+/**
+ * One comma-separated field of a "Data:" line
+ *
+ * `magnitude` is the typical absolute value printed (it sets the number of
+ * integer digits); `negative` marks fields that usually carry a sign.
+ */
+struct FieldSpec {
+    std::string name;
+    FieldKind kind;
+    int decimals;
+    double magnitude;
+    bool negative;
+};
+
+/**
+ * A telemetry line layout and the rate it is emitted at
+ */
+struct TelemetryFormat {
+    std::string name;
+    std::string prefix;             // e.g. "Data:"
+    std::vector<FieldSpec> fields;
+    long interval_ms;               // loop() tick interval of the sketch
+    double control_us;              // CPU time of the non-telemetry part of a tick
+};
+
+/**
+ * p2-1.cpp: Data:Time,Position,Reference,Error,ControlSignal,Ref+15%,Ref+2%,Ref-2%
+ */
+inline TelemetryFormat format_p2_1() {
+    return {
+        "p2-1", "Data:",
+        {
+            {"Time", FieldKind::Time, 3, 0.0, false},
+            {"Position", FieldKind::Float, 2, 200.0, false},
+            {"Reference", FieldKind::Float, 2, 200.0, false},
+            {"Error", FieldKind::Float, 2, 20.0, true},
+            {"ControlSignal", FieldKind::Float, 2, 200.0, true},
+            {"Ref+15%", FieldKind::Float, 2, 230.0, false},
+            {"Ref+2%", FieldKind::Float, 2, 204.0, false},
+            {"Ref-2%", FieldKind::Float, 2, 196.0, false},
+        },
+        10, 450.0
+    };
+}
+
+/**
+ * p1-2.cpp / p1-3.cpp: Data:Duty,Time,Velocity
+ */
+inline TelemetryFormat format_p1_3() {
+    return {
+        "p1-3", "Data:",
+        {
+            {"Duty", FieldKind::Int, 0, 200.0, false},
+            {"Time", FieldKind::Time, 3, 0.0, false},
+            {"Velocity", FieldKind::Float, 2, 1500.0, true},
+        },
+        50, 250.0
+    };
+}
+
+/**
+ * kp.cpp: Data:Time,Position,Reference
+ */
+inline TelemetryFormat format_kp() {
+    return {
+        "kp", "Data:",
+        {
+            {"Time", FieldKind::Time, 3, 0.0, false},
+            {"Position", FieldKind::Float, 2, 200.0, false},
+            {"Reference", FieldKind::Float, 2, 200.0, false},
+        },
+        10, 450.0
+    };
+}
+
+/**
+ * CPU cost of the Arduino Print path in cycles (ATmega2560 @ 16 MHz)
+ *
+ * Print::printFloat() does a float division per decimal for rounding, then one
+ * 32-bit division per printed integer digit and a float multiply/convert per
+ * decimal digit. Every byte costs a HardwareSerial::write() call plus one
+ * USART data-register-empty interrupt when it is shifted out.
+ */
+struct PrintCostModel {
+    double f_cpu_hz = 16e6;
+    double write_cycles = 70;        // HardwareSerial::write() with free space
+    double udre_isr_cycles = 60;     // TX interrupt per transmitted byte
+    double udiv32_cycles = 650;      // __udivmodsi4, one per integer digit
+    double fdiv_cycles = 480;
+    double fmul_cycles = 150;
+    double fadd_cycles = 110;
+    double ftoi_cycles = 80;
+    double float_checks_cycles = 300;  // isnan/isinf/overflow compares
+    double call_cycles = 40;           // per print() call
+
+    double us(double cycles) const { return cycles / f_cpu_hz * 1e6; }
+};
+
+/**
+ * Link and host parameters
+ */
+struct LinkConfig {
+    long baud = 115200;
+    int bits_per_byte = 10;            // 8N1
+    int tx_buffer_bytes = 64;          // SERIAL_TX_BUFFER_SIZE
+    double duration_s = 10.0;
+    double start_time_s = 2.0;         // millis() at first tick (after setup delay)
+
+    // USB-serial bridge (Arduino-usbserial on the 16U2)
+    int bridge_buffer_bytes = 128;
+    int usb_packet_bytes = 64;         // bulk endpoint size, flushes immediately when full
+    double bridge_flush_ms = 4.0;      // timer-driven flush of partial packets
+    double usb_latency_ms = 1.0;       // one USB frame
+
+    // Host side
+    int host_buffer_bytes = 4096;      // OS driver receive buffer
+    double host_read_ms = 20.0;        // plotter FuncAnimation interval
+
+    PrintCostModel cost;
+};
+
+/**
+ * Simulation result for one format/config pair
+ */
+struct LinkResult {
+    std::string format;
+    long baud = 0;
+    double line_bytes = 0;           // mean bytes per line (incl. "\r\n")
+    double print_cpu_us = 0;         // mean CPU time spent formatting/writing per line
+    double mean_block_us = 0;        // mean time per tick stalled on a full TX ring
+    double p99_block_us = 0;
+    double max_block_us = 0;
+    double max_tick_us = 0;          // longest control + print time of one tick
+    long ticks_expected = 0;         // ticks an ideal loop would run
+    long ticks_run = 0;
+    long ticks_missed = 0;           // skipped because a tick overran the interval
+    double uart_utilization = 0;     // fraction of UART bit time in use
+    long samples_delivered = 0;
+    long samples_dropped = 0;        // lost on a full bridge or host buffer
+    double mean_latency_ms = 0;      // tick start -> host read
+    double p99_latency_ms = 0;
+    double max_latency_ms = 0;
+};
+
+/**
+ * Number of integer digits printed for |value|
+ */
+inline int integer_digits(double value) {
+    unsigned long n = static_cast<unsigned long>(std::fabs(value));
+    int digits = 1;
+    while (n >= 10) {
+        n /= 10;
+        ++digits;
+    }
+    return digits;
+}
+
+/**
+ * One firmware step of a tick: spend `cycles`, then write one byte
+ */
+struct FirmwareOp {
+    double cycles;
+};
+
+/**
+ * Build the op sequence for one "Data:" line printed at `now_s`
+ */
+inline std::vector<FirmwareOp> build_line_ops(const TelemetryFormat& fmt, double now_s,
+                                              const PrintCostModel& cost) {
+    std::vector<FirmwareOp> ops;
+    const double per_byte = cost.write_cycles + cost.udre_isr_cycles;
+
+    auto emit_bytes = [&](int n, double extra_cycles) {
+        for (int i = 0; i < n; ++i) {
+            ops.push_back({per_byte + (i == 0 ? extra_cycles : 0.0)});
+        }
+    };
+
+    // Serial.print("Data:")
+    emit_bytes(static_cast<int>(fmt.prefix.size()), cost.call_cycles);
+
+    for (size_t f = 0; f < fmt.fields.size(); ++f) {
+        const FieldSpec& field = fmt.fields[f];
+
+        if (f > 0) {
+            emit_bytes(1, cost.call_cycles);  // Serial.print(",")
+        }
+
+        double value = field.kind == FieldKind::Time ? now_s : field.magnitude;
+        int int_digits = integer_digits(value);
+
+        if (field.kind == FieldKind::Int) {
+            int chars = int_digits + (field.negative ? 1 : 0);
+            double cycles = cost.call_cycles + int_digits * cost.udiv32_cycles;
+            emit_bytes(chars, cycles);
+            continue;
+        }
+
+        // Print::printFloat(): checks, rounding loop, integer part, decimals
+        int d = field.decimals;
+        double setup = cost.call_cycles + cost.float_checks_cycles +
+                       d * cost.fdiv_cycles + cost.fadd_cycles + cost.ftoi_cycles;
+        if (field.negative) {
+            emit_bytes(1, setup);
+            setup = 0;
+        }
+        emit_bytes(int_digits, setup + int_digits * cost.udiv32_cycles);
+        if (d > 0) {
+            emit_bytes(1, cost.fadd_cycles);  // '.'
+            for (int i = 0; i < d; ++i) {
+                double digit = cost.fmul_cycles + cost.ftoi_cycles + cost.fadd_cycles +
+                               cost.udiv32_cycles + cost.call_cycles;
+                emit_bytes(1, digit);
+            }
+        }
+    }
+
+    // println() terminator
+    emit_bytes(2, cost.call_cycles);
+    return ops;
+}
+
+inline double percentile(std::vector<double> values, double p) {
+    if (values.empty()) {
+        return 0.0;
+    }
+    std::sort(values.begin(), values.end());
+    size_t idx = static_cast<size_t>(p * (values.size() - 1) + 0.5);
+    return values[std::min(idx, values.size() - 1)];
+}
+
+/**
+ * Run the discrete-event simulation of one telemetry format over one link
+ */
+inline LinkResult simulate(const TelemetryFormat& fmt, const LinkConfig& cfg) {
+    enum EventType { TICK_DUE, FW_STEP, UART_DONE, BRIDGE_FLUSH, USB_ARRIVE, HOST_READ };
+
+    struct Event {
+        double t;
+        int type;
+        uint64_t seq;
+        long arg;
+        bool operator>(const Event& o) const {
+            return t != o.t ? t > o.t : seq > o.seq;
+        }
+    };
+
+    // A byte in flight, tagged with the sample (line) it belongs to
+    struct Byte {
+        long sample;
+        bool eol;
+    };
+
+    std::priority_queue<Event, std::vector<Event>, std::greater<Event>> queue;
+    uint64_t seq = 0;
+    auto schedule = [&](double t, int type, long arg = 0) {
+        queue.push({t, type, seq++, arg});
+    };
+
+    const double byte_time = static_cast<double>(cfg.bits_per_byte) / cfg.baud;
+    const double interval = fmt.interval_ms / 1000.0;
+    const double t_end = cfg.start_time_s + cfg.duration_s;
+
+    // Firmware state
+    std::vector<FirmwareOp> ops;
+    size_t op_index = 0;
+    long current_sample = -1;
+    double tick_start = 0;
+    double block_start = 0;
+    double tick_block = 0;
+    bool op_cost_paid = false;
+    bool waiting = false;
+    long prev_tick_ms = 0;
+    std::vector<double> tick_starts;
+    std::vector<double> block_per_tick;
+    double print_cycles_total = 0;
+    double bytes_total = 0;
+    double max_tick = 0;
+
+    // UART / bridge / host state
+    std::deque<Byte> tx_ring;
+    bool uart_busy = false;
+    Byte uart_byte{0, false};
+    double uart_busy_time = 0;
+    std::deque<Byte> bridge;
+    std::deque<Byte> host_buffer;
+    std::vector<std::vector<Byte>> usb_packets;
+    size_t usb_in_flight = 0;
+    std::vector<bool> sample_dropped;
+    std::vector<bool> sample_delivered;
+    std::vector<double> latencies;
+    long host_line_sample = -1;
+    bool host_line_corrupt = false;
+
+    auto start_uart = [&](double now) {
+        if (!uart_busy && !tx_ring.empty()) {
+            uart_byte = tx_ring.front();
+            tx_ring.pop_front();
+            uart_busy = true;
+            uart_busy_time += byte_time;
+            schedule(now + byte_time, UART_DONE);
+        }
+    };
+
+    auto flush_bridge = [&](double now) {
+        if (bridge.empty()) {
+            return;
+        }
+        size_t n = std::min(bridge.size(), static_cast<size_t>(cfg.usb_packet_bytes));
+        usb_packets.emplace_back(bridge.begin(), bridge.begin() + n);
+        bridge.erase(bridge.begin(), bridge.begin() + n);
+        ++usb_in_flight;
+        schedule(now + cfg.usb_latency_ms / 1000.0, USB_ARRIVE,
+                 static_cast<long>(usb_packets.size() - 1));
+    };
+
+    // Ticks stop at t_end; the periodic flush and host read keep running until
+    // the lines already printed have left the pipeline, so they are not lost
+    auto pipeline_busy = [&]() {
+        return op_index < ops.size() || !tx_ring.empty() || uart_busy || !bridge.empty() ||
+               usb_in_flight > 0 || !host_buffer.empty();
+    };
+
+    schedule(cfg.start_time_s, TICK_DUE);
+    schedule(cfg.start_time_s + cfg.bridge_flush_ms / 1000.0, BRIDGE_FLUSH);
+    schedule(cfg.start_time_s + cfg.host_read_ms / 1000.0, HOST_READ);
+
+    while (!queue.empty()) {
+        Event ev = queue.top();
+        queue.pop();
+        double now = ev.t;
+
+        switch (ev.type) {
+            case TICK_DUE: {
+                // millis() resolution: the sketch stores the integer ms of the tick
+                prev_tick_ms = static_cast<long>(std::floor(now * 1000.0));
+                tick_start = now;
+                tick_block = 0;
+                ++current_sample;
+                tick_starts.push_back(now);
+                sample_dropped.push_back(false);
+                sample_delivered.push_back(false);
+
+                ops = build_line_ops(fmt, prev_tick_ms / 1000.0, cfg.cost);
+                op_index = 0;
+                for (const auto& op : ops) {
+                    print_cycles_total += op.cycles;
+                }
+                bytes_total += ops.size();
+
+                schedule(now + fmt.control_us * 1e-6, FW_STEP);
+                break;
+            }
+
+            case FW_STEP: {
+                if (op_index < ops.size()) {
+                    // Spend the op's CPU time first, then try to write its byte
+                    if (!op_cost_paid) {
+                        op_cost_paid = true;
+                        schedule(now + cfg.cost.us(ops[op_index].cycles) * 1e-6, FW_STEP);
+                        break;
+                    }
+                    if (static_cast<int>(tx_ring.size()) >= cfg.tx_buffer_bytes) {
+                        // HardwareSerial::write() spins until the TX interrupt frees a slot
+                        if (!waiting) {
+                            waiting = true;
+                            block_start = now;
+                        }
+                        break;
+                    }
+                    if (waiting) {
+                        tick_block += now - block_start;
+                        waiting = false;
+                    }
+                    op_cost_paid = false;
+                    bool eol = op_index + 1 == ops.size();
+                    tx_ring.push_back({current_sample, eol});
+                    ++op_index;
+                    start_uart(now);
+                    schedule(now, FW_STEP);
+                    break;
+                }
+
+                // Tick finished: next tick starts at the first millis() poll past the interval
+                double tick_time = now - tick_start;
+                max_tick = std::max(max_tick, tick_time);
+                block_per_tick.push_back(tick_block);
+
+                long next_ms = prev_tick_ms + fmt.interval_ms;
+                long now_ms = static_cast<long>(std::floor(now * 1000.0));
+                double next = next_ms > now_ms ? next_ms / 1000.0 : now;
+                if (next < t_end) {
+                    schedule(next, TICK_DUE);
+                }
+                break;
+            }
+
+            case UART_DONE: {
+                uart_busy = false;
+                if (static_cast<int>(bridge.size()) < cfg.bridge_buffer_bytes) {
+                    bridge.push_back(uart_byte);
+                    if (static_cast<int>(bridge.size()) >= cfg.usb_packet_bytes) {
+                        flush_bridge(now);
+                    }
+                } else {
+                    sample_dropped[uart_byte.sample] = true;
+                }
+                start_uart(now);
+                if (waiting && static_cast<int>(tx_ring.size()) < cfg.tx_buffer_bytes) {
+                    schedule(now, FW_STEP);
+                }
+                break;
+            }
+
+            case BRIDGE_FLUSH: {
+                flush_bridge(now);
+                if (now < t_end || pipeline_busy()) {
+                    schedule(now + cfg.bridge_flush_ms / 1000.0, BRIDGE_FLUSH);
+                }
+                break;
+            }
+
+            case USB_ARRIVE: {
+                for (const Byte& b : usb_packets[ev.arg]) {
+                    if (static_cast<int>(host_buffer.size()) < cfg.host_buffer_bytes) {
+                        host_buffer.push_back(b);
+                    } else {
+                        sample_dropped[b.sample] = true;
+                    }
+                }
+                usb_packets[ev.arg].clear();
+                --usb_in_flight;
+                break;
+            }
+
+            case HOST_READ: {
+                // readline() loop: consume everything that is available
+                while (!host_buffer.empty()) {
+                    Byte b = host_buffer.front();
+                    host_buffer.pop_front();
+                    if (b.sample != host_line_sample) {
+                        host_line_sample = b.sample;
+                        host_line_corrupt = false;
+                    }
+                    if (sample_dropped[b.sample]) {
+                        host_line_corrupt = true;
+                    }
+                    if (b.eol && !host_line_corrupt) {
+                        sample_delivered[b.sample] = true;
+                        latencies.push_back((now - tick_starts[b.sample]) * 1000.0);
+                    }
+                }
+                if (now < t_end || pipeline_busy()) {
+                    schedule(now + cfg.host_read_ms / 1000.0, HOST_READ);
+                }
+                break;
+            }
+        }
+    }
+
+    LinkResult r;
+    r.format = fmt.name;
+    r.baud = cfg.baud;
+    r.ticks_run = static_cast<long>(tick_starts.size());
+    r.ticks_expected = static_cast<long>(std::floor(cfg.duration_s / interval));
+    r.ticks_missed = std::max(0L, r.ticks_expected - r.ticks_run);
+
+    if (r.ticks_run > 0) {
+        r.line_bytes = bytes_total / r.ticks_run;
+        r.print_cpu_us = cfg.cost.us(print_cycles_total) / r.ticks_run;
+    }
+
+    double block_sum = 0;
+    for (double b : block_per_tick) {
+        block_sum += b;
+        r.max_block_us = std::max(r.max_block_us, b * 1e6);
+    }
+    if (!block_per_tick.empty()) {
+        r.mean_block_us = block_sum / block_per_tick.size() * 1e6;
+    }
+    r.p99_block_us = percentile(block_per_tick, 0.99) * 1e6;
+    r.max_tick_us = max_tick * 1e6;
+    r.uart_utilization = std::min(1.0, uart_busy_time / cfg.duration_s);
+
+    for (size_t i = 0; i < sample_delivered.size(); ++i) {
+        if (sample_delivered[i]) {
+            ++r.samples_delivered;
+        } else {
+            ++r.samples_dropped;
+        }
+    }
+
+    if (!latencies.empty()) {
+        double sum = 0;
+        for (double l : latencies) {
+            sum += l;
+            r.max_latency_ms = std::max(r.max_latency_ms, l);
+        }
+        r.mean_latency_ms = sum / latencies.size();
+        r.p99_latency_ms = percentile(latencies, 0.99);
+    }
+
+    return r;
+}
+
+} // namespace LinkSim
+
+#endif // LINK_SIM_HPP
@@ -0,0 +1,111 @@
+/**
+ * LQR Design using lqr_design.hpp
+ *
+ * Computes the state-feedback gains and observer gains for the LQR mode of
+ * p2-1.cpp from the latest data/1-3/ summary (tau, K), checks the design in
+ * simulation and prints (or uploads) the serial commands (NOT for Arduino).
+ *
+ * Compilation:
+ *   g++ -std=c++17 -O2 lqr_design.cpp -o lqr_design
+ *
+ * Usage:
+ *   ./lqr_design
+ *   ./lqr_design --qe 1 --qw 0.001 --qz 30 --r 1.5e-5 --ref 200
+ *   ./lqr_design --upload            (sends T:/L:/O:/M:1 to $COM_MEGA2560)
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include "data_loader.hpp"
+#include "lqr_design.hpp"
+#include "serial_port.hpp"
+
+int main(int argc, char** argv) {
+    LqrDesign::Weights weights;
+    double reference = 200.0;
+    bool upload = false;
+
+    for (int i = 1; i < argc; ++i) {
+        auto next = [&]() { return i + 1 < argc ? std::atof(argv[++i]) : 0.0; };
+        if (std::strcmp(argv[i], "--qe") == 0) {
+            weights.q_e = next();
+        } else if (std::strcmp(argv[i], "--qw") == 0) {
+            weights.q_w = next();
+        } else if (std::strcmp(argv[i], "--qz") == 0) {
+            weights.q_z = next();
+        } else if (std::strcmp(argv[i], "--r") == 0) {
+            weights.r = next();
+        } else if (std::strcmp(argv[i], "--ref") == 0) {
+            reference = next();
+        } else if (std::strcmp(argv[i], "--upload") == 0) {
+            upload = true;
+        } else {
+            std::cerr << "Unknown option: " << argv[i] << std::endl;
+            return 1;
+        }
+    }
+
+    std::cout << "========================================" << std::endl;
+    std::cout << "LQR State-Feedback Design" << std::endl;
+    std::cout << "========================================" << std::endl;
+    std::cout << std::endl;
+
+    try {
+        auto [tau, K] = DataLoader::load_system_parameters("1-3");
+        LqrDesign::Plant plant{tau, K, 0.01};
+
+        auto gains = LqrDesign::solve_lqr(plant, weights);
+        auto observer = LqrDesign::solve_observer(plant, LqrDesign::NoiseModel{});
+        if (!gains.converged || !observer.converged) {
+            std::cerr << "Error: Riccati iteration did not converge" << std::endl;
+            return 1;
+        }
+
+        std::cout << "Weights: q_e=" << weights.q_e << ", q_w=" << weights.q_w
+                  << ", q_z=" << weights.q_z << ", r=" << weights.r << std::endl;
+        std::cout << "State feedback: k_e=" << gains.k_e << ", k_w=" << gains.k_w
+                  << ", k_z=" << gains.k_z << " (" << gains.iterations << " iterations)" << std::endl;
+        std::cout << "Observer: l_theta=" << observer.l_theta << ", l_omega=" << observer.l_omega << std::endl;
+        std::cout << std::endl;
+
+        auto sim = LqrDesign::simulate(plant, gains, observer, reference);
+        const auto& m = sim.metrics;
+        std::cout << "Simulated step to " << reference << " deg:" << std::endl;
+        std::cout << "  Overshoot: " << m.overshoot << " % (spec: < 15%)" << std::endl;
+        std::cout << "  Settling time: " << m.settling_time << " s (spec: <= 0.5s)" << std::endl;
+        std::cout << "  Rise time: " << m.rise_time << " s" << std::endl;
+        std::cout << "  Steady-state error: " << m.steady_state_error << " deg" << std::endl;
+        std::cout << std::endl;
+
+        auto commands = LqrDesign::upload_commands(plant, gains, observer);
+        std::cout << "Serial commands for p2-1.cpp:" << std::endl;
+        for (const auto& c : commands) {
+            std::cout << "  " << c << std::endl;
+        }
+
+        if (upload) {
+            SerialPort::Port port(SerialPort::default_port_name(), 115200);
+            port.wait_for_reset();
+            for (const auto& c : commands) {
+                port.write_line(c);
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            }
+            std::string line;
+            auto until = std::chrono::steady_clock::now() + std::chrono::milliseconds(500);
+            while (std::chrono::steady_clock::now() < until) {
+                if (port.read_line(line, 50) && line.rfind("Data:", 0) != 0) {
+                    std::cout << "  < " << line << std::endl;
+                }
+            }
+            std::cout << "Uploaded to " << port.name() << std::endl;
+        }
+
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,330 @@
+/**
+ * LQR State-Feedback Design - Header-Only C++ Version
+ *
+ * Designs the state-feedback controller and observer used by the LQR mode of
+ * p2-1.cpp from the identified first-order model (tau, K).
+ *
+ * Plant sampled at the firmware tick dt (zero-order hold, exact):
+ *   θ[k+1] = θ + a12 ω + b1 u
+ *   ω[k+1] = a22 ω + b2 u
+ *   a22 = e^(-dt/τ), a12 = τ(1 - a22), b2 = K(1 - a22), b1 = K(dt - a12)
+ *
+ * Controller state x = [e, ω, z] with e = θ - r and z[k+1] = z + dt e.
+ * The gain k = [k_e, k_ω, k_z] minimizes Σ xᵀQx + R u² (discrete Riccati
+ * equation solved by fixed-point iteration); the firmware applies u = -k x.
+ *
+ * Observer: steady-state Kalman gain L = [l_θ, l_ω] for the [θ, ω] model with
+ * encoder measurement y = θ, used in predictor-corrector form:
+ *   x⁻ = A x̂ + B u,   x̂ = x⁻ + L (y - θ⁻)
+ *
+ * IMPORTANT:
+ * - This is a HEADER-ONLY library for PC-side tools (DO NOT include in Arduino code)
+ *
+ * Requirements:
+ * - C++17 or higher
+ *
+ * Usage:
+ *   #include "lqr_design.hpp"
+ *
+ *   LqrDesign::Plant plant{tau, K, 0.01};
+ *   auto k = LqrDesign::solve_lqr(plant, LqrDesign::Weights{});
+ *   auto L = LqrDesign::solve_observer(plant, LqrDesign::NoiseModel{});
+ */
+
+#ifndef LQR_DESIGN_HPP
+#define LQR_DESIGN_HPP
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "motor_sim.hpp"
+#include "step_metrics.hpp"
+
+namespace LqrDesign {
+
+template <size_t R, size_t C>
+using Mat = std::array<std::array<double, C>, R>;
+
+template <size_t R, size_t K, size_t C>
+inline Mat<R, C> mul(const Mat<R, K>& a, const Mat<K, C>& b) {
+    Mat<R, C> out{};
+    for (size_t i = 0; i < R; ++i) {
+        for (size_t j = 0; j < C; ++j) {
+            double sum = 0.0;
+            for (size_t k = 0; k < K; ++k) {
+                sum += a[i][k] * b[k][j];
+            }
+            out[i][j] = sum;
+        }
+    }
+    return out;
+}
+
+template <size_t R, size_t C>
+inline Mat<C, R> transpose(const Mat<R, C>& a) {
+    Mat<C, R> out{};
+    for (size_t i = 0; i < R; ++i) {
+        for (size_t j = 0; j < C; ++j) {
+            out[j][i] = a[i][j];
+        }
+    }
+    return out;
+}
+
+template <size_t R, size_t C>
+inline Mat<R, C> add(const Mat<R, C>& a, const Mat<R, C>& b, double scale_b = 1.0) {
+    Mat<R, C> out{};
+    for (size_t i = 0; i < R; ++i) {
+        for (size_t j = 0; j < C; ++j) {
+            out[i][j] = a[i][j] + scale_b * b[i][j];
+        }
+    }
+    return out;
+}
+
+template <size_t R, size_t C>
+inline double max_abs_diff(const Mat<R, C>& a, const Mat<R, C>& b) {
+    double d = 0.0;
+    for (size_t i = 0; i < R; ++i) {
+        for (size_t j = 0; j < C; ++j) {
+            d = std::max(d, std::fabs(a[i][j] - b[i][j]));
+        }
+    }
+    return d;
+}
+
+/**
+ * First-order velocity plant sampled at the controller tick
+ */
+struct Plant {
+    double tau;
+    double K;
+    double dt = 0.01;   // p2-1.cpp interval (10 ms)
+};
+
+/**
+ * ZOH discretization of [θ, ω]
+ */
+struct Discrete {
+    double a12, a22, b1, b2;
+};
+
+inline Discrete discretize(const Plant& p) {
+    Discrete d;
+    d.a22 = std::exp(-p.dt / p.tau);
+    d.a12 = p.tau * (1.0 - d.a22);
+    d.b2 = p.K * (1.0 - d.a22);
+    d.b1 = p.K * (p.dt - d.a12);
+    return d;
+}
+
+/**
+ * LQR weights on [e (deg), ω (deg/s), z (deg·s)] and u (PWM)
+ *
+ * Defaults follow Bryson's rule (1 deg error ~ 30 deg/s ~ 0.18 deg·s ~ 255 PWM),
+ * checked in simulate() against the 2-1 specs with the 50 PWM deadzone.
+ */
+struct Weights {
+    double q_e = 1.0;
+    double q_w = 0.001;
+    double q_z = 30.0;
+    double r = 1.0 / (255.0 * 255.0);
+};
+
+struct Gains {
+    double k_e = 0.0;
+    double k_w = 0.0;
+    double k_z = 0.0;
+    int iterations = 0;
+    bool converged = false;
+};
+
+/**
+ * Solve the discrete algebraic Riccati equation for [e, ω, z]
+ */
+inline Gains solve_lqr(const Plant& plant, const Weights& w,
+                       int max_iterations = 100000, double tolerance = 1e-9) {
+    Discrete d = discretize(plant);
+
+    Mat<3, 3> A = {{{1.0, d.a12, 0.0},
+                    {0.0, d.a22, 0.0},
+                    {plant.dt, 0.0, 1.0}}};
+    Mat<3, 1> B = {{{d.b1}, {d.b2}, {0.0}}};
+    Mat<3, 3> Q = {{{w.q_e, 0.0, 0.0},
+                    {0.0, w.q_w, 0.0},
+                    {0.0, 0.0, w.q_z}}};
+
+    Mat<3, 3> P = Q;
+    Mat<1, 3> K{};
+    Gains g;
+
+    for (int it = 0; it < max_iterations; ++it) {
+        auto At = transpose(A);
+        auto Bt = transpose(B);
+        auto PA = mul(P, A);
+        auto PB = mul(P, B);
+        double s = w.r + mul(Bt, PB)[0][0];
+        auto BtPA = mul(Bt, PA);
+        for (size_t j = 0; j < 3; ++j) {
+            K[0][j] = BtPA[0][j] / s;
+        }
+
+        // P = Q + Aᵀ P A - Aᵀ P B K
+        auto next = add(Q, add(mul(At, PA), mul(mul(At, PB), K), -1.0));
+        double diff = max_abs_diff(next, P);
+        P = next;
+        g.iterations = it + 1;
+
+        double scale = 0.0;
+        for (const auto& row : P) {
+            for (double v : row) {
+                scale = std::max(scale, std::fabs(v));
+            }
+        }
+        if (diff <= tolerance * std::max(1.0, scale)) {
+            g.converged = true;
+            break;
+        }
+    }
+
+    g.k_e = K[0][0];
+    g.k_w = K[0][1];
+    g.k_z = K[0][2];
+    return g;
+}
+
+/**
+ * Noise model for the observer
+ *
+ * The encoder quantizes θ to 360/374 deg (σ = q/√12); process noise acts on
+ * the velocity (unmodeled load and friction).
+ */
+struct NoiseModel {
+    double measurement_std = (360.0 / 374.0) / std::sqrt(12.0);  // deg
+    double velocity_std = 20.0;                                    // deg/s per tick
+    double position_std = 0.05;                                    // deg per tick
+};
+
+struct ObserverGains {
+    double l_theta = 0.0;
+    double l_omega = 0.0;
+    bool converged = false;
+};
+
+/**
+ * Steady-state Kalman gain (filter form) for [θ, ω] with y = θ
+ */
+inline ObserverGains solve_observer(const Plant& plant, const NoiseModel& noise,
+                                    int max_iterations = 100000, double tolerance = 1e-10) {
+    Discrete d = discretize(plant);
+    Mat<2, 2> A = {{{1.0, d.a12}, {0.0, d.a22}}};
+    Mat<2, 2> Qn = {{{noise.position_std * noise.position_std, 0.0},
+                     {0.0, noise.velocity_std * noise.velocity_std}}};
+    double Rn = noise.measurement_std * noise.measurement_std;
+
+    // Prior covariance P⁻ iterated to steady state
+    Mat<2, 2> P = Qn;
+    ObserverGains L;
+    for (int it = 0; it < max_iterations; ++it) {
+        double s = P[0][0] + Rn;
+        double l0 = P[0][0] / s;
+        double l1 = P[1][0] / s;
+
+        // Posterior: (I - L C) P⁻
+        Mat<2, 2> post = {{{P[0][0] - l0 * P[0][0], P[0][1] - l0 * P[0][1]},
+                           {P[1][0] - l1 * P[0][0], P[1][1] - l1 * P[0][1]}}};
+        auto next = add(mul(mul(A, post), transpose(A)), Qn);
+
+        double diff = max_abs_diff(next, P);
+        P = next;
+        L.l_theta = l0;
+        L.l_omega = l1;
+        if (diff <= tolerance * std::max(1.0, P[1][1])) {
+            L.converged = true;
+            break;
+        }
+    }
+    return L;
+}
+
+/**
+ * Closed-loop response of the firmware LQR mode (for checking a design)
+ */
+struct SimResult {
+    std::vector<double> time;
+    std::vector<double> position;
+    std::vector<double> control;
+    StepMetrics::Metrics metrics;
+};
+
+/**
+ * Simulate the LQR mode of p2-1.cpp: plant integrated at 1 ms, controller and
+ * observer every dt on the quantized encoder angle, ±255 saturation, deadzone
+ * and conditional integration while saturated (as in the firmware).
+ */
+inline SimResult simulate(const Plant& plant, const Gains& k, const ObserverGains& L,
+                          double reference, double t_max = 2.0,
+                          const MotorSim::FrictionParams& friction = {},
+                          double deadzone = MotorSim::PWM_DEADZONE) {
+    const double sim_dt = 0.001;
+    const double deg_per_count = 360.0 / 374.0;
+    const int steps_per_tick = static_cast<int>(std::lround(plant.dt / sim_dt));
+    Discrete d = discretize(plant);
+
+    MotorSim::MotorModel motor(plant.tau, plant.K, sim_dt, friction);
+    double th_hat = 0.0, w_hat = 0.0, z = 0.0, u_applied = 0.0;
+    SimResult r;
+
+    int n_ticks = static_cast<int>(t_max / plant.dt);
+    for (int tick = 0; tick < n_ticks; ++tick) {
+        double y = std::floor(motor.get_position() / deg_per_count) * deg_per_count;
+
+        // Observer: predict with the applied PWM, correct with the encoder
+        double th_pred = th_hat + d.a12 * w_hat + d.b1 * u_applied;
+        double w_pred = d.a22 * w_hat + d.b2 * u_applied;
+        double innov = y - th_pred;
+        th_hat = th_pred + L.l_theta * innov;
+        w_hat = w_pred + L.l_omega * innov;
+
+        double e = th_hat - reference;
+        double u = -(k.k_e * e + k.k_w * w_hat + k.k_z * z);
+        bool saturated = std::fabs(u) >= MotorSim::PWM_MAX && (u > 0) == (e < 0);
+        if (!saturated) {
+            z += plant.dt * e;
+        }
+        u_applied = MotorSim::apply_pwm_limits(u, deadzone);
+
+        r.time.push_back(tick * plant.dt);
+        r.position.push_back(y);
+        r.control.push_back(u);
+
+        for (int s = 0; s < steps_per_tick; ++s) {
+            motor.update(u_applied);
+        }
+    }
+
+    r.metrics = StepMetrics::compute(r.time.data(), r.position.data(), r.time.size(), reference);
+    return r;
+}
+
+/**
+ * Serial commands that upload a design to p2-1.cpp and select the LQR mode
+ */
+inline std::vector<std::string> upload_commands(const Plant& plant, const Gains& k,
+                                                const ObserverGains& L) {
+    std::ostringstream t, g, o;
+    t.precision(6);
+    g.precision(6);
+    o.precision(6);
+    t << "T:" << plant.tau << "," << plant.K;
+    g << "L:" << k.k_e << "," << k.k_w << "," << k.k_z;
+    o << "O:" << L.l_theta << "," << L.l_omega;
+    return {t.str(), g.str(), o.str(), "M:1"};
+}
+
+} // namespace LqrDesign
+
+#endif // LQR_DESIGN_HPP
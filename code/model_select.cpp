@@ -0,0 +1,97 @@
+/**
+ * Plant Model Selection using plant_models.hpp
+ *
+ * Fits the first-order, dead-time, electrical-pole and friction models to the
+ * latest duty sweep of a task, ranks them by AIC, BIC and blocked
+ * cross-validation, and saves the selected model as
+ * data/<task>/model_<timestamp>.json for the simulator (NOT for Arduino).
+ *
+ * Compilation:
+ *   g++ -std=c++17 -O2 model_select.cpp -o model_select -pthread
+ *
+ * Usage:
+ *   ./model_select             (uses data/1-3/)
+ *   ./model_select 1-2 --folds 8
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include "plant_models.hpp"
+
+int main(int argc, char** argv) {
+    std::string task = "1-3";
+    PlantModels::Options opt;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--folds") == 0 && i + 1 < argc) {
+            opt.folds = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--evals") == 0 && i + 1 < argc) {
+            opt.max_evals = std::atoi(argv[++i]);
+        } else if (argv[i][0] != '-') {
+            task = argv[i];
+        } else {
+            std::cerr << "Unknown option: " << argv[i] << std::endl;
+            return 1;
+        }
+    }
+
+    std::cout << "========================================" << std::endl;
+    std::cout << "Plant Model Selection (task " << task << ")" << std::endl;
+    std::cout << "========================================" << std::endl;
+    std::cout << std::endl;
+
+    try {
+        fs::path source = DataLoader::find_latest_file(DataLoader::get_task_data_dir(task),
+                                                       "raw_data_");
+        auto data = DataLoader::load_latest_raw_data(task);
+
+        // First-order guess from the plotter summary, if there is one
+        double tau = 0.1, K = 10.0;
+        try {
+            std::tie(tau, K) = DataLoader::load_system_parameters(task, false);
+        } catch (const std::exception&) {
+            std::cout << "No summary_*.json found, starting from tau=0.1, K=10" << std::endl;
+        }
+
+        std::cout << "Fitting " << opt.folds << "-fold cross-validated models..." << std::endl;
+        auto fits = PlantModels::fit_all(data, tau, K, opt);
+        size_t chosen = PlantModels::select(fits, opt.tie_margin);
+
+        std::cout << std::endl;
+        std::cout << std::left << std::setw(10) << "model" << std::right
+                  << std::setw(4) << "k" << std::setw(12) << "RMS" << std::setw(12) << "CV RMS"
+                  << std::setw(12) << "AIC" << std::setw(12) << "BIC" << "  parameters" << std::endl;
+        std::cout << std::fixed;
+        for (size_t i = 0; i < fits.size(); ++i) {
+            const auto& r = fits[i];
+            const auto& p = r.params;
+            std::cout << std::left << std::setw(10) << PlantModels::model_name(p.type) << std::right
+                      << std::setw(4) << p.n_params() << std::setprecision(2)
+                      << std::setw(12) << r.rms << std::setw(12) << r.cv_rmse
+                      << std::setprecision(1) << std::setw(12) << r.aic << std::setw(12) << r.bic
+                      << std::setprecision(4) << "  τ=" << p.tau << " K=" << p.K;
+            if (p.type == PlantModels::ModelType::DeadTime) std::cout << " θ=" << p.dead_time;
+            if (p.type == PlantModels::ModelType::SecondOrder) std::cout << " τ_e=" << p.tau_e;
+            if (p.type == PlantModels::ModelType::Friction) {
+                std::cout << std::setprecision(1) << " c=" << p.coulomb_fwd << "/" << p.coulomb_rev;
+            }
+            std::cout << (i == chosen ? "  <- selected" : "") << std::endl;
+        }
+        std::cout << std::defaultfloat << std::endl;
+        std::cout << "(RMS in deg/s; lower AIC/BIC is better)" << std::endl;
+        std::cout << std::endl;
+
+        fs::path saved = PlantModels::save_model(task, fits[chosen], source.filename().string());
+        std::cout << "Saved: " << saved << std::endl;
+
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        std::cerr << std::endl;
+        std::cerr << "Please run: python run.py " << task << std::endl;
+        std::cerr << "Then press 'p' to save data" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,392 @@
+/**
+ * Motor C API - implementation of motor_capi.h
+ *
+ * Thin wrappers around the header-only libraries; every entry point catches
+ * exceptions and reports them through motor_last_error().
+ *
+ * Compilation (from code/):
+ *   g++ -std=c++17 -O2 -shared -fPIC motor_capi.cpp -o libmotor_capi.so -pthread
+ *
+ * The Python side is src/motor_native.py.
+ */
+
+#include "motor_capi.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include "data_loader.hpp"
+#include "motor_sim.hpp"
+#include "step_metrics.hpp"
+
+struct motor_table {
+    std::vector<double> data;
+    size_t rows = 0;
+    size_t cols = 0;
+    std::string header;
+    std::string path;
+};
+
+namespace {
+
+thread_local std::string last_error;
+
+std::mutex root_mutex;
+std::string project_root;  // empty = DataLoader::get_project_root()
+
+int fail(const std::string& message) {
+    last_error = message;
+    return -1;
+}
+
+fs::path task_dir(const std::string& task) {
+    std::lock_guard<std::mutex> lock(root_mutex);
+    if (project_root.empty()) {
+        return DataLoader::get_task_data_dir(task);
+    }
+    return fs::path(project_root) / "data" / task;
+}
+
+std::string read_file(const fs::path& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to open file: " + path.string());
+    }
+    std::ostringstream ss;
+    ss << file.rdbuf();
+    return ss.str();
+}
+
+const char* skip_spaces(const char* p, const char* end) {
+    while (p < end && (*p == ' ' || *p == '\t')) {
+        ++p;
+    }
+    return p;
+}
+
+/**
+ * Parse up to n comma-separated numbers from [p, end); returns how many were parsed
+ *
+ * Fields go through DataLoader::detail::parse_number, so this builds wherever
+ * the loaders do (strtod fallback without floating-point std::from_chars).
+ */
+size_t parse_fields(const char* p, const char* end, double* out, size_t n) {
+    size_t count = 0;
+    while (count < n) {
+        const char* comma = std::find(p, end, ',');
+        double value;
+        if (!DataLoader::detail::parse_number(DataLoader::detail::trim(std::string_view(p, comma - p)),
+                                              value)) {
+            break;
+        }
+        out[count++] = value;
+        if (comma == end) {
+            break;
+        }
+        p = comma + 1;
+    }
+    return count;
+}
+
+size_t sample_count(const motor_sim_config& c) {
+    if (c.sim_dt <= 0 || c.t_max <= 0) {
+        return 0;
+    }
+    // Same length as np.arange(0, t_max, dt)
+    return static_cast<size_t>(std::ceil(c.t_max / c.sim_dt));
+}
+
+MotorSim::FrictionParams friction_of(const motor_sim_config& c) {
+    MotorSim::FrictionParams f;
+    f.coulomb_fwd = c.friction[0];
+    f.coulomb_rev = c.friction[1];
+    f.stiction_fwd = c.friction[2];
+    f.stiction_rev = c.friction[3];
+    f.gain_fwd = c.friction[4];
+    f.gain_rev = c.friction[5];
+    return f;
+}
+
+/**
+ * One response, sample for sample like simulate_pid_response() in
+ * p2-1_pid_simulation.py: e[i] = r - θ[i-1], then the plant steps with u[i]
+ */
+void simulate_one(const motor_sim_config& c, const MotorSim::FrictionParams& friction,
+                  const double* gains, size_t n, int ratio,
+                  double* position, double* control) {
+    if (n == 0) {
+        return;
+    }
+    MotorSim::MotorModel motor(c.tau, c.K, c.sim_dt, friction);
+    MotorSim::PIDController pid(gains[0], gains[1], gains[2], c.sim_dt * ratio);
+
+    position[0] = 0.0;
+    control[0] = 0.0;
+    double u = 0.0;
+    for (size_t i = 1; i < n; ++i) {
+        if ((i - 1) % ratio == 0) {
+            u = pid.update(c.reference - position[i - 1]);
+        }
+        control[i] = u;
+        motor.update(c.firmware_limits ? MotorSim::apply_pwm_limits(u, c.deadzone) : u);
+        position[i] = motor.get_position();
+    }
+}
+
+void write_metrics(const StepMetrics::Metrics& m, double* out) {
+    out[MOTOR_METRIC_OVERSHOOT] = m.overshoot;
+    out[MOTOR_METRIC_SETTLING_TIME] = m.settling_time;
+    out[MOTOR_METRIC_RISE_TIME] = m.rise_time;
+    out[MOTOR_METRIC_STEADY_STATE_ERROR] = m.steady_state_error;
+    out[MOTOR_METRIC_PEAK] = m.peak;
+}
+
+} // namespace
+
+extern "C" {
+
+int motor_capi_version(void) {
+    return MOTOR_CAPI_VERSION;
+}
+
+const char* motor_last_error(void) {
+    return last_error.c_str();
+}
+
+int motor_set_project_root(const char* path) {
+    std::lock_guard<std::mutex> lock(root_mutex);
+    project_root = path ? path : "";
+    return 0;
+}
+
+size_t motor_sim_samples(const motor_sim_config* config) {
+    return config ? sample_count(*config) : 0;
+}
+
+int motor_simulate_pid_batch(const motor_sim_config* config, const double* gains, size_t n,
+                             double* position, double* control, double* metrics, int threads) {
+    if (!config || (!gains && n > 0)) {
+        return fail("motor_simulate_pid_batch: null argument");
+    }
+    const motor_sim_config c = *config;
+    if (c.tau <= 0 || c.sim_dt <= 0 || c.control_dt <= 0 || c.t_max <= 0) {
+        return fail("motor_simulate_pid_batch: tau, t_max, sim_dt and control_dt must be positive");
+    }
+
+    try {
+        const size_t samples = sample_count(c);
+        const int ratio = std::max(1, static_cast<int>(std::lround(c.control_dt / c.sim_dt)));
+        const auto friction = friction_of(c);
+
+        std::vector<double> t(samples);
+        for (size_t i = 0; i < samples; ++i) {
+            t[i] = i * c.sim_dt;
+        }
+
+        unsigned workers = threads > 0 ? static_cast<unsigned>(threads)
+                                       : std::max(1u, std::thread::hardware_concurrency());
+        workers = static_cast<unsigned>(std::min<size_t>(workers, std::max<size_t>(n, 1)));
+
+        std::atomic<size_t> next{0};
+        auto work = [&]() {
+            std::vector<double> pos_buf(samples), ctrl_buf(samples);
+            for (size_t k = next++; k < n; k = next++) {
+                double* pos = position ? position + k * samples : pos_buf.data();
+                double* ctrl = control ? control + k * samples : ctrl_buf.data();
+                simulate_one(c, friction, gains + 3 * k, samples, ratio, pos, ctrl);
+                if (metrics) {
+                    write_metrics(StepMetrics::compute(t.data(), pos, samples, c.reference),
+                                  metrics + k * MOTOR_METRIC_COUNT);
+                }
+            }
+        };
+
+        if (workers <= 1) {
+            work();
+        } else {
+            std::vector<std::thread> pool;
+            for (unsigned w = 0; w < workers; ++w) {
+                pool.emplace_back(work);
+            }
+            for (auto& th : pool) {
+                th.join();
+            }
+        }
+    } catch (const std::exception& e) {
+        return fail(e.what());
+    }
+    return 0;
+}
+
+int motor_step_metrics(const double* t, const double* y, size_t n,
+                       double reference, double band, double* metrics) {
+    return motor_step_metrics_batch(t, y, 1, n, reference, band, metrics);
+}
+
+int motor_step_metrics_batch(const double* t, const double* y, size_t rows, size_t n,
+                             double reference, double band, double* metrics) {
+    if (!t || !y || !metrics) {
+        return fail("motor_step_metrics: null argument");
+    }
+    for (size_t r = 0; r < rows; ++r) {
+        write_metrics(StepMetrics::compute(t, y + r * n, n, reference, band),
+                      metrics + r * MOTOR_METRIC_COUNT);
+    }
+    return 0;
+}
+
+long motor_parse_data_lines(const char* text, size_t length, size_t n_fields,
+                            double* out, size_t max_rows, size_t* consumed) {
+    if (!text || (!out && max_rows > 0) || n_fields == 0) {
+        fail("motor_parse_data_lines: invalid argument");
+        return -1;
+    }
+
+    const char* p = text;
+    const char* end = text + length;
+    size_t rows = 0;
+    while (p < end && rows < max_rows) {
+        const char* eol = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        if (!eol) {
+            break;  // Incomplete line: leave it for the next chunk
+        }
+        const char* line = skip_spaces(p, eol);
+        const char* line_end = eol;
+        while (line_end > line && (line_end[-1] == '\r' || line_end[-1] == ' ')) {
+            --line_end;
+        }
+        if (line_end - line > 5 && std::memcmp(line, "Data:", 5) == 0) {
+            double* row = out + rows * n_fields;
+            if (parse_fields(line + 5, line_end, row, n_fields) == n_fields) {
+                ++rows;
+            }
+        }
+        p = eol + 1;
+    }
+
+    if (consumed) {
+        *consumed = static_cast<size_t>(p - text);
+    }
+    return static_cast<long>(rows);
+}
+
+int motor_load_latest_summary(const char* task, motor_summary* out) {
+    if (!task || !out) {
+        return fail("motor_load_latest_summary: null argument");
+    }
+    try {
+        fs::path file = DataLoader::find_latest_file(task_dir(task), "summary_");
+        std::string json = read_file(file);
+
+        motor_summary s{};
+        s.tau_average = DataLoader::extract_json_number(json, "tau_average");
+        s.K_average = DataLoader::extract_json_number(json, "K_average");
+        s.tau_std = DataLoader::extract_json_number(json, "tau_std");
+        s.K_std = DataLoader::extract_json_number(json, "K_std");
+        s.data_points = static_cast<int>(DataLoader::extract_json_number(json, "data_points"));
+        std::string timestamp = DataLoader::extract_json_string(json, "timestamp");
+        std::string task_name = DataLoader::extract_json_string(json, "task");
+        std::strncpy(s.timestamp, timestamp.c_str(), sizeof(s.timestamp) - 1);
+        std::strncpy(s.task, task_name.c_str(), sizeof(s.task) - 1);
+        *out = s;
+    } catch (const std::exception& e) {
+        return fail(e.what());
+    }
+    return 0;
+}
+
+motor_table* motor_load_table(const char* path) {
+    if (!path) {
+        fail("motor_load_table: null path");
+        return nullptr;
+    }
+    try {
+        std::string text = read_file(path);
+        auto table = std::make_unique<motor_table>();
+        table->path = path;
+
+        const char* p = text.data();
+        const char* end = p + text.size();
+        const char* eol = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        const char* header_end = eol ? eol : end;
+        table->header.assign(p, header_end);
+        while (!table->header.empty() && table->header.back() == '\r') {
+            table->header.pop_back();
+        }
+        table->cols = table->header.empty()
+            ? 0 : std::count(table->header.begin(), table->header.end(), ',') + 1;
+        if (table->cols == 0) {
+            throw std::runtime_error("Empty CSV header: " + table->path);
+        }
+
+        // Rough reservation: the smallest plausible row is "0,0,0\n"
+        table->data.reserve(text.size() / (2 * table->cols) * table->cols);
+        std::vector<double> row(table->cols);
+        p = eol ? eol + 1 : end;
+        while (p < end) {
+            const char* line_end = static_cast<const char*>(std::memchr(p, '\n', end - p));
+            if (!line_end) {
+                line_end = end;
+            }
+            if (parse_fields(p, line_end, row.data(), table->cols) == table->cols) {
+                table->data.insert(table->data.end(), row.begin(), row.end());
+                ++table->rows;
+            }
+            p = line_end + 1;
+        }
+        table->data.shrink_to_fit();
+        return table.release();
+    } catch (const std::exception& e) {
+        fail(e.what());
+        return nullptr;
+    }
+}
+
+motor_table* motor_load_latest_table(const char* task, const char* prefix) {
+    if (!task || !prefix) {
+        fail("motor_load_latest_table: null argument");
+        return nullptr;
+    }
+    try {
+        fs::path file = DataLoader::find_latest_file(task_dir(task), prefix);
+        return motor_load_table(file.string().c_str());
+    } catch (const std::exception& e) {
+        fail(e.what());
+        return nullptr;
+    }
+}
+
+size_t motor_table_rows(const motor_table* table) {
+    return table ? table->rows : 0;
+}
+
+size_t motor_table_cols(const motor_table* table) {
+    return table ? table->cols : 0;
+}
+
+const double* motor_table_data(const motor_table* table) {
+    return table ? table->data.data() : nullptr;
+}
+
+const char* motor_table_header(const motor_table* table) {
+    return table ? table->header.c_str() : "";
+}
+
+const char* motor_table_path(const motor_table* table) {
+    return table ? table->path.c_str() : "";
+}
+
+void motor_table_free(motor_table* table) {
+    delete table;
+}
+
+} // extern "C"
@@ -0,0 +1,147 @@
+/**
+ * Motor C API - C ABI for the PC-side C++ engines
+ *
+ * Exposes the batched PID simulator (motor_sim.hpp), the step metric kernel
+ * (step_metrics.hpp), the "Data:" line parser and the data/ loaders
+ * (data_loader.hpp) through plain C functions, so the Python tools can call
+ * them with ctypes (see src/motor_native.py) without extra dependencies.
+ *
+ * Conventions:
+ * - All arrays are caller-allocated, contiguous, row-major doubles; numpy
+ *   arrays are passed by pointer without copying
+ * - Functions return 0 on success and -1 on error; motor_last_error() holds
+ *   the message (per thread). No C++ exception crosses the ABI
+ * - Loaded tables are owned by the library until motor_table_free(); their
+ *   data pointer can be wrapped by numpy without copying
+ *
+ * IMPORTANT:
+ * - For PC-side tools only (DO NOT include in Arduino code)
+ * - Bump MOTOR_CAPI_VERSION whenever a signature or struct layout changes
+ *
+ * Compilation (from code/):
+ *   g++ -std=c++17 -O2 -shared -fPIC motor_capi.cpp -o libmotor_capi.so -pthread
+ */
+
+#ifndef MOTOR_CAPI_H
+#define MOTOR_CAPI_H
+
+#include <stddef.h>
+
+#if defined(_WIN32)
+#define MOTOR_CAPI_EXPORT __declspec(dllexport)
+#else
+#define MOTOR_CAPI_EXPORT __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MOTOR_CAPI_VERSION 1
+
+/* Columns of a metrics row (same definitions as step_metrics.hpp) */
+#define MOTOR_METRIC_OVERSHOOT 0
+#define MOTOR_METRIC_SETTLING_TIME 1
+#define MOTOR_METRIC_RISE_TIME 2
+#define MOTOR_METRIC_STEADY_STATE_ERROR 3
+#define MOTOR_METRIC_PEAK 4
+#define MOTOR_METRIC_COUNT 5
+
+/**
+ * Closed-loop PID step simulation settings
+ *
+ * The plant is integrated every sim_dt; the controller runs every control_dt
+ * (rounded to a multiple of sim_dt) and holds its output in between.
+ * firmware_limits = 0 reproduces p2-1_pid_simulation.py (no deadzone or
+ * saturation), 1 applies the p2-1.cpp deadzone and ±255 saturation.
+ */
+typedef struct {
+    double tau;
+    double K;
+    double reference;
+    double t_max;
+    double sim_dt;
+    double control_dt;
+    double deadzone;
+    int firmware_limits;
+    /* coulomb_fwd, coulomb_rev, stiction_fwd, stiction_rev, gain_fwd, gain_rev (all 0 = none) */
+    double friction[6];
+} motor_sim_config;
+
+typedef struct {
+    double tau_average;
+    double K_average;
+    double tau_std;
+    double K_std;
+    int data_points;
+    char timestamp[32];
+    char task[16];
+} motor_summary;
+
+typedef struct motor_table motor_table;
+
+MOTOR_CAPI_EXPORT int motor_capi_version(void);
+MOTOR_CAPI_EXPORT const char* motor_last_error(void);
+
+/* Data root used by the loaders (the project root containing data/); NULL restores the default */
+MOTOR_CAPI_EXPORT int motor_set_project_root(const char* path);
+
+/* Number of samples per simulated response (t = 0, sim_dt, ... < t_max) */
+MOTOR_CAPI_EXPORT size_t motor_sim_samples(const motor_sim_config* config);
+
+/**
+ * Simulate n gain sets in parallel
+ *
+ * gains:    n x 3 (Kp, Ki, Kd)
+ * position: n x samples, or NULL
+ * control:  n x samples, or NULL (controller output before limits)
+ * metrics:  n x MOTOR_METRIC_COUNT, or NULL
+ * threads:  worker threads, 0 = hardware concurrency
+ */
+MOTOR_CAPI_EXPORT int motor_simulate_pid_batch(const motor_sim_config* config,
+                                               const double* gains, size_t n,
+                                               double* position, double* control,
+                                               double* metrics, int threads);
+
+/* Step metrics of one response y(t) of length n (band: 0.02 = 2%) */
+MOTOR_CAPI_EXPORT int motor_step_metrics(const double* t, const double* y, size_t n,
+                                         double reference, double band, double* metrics);
+
+/* Step metrics of rows responses (rows x n) sharing the time base t */
+MOTOR_CAPI_EXPORT int motor_step_metrics_batch(const double* t, const double* y,
+                                               size_t rows, size_t n,
+                                               double reference, double band, double* metrics);
+
+/**
+ * Parse "Data:v1,v2,..." lines from a serial capture
+ *
+ * Lines with another prefix or fewer than n_fields values are skipped.
+ * Parsing stops after max_rows rows or at the last complete line;
+ * *consumed receives the number of bytes used (keep the rest for the
+ * next chunk when streaming). Returns the number of rows written to
+ * out (max_rows x n_fields), or -1 on error.
+ */
+MOTOR_CAPI_EXPORT long motor_parse_data_lines(const char* text, size_t length, size_t n_fields,
+                                              double* out, size_t max_rows, size_t* consumed);
+
+MOTOR_CAPI_EXPORT int motor_load_latest_summary(const char* task, motor_summary* out);
+
+/**
+ * Load the latest data/<task>/<prefix>*.csv (e.g. "raw_data_", "pid_data_")
+ *
+ * Returns NULL on error. Rows with non-numeric fields are skipped.
+ */
+MOTOR_CAPI_EXPORT motor_table* motor_load_latest_table(const char* task, const char* prefix);
+MOTOR_CAPI_EXPORT motor_table* motor_load_table(const char* path);
+MOTOR_CAPI_EXPORT size_t motor_table_rows(const motor_table* table);
+MOTOR_CAPI_EXPORT size_t motor_table_cols(const motor_table* table);
+MOTOR_CAPI_EXPORT const double* motor_table_data(const motor_table* table);
+MOTOR_CAPI_EXPORT const char* motor_table_header(const motor_table* table);
+MOTOR_CAPI_EXPORT const char* motor_table_path(const motor_table* table);
+MOTOR_CAPI_EXPORT void motor_table_free(motor_table* table);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MOTOR_CAPI_H */
@@ -0,0 +1,236 @@
+/**
+ * Motor Simulator - Header-Only C++ Version
+ *
+ * Shared plant and controller models for PC-based simulations.
+ *
+ * Plant (velocity in deg/s, u in PWM counts):
+ *   τ dω/dt = K (u - u_f) - ω,   dθ/dt = ω
+ *
+ * where u_f is the friction term identified by friction_id.hpp
+ * (Coulomb offset per direction plus a stiction breakaway threshold).
+ * With all friction terms zero this is the pure first-order model K/(τs+1)
+ * used by p2-1_pid_design.m and p2-1_pid_simulation.py.
+ *
+ * Optionally the drive reaches the mechanics through a dead time and an
+ * electrical pole 1/(τ_e s + 1) (models selected by plant_models.hpp):
+ *   u → delay → 1/(τ_e s + 1) → friction → K/(τs+1)
+ *
+ * The PID controller mirrors p2-1.cpp (integral clamp, low-pass filtered
+ * derivative, deadzone and ±255 saturation) so gains tuned here transfer
+ * to the firmware.
+ *
+ * IMPORTANT:
+ * - This is a HEADER-ONLY library for PC-side tools (DO NOT include in Arduino code)
+ *
+ * Requirements:
+ * - C++17 or higher
+ *
+ * Usage:
+ *   #include "motor_sim.hpp"
+ *
+ *   MotorSim::MotorModel motor(tau, K, 0.001);
+ *   MotorSim::PIDController pid(Kp, Ki, Kd, 0.01);
+ */
+
+#ifndef MOTOR_SIM_HPP
+#define MOTOR_SIM_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace MotorSim {
+
+// Firmware constants (see p2-1.cpp)
+constexpr double PWM_MAX = 255.0;
+constexpr double PWM_DEADZONE = 50.0;
+constexpr double INTEGRAL_MAX = 100.0;
+constexpr double DERIVATIVE_ALPHA = 0.2;
+
+/**
+ * Friction terms per direction, in PWM counts
+ *
+ * - coulomb:  constant duty lost to friction while moving (u_ss = coulomb + ω / K)
+ * - stiction: duty needed to break away from standstill (>= coulomb)
+ * - gain:     viscous gain 1/b in (deg/s)/PWM above the Coulomb offset
+ *             (0 = use the model K)
+ *
+ * "fwd" is positive duty, "rev" is negative duty.
+ */
+struct FrictionParams {
+    double coulomb_fwd = 0.0;
+    double coulomb_rev = 0.0;
+    double stiction_fwd = 0.0;
+    double stiction_rev = 0.0;
+    double gain_fwd = 0.0;
+    double gain_rev = 0.0;
+
+    bool enabled() const {
+        return coulomb_fwd > 0 || coulomb_rev > 0 || stiction_fwd > 0 || stiction_rev > 0;
+    }
+};
+
+/**
+ * First-order velocity model with optional friction, dead time and electrical pole
+ */
+class MotorModel {
+public:
+    MotorModel(double tau, double K, double dt, const FrictionParams& friction = {})
+        : tau_(tau), K_(K), dt_(dt), friction_(friction), velocity_(0.0), position_(0.0) {}
+
+    /**
+     * Input dead time in seconds (0 = none); fractions of dt are interpolated
+     */
+    void set_dead_time(double seconds) {
+        double steps = std::max(0.0, seconds) / dt_;
+        delay_steps_ = static_cast<size_t>(steps);
+        delay_frac_ = steps - delay_steps_;
+        delay_.assign(seconds > 0 ? delay_steps_ + 2 : 0, 0.0);
+        delay_index_ = 0;
+    }
+
+    /**
+     * Electrical time constant τ_e in seconds (0 = none)
+     */
+    void set_electrical_pole(double tau_e) {
+        tau_e_ = std::max(0.0, tau_e);
+        // Exact discretization keeps the pole stable even for τ_e < dt
+        drive_alpha_ = tau_e_ > 0 ? 1.0 - std::exp(-dt_ / tau_e_) : 1.0;
+        drive_ = 0.0;
+    }
+
+    void update(double control) {
+        if (!delay_.empty()) {
+            size_t n = delay_.size();
+            delay_[delay_index_] = control;
+            double newer = delay_[(delay_index_ + n - delay_steps_) % n];
+            double older = delay_[(delay_index_ + n - delay_steps_ - 1) % n];
+            delay_index_ = (delay_index_ + 1) % n;
+            control = newer + delay_frac_ * (older - newer);
+        }
+        if (tau_e_ > 0) {
+            drive_ += (control - drive_) * drive_alpha_;
+            control = drive_;
+        }
+
+        double effective = control;
+
+        if (friction_.enabled()) {
+            if (std::fabs(velocity_) < STANDSTILL_VELOCITY) {
+                // Stuck until the drive exceeds the breakaway duty
+                double breakaway = control >= 0 ? friction_.stiction_fwd : friction_.stiction_rev;
+                if (std::fabs(control) <= breakaway) {
+                    velocity_ = 0.0;
+                    return;
+                }
+            }
+            double direction = velocity_ != 0.0 ? velocity_ : control;
+            if (direction > 0) {
+                effective = control - friction_.coulomb_fwd;
+            } else {
+                effective = control + friction_.coulomb_rev;
+            }
+        }
+
+        // Motor dynamics: dω/dt = (K*u - ω) / τ
+        double gain = K_;
+        if (friction_.enabled()) {
+            double g = effective >= 0 ? friction_.gain_fwd : friction_.gain_rev;
+            if (g > 0) {
+                gain = g;
+            }
+        }
+        double dv = (gain * effective - velocity_) / tau_;
+        double next = velocity_ + dv * dt_;
+
+        // Friction brings the motor to rest; it never reverses it within one step
+        if (friction_.enabled() && velocity_ != 0.0 && (next > 0) != (velocity_ > 0)) {
+            next = 0.0;
+        }
+
+        velocity_ = next;
+        position_ += velocity_ * dt_;
+    }
+
+    double get_position() const { return position_; }
+    double get_velocity() const { return velocity_; }
+    const FrictionParams& friction() const { return friction_; }
+
+    void reset() {
+        velocity_ = 0.0;
+        position_ = 0.0;
+        drive_ = 0.0;
+        std::fill(delay_.begin(), delay_.end(), 0.0);
+        delay_index_ = 0;
+    }
+
+private:
+    static constexpr double STANDSTILL_VELOCITY = 1e-3;  // deg/s
+
+    double tau_, K_, dt_;
+    FrictionParams friction_;
+    double velocity_, position_;
+    double tau_e_ = 0.0;
+    double drive_alpha_ = 1.0;
+    double drive_ = 0.0;              // Drive after the electrical pole
+    std::vector<double> delay_;       // Dead-time ring buffer
+    size_t delay_index_ = 0;
+    size_t delay_steps_ = 0;
+    double delay_frac_ = 0.0;
+};
+
+/**
+ * PID controller matching p2-1.cpp
+ */
+class PIDController {
+public:
+    PIDController(double Kp, double Ki, double Kd, double dt,
+                  double alpha = DERIVATIVE_ALPHA, double integral_max = INTEGRAL_MAX)
+        : Kp_(Kp), Ki_(Ki), Kd_(Kd), dt_(dt), alpha_(alpha), integral_max_(integral_max),
+          error_integral_(0.0), error_prev_(0.0), derivative_filtered_(0.0) {}
+
+    double update(double error) {
+        // Proportional
+        double P = Kp_ * error;
+
+        // Integral (with anti-windup)
+        error_integral_ += error * dt_;
+        error_integral_ = std::clamp(error_integral_, -integral_max_, integral_max_);
+        double I = Ki_ * error_integral_;
+
+        // Derivative (with low-pass filter)
+        double derivative_raw = (error - error_prev_) / dt_;
+        derivative_filtered_ = alpha_ * derivative_raw + (1 - alpha_) * derivative_filtered_;
+        double D = Kd_ * derivative_filtered_;
+
+        error_prev_ = error;
+
+        return P + I + D;
+    }
+
+    void reset() {
+        error_integral_ = 0.0;
+        error_prev_ = 0.0;
+        derivative_filtered_ = 0.0;
+    }
+
+private:
+    double Kp_, Ki_, Kd_, dt_, alpha_, integral_max_;
+    double error_integral_;
+    double error_prev_;
+    double derivative_filtered_;
+};
+
+/**
+ * Deadzone and saturation applied by the firmware before analogWrite()
+ */
+inline double apply_pwm_limits(double control, double deadzone = PWM_DEADZONE) {
+    if (std::fabs(control) <= deadzone) {
+        return 0.0;
+    }
+    return std::clamp(control, -PWM_MAX, PWM_MAX);
+}
+
+} // namespace MotorSim
+
+#endif // MOTOR_SIM_HPP
@@ -0,0 +1,204 @@
+/**
+ * Output Writer Benchmark using output_writer.hpp
+ *
+ * Simulates a long PID run, exports it as CSV with std::ofstream (per-row
+ * std::endl and '\n') and with OutputWriter::CsvWriter (row by row and
+ * column-parallel), checks that every number reads back exactly and
+ * compares the throughput. A summary JSON is written and read back with
+ * the DataLoader extractors. Files go to the system temp directory
+ * (NOT for Arduino).
+ *
+ * Compilation:
+ *   g++ -std=c++17 -O2 output_writer.cpp -o output_writer -pthread
+ *
+ * Usage:
+ *   ./output_writer
+ *   ./output_writer --rows 5000000 --threads 8
+ *   ./output_writer --precision 6 --keep
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include "motor_sim.hpp"
+#include "output_writer.hpp"
+
+namespace {
+
+struct Columns {
+    std::vector<double> time, position, error, control;
+};
+
+Columns simulate(size_t rows) {
+    const double dt = 0.001;
+    MotorSim::MotorModel motor(0.1, 12.0, dt);
+    MotorSim::PIDController pid(10.0, 5.0, 0.5, dt);
+    Columns c;
+    for (size_t i = 0; i < rows; ++i) {
+        // Square-wave reference so the values keep changing
+        double reference = (i / 2000) % 2 ? -200.0 : 200.0;
+        double position = motor.get_position();
+        double error = reference - position;
+        double control = MotorSim::apply_pwm_limits(pid.update(error));
+        motor.update(control);
+        c.time.push_back(i * dt);
+        c.position.push_back(position);
+        c.error.push_back(error);
+        c.control.push_back(control);
+    }
+    return c;
+}
+
+// Max relative difference between the file and the columns (0 = exact)
+double read_back(const fs::path& path, const Columns& c) {
+    std::ifstream in(path);
+    std::string line;
+    std::getline(in, line);   // header
+    const std::vector<double>* cols[] = {&c.time, &c.position, &c.error, &c.control};
+    double worst = 0.0;
+    size_t row = 0;
+    while (std::getline(in, line)) {
+        const char* p = line.c_str();
+        for (const auto* col : cols) {
+            char* end;
+            double v = std::strtod(p, &end);
+            double ref = (*col)[row];
+            double diff = std::fabs(v - ref) / std::max(1e-300, std::fabs(ref));
+            worst = std::max(worst, ref == v ? 0.0 : diff);
+            p = *end == ',' ? end + 1 : end;
+        }
+        ++row;
+    }
+    if (row != c.time.size()) {
+        throw std::runtime_error(path.filename().string() + ": read " + std::to_string(row) +
+                                 " of " + std::to_string(c.time.size()) + " rows");
+    }
+    return worst;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t rows = 2000000;
+    size_t threads = 0;
+    int precision = -1;
+    bool keep = false;
+
+    for (int i = 1; i < argc; ++i) {
+        bool has_value = i + 1 < argc;
+        if (std::strcmp(argv[i], "--rows") == 0 && has_value) {
+            rows = static_cast<size_t>(std::max(1, std::atoi(argv[++i])));
+        } else if (std::strcmp(argv[i], "--threads") == 0 && has_value) {
+            threads = static_cast<size_t>(std::max(1, std::atoi(argv[++i])));
+        } else if (std::strcmp(argv[i], "--precision") == 0 && has_value) {
+            precision = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--keep") == 0) {
+            keep = true;
+        } else {
+            std::cerr << "Unknown option: " << argv[i] << std::endl;
+            return 1;
+        }
+    }
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    std::cout << "========================================" << std::endl;
+    std::cout << "Output Writer Benchmark" << std::endl;
+    std::cout << "========================================" << std::endl;
+    std::cout << std::endl;
+
+    try {
+        fs::path dir = fs::temp_directory_path() / ("output_writer_" + FrictionId::make_timestamp());
+        fs::create_directories(dir);
+        std::cout << "Simulating " << rows << " rows..." << std::endl;
+        auto c = simulate(rows);
+        const std::vector<std::string> header = {"Time(s)", "Position(deg)", "Error(deg)", "Control(PWM)"};
+        std::cout << "Writing to " << dir.string() << std::endl << std::endl;
+
+        struct Method {
+            const char* name;
+            std::function<void(const fs::path&)> write;
+            bool exact;   // shortest round-trip text
+        };
+        std::vector<Method> methods = {
+            {"ofstream + std::endl", [&](const fs::path& p) {
+                 std::ofstream out(p);
+                 out << "Time(s),Position(deg),Error(deg),Control(PWM)" << std::endl;
+                 for (size_t i = 0; i < rows; ++i) {
+                     out << c.time[i] << "," << c.position[i] << "," << c.error[i] << ","
+                         << c.control[i] << std::endl;
+                 }
+             }, false},
+            {"ofstream + '\\n'", [&](const fs::path& p) {
+                 std::ofstream out(p);
+                 out << "Time(s),Position(deg),Error(deg),Control(PWM)\n";
+                 for (size_t i = 0; i < rows; ++i) {
+                     out << c.time[i] << "," << c.position[i] << "," << c.error[i] << ","
+                         << c.control[i] << "\n";
+                 }
+             }, false},
+            {"CsvWriter row()", [&](const fs::path& p) {
+                 OutputWriter::CsvWriter csv(p, header, precision);
+                 for (size_t i = 0; i < rows; ++i) {
+                     csv.row(c.time[i], c.position[i], c.error[i], c.control[i]);
+                 }
+                 csv.close();
+             }, precision < 0},
+            {"CsvWriter columns()", [&](const fs::path& p) {
+                 OutputWriter::CsvWriter csv(p, header, precision);
+                 csv.columns({&c.time, &c.position, &c.error, &c.control}, threads);
+                 csv.close();
+             }, precision < 0},
+        };
+
+        std::printf("%-22s %9s %10s %10s %12s\n", "Method", "Time(s)", "MB", "MB/s", "Max rel err");
+        for (size_t m = 0; m < methods.size(); ++m) {
+            fs::path path = dir / ("sim_" + std::to_string(m) + ".csv");
+            auto start = std::chrono::steady_clock::now();
+            methods[m].write(path);
+            double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            double mb = fs::file_size(path) / 1e6;
+            double err = read_back(path, c);
+            std::printf("%-22s %9.3f %10.1f %10.1f %12.3g%s\n", methods[m].name, elapsed, mb,
+                        elapsed > 0 ? mb / elapsed : 0.0, err,
+                        methods[m].exact && err != 0.0 ? "  NOT EXACT" : "");
+            if (methods[m].exact && err != 0.0) {
+                throw std::runtime_error(std::string(methods[m].name) + " lost precision");
+            }
+        }
+        std::printf("(columns() on %zu threads)\n", threads);
+        std::cout << std::endl;
+
+        // Summary round trip through the loader's extractors
+        DataLoader::SummaryMetadata summary{0.1234567890123, 12.5, 1e-05, 0.25, 1234, "", "1-3"};
+        OutputWriter::JsonObject json;
+        json.field("timestamp", FrictionId::make_timestamp()).field("task", summary.task);
+        json.field("tau_average", summary.tau_average).field("K_average", summary.K_average);
+        json.field("data_points", summary.data_points);
+        json.field("tau_std", summary.tau_std).field("K_std", summary.K_std);
+        fs::path summary_path = dir / "summary.json";
+        json.save(summary_path);
+        std::ifstream in(summary_path);
+        std::string text((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        bool ok = DataLoader::extract_json_number(text, "tau_average") == summary.tau_average &&
+                  DataLoader::extract_json_number(text, "K_average") == summary.K_average &&
+                  DataLoader::extract_json_number(text, "tau_std") == summary.tau_std &&
+                  DataLoader::extract_json_number(text, "data_points") == summary.data_points &&
+                  DataLoader::extract_json_string(text, "task") == summary.task;
+        std::cout << "Summary JSON:" << std::endl << text << std::endl;
+        std::cout << "Read back by DataLoader: " << (ok ? "ok" : "MISMATCH") << std::endl;
+
+        if (!keep) {
+            fs::remove_all(dir);
+        }
+        return ok ? 0 : 2;
+
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+}
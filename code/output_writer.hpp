@@ -0,0 +1,472 @@
+/**
+ * Buffered CSV and JSON Output - Header-Only C++ Version
+ *
+ * Writers for simulation exports and summary files that keep formatting
+ * off the critical path:
+ *
+ * - numbers are formatted with std::to_chars straight into a block buffer
+ *   (no locale, no stream state, no flush per row)
+ * - the buffer goes to disk in large blocks (1 MiB by default)
+ * - CsvWriter::columns() formats row ranges on several threads and writes
+ *   them in order, so a bulk export is limited by the disk
+ * - JsonObject reproduces Python's json.dump(..., indent=2) layout, and
+ *   save_summary() writes data/<task>/summary_<timestamp>.json exactly as
+ *   plotter.py does, readable by DataLoader::load_latest_summary()
+ *
+ * CSV numbers are the shortest text that parses back to the same double
+ * (or `precision` significant digits); NaN is written as "nan".
+ *
+ * IMPORTANT:
+ * - This is a HEADER-ONLY library for PC-side tools (DO NOT include in Arduino code)
+ *
+ * Requirements:
+ * - C++17 or higher with floating-point std::to_chars (GCC 11+, MSVC 19.24+)
+ * - -pthread when columns() runs on more than one thread
+ *
+ * Usage:
+ *   #include "output_writer.hpp"
+ *
+ *   OutputWriter::CsvWriter csv("out.csv", {"Time(s)", "Position(deg)"});
+ *   csv.row(t, position);
+ *   csv.columns({&time, &position}, 4);
+ *
+ *   DataLoader::SummaryMetadata summary{tau, K, tau_std, K_std, points, "", "1-3"};
+ *   auto path = OutputWriter::save_summary("1-3", summary);
+ */
+
+#ifndef OUTPUT_WRITER_HPP
+#define OUTPUT_WRITER_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include "data_loader.hpp"
+#include "friction_id.hpp"
+
+namespace OutputWriter {
+
+constexpr size_t DEFAULT_BLOCK = 1 << 20;   // bytes per write
+constexpr size_t MAX_NUMBER = 32;           // longest formatted double
+
+/**
+ * Shortest round-trip text (precision < 0) or `precision` significant digits
+ */
+inline char* format_number(char* first, char* last, double value, int precision = -1) {
+    if (std::isnan(value)) {
+        std::memcpy(first, "nan", 3);
+        return first + 3;
+    }
+    auto result = precision < 0
+                      ? std::to_chars(first, last, value)
+                      : std::to_chars(first, last, value, std::chars_format::general, precision);
+    return result.ptr;
+}
+
+inline char* format_number(char* first, char* last, long long value) {
+    return std::to_chars(first, last, value).ptr;
+}
+
+/**
+ * A double as Python's repr() writes it: shortest digits, fixed notation
+ * for 1e-4 <= |x| < 1e16 with at least one decimal, else d.ddde±XX;
+ * NaN and infinities as json.dump writes them
+ */
+inline std::string python_float(double value) {
+    if (std::isnan(value)) {
+        return "NaN";
+    }
+    if (std::isinf(value)) {
+        return value > 0 ? "Infinity" : "-Infinity";
+    }
+    char sci[MAX_NUMBER];
+    char* end = std::to_chars(sci, sci + sizeof(sci), value, std::chars_format::scientific).ptr;
+    std::string_view text(sci, end - sci);
+
+    // Split "-d.ddde-XX" into sign, digits and exponent
+    size_t e = text.find('e');
+    int exponent = std::atoi(std::string(text.substr(e + 1)).c_str());
+    std::string digits;
+    bool negative = text[0] == '-';
+    for (char c : text.substr(0, e)) {
+        if (c >= '0' && c <= '9') {
+            digits += c;
+        }
+    }
+
+    std::string out = negative ? "-" : "";
+    if (exponent < -4 || exponent >= 16) {
+        out += digits[0];
+        if (digits.size() > 1) {
+            out += '.';
+            out += digits.substr(1);
+        }
+        char exp[16];
+        std::snprintf(exp, sizeof(exp), "e%c%02d", exponent < 0 ? '-' : '+', std::abs(exponent));
+        return out + exp;
+    }
+    if (exponent < 0) {
+        return out + "0." + std::string(-exponent - 1, '0') + digits;
+    }
+    size_t int_digits = static_cast<size_t>(exponent) + 1;
+    if (digits.size() <= int_digits) {
+        return out + digits + std::string(int_digits - digits.size(), '0') + ".0";
+    }
+    return out + digits.substr(0, int_digits) + "." + digits.substr(int_digits);
+}
+
+/**
+ * JSON string literal with the escapes json.dump uses (ensure_ascii off)
+ */
+inline std::string json_string(std::string_view text) {
+    std::string out = "\"";
+    for (char c : text) {
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char esc[8];
+                    std::snprintf(esc, sizeof(esc), "\\u%04x", c);
+                    out += esc;
+                } else {
+                    out += c;
+                }
+        }
+    }
+    return out + "\"";
+}
+
+/**
+ * CSV file written through a block buffer
+ *
+ * Rows are built with field()/end_row() or row(...). The destructor
+ * writes what is left; call close() to see write errors as exceptions.
+ */
+class CsvWriter {
+public:
+    CsvWriter(const fs::path& path, const std::vector<std::string>& header = {}, int precision = -1,
+              size_t block_size = DEFAULT_BLOCK)
+        : path_(path), precision_(precision), block_(std::max<size_t>(block_size, 4 * MAX_NUMBER)) {
+        out_.open(path, std::ios::binary);
+        if (!out_.is_open()) {
+            throw std::runtime_error("Failed to open file: " + path.string());
+        }
+        buffer_.resize(block_);
+        if (!header.empty()) {
+            for (const auto& name : header) {
+                field(std::string_view(name));
+            }
+            end_row();
+            rows_ = 0;
+        }
+    }
+
+    ~CsvWriter() {
+        try {
+            close();
+        } catch (const std::exception&) {
+        }
+    }
+
+    CsvWriter(const CsvWriter&) = delete;
+    CsvWriter& operator=(const CsvWriter&) = delete;
+
+    /**
+     * "# text" line (comments are skipped by the loaders)
+     */
+    void comment(std::string_view text) {
+        append("# ");
+        append(text);
+        append("\n");
+    }
+
+    void field(double value) {
+        separate();
+        reserve(MAX_NUMBER);
+        used_ = format_number(buffer_.data() + used_, buffer_.data() + buffer_.size(), value, precision_) -
+                buffer_.data();
+    }
+
+    void field(float value) { field(static_cast<double>(value)); }
+
+    template <typename T, typename = std::enable_if_t<std::is_integral_v<T>>>
+    void field(T value) {
+        separate();
+        reserve(MAX_NUMBER);
+        used_ = format_number(buffer_.data() + used_, buffer_.data() + buffer_.size(),
+                              static_cast<long long>(value)) -
+                buffer_.data();
+    }
+
+    void field(std::string_view text) {
+        separate();
+        append(text);
+    }
+
+    void field(const char* text) { field(std::string_view(text)); }
+    void field(const std::string& text) { field(std::string_view(text)); }
+
+    void end_row() {
+        append("\n");
+        first_field_ = true;
+        ++rows_;
+    }
+
+    template <typename... T>
+    void row(const T&... values) {
+        (field(values), ...);
+        end_row();
+    }
+
+    /**
+     * Rows i = 0..n-1 of equally long columns, formatted on `threads`
+     * workers (0 = all cores) in chunks and written in order
+     */
+    void columns(const std::vector<const std::vector<double>*>& cols, size_t threads = 1,
+                 size_t chunk_rows = 1 << 15) {
+        if (cols.empty()) {
+            return;
+        }
+        size_t n = cols[0]->size();
+        for (const auto* c : cols) {
+            if (c->size() != n) {
+                throw std::runtime_error("CSV columns differ in length");
+            }
+        }
+        if (threads == 0) {
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        }
+        if (threads == 1 || n <= chunk_rows) {
+            for (size_t i = 0; i < n; ++i) {
+                for (const auto* c : cols) {
+                    field((*c)[i]);
+                }
+                end_row();
+            }
+            return;
+        }
+
+        // One round = threads × chunk_rows rows, so memory stays bounded
+        std::vector<std::string> chunks(threads);
+        for (size_t round = 0; round < n; round += threads * chunk_rows) {
+            std::atomic<size_t> next{0};
+            auto worker = [&]() {
+                for (size_t k = next++; k < threads; k = next++) {
+                    size_t begin = round + k * chunk_rows;
+                    size_t end = std::min(n, begin + chunk_rows);
+                    format_rows(cols, begin, end, chunks[k]);
+                }
+            };
+            std::vector<std::thread> pool;
+            for (size_t i = 1; i < threads; ++i) {
+                pool.emplace_back(worker);
+            }
+            worker();
+            for (auto& th : pool) {
+                th.join();
+            }
+            for (auto& chunk : chunks) {
+                write_block(chunk.data(), chunk.size());
+                rows_ += std::count(chunk.begin(), chunk.end(), '\n');
+                chunk.clear();
+            }
+        }
+    }
+
+    void flush() {
+        drain();
+        out_.flush();
+        if (!out_) {
+            throw std::runtime_error("Failed to write file: " + path_.string());
+        }
+    }
+
+    void close() {
+        if (out_.is_open()) {
+            flush();
+            out_.close();
+        }
+    }
+
+    const fs::path& path() const { return path_; }
+    size_t rows() const { return rows_; }
+    size_t bytes() const { return written_ + used_; }
+
+private:
+    void format_rows(const std::vector<const std::vector<double>*>& cols, size_t begin, size_t end,
+                     std::string& text) const {
+        text.resize((end - begin) * cols.size() * (MAX_NUMBER + 1));
+        char* p = text.data();
+        char* last = text.data() + text.size();
+        for (size_t i = begin; i < end; ++i) {
+            for (size_t c = 0; c < cols.size(); ++c) {
+                if (c > 0) {
+                    *p++ = ',';
+                }
+                p = format_number(p, last, (*cols[c])[i], precision_);
+            }
+            *p++ = '\n';
+        }
+        text.resize(p - text.data());
+    }
+
+    void separate() {
+        if (!first_field_) {
+            append(",");
+        }
+        first_field_ = false;
+    }
+
+    void append(std::string_view text) {
+        if (text.size() > block_) {
+            drain();
+            write_block(text.data(), text.size());
+            return;
+        }
+        reserve(text.size());
+        std::memcpy(buffer_.data() + used_, text.data(), text.size());
+        used_ += text.size();
+    }
+
+    void reserve(size_t n) {
+        if (used_ + n > buffer_.size()) {
+            drain();
+        }
+    }
+
+    void drain() {
+        write_block(buffer_.data(), used_);
+        used_ = 0;
+    }
+
+    void write_block(const char* data, size_t n) {
+        if (n == 0) {
+            return;
+        }
+        if (used_ > 0 && data != buffer_.data()) {
+            drain();
+        }
+        out_.write(data, static_cast<std::streamsize>(n));
+        if (!out_) {
+            throw std::runtime_error("Failed to write file: " + path_.string());
+        }
+        written_ += n;
+    }
+
+    fs::path path_;
+    std::ofstream out_;
+    int precision_;
+    size_t block_;
+    std::vector<char> buffer_;
+    size_t used_ = 0;
+    size_t written_ = 0;
+    size_t rows_ = 0;
+    bool first_field_ = true;
+};
+
+/**
+ * Flat JSON object in json.dump(indent=2) layout, keys in insertion order
+ */
+class JsonObject {
+public:
+    JsonObject& field(std::string_view key, double value) { return raw(key, python_float(value)); }
+
+    template <typename T, typename = std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, bool>>>
+    JsonObject& field(std::string_view key, T value) {
+        return raw(key, std::to_string(value));
+    }
+
+    JsonObject& field(std::string_view key, bool value) { return raw(key, value ? "true" : "false"); }
+    JsonObject& field(std::string_view key, std::string_view text) { return raw(key, json_string(text)); }
+    JsonObject& field(std::string_view key, const char* text) { return field(key, std::string_view(text)); }
+    JsonObject& field(std::string_view key, const std::string& text) { return field(key, std::string_view(text)); }
+    JsonObject& null(std::string_view key) { return raw(key, "null"); }
+
+    JsonObject& field(std::string_view key, const std::vector<double>& values) {
+        if (values.empty()) {
+            return raw(key, "[]");
+        }
+        std::string text = "[";
+        for (size_t i = 0; i < values.size(); ++i) {
+            text += (i ? ",\n    " : "\n    ") + python_float(values[i]);
+        }
+        return raw(key, text + "\n  ]");
+    }
+
+    std::string str() const { return text_.empty() ? "{}" : "{" + text_ + "\n}"; }
+
+    void save(const fs::path& path) const {
+        std::ofstream out(path, std::ios::binary);
+        if (!out.is_open()) {
+            throw std::runtime_error("Failed to open file: " + path.string());
+        }
+        std::string text = str();
+        out.write(text.data(), static_cast<std::streamsize>(text.size()));
+        if (!out) {
+            throw std::runtime_error("Failed to write file: " + path.string());
+        }
+    }
+
+private:
+    JsonObject& raw(std::string_view key, const std::string& value) {
+        text_ += text_.empty() ? "\n  " : ",\n  ";
+        text_ += json_string(key);
+        text_ += ": ";
+        text_ += value;
+        return *this;
+    }
+
+    std::string text_;
+};
+
+/**
+ * Write data/<task>/summary_<timestamp>.json with plotter.py's keys and
+ * layout; NaN averages are written as null like Python's None
+ */
+inline fs::path save_summary(const std::string& task_name, DataLoader::SummaryMetadata summary) {
+    fs::path data_dir = DataLoader::get_task_data_dir(task_name);
+    fs::create_directories(data_dir);
+    if (summary.timestamp.empty()) {
+        summary.timestamp = FrictionId::make_timestamp();
+    }
+    if (summary.task.empty()) {
+        summary.task = task_name;
+    }
+
+    auto number = [](JsonObject& json, const char* key, double value) {
+        if (std::isnan(value)) {
+            json.null(key);
+        } else {
+            json.field(key, value);
+        }
+    };
+    JsonObject json;
+    json.field("timestamp", summary.timestamp).field("task", summary.task);
+    number(json, "tau_average", summary.tau_average);
+    number(json, "K_average", summary.K_average);
+    json.field("data_points", summary.data_points);
+    if (!std::isnan(summary.tau_average)) {
+        json.field("tau_std", summary.tau_std);
+    }
+    if (!std::isnan(summary.K_average)) {
+        json.field("K_std", summary.K_std);
+    }
+
+    fs::path filename = data_dir / ("summary_" + summary.timestamp + ".json");
+    json.save(filename);
+    return filename;
+}
+
+} // namespace OutputWriter
+
+#endif // OUTPUT_WRITER_HPP
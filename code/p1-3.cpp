@@ -4,6 +4,7 @@
 // Based on P#1-2 code with added K calculation at steady state
 
 #include <Arduino.h>
+#include <EEPROM.h>
 #include <Encoder.h>
 
 // Pin definitions
@@ -11,6 +12,11 @@ const int ENA_PIN = 6;
 const int IN1_PIN = 7;
 const int IN2_PIN = 8;
 
+// Device id stored by p2-1.cpp (U:<id>); plotter.py files the measured
+// tau/K under it in data/devices/
+const int DEVICE_ID_ADDR = 0;
+const uint16_t DEVICE_ID_MAGIC = 0x4944;   // "ID"
+
 // Encoder setup
 Encoder myEncoder(20, 21);
 const float PPR = 374.0;
@@ -19,6 +25,14 @@ const float PPR = 374.0;
 const int D_VALUES[] = {150, 175, 200, 225, 250};
 const int NUM_D_VALUES = 5;
 
+// Friction sweep for code/friction_id.cpp: adds duties near the deadzone and
+// the opposite direction (reported as negative duty). K is only computed for
+// positive duties, so the 1-3 summary is unaffected.
+const bool FRICTION_SWEEP = false;
+const int FRICTION_D_VALUES[] = {60, 80, 100, 125, 150, 175, 200, 225, 250,
+                                 -60, -80, -100, -125, -150, -175, -200, -225, -250};
+const int NUM_FRICTION_D_VALUES = 18;
+
 // Timing variables
 unsigned long prevTime = 0;
 unsigned long stateStartTime = 0;
@@ -75,6 +89,19 @@ void setup() {
   // Send task identifier
   Serial.println("TASK:1-3");
 
+  uint16_t magic = 0;
+  unsigned long deviceId = 0;
+  EEPROM.get(DEVICE_ID_ADDR, magic);
+  if (magic == DEVICE_ID_MAGIC) {
+    EEPROM.get(DEVICE_ID_ADDR + sizeof(DEVICE_ID_MAGIC), deviceId);
+  }
+  Serial.print("DEVICE:");
+  if (deviceId > 0) {
+    Serial.println(deviceId);
+  } else {
+    Serial.println("none");
+  }
+
   Serial.println("Starting K parameter measurement...");
   Serial.println("(Also measuring Tau for comparison)");
 
@@ -87,12 +114,12 @@ void loop() {
   // State machine for automatic duty cycling
   switch (currentState) {
     case START_MOTOR:
-      if (currentDIndex < NUM_D_VALUES) {
-        currentDuty = D_VALUES[currentDIndex];
+      if (currentDIndex < (FRICTION_SWEEP ? NUM_FRICTION_D_VALUES : NUM_D_VALUES)) {
+        currentDuty = FRICTION_SWEEP ? FRICTION_D_VALUES[currentDIndex] : D_VALUES[currentDIndex];
         Serial.print("Test ");
         Serial.print(currentDIndex + 1);
         Serial.print("/");
-        Serial.print(NUM_D_VALUES);
+        Serial.print(FRICTION_SWEEP ? NUM_FRICTION_D_VALUES : NUM_D_VALUES);
         Serial.print(": d=");
         Serial.println(currentDuty);
 
@@ -108,10 +135,15 @@ void loop() {
         K_duty = currentDuty;
         K_value = 0;
 
-        // Start motor (reversed direction)
-        digitalWrite(IN1_PIN, LOW);
-        digitalWrite(IN2_PIN, HIGH);
-        analogWrite(ENA_PIN, currentDuty);
+        // Start motor (reversed direction; negative duty runs the other way)
+        if (currentDuty > 0) {
+          digitalWrite(IN1_PIN, LOW);
+          digitalWrite(IN2_PIN, HIGH);
+        } else {
+          digitalWrite(IN1_PIN, HIGH);
+          digitalWrite(IN2_PIN, LOW);
+        }
+        analogWrite(ENA_PIN, abs(currentDuty));
 
         stateStartTime = currentTime;
         currentState = WAIT_STEADY;
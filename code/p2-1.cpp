@@ -11,8 +11,39 @@
 //   - Upload this code with: python run.py 2-1
 //   - Set reference angle via Serial: "R:200" (for 200 degrees)
 //   - Monitor position, error, and control signal via plotter
+//   - Optional LQR state feedback: run code/lqr_design.cpp and send its
+//     T:/L:/O: commands, then "M:1" (M:0 returns to PID)
+//   - Dead-time compensation: run code/dead_time_id.cpp on step captures and
+//     send its "T:<tau>,<K>" and "D:<ticks>" (Smith predictor, D:0 = off)
+//   - Repeated moves: after "T:<tau>,<K>", "I:90,100" repeats a 90 deg
+//     out-and-back move every 100 ticks and learns a feedforward table
+//     (iterative learning control); "ILC:" lines report each repetition
+//   - Time-optimal moves: after "T:<tau>,<K>", "M:2" runs every R: move of
+//     10 deg or more as full drive / full brake on the model's switching
+//     curve and hands off to PID near the target; "TimeOpt:" lines report
+//     each move
+//   - Long-duration monitoring: "W:100" replaces the per-tick Data: lines by
+//     one Stat: line per 100 ticks (W:0 returns to Data:)
+//   - Load disturbances: after "T:<tau>,<K>", "Q:5" estimates the input-side
+//     disturbance through the model inverse with a 5 Hz Q-filter and
+//     subtracts it from the PID output each tick (Q:0 = off)
+//   - PWM-synchronous sampling: "P:5" runs the control step every 5th period
+//     of the Timer4 PWM carrier (pin 6) with the encoder latched in the
+//     overflow interrupt, so samples sit at the same point of every PWM
+//     period; "P:8,8" runs a 2 ms loop on an 8x faster carrier (3.9 kHz)
+//     (P:0 returns to the 10 ms millis() tick)
+//   - Velocity servo: after "T:<tau>,<K>", "V:600" holds 600 deg/s with a
+//     fixed-point PI plus feedforward from the K/deadzone map; the speed
+//     follows a first-order reference tau/4 (V:600,8 for tau/8). Data:
+//     position/reference/error then carry speed/setpoint/speed error (deg/s).
+//     Runs on the PWM-synchronous tick too; R: or M: returns to position control
+//   - Device identity: the board's id is kept in EEPROM and printed as
+//     "DEVICE:<id>" at startup and on "U"; "U:<id>" stores a new one.
+//     plotter_pid.py looks the id up in data/devices/ and sends this board's
+//     T:/G:/L:/O:/D:/Q: (src/device_registry.py)
 
 #include <Arduino.h>
+#include <EEPROM.h>
 #include <Encoder.h>
 
 // Pin definitions
@@ -39,6 +70,7 @@ float error = 0.0;            // Current error
 float error_prev = 0.0;       // Previous error (for derivative)
 float error_integral = 0.0;   // Accumulated error (for integral)
 float control_signal = 0.0;   // PID output
+float position_prev = 0.0;    // Previous position (standstill detection)
 
 // Anti-windup
 const float INTEGRAL_MAX = 100.0;  // Prevent integral windup
@@ -49,20 +81,251 @@ const int PWM_MAX = 255;
 const int PWM_MIN = 0;
 const int PWM_DEADZONE = 50;  // Minimum PWM to overcome friction
 
+// Friction compensation (paste the table printed by code/friction_id.cpp)
+// When enabled, the identified per-direction offsets replace PWM_DEADZONE:
+// the output is shifted by the Coulomb offset while moving and by the
+// stiction offset from standstill instead of being zeroed below the deadzone.
+const bool USE_FRICTION_COMP = false;
+const int FRICTION_COULOMB_FWD = 50;
+const int FRICTION_COULOMB_REV = 50;
+const int FRICTION_STICTION_FWD = 50;
+const int FRICTION_STICTION_REV = 50;
+const float FRICTION_COMP_MIN = 5.0;  // |control| below this commands zero
+
 // Timing
 unsigned long prevTime = 0;
 const long interval = 10;  // 10ms control loop (100 Hz)
 
+// PWM-synchronous tick (P:<divider>[,<prescaler>], 0 = off)
+// Pin 6 is OC4A. Timer4 runs the Arduino default 8-bit phase-correct PWM,
+// 510 timer counts per carrier period; the overflow interrupt fires at
+// BOTTOM, the middle of the on-pulse, as far from both switching edges as
+// possible. Every <divider>th overflow the ISR latches the encoder and
+// flags a tick for loop(). M:1, M:2, D: and I: use the model T: discretizes
+// at the 10 ms tick, so they stay off while this is on.
+const long PWM_SYNC_MIN_PERIOD_US = 2000;  // Leaves time for the step itself
+const int PWM_SYNC_MAX_DIVIDER = 250;
+int pwmSyncDivider = 0;
+int pwmSyncPrescaler = 64;                  // Arduino default (490 Hz)
+float pwmSyncPeriod = 0.0;                  // s, control period while on
+volatile int pwmSyncPhase = 0;              // Overflows since the last tick
+volatile long pwmSyncCount = 0;             // Encoder latched at the tick
+volatile bool pwmSyncPending = false;
+volatile unsigned int pwmSyncOverruns = 0;  // Ticks loop() was too late for
+
 // Low-pass filter for derivative (reduce noise)
 float derivative_filtered = 0.0;
 const float alpha = 0.2;  // Filter coefficient (0 = no new data, 1 = no filtering)
 
+// Control mode (M:0 = PID, M:1 = LQR state feedback, M:2 = time-optimal)
+const int MODE_PID = 0;
+const int MODE_LQR = 1;
+const int MODE_TIME_OPT = 2;
+const int MODE_VELOCITY = 3;  // Entered with V:, not M:
+int controlMode = MODE_PID;
+
+// Fixed point (Q16.16) for the observer and state feedback
+typedef long fx_t;
+const int FX_SHIFT = 16;
+const fx_t DEG_PER_COUNT_FX = 63083;  // (360 / PPR) * 65536
+const fx_t LQR_DT_FX = 655;           // 0.01 s (interval) * 65536
+const fx_t LQR_INTEGRAL_MAX = 100L << FX_SHIFT;
+
+// Plant model for the observer (T:<tau>,<K>), discretized at the 10 ms tick
+//   θ[k+1] = θ + a12 ω + b1 u,  ω[k+1] = a22 ω + b2 u
+bool modelReady = false;
+float modelTau = 0.0, modelK = 0.0;
+fx_t OBS_A12 = 0, OBS_A22 = 0, OBS_B1 = 0, OBS_B2 = 0;
+
+// Observer gains (O:<l_theta>,<l_omega>) and state feedback gains
+// (L:<k_e>,<k_w>,<k_z>), both computed by code/lqr_design.cpp
+bool observerReady = false;
+bool lqrReady = false;
+fx_t OBS_L1 = 0, OBS_L2 = 0;
+fx_t LQR_KE = 0, LQR_KW = 0, LQR_KZ = 0;
+
+// Observer / LQR state
+fx_t theta_hat = 0;        // Estimated position (deg)
+fx_t omega_hat = 0;        // Estimated velocity (deg/s)
+fx_t lqr_integral = 0;     // Integral of (θ - r) (deg·s)
+fx_t reference_fx = 0;
+bool observerReset = true;
+int pwm_prev = 0;          // PWM applied last tick (observer input)
+
+// Smith predictor for the PID loop (D:<ticks>, 0 = off), uses the T: model.
+// The delay-free model output replaces the delayed one in the feedback:
+//   y_fb = y + θm[k] - θm[k - d]
+// so the PID acts on the predicted position. Error in Data: lines is
+// reference - y_fb while active.
+const int SMITH_MAX_DELAY = 20;
+const fx_t SMITH_REBASE = 10000L << FX_SHIFT;  // Keep θm well inside Q16.16
+int smithDelay = 0;
+fx_t smith_theta = 0;      // Delay-free model position (deg)
+fx_t smith_omega = 0;      // Delay-free model velocity (deg/s)
+fx_t smith_history[SMITH_MAX_DELAY];
+int smithIndex = 0;
+
+// Iterative learning control (I:<amplitude>,<ticks>, I:0 = off)
+// A repeated out-and-back profile from the reference at I: time. The loop
+// adds ilcTable[k] (Q16.16 PWM) to the controller output; the entry used
+// lead+2 ticks ago is corrected from this repetition's error through the
+// inverse of the closed loop seen by the feedforward:
+//   u_ff[j] <- q (u_ff[j] + gain (P^-1 e + u_fb)[j]),  j = k - lead - 2
+// with P^-1 the T: model. One [1 2 1]/4 pass per repetition (Q-filter)
+// keeps the learning away from the unmodeled high frequencies.
+const int ILC_MAX_TICKS = 300;
+const int ILC_MAX_LEAD = 5;
+const int ILC_HIST = ILC_MAX_LEAD + 3;
+const long ILC_RATE = 1000 / interval;  // 1 / T for error differences
+fx_t ilcTable[ILC_MAX_TICKS];
+fx_t ilcFbHist[ILC_HIST];                // Feedback output, last ticks
+fx_t ilcErr[3];                          // e[k], e[k-1], e[k-2]
+fx_t ILC_INV_B2 = 0;                     // 1 / b2 of the T: model
+fx_t ilcGain = 32768;                    // J:<gain>,<lead>,<q>: 0.5
+fx_t ilcQ = 65536;                       // 1.0 (no forgetting)
+int ilcLead = 1;
+int ilcTicks = 0;
+int ilcIndex = 0;
+int ilcWarmup = 0;
+int ilcHistHead = 0;
+long ilcRep = 0;
+float ilcAmplitude = 0.0;
+float ilcBase = 0.0;
+float ilcSumSq = 0.0;
+float ilcMaxErr = 0.0;
+
+// Time-optimal positioning (M:2), uses the T: model
+// Full drive towards the target, then full reverse drive from the point
+// where the remaining distance equals the braking distance at the current
+// speed. Braking from ω with u = -U (a = K U) stops after
+//   D(ω) = τ ω - a τ ln(1 + ω / a)
+// tabulated over [0, 0.98 a] when T: arrives and interpolated per tick.
+// The switch is advanced by the distance covered in 1 + D: ticks (sampling
+// and dead time); PID takes over once the motor has stopped or the target
+// is passed.
+const int TOPT_TABLE_SIZE = 33;
+const int TOPT_IDLE = 0;                    // PID holds the target
+const int TOPT_ACCEL = 1;
+const int TOPT_BRAKE = 2;
+const long TOPT_RATE = 1000 / interval;     // 1 / T for position differences
+const fx_t TOPT_MIN_MOVE = 10L << FX_SHIFT;     // Smaller moves: PID only
+const fx_t TOPT_HYSTERESIS = 2L << FX_SHIFT;    // Brake -> accel again
+const fx_t TOPT_STOP_SPEED = 20L << FX_SHIFT;   // deg/s, hand off below
+const int TOPT_MAX_TICKS = 500;             // Give up after 5 s
+bool toptReady = false;
+fx_t toptDistance[TOPT_TABLE_SIZE];         // D(ω) (deg)
+fx_t toptSpeedStep = 0;                     // ω between entries (deg/s)
+int toptPhase = TOPT_IDLE;
+int toptDir = 1;
+int toptAccelTicks = 0;
+int toptBrakeTicks = 0;
+
+// Disturbance observer (Q:<hz>[,<order>], 0 = off), PID control only
+// Inverting the T: model over one tick with the applied PWM u gives the
+// input-side disturbance (load torque, friction) in PWM units:
+//   Δθ[k] - a22 Δθ[k-1] = b1 (u + d)[k-1] + c1 (u + d)[k-2],  c1 = a12 b2 - a22 b1
+//   d_raw = (Δθ[k] - a22 Δθ[k-1] - b1 u[k-1] - c1 u[k-2]) / (b1 + c1)
+// One encoder count is ~100 PWM in d_raw, so a Q-filter (1st or 2nd order
+// low-pass at <hz>) smooths it; the PID output is reduced by d_hat.
+const fx_t DOB_LIMIT = 150L << FX_SHIFT;  // Largest compensation (PWM)
+bool dobReady = false;                     // Model inverse from T:
+int dobOrder = 0;                          // 0 = off, 1 or 2
+fx_t dobQ = 0;                             // 1 - exp(-2π f T)
+fx_t DOB_C1 = 0;
+fx_t DOB_INV = 0;                          // 1 / (b1 + c1)
+fx_t dobDelta = 0;                         // Δθ[k-1] (deg)
+fx_t dobStage1 = 0;
+fx_t dobHat = 0;                           // Filtered disturbance (PWM)
+long dobCountPrev = 0;
+int pwm_prev2 = 0;                         // u[k-2]
+bool dobReset = true;
+
+// Velocity servo (V:<deg/s>[,<speedup>]), uses the T: model
+// The setpoint is shaped into a first-order reference r with time constant
+// tau / speedup. The feedforward inverts the model over one tick,
+//   u_ff = (r[k+1] - a r[k]) / ((1 - a) K),  a = exp(-T / tau)
+// raised to the deadzone (or Coulomb/stiction offset) in the direction of
+// travel, so the motor follows r open loop. A PI with the plant pole
+// cancelled (Ki = Kp / tau, loop gain K Kp = VEL_LOOP_GAIN) removes the
+// remaining error and drift. Speed is the encoder difference over
+// ~VEL_WINDOW_MS (one count = 24 deg/s at 40 ms), compared with the mean of
+// r over the same ticks.
+const int VEL_WINDOW_MAX = 25;
+const long VEL_WINDOW_MS = 40;
+const float VEL_LOOP_GAIN = 2.0;
+const int VEL_SPEEDUP_DEFAULT = 4;
+const fx_t VEL_STOP = 1L << FX_SHIFT;         // |r| below this at V:0: motor off
+bool velReady = false;                        // T: with K > 0
+int velSpeedup = VEL_SPEEDUP_DEFAULT;
+int velWindow = 1;                            // Ticks in the speed window
+fx_t velSetpoint = 0;                         // deg/s
+fx_t velRef = 0;                              // Shaped reference r (deg/s)
+fx_t velAlpha = 0;                            // 1 - exp(-speedup T / tau)
+fx_t VEL_A = 0;                               // exp(-T / tau)
+fx_t VEL_INV_B = 0;                           // 1 / ((1 - a) K)
+fx_t VEL_COUNT_SCALE = 0;                     // deg/s per count over the window
+fx_t VEL_KP = 0, VEL_KI_T = 0;                // PWM per deg/s, Ki T
+float velPeriod = 0.01;                       // s, tick the constants are for
+fx_t velIntegral = 0;                         // PWM
+fx_t velMeasured = 0;
+long velCounts[VEL_WINDOW_MAX];
+fx_t velRefHist[VEL_WINDOW_MAX];
+int64_t velRefSum = 0;
+int velIndex = 0;
+bool velReset = true;
+
+// Windowed telemetry (W:<ticks>, 0 = off)
+// Every tick feeds min/max/mean/variance accumulators of position, velocity,
+// error and control signal; one line per window is sent instead of the
+// per-tick Data: lines, so extremes and noise between lines are not lost:
+//   Stat:<t_start>,<t_end>,<n>,<pos min,max,mean,var>,<vel ...>,<err ...>,<ctrl ...>
+const int STAT_SIGNALS = 4;   // position, velocity, error, control
+const int STAT_WINDOW_MAX = 6000;
+struct RunningStat {
+  float minValue;
+  float maxValue;
+  float mean;
+  float m2;                   // Sum of squared deviations (Welford)
+};
+RunningStat stats[STAT_SIGNALS];
+int statWindow = 0;
+int statCount = 0;
+unsigned long statStartTime = 0;
+
+// Device identity (U:<id>, U = report), read by every sketch that prints DEVICE:
+// EEPROM layout: 2-byte magic, then the 32-bit id (0 = not provisioned)
+const int DEVICE_ID_ADDR = 0;
+const uint16_t DEVICE_ID_MAGIC = 0x4944;   // "ID"
+unsigned long deviceId = 0;
+
 // Serial command parsing
 String inputString = "";
 bool stringComplete = false;
 
 // Function declarations
 void processSerialCommand();
+void statAdd(RunningStat& s, float x);
+void sendStats(unsigned long endTime);
+void ilcLearn(float e, float u_fb);
+void ilcEndRepetition();
+void toptStart();
+bool toptUpdate(long encoderCount);
+fx_t toptBrakingDistance(fx_t speed);
+bool pwmSyncStart(int divider, int prescaler);
+void pwmSyncStop();
+void dobUpdate(long encoderCount);
+void velConfigure();
+float velUpdate(long encoderCount);
+unsigned long readDeviceId();
+void printDeviceId();
+
+fx_t toFx(float x) {
+  return (fx_t)(x * 65536.0);
+}
+
+fx_t fxMul(fx_t a, fx_t b) {
+  return (fx_t)(((int64_t)a * b) >> FX_SHIFT);
+}
 
 void setup() {
   pinMode(ENA_PIN, OUTPUT);
@@ -78,29 +341,44 @@ void setup() {
   delay(2000);
 
   // Send task identifier
-  Serial.println("TASK:2-1");
+  Serial.println(F("TASK:2-1"));
+  deviceId = readDeviceId();
+  printDeviceId();
 
-  Serial.println("PID Position Controller Started");
-  Serial.println("Commands:");
-  Serial.println("  R:<value>  - Set reference position (e.g., R:200)");
-  Serial.println("  G:<Kp>,<Ki>,<Kd> - Set PID gains (e.g., G:10.5,5.2,2.1)");
-  Serial.println("  S - Stop motor");
-  Serial.println("");
+  Serial.println(F("PID Position Controller Started"));
+  Serial.println(F("Commands:"));
+  Serial.println(F("  R:<value>  - Set reference position (e.g., R:200)"));
+  Serial.println(F("  G:<Kp>,<Ki>,<Kd> - Set PID gains (e.g., G:10.5,5.2,2.1)"));
+  Serial.println(F("  M:<0|1|2> - Control mode (0 = PID, 1 = LQR, 2 = time-optimal)"));
+  Serial.println(F("  T:<tau>,<K> - Plant model for the observer"));
+  Serial.println(F("  L:<k_e>,<k_w>,<k_z> - LQR state feedback gains"));
+  Serial.println(F("  O:<l_theta>,<l_omega> - Observer gains"));
+  Serial.println(F("  D:<ticks> - Smith predictor dead time (0 = off)"));
+  Serial.println(F("  I:<amplitude>,<ticks> - Repeated move with ILC (I:0 = off)"));
+  Serial.println(F("  J:<gain>,<lead>,<q> - ILC learning parameters"));
+  Serial.println(F("  W:<ticks> - Windowed statistics instead of Data: (0 = off)"));
+  Serial.println(F("  Q:<hz>[,<order>] - Disturbance observer Q-filter (0 = off)"));
+  Serial.println(F("  P:<divider>[,<prescaler>] - Tick from the PWM carrier (0 = off)"));
+  Serial.println(F("  V:<deg/s>[,<speedup>] - Velocity servo (R: or M: to leave)"));
+  Serial.println(F("  U[:<id>] - Report (or store) the device id"));
+  Serial.println(F("  S - Stop motor"));
+  Serial.println(F(""));
 
-  Serial.print("Initial reference: ");
+  Serial.print(F("Initial reference: "));
   Serial.print(reference);
-  Serial.println(" deg");
+  Serial.println(F(" deg"));
 
-  Serial.print("PID gains: Kp=");
+  Serial.print(F("PID gains: Kp="));
   Serial.print(Kp, 3);
-  Serial.print(", Ki=");
+  Serial.print(F(", Ki="));
   Serial.print(Ki, 3);
-  Serial.print(", Kd=");
+  Serial.print(F(", Kd="));
   Serial.println(Kd, 3);
-  Serial.println("");
+  Serial.println(F(""));
 
   // Reset encoder
   myEncoder.write(0);
+  reference_fx = toFx(reference);
 
   prevTime = millis();
 
@@ -118,42 +396,162 @@ void loop() {
     stringComplete = false;
   }
 
-  // PID control loop
-  if (currentTime - prevTime >= interval) {
+  // PID control loop (millis() tick or PWM-synchronous tick)
+  bool tick = (pwmSyncDivider > 0) ? pwmSyncPending : (currentTime - prevTime >= interval);
+  if (tick) {
     float dt = (currentTime - prevTime) / 1000.0;  // Convert to seconds
     prevTime = currentTime;
 
-    // Read encoder
-    long encoderCount = myEncoder.read();
+    // Read encoder (latched by the Timer4 ISR in PWM-synchronous mode)
+    long encoderCount;
+    if (pwmSyncDivider > 0) {
+      noInterrupts();
+      encoderCount = pwmSyncCount;
+      pwmSyncPending = false;
+      interrupts();
+      dt = pwmSyncPeriod;  // Exact sample spacing, not the millis() jitter
+    } else {
+      encoderCount = myEncoder.read();
+    }
     float rawAngle = (encoderCount / PPR) * 360.0;
 
     // Use raw angle for linear control (no 0-360 switching)
     position = rawAngle;
 
+    // Repeated profile: smoothstep out in the first half, back in the second
+    if (ilcTicks > 0) {
+      int half = ilcTicks / 2;
+      float x = (ilcIndex < half) ? (float)ilcIndex / half
+                                  : (float)(ilcTicks - ilcIndex) / (ilcTicks - half);
+      reference = ilcBase + ilcAmplitude * x * x * (3 - 2 * x);
+      reference_fx = toFx(reference);
+    }
+
+    // Smith predictor: advance the delay-free model with last tick's PWM
+    float feedback = position;
+    if (smithDelay > 0 && controlMode != MODE_LQR) {
+      fx_t u_fx = (fx_t)pwm_prev << FX_SHIFT;
+      fx_t theta_next = smith_theta + fxMul(OBS_A12, smith_omega) + fxMul(OBS_B1, u_fx);
+      smith_omega = fxMul(OBS_A22, smith_omega) + fxMul(OBS_B2, u_fx);
+      smith_theta = theta_next;
+
+      // Ring of the last d model positions: the oldest is θm[k - d]
+      fx_t delayed = smith_history[smithIndex];
+      smith_history[smithIndex] = smith_theta;
+      smithIndex = (smithIndex + 1) % smithDelay;
+      feedback = position + (smith_theta - delayed) / 65536.0;
+
+      // Only differences matter; shift everything back towards zero
+      if (smith_theta > SMITH_REBASE || smith_theta < -SMITH_REBASE) {
+        fx_t offset = smith_theta;
+        smith_theta = 0;
+        for (int i = 0; i < smithDelay; i++) {
+          smith_history[i] -= offset;
+        }
+      }
+    }
+
     // Calculate error
-    error = reference - position;
+    error = reference - feedback;
 
     // (Shortest path logic removed for uni-directional step response)
 
-    // Proportional term
-    float P = Kp * error;
+    // State observer (fixed point): predict with last tick's PWM, correct
+    // with the encoder. Runs in both modes so M:1 starts from a settled estimate.
+    if (modelReady && observerReady) {
+      fx_t y = (fx_t)((int64_t)encoderCount * DEG_PER_COUNT_FX);
+      if (observerReset) {
+        theta_hat = y;
+        omega_hat = 0;
+        observerReset = false;
+      }
+      fx_t u_fx = (fx_t)pwm_prev << FX_SHIFT;
+      fx_t theta_pred = theta_hat + fxMul(OBS_A12, omega_hat) + fxMul(OBS_B1, u_fx);
+      fx_t omega_pred = fxMul(OBS_A22, omega_hat) + fxMul(OBS_B2, u_fx);
+      fx_t innovation = y - theta_pred;
+      theta_hat = theta_pred + fxMul(OBS_L1, innovation);
+      omega_hat = omega_pred + fxMul(OBS_L2, innovation);
+    }
+
+    if (dobOrder > 0) {
+      dobUpdate(encoderCount);
+    }
+
+    // Time-optimal move in progress: full drive, PID after the handoff
+    bool bangBang = (controlMode == MODE_TIME_OPT) && toptUpdate(encoderCount);
+
+    if (controlMode == MODE_VELOCITY) {
+      control_signal = velUpdate(encoderCount);
+    } else if (bangBang) {
+      int drive = (toptPhase == TOPT_ACCEL) ? PWM_MAX : -PWM_MAX;
+      control_signal = toptDir * drive;
+    } else if (controlMode == MODE_LQR) {
+      // State feedback u = -(k_e e + k_w ω + k_z z) with e = θ - r
+      fx_t e_fx = theta_hat - reference_fx;
+      int64_t u_wide = -(((int64_t)LQR_KE * e_fx + (int64_t)LQR_KW * omega_hat +
+                          (int64_t)LQR_KZ * lqr_integral) >> FX_SHIFT);
+      u_wide = constrain(u_wide, -(1000L << FX_SHIFT), 1000L << FX_SHIFT);
+      fx_t u_fx = (fx_t)u_wide;
+
+      // Conditional integration: hold z while saturated towards the reference
+      bool saturated = (u_fx >= ((fx_t)PWM_MAX << FX_SHIFT) && e_fx < 0) ||
+                       (u_fx <= -((fx_t)PWM_MAX << FX_SHIFT) && e_fx > 0);
+      if (!saturated) {
+        lqr_integral = constrain(lqr_integral + fxMul(LQR_DT_FX, e_fx),
+                                 -LQR_INTEGRAL_MAX, LQR_INTEGRAL_MAX);
+      }
+
+      control_signal = u_fx / 65536.0;
+    } else {
+      // Proportional term
+      float P = Kp * error;
+
+      // Integral term (with anti-windup)
+      error_integral += error * dt;
+      error_integral = constrain(error_integral, INTEGRAL_MIN, INTEGRAL_MAX);
+      float I = Ki * error_integral;
+
+      // Derivative term (with low-pass filter to reduce noise)
+      float derivative_raw = (error - error_prev) / dt;
+      derivative_filtered = alpha * derivative_raw + (1 - alpha) * derivative_filtered;
+      float D = Kd * derivative_filtered;
 
-    // Integral term (with anti-windup)
-    error_integral += error * dt;
-    error_integral = constrain(error_integral, INTEGRAL_MIN, INTEGRAL_MAX);
-    float I = Ki * error_integral;
+      // PID output
+      control_signal = P + I + D;
+    }
 
-    // Derivative term (with low-pass filter to reduce noise)
-    float derivative_raw = (error - error_prev) / dt;
-    derivative_filtered = alpha * derivative_raw + (1 - alpha) * derivative_filtered;
-    float D = Kd * derivative_filtered;
+    // Learned feedforward for this point of the repetition
+    if (ilcTicks > 0) {
+      float u_fb = control_signal;
+      control_signal += ilcTable[ilcIndex] / 65536.0;
+      ilcLearn(reference - position, u_fb);
+      if (++ilcIndex >= ilcTicks) {
+        ilcEndRepetition();
+      }
+    }
 
-    // PID output
-    control_signal = P + I + D;
+    // Disturbance feedforward (not during bang-bang or LQR)
+    if (dobOrder > 0 && !bangBang && controlMode != MODE_LQR) {
+      control_signal -= dobHat / 65536.0;
+    }
 
-    // Apply deadzone and saturation
+    // Apply deadzone (or friction compensation) and saturation
     int pwm = 0;
-    if (abs(control_signal) > PWM_DEADZONE) {
+    if (controlMode == MODE_VELOCITY) {
+      // Deadzone is part of the feedforward; off only once stopped at V:0
+      if (velSetpoint != 0 || velRef != 0) {
+        pwm = (int)constrain(control_signal, -PWM_MAX, PWM_MAX);
+      }
+    } else if (USE_FRICTION_COMP) {
+      bool standstill = (position == position_prev);
+      if (control_signal > FRICTION_COMP_MIN) {
+        int offset = standstill ? FRICTION_STICTION_FWD : FRICTION_COULOMB_FWD;
+        pwm = (int)constrain(control_signal + offset, -PWM_MAX, PWM_MAX);
+      } else if (control_signal < -FRICTION_COMP_MIN) {
+        int offset = standstill ? FRICTION_STICTION_REV : FRICTION_COULOMB_REV;
+        pwm = (int)constrain(control_signal - offset, -PWM_MAX, PWM_MAX);
+      }
+    } else if (abs(control_signal) > PWM_DEADZONE) {
       pwm = (int)constrain(control_signal, -PWM_MAX, PWM_MAX);
     }
 
@@ -174,36 +572,226 @@ void loop() {
       digitalWrite(IN2_PIN, LOW);
       analogWrite(ENA_PIN, 0);
     }
+    pwm_prev2 = pwm_prev;
+    pwm_prev = pwm;
 
-    // Send data for plotting
-    // Modified Format for Verification: 
-    // Data:Time,Position,Reference,Error,ControlSignal,Ref+15%,Ref+2%,Ref-2%
-    Serial.print("Data:");
-    Serial.print(currentTime / 1000.0, 3);
-    Serial.print(",");
-    Serial.print(position, 2);
-    Serial.print(",");
-    Serial.print(reference, 2);
-    Serial.print(",");
-    Serial.print(error, 2);
-    Serial.print(",");
-    Serial.print(control_signal, 2);
-
-    // Add verification limits to the graph
-    float limit_overshoot = reference * 1.15; // +15% overshoot limit
-    float limit_settle_upper = reference * 1.02; // +2% settling band
-    float limit_settle_lower = reference * 0.98; // -2% settling band
+    if (statWindow > 0) {
+      // Aggregate at the control rate, send once per window
+      if (statCount == 0) {
+        statStartTime = currentTime;
+      }
+      statCount++;
+      statAdd(stats[0], position);
+      statAdd(stats[1], (position - position_prev) / dt);
+      statAdd(stats[2], error);
+      statAdd(stats[3], control_signal);
+      if (statCount >= statWindow) {
+        sendStats(currentTime);
+      }
+    } else {
+      // Send data for plotting
+      // Modified Format for Verification: 
+      // Data:Time,Position,Reference,Error,ControlSignal,Ref+15%,Ref+2%,Ref-2%
+      // (speeds in deg/s instead of positions in the velocity servo)
+      float shown = position;
+      float target = reference;
+      if (controlMode == MODE_VELOCITY) {
+        shown = velMeasured / 65536.0;
+        target = velSetpoint / 65536.0;
+      }
+      Serial.print(F("Data:"));
+      Serial.print(currentTime / 1000.0, 3);
+      Serial.print(F(","));
+      Serial.print(shown, 2);
+      Serial.print(F(","));
+      Serial.print(target, 2);
+      Serial.print(F(","));
+      Serial.print(error, 2);
+      Serial.print(F(","));
+      Serial.print(control_signal, 2);
+
+      // Add verification limits to the graph
+      float limit_overshoot = target * 1.15; // +15% overshoot limit
+      float limit_settle_upper = target * 1.02; // +2% settling band
+      float limit_settle_lower = target * 0.98; // -2% settling band
     
-    Serial.print(",");
-    Serial.print(limit_overshoot, 2);
-    Serial.print(",");
-    Serial.print(limit_settle_upper, 2);
-    Serial.print(",");
-    Serial.println(limit_settle_lower, 2);
+      Serial.print(F(","));
+      Serial.print(limit_overshoot, 2);
+      Serial.print(F(","));
+      Serial.print(limit_settle_upper, 2);
+      Serial.print(F(","));
+      Serial.println(limit_settle_lower, 2);
+    }
 
     // Update previous error
     error_prev = error;
+    position_prev = position;
+  }
+}
+
+// Welford update; statCount already includes x
+void statAdd(RunningStat& s, float x) {
+  if (statCount == 1) {
+    s.minValue = x;
+    s.maxValue = x;
+    s.mean = x;
+    s.m2 = 0;
+    return;
+  }
+  if (x < s.minValue) s.minValue = x;
+  if (x > s.maxValue) s.maxValue = x;
+  float delta = x - s.mean;
+  s.mean += delta / statCount;
+  s.m2 += delta * (x - s.mean);
+}
+
+void sendStats(unsigned long endTime) {
+  Serial.print(F("Stat:"));
+  Serial.print(statStartTime / 1000.0, 3);
+  Serial.print(F(","));
+  Serial.print(endTime / 1000.0, 3);
+  Serial.print(F(","));
+  Serial.print(statCount);
+  for (int i = 0; i < STAT_SIGNALS; i++) {
+    Serial.print(F(","));
+    Serial.print(stats[i].minValue, 2);
+    Serial.print(F(","));
+    Serial.print(stats[i].maxValue, 2);
+    Serial.print(F(","));
+    Serial.print(stats[i].mean, 2);
+    Serial.print(F(","));
+    Serial.print(statCount > 1 ? stats[i].m2 / (statCount - 1) : 0.0, 3);
   }
+  Serial.println();
+  statCount = 0;
+}
+
+// Correct the table entry lead+2 ticks back; O(1) per tick
+void ilcLearn(float e, float u_fb) {
+  ilcErr[2] = ilcErr[1];
+  ilcErr[1] = ilcErr[0];
+  ilcErr[0] = toFx(e);
+  // Only ±PWM_MAX of the feedback reaches the motor; large gains would
+  // otherwise overflow Q16.16 (|u_fb| > 32767)
+  ilcFbHist[ilcHistHead] = toFx(constrain(u_fb, (float)-PWM_MAX, (float)PWM_MAX));
+  ilcHistHead = (ilcHistHead + 1) % ILC_HIST;
+
+  ilcSumSq += e * e;
+  if (abs(e) > ilcMaxErr) {
+    ilcMaxErr = abs(e);
+  }
+
+  if (ilcWarmup < ilcLead + 2) {
+    ilcWarmup++;  // Histories not filled yet
+    return;
+  }
+
+  // Plant inverse on the error: u = (ω[k+1] - a22 ω[k]) / b2
+  fx_t w1 = (ilcErr[0] - ilcErr[1]) * ILC_RATE;
+  fx_t w0 = (ilcErr[1] - ilcErr[2]) * ILC_RATE;
+  fx_t inverse = fxMul(w1 - fxMul(OBS_A22, w0), ILC_INV_B2);
+  fx_t u_fb_j = ilcFbHist[(ilcHistHead + ILC_HIST - (ilcLead + 3)) % ILC_HIST];
+
+  int j = (ilcIndex - ilcLead - 2 + ilcTicks) % ilcTicks;
+  fx_t u = fxMul(ilcQ, ilcTable[j] + fxMul(ilcGain, inverse + u_fb_j));
+  ilcTable[j] = constrain(u, -((fx_t)PWM_MAX << FX_SHIFT), (fx_t)PWM_MAX << FX_SHIFT);
+}
+
+// Q-filter pass over the (circular) table and per-repetition report
+void ilcEndRepetition() {
+  fx_t first = ilcTable[0];
+  fx_t prev = ilcTable[ilcTicks - 1];
+  for (int i = 0; i < ilcTicks; i++) {
+    fx_t next = (i + 1 < ilcTicks) ? ilcTable[i + 1] : first;
+    fx_t current = ilcTable[i];
+    ilcTable[i] = (prev + 2 * current + next) / 4;
+    prev = current;
+  }
+
+  Serial.print(F("ILC:"));
+  Serial.print(ilcRep);
+  Serial.print(F(","));
+  Serial.print(sqrt(ilcSumSq / ilcTicks), 3);
+  Serial.print(F(","));
+  Serial.println(ilcMaxErr, 3);
+
+  ilcRep++;
+  ilcIndex = 0;
+  ilcSumSq = 0;
+  ilcMaxErr = 0;
+}
+
+// Begin a move to the reference if it is far enough for full drive
+void toptStart() {
+  float distance = reference - position;
+  if (toFx(abs(distance)) < TOPT_MIN_MOVE) {
+    toptPhase = TOPT_IDLE;
+    return;
+  }
+  toptDir = (distance > 0) ? 1 : -1;
+  toptPhase = TOPT_ACCEL;
+  toptAccelTicks = 0;
+  toptBrakeTicks = 0;
+}
+
+// Braking distance at a speed (deg/s, >= 0), linear in the table
+fx_t toptBrakingDistance(fx_t speed) {
+  if (speed <= 0) {
+    return 0;
+  }
+  int64_t index = ((int64_t)speed << FX_SHIFT) / toptSpeedStep;
+  int i = (int)(index >> FX_SHIFT);
+  if (i >= TOPT_TABLE_SIZE - 1) {
+    return toptDistance[TOPT_TABLE_SIZE - 1];
+  }
+  fx_t frac = (fx_t)(index & 0xFFFF);
+  return toptDistance[i] + fxMul(toptDistance[i + 1] - toptDistance[i], frac);
+}
+
+// Phase of the running move; false once PID has the target
+bool toptUpdate(long encoderCount) {
+  if (toptPhase == TOPT_IDLE) {
+    return false;
+  }
+
+  // Distance to go and speed, both positive towards the target
+  fx_t y = (fx_t)((int64_t)encoderCount * DEG_PER_COUNT_FX);
+  fx_t omega = (modelReady && observerReady) ? omega_hat
+                                             : toFx(position - position_prev) * TOPT_RATE;
+  fx_t togo = (toptDir > 0) ? reference_fx - y : y - reference_fx;
+  fx_t speed = (toptDir > 0) ? omega : -omega;
+  fx_t margin = fxMul(max(speed, (fx_t)0), LQR_DT_FX) * (1 + smithDelay);
+  fx_t braking = toptBrakingDistance(speed) + margin;
+
+  if (toptPhase == TOPT_ACCEL && togo <= braking) {
+    toptPhase = TOPT_BRAKE;
+  } else if (toptPhase == TOPT_BRAKE && togo > braking + TOPT_HYSTERESIS) {
+    toptPhase = TOPT_ACCEL;  // Braked too early (model mismatch)
+  }
+
+  bool stopped = (toptPhase == TOPT_BRAKE) && (speed <= TOPT_STOP_SPEED || togo <= 0);
+  if (!stopped && toptAccelTicks + toptBrakeTicks < TOPT_MAX_TICKS) {
+    if (toptPhase == TOPT_ACCEL) {
+      toptAccelTicks++;
+    } else {
+      toptBrakeTicks++;
+    }
+    return true;
+  }
+
+  // Handoff: PID starts clean from here
+  toptPhase = TOPT_IDLE;
+  error_integral = 0;
+  derivative_filtered = 0;
+  error_prev = error;
+
+  Serial.print(F("TimeOpt:"));
+  Serial.print(toptAccelTicks * interval);
+  Serial.print(F(","));
+  Serial.print(toptBrakeTicks * interval);
+  Serial.print(F(","));
+  Serial.println(error, 2);
+  return false;
 }
 
 void serialEvent() {
@@ -216,6 +804,189 @@ void serialEvent() {
   }
 }
 
+// Disturbance estimate from this tick's encoder count and the last two PWMs
+void dobUpdate(long encoderCount) {
+  fx_t delta = (fx_t)((int64_t)(encoderCount - dobCountPrev) * DEG_PER_COUNT_FX);
+  dobCountPrev = encoderCount;
+  if (dobReset) {
+    // No valid differences yet
+    dobDelta = 0;
+    dobStage1 = 0;
+    dobHat = 0;
+    dobReset = false;
+    return;
+  }
+  fx_t residual = delta - fxMul(OBS_A22, dobDelta) - fxMul(OBS_B1, (fx_t)pwm_prev << FX_SHIFT) -
+                  fxMul(DOB_C1, (fx_t)pwm_prev2 << FX_SHIFT);
+  fx_t raw = (fx_t)constrain(((int64_t)residual * DOB_INV) >> FX_SHIFT,
+                             -(1000L << FX_SHIFT), 1000L << FX_SHIFT);
+  dobDelta = delta;
+
+  dobStage1 += fxMul(dobQ, raw - dobStage1);
+  fx_t filtered = (dobOrder == 2) ? dobHat + fxMul(dobQ, dobStage1 - dobHat) : dobStage1;
+  dobHat = constrain(filtered, -DOB_LIMIT, DOB_LIMIT);
+}
+
+// Velocity servo constants for the T: model and the active tick
+void velConfigure() {
+  if (!velReady) {
+    return;
+  }
+  float T = (pwmSyncDivider > 0) ? pwmSyncPeriod : interval / 1000.0;
+  velPeriod = T;
+  float a = exp(-T / modelTau);
+  VEL_A = toFx(a);
+  VEL_INV_B = toFx(1.0 / ((1 - a) * modelK));
+  velAlpha = toFx(1 - exp(-velSpeedup * T / modelTau));
+  velWindow = constrain((int)(VEL_WINDOW_MS / 1000.0 / T + 0.5), 1, VEL_WINDOW_MAX);
+  VEL_COUNT_SCALE = toFx(360.0 / PPR / (velWindow * T));
+  VEL_KP = toFx(VEL_LOOP_GAIN / modelK);
+  VEL_KI_T = toFx(VEL_LOOP_GAIN / modelK * T / modelTau);
+  velReset = true;
+}
+
+// Control signal (PWM) of the velocity servo for this tick
+float velUpdate(long encoderCount) {
+  if (velReset) {
+    // Start from last tick's speed so a running motor is picked up smoothly
+    float countsPerTick = (position - position_prev) * PPR / 360.0;
+    velRef = toFx((position - position_prev) / velPeriod);
+    velRefSum = 0;
+    for (int i = 0; i < velWindow; i++) {
+      velCounts[i] = encoderCount - (long)(countsPerTick * (velWindow - i));
+      velRefHist[i] = velRef;
+      velRefSum += velRef;
+    }
+    velMeasured = velRef;
+    velIntegral = 0;
+    velIndex = 0;
+    velReset = false;
+  }
+
+  // Speed over the window and the mean reference over the same ticks
+  velMeasured = (fx_t)(encoderCount - velCounts[velIndex]) * VEL_COUNT_SCALE;
+  fx_t expected = (fx_t)(velRefSum / velWindow);
+  velCounts[velIndex] = encoderCount;
+
+  // Shape the setpoint; the feedforward asks for next tick's reference
+  fx_t r = velRef;
+  velRef += fxMul(velAlpha, velSetpoint - velRef);
+  if (velSetpoint == 0 && abs(velRef) < VEL_STOP) {
+    velRef = 0;
+  }
+  velRefSum += velRef - velRefHist[velIndex];
+  velRefHist[velIndex] = velRef;
+  velIndex = (velIndex + 1) % velWindow;
+
+  fx_t u_ff = (fx_t)constrain(((int64_t)(velRef - fxMul(VEL_A, r)) * VEL_INV_B) >> FX_SHIFT,
+                              -(1000L << FX_SHIFT), 1000L << FX_SHIFT);
+  bool standstill = (position == position_prev);
+  if (velRef > 0 && u_ff > 0) {
+    int offset = USE_FRICTION_COMP ? (standstill ? FRICTION_STICTION_FWD : FRICTION_COULOMB_FWD)
+                                   : PWM_DEADZONE;
+    u_ff = max(u_ff, (fx_t)offset << FX_SHIFT);
+  } else if (velRef < 0 && u_ff < 0) {
+    int offset = USE_FRICTION_COMP ? (standstill ? FRICTION_STICTION_REV : FRICTION_COULOMB_REV)
+                                   : PWM_DEADZONE;
+    u_ff = min(u_ff, -((fx_t)offset << FX_SHIFT));
+  }
+
+  // PI on the speed error; hold the integral while saturated in its direction
+  fx_t e = expected - velMeasured;
+  error = e / 65536.0;
+  if (velSetpoint == 0 && velRef == 0) {
+    velIntegral = 0;
+    return 0.0;
+  }
+  fx_t u = u_ff + fxMul(VEL_KP, e) + velIntegral;
+  fx_t limit = (fx_t)PWM_MAX << FX_SHIFT;
+  bool saturated = (u >= limit && e > 0) || (u <= -limit && e < 0);
+  if (!saturated) {
+    velIntegral = constrain(velIntegral + fxMul(VEL_KI_T, e), -limit, limit);
+  }
+  return u / 65536.0;
+}
+
+// Timer4 overflow = BOTTOM of the pin 6 PWM carrier
+ISR(TIMER4_OVF_vect) {
+  if (++pwmSyncPhase < pwmSyncDivider) {
+    return;
+  }
+  pwmSyncPhase = 0;
+  if (pwmSyncPending) {
+    pwmSyncOverruns++;  // Previous sample not used yet; keep the newest
+  }
+  // Encoder::read() ends with interrupts() so the encoder ISRs may nest
+  // here; this ISR itself cannot re-enter within one carrier period
+  pwmSyncCount = myEncoder.read();
+  pwmSyncPending = true;
+}
+
+// Returns false if the resulting control period is out of range
+bool pwmSyncStart(int divider, int prescaler) {
+  byte clockSelect;
+  if (prescaler == 1) {
+    clockSelect = _BV(CS40);
+  } else if (prescaler == 8) {
+    clockSelect = _BV(CS41);
+  } else if (prescaler == 64) {
+    clockSelect = _BV(CS41) | _BV(CS40);
+  } else {
+    return false;
+  }
+  // 510 counts per phase-correct period at 16 MHz / prescaler
+  float periodUs = 510.0 * prescaler / 16.0 * divider;
+  if (divider < 1 || divider > PWM_SYNC_MAX_DIVIDER || periodUs < PWM_SYNC_MIN_PERIOD_US) {
+    return false;
+  }
+
+  noInterrupts();
+  TCCR4B = (TCCR4B & ~(_BV(CS42) | _BV(CS41) | _BV(CS40))) | clockSelect;
+  pwmSyncDivider = divider;
+  pwmSyncPrescaler = prescaler;
+  pwmSyncPeriod = periodUs / 1000000.0;
+  pwmSyncPhase = 0;
+  pwmSyncPending = false;
+  pwmSyncOverruns = 0;
+  TIFR4 = _BV(TOV4);    // Drop a stale overflow flag
+  TIMSK4 |= _BV(TOIE4);
+  interrupts();
+  return true;
+}
+
+unsigned long readDeviceId() {
+  uint16_t magic = 0;
+  unsigned long id = 0;
+  EEPROM.get(DEVICE_ID_ADDR, magic);
+  if (magic != DEVICE_ID_MAGIC) {
+    return 0;
+  }
+  EEPROM.get(DEVICE_ID_ADDR + sizeof(DEVICE_ID_MAGIC), id);
+  return id;
+}
+
+// "DEVICE:<id>", or "DEVICE:none" before U:<id>
+void printDeviceId() {
+  Serial.print(F("DEVICE:"));
+  if (deviceId > 0) {
+    Serial.println(deviceId);
+  } else {
+    Serial.println(F("none"));
+  }
+}
+
+// Back to the millis() tick and the default 490 Hz carrier
+void pwmSyncStop() {
+  noInterrupts();
+  TIMSK4 &= ~_BV(TOIE4);
+  TCCR4B = (TCCR4B & ~(_BV(CS42) | _BV(CS41) | _BV(CS40))) | _BV(CS41) | _BV(CS40);
+  pwmSyncDivider = 0;
+  pwmSyncPrescaler = 64;
+  pwmSyncPending = false;
+  interrupts();
+  prevTime = millis();
+}
+
 void processSerialCommand() {
   inputString.trim();
 
@@ -223,13 +994,25 @@ void processSerialCommand() {
     // Set reference
     float newRef = inputString.substring(2).toFloat();
     reference = newRef;
+    reference_fx = toFx(reference);
+    ilcBase = newRef;  // Repeated moves start from here
 
     // Reset integral term when reference changes
     error_integral = 0;
+    lqr_integral = 0;
 
-    Serial.print("Reference set to: ");
+    Serial.print(F("Reference set to: "));
     Serial.print(reference);
-    Serial.println(" deg");
+    Serial.println(F(" deg"));
+
+    if (controlMode == MODE_VELOCITY) {
+      controlMode = MODE_PID;
+      Serial.println(F("Control mode: PID"));
+    }
+
+    if (controlMode == MODE_TIME_OPT) {
+      toptStart();
+    }
 
   } else if (inputString.startsWith("G:")) {
     // Set PID gains
@@ -245,14 +1028,382 @@ void processSerialCommand() {
       // Reset integral when gains change
       error_integral = 0;
 
-      Serial.print("Gains updated: Kp=");
+      Serial.print(F("Gains updated: Kp="));
       Serial.print(Kp, 3);
-      Serial.print(", Ki=");
+      Serial.print(F(", Ki="));
       Serial.print(Ki, 3);
-      Serial.print(", Kd=");
+      Serial.print(F(", Kd="));
       Serial.println(Kd, 3);
     } else {
-      Serial.println("Error: Invalid gain format. Use G:<Kp>,<Ki>,<Kd>");
+      Serial.println(F("Error: Invalid gain format. Use G:<Kp>,<Ki>,<Kd>"));
+    }
+
+  } else if (inputString.startsWith("M:")) {
+    // Select control mode
+    int mode = inputString.substring(2).toInt();
+
+    if (mode != MODE_PID && pwmSyncDivider > 0) {
+      Serial.println(F("Error: LQR and time-optimal modes need the 10 ms tick (send P:0)"));
+    } else if (mode == MODE_LQR && !(modelReady && observerReady && lqrReady)) {
+      Serial.println(F("Error: Send T:, L: and O: before selecting LQR mode"));
+    } else if (mode == MODE_TIME_OPT && !toptReady) {
+      Serial.println(F("Error: Send T: with K > 0 before selecting time-optimal mode"));
+    } else if (mode == MODE_PID || mode == MODE_LQR || mode == MODE_TIME_OPT) {
+      if (controlMode == MODE_VELOCITY) {
+        // Hold wherever the velocity servo left the motor
+        reference = position;
+        reference_fx = toFx(reference);
+        derivative_filtered = 0;
+        error_prev = 0;
+        observerReset = true;
+      }
+      controlMode = mode;
+      error_integral = 0;
+      lqr_integral = 0;
+      toptPhase = TOPT_IDLE;
+
+      Serial.print(F("Control mode: "));
+      if (controlMode == MODE_LQR) {
+        Serial.println(F("LQR"));
+      } else if (controlMode == MODE_TIME_OPT) {
+        Serial.println(F("Time-optimal"));
+        toptStart();
+      } else {
+        Serial.println(F("PID"));
+      }
+    } else {
+      Serial.println(F("Error: Invalid mode. Use M:0 (PID), M:1 (LQR) or M:2 (time-optimal)"));
+    }
+
+  } else if (inputString.startsWith("T:")) {
+    // Plant model: discretize once here (float), run in fixed point
+    String modelStr = inputString.substring(2);
+    int comma = modelStr.indexOf(',');
+    float tau = modelStr.substring(0, comma).toFloat();
+    float K = modelStr.substring(comma + 1).toFloat();
+
+    if (comma > 0 && tau > 0) {
+      modelTau = tau;
+      modelK = K;
+      float T = interval / 1000.0;
+      float a22 = exp(-T / tau);
+      float a12 = tau * (1 - a22);
+      OBS_A22 = toFx(a22);
+      OBS_A12 = toFx(a12);
+      OBS_B2 = toFx(K * (1 - a22));
+      OBS_B1 = toFx(K * (T - a12));
+      ILC_INV_B2 = toFx(1.0 / (K * (1 - a22)));
+      modelReady = true;
+      observerReset = true;
+
+      // Disturbance observer: one-tick inverse of the position model
+      float b1 = K * (T - a12);
+      float c1 = a12 * K * (1 - a22) - a22 * b1;
+      dobReady = K > 0;
+      if (dobReady) {
+        DOB_C1 = toFx(c1);
+        DOB_INV = toFx(1.0 / (b1 + c1));
+      } else {
+        dobOrder = 0;
+      }
+      dobReset = true;
+
+      // Braking distance table for the time-optimal mode
+      toptReady = K > 0;
+      if (toptReady) {
+        float a = K * PWM_MAX;
+        float step = 0.98 * a / (TOPT_TABLE_SIZE - 1);
+        for (int i = 0; i < TOPT_TABLE_SIZE; i++) {
+          float w = step * i;
+          toptDistance[i] = toFx(tau * w - a * tau * log(1 + w / a));
+        }
+        toptSpeedStep = toFx(step);
+      } else if (controlMode == MODE_TIME_OPT) {
+        controlMode = MODE_PID;
+        toptPhase = TOPT_IDLE;
+      }
+
+      // Velocity servo feedforward and PI
+      velReady = K > 0;
+      if (velReady) {
+        velConfigure();
+      } else if (controlMode == MODE_VELOCITY) {
+        controlMode = MODE_PID;
+        reference = position;
+        reference_fx = toFx(reference);
+      }
+
+      Serial.print(F("Model updated: tau="));
+      Serial.print(tau, 4);
+      Serial.print(F(", K="));
+      Serial.println(K, 4);
+    } else {
+      Serial.println(F("Error: Invalid model format. Use T:<tau>,<K>"));
+    }
+
+  } else if (inputString.startsWith("L:")) {
+    // State feedback gains
+    String gainStr = inputString.substring(2);
+    int comma1 = gainStr.indexOf(',');
+    int comma2 = gainStr.indexOf(',', comma1 + 1);
+
+    if (comma1 > 0 && comma2 > 0) {
+      LQR_KE = toFx(gainStr.substring(0, comma1).toFloat());
+      LQR_KW = toFx(gainStr.substring(comma1 + 1, comma2).toFloat());
+      LQR_KZ = toFx(gainStr.substring(comma2 + 1).toFloat());
+      lqr_integral = 0;
+      lqrReady = true;
+      Serial.println(F("LQR gains updated"));
+    } else {
+      Serial.println(F("Error: Invalid gain format. Use L:<k_e>,<k_w>,<k_z>"));
+    }
+
+  } else if (inputString.startsWith("O:")) {
+    // Observer gains
+    String gainStr = inputString.substring(2);
+    int comma = gainStr.indexOf(',');
+
+    if (comma > 0) {
+      OBS_L1 = toFx(gainStr.substring(0, comma).toFloat());
+      OBS_L2 = toFx(gainStr.substring(comma + 1).toFloat());
+      observerReady = true;
+      observerReset = true;
+      Serial.println(F("Observer gains updated"));
+    } else {
+      Serial.println(F("Error: Invalid gain format. Use O:<l_theta>,<l_omega>"));
+    }
+
+  } else if (inputString.startsWith("D:")) {
+    // Smith predictor dead time in control ticks (digits only: toInt()
+    // would read "D:x" as 0 and switch the predictor off without a word)
+    String tickStr = inputString.substring(2);
+    bool numeric = tickStr.length() > 0;
+    for (unsigned int i = 0; i < tickStr.length(); i++) {
+      if (tickStr.charAt(i) < '0' || tickStr.charAt(i) > '9') {
+        numeric = false;
+      }
+    }
+    int ticks = numeric ? tickStr.toInt() : -1;
+
+    if (ticks < 0 || ticks > SMITH_MAX_DELAY) {
+      Serial.println(F("Error: Invalid dead time. Use D:<0-20>"));
+    } else if (ticks > 0 && !modelReady) {
+      Serial.println(F("Error: Send T: before enabling the Smith predictor"));
+    } else if (ticks > 0 && pwmSyncDivider > 0) {
+      Serial.println(F("Error: The Smith predictor needs the 10 ms tick (send P:0)"));
+    } else if (ticks > 0 && dobOrder > 0) {
+      Serial.println(F("Error: Turn the disturbance observer off first (Q:0)"));
+    } else if (ticks > 0 && controlMode == MODE_VELOCITY) {
+      Serial.println(F("Error: The Smith predictor needs position control (R: or M:0 first)"));
+    } else {
+      smithDelay = ticks;
+      smith_theta = 0;
+      smith_omega = 0;
+      smithIndex = 0;
+      for (int i = 0; i < SMITH_MAX_DELAY; i++) {
+        smith_history[i] = 0;
+      }
+      error_integral = 0;
+
+      Serial.print(F("Smith predictor: "));
+      if (smithDelay > 0) {
+        Serial.print(smithDelay * interval);
+        Serial.println(F(" ms dead time"));
+      } else {
+        Serial.println(F("off"));
+      }
+    }
+
+  } else if (inputString.startsWith("I:")) {
+    // Repeated move with iterative learning control
+    String ilcStr = inputString.substring(2);
+    int comma = ilcStr.indexOf(',');
+    float amplitude = ilcStr.substring(0, comma).toFloat();
+    int ticks = (comma > 0) ? ilcStr.substring(comma + 1).toInt() : 0;
+
+    if (amplitude == 0) {
+      if (ilcTicks > 0) {
+        reference = ilcBase;
+        reference_fx = toFx(reference);
+      }
+      ilcTicks = 0;
+      Serial.println(F("ILC: off"));
+    } else if (!modelReady) {
+      Serial.println(F("Error: Send T: before starting ILC"));
+    } else if (controlMode == MODE_VELOCITY) {
+      Serial.println(F("Error: ILC needs position control (R: or M:0 first)"));
+    } else if (pwmSyncDivider > 0) {
+      Serial.println(F("Error: ILC needs the 10 ms tick (send P:0)"));
+    } else if (ticks >= 20 && ticks <= ILC_MAX_TICKS) {
+      if (ilcTicks == 0) {
+        ilcBase = reference;
+      }
+      ilcAmplitude = amplitude;
+      ilcTicks = ticks;
+      ilcIndex = 0;
+      ilcWarmup = 0;
+      ilcRep = 0;
+      ilcSumSq = 0;
+      ilcMaxErr = 0;
+      for (int i = 0; i < ILC_MAX_TICKS; i++) {
+        ilcTable[i] = 0;
+      }
+      error_integral = 0;
+
+      Serial.print(F("ILC: "));
+      Serial.print(ilcAmplitude);
+      Serial.print(F(" deg every "));
+      Serial.print(ilcTicks);
+      Serial.println(F(" ticks"));
+    } else {
+      Serial.println(F("Error: Use I:<amplitude>,<20-300 ticks> (I:0 = off)"));
+    }
+
+  } else if (inputString.startsWith("J:")) {
+    // Learning parameters
+    String paramStr = inputString.substring(2);
+    int comma1 = paramStr.indexOf(',');
+    int comma2 = paramStr.indexOf(',', comma1 + 1);
+    float gain = paramStr.substring(0, comma1).toFloat();
+    int lead = paramStr.substring(comma1 + 1, comma2).toInt();
+    float q = paramStr.substring(comma2 + 1).toFloat();
+
+    if (comma1 > 0 && comma2 > 0 && gain >= 0 && lead >= 0 && lead <= ILC_MAX_LEAD &&
+        q > 0 && q <= 1) {
+      ilcGain = toFx(gain);
+      ilcLead = lead;
+      ilcQ = toFx(q);
+      ilcWarmup = 0;
+      Serial.println(F("ILC parameters updated"));
+    } else {
+      Serial.println(F("Error: Use J:<gain>,<lead 0-5>,<q 0-1>"));
+    }
+
+  } else if (inputString.startsWith("W:")) {
+    // Windowed telemetry
+    int window = inputString.substring(2).toInt();
+
+    if (window >= 0 && window <= STAT_WINDOW_MAX) {
+      statWindow = window;
+      statCount = 0;
+      Serial.print(F("Telemetry window: "));
+      Serial.print(statWindow);
+      Serial.println(statWindow > 0 ? F(" ticks") : F(" (raw Data:)"));
+    } else {
+      Serial.println(F("Error: Invalid window. Use W:<0-6000>"));
+    }
+
+  } else if (inputString.startsWith("Q:")) {
+    // Disturbance observer
+    String dobStr = inputString.substring(2);
+    int comma = dobStr.indexOf(',');
+    float hz = dobStr.substring(0, comma).toFloat();
+    int order = (comma > 0) ? dobStr.substring(comma + 1).toInt() : 2;
+    float nyquist = 500.0 / interval;
+
+    if (hz == 0) {
+      dobOrder = 0;
+      Serial.println(F("Disturbance observer: off"));
+    } else if (!dobReady) {
+      Serial.println(F("Error: Send T: with K > 0 before enabling the disturbance observer"));
+    } else if (smithDelay > 0 || pwmSyncDivider > 0) {
+      Serial.println(F("Error: The disturbance observer needs D:0 and P:0"));
+    } else if (controlMode == MODE_VELOCITY) {
+      Serial.println(F("Error: The disturbance observer needs position control (R: or M:0 first)"));
+    } else if (hz > 0 && hz < nyquist && (order == 1 || order == 2)) {
+      dobQ = toFx(1 - exp(-2 * PI * hz * interval / 1000.0));
+      dobOrder = order;
+      dobReset = true;
+      error_integral = 0;
+      Serial.print(F("Disturbance observer: Q-filter "));
+      Serial.print(hz, 1);
+      Serial.print(F(" Hz, order "));
+      Serial.println(dobOrder);
+    } else {
+      Serial.println(F("Error: Use Q:<hz 0-50>[,<order 1|2>] (Q:0 = off)"));
+    }
+
+  } else if (inputString.startsWith("P:")) {
+    // PWM-synchronous tick
+    String syncStr = inputString.substring(2);
+    int comma = syncStr.indexOf(',');
+    int divider = syncStr.substring(0, comma).toInt();
+    int prescaler = (comma > 0) ? syncStr.substring(comma + 1).toInt() : 64;
+
+    if (divider == 0) {
+      if (pwmSyncDivider > 0) {
+        Serial.print(F("PWM sync: off ("));
+        Serial.print(pwmSyncOverruns);
+        Serial.println(F(" overruns)"));
+      } else {
+        Serial.println(F("PWM sync: off"));
+      }
+      pwmSyncStop();
+      velConfigure();
+    } else if ((controlMode != MODE_PID && controlMode != MODE_VELOCITY) || smithDelay > 0 || ilcTicks > 0 || dobOrder > 0) {
+      Serial.println(F("Error: PWM sync runs PID or V: only (M:0, D:0, I:0, Q:0 first)"));
+    } else if (pwmSyncStart(divider, prescaler)) {
+      error_integral = 0;
+      derivative_filtered = 0;
+      velConfigure();
+      Serial.print(F("PWM sync: carrier "));
+      Serial.print(1000000.0 / (510.0 * pwmSyncPrescaler / 16), 0);
+      Serial.print(F(" Hz, tick every "));
+      Serial.print(pwmSyncDivider);
+      Serial.print(F(" periods ("));
+      Serial.print(pwmSyncPeriod * 1000.0, 2);
+      Serial.println(F(" ms)"));
+      if (statWindow == 0 && pwmSyncPeriod < interval / 1000.0) {
+        Serial.println(F("Note: Data: lines may not keep up, use W:<ticks>"));
+      }
+    } else {
+      Serial.println(F("Error: Use P:<divider>[,<1|8|64>] with a period of 2 ms or more (P:0 = off)"));
+    }
+
+  } else if (inputString.startsWith("V:")) {
+    // Velocity servo setpoint
+    String velStr = inputString.substring(2);
+    int comma = velStr.indexOf(',');
+    float speed = velStr.substring(0, comma).toFloat();
+    int speedup = (comma > 0) ? velStr.substring(comma + 1).toInt() : velSpeedup;
+
+    if (!velReady) {
+      Serial.println(F("Error: Send T: with K > 0 before the velocity servo"));
+    } else if (smithDelay > 0 || ilcTicks > 0 || dobOrder > 0) {
+      Serial.println(F("Error: The velocity servo needs D:0, I:0 and Q:0"));
+    } else if (abs(speed) <= modelK * PWM_MAX && speedup >= 1 && speedup <= 10) {
+      if (speedup != velSpeedup || controlMode != MODE_VELOCITY) {
+        velSpeedup = speedup;
+        velConfigure();
+      }
+      controlMode = MODE_VELOCITY;
+      toptPhase = TOPT_IDLE;
+      velSetpoint = toFx(speed);
+
+      Serial.print(F("Velocity setpoint: "));
+      Serial.print(speed, 1);
+      Serial.print(F(" deg/s (reference time constant "));
+      Serial.print(modelTau / velSpeedup * 1000.0, 0);
+      Serial.println(F(" ms)"));
+    } else {
+      Serial.print(F("Error: Use V:<deg/s>[,<speedup 1-10>] with |deg/s| <= K*255 = "));
+      Serial.println(modelK * PWM_MAX, 0);
+    }
+
+  } else if (inputString.equals("U")) {
+    printDeviceId();
+
+  } else if (inputString.startsWith("U:")) {
+    // Store the device id (EEPROM.put only rewrites changed bytes)
+    long id = inputString.substring(2).toInt();
+
+    if (id > 0) {
+      EEPROM.put(DEVICE_ID_ADDR, DEVICE_ID_MAGIC);
+      EEPROM.put(DEVICE_ID_ADDR + sizeof(DEVICE_ID_MAGIC), (unsigned long)id);
+      deviceId = id;
+      printDeviceId();
+    } else {
+      Serial.println(F("Error: Use U:<id> with 1 <= id <= 2147483647"));
     }
 
   } else if (inputString.equals("S")) {
@@ -261,9 +1412,20 @@ void processSerialCommand() {
     digitalWrite(IN2_PIN, LOW);
     analogWrite(ENA_PIN, 0);
     error_integral = 0;
-    Serial.println("Motor stopped");
+    lqr_integral = 0;
+    toptPhase = TOPT_IDLE;
+    dobReset = true;
+    velSetpoint = 0;
+    velRef = 0;
+    if (ilcTicks > 0) {
+      // End the repeated move like I:0, or the next tick regenerates it
+      reference = ilcBase;
+      reference_fx = toFx(reference);
+      ilcTicks = 0;
+    }
+    Serial.println(F("Motor stopped"));
 
   } else {
-    Serial.println("Unknown command");
+    Serial.println(F("Unknown command"));
   }
 }
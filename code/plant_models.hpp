@@ -0,0 +1,526 @@
+/**
+ * Plant Model Selection - Header-Only C++ Version
+ *
+ * Fits a family of velocity models to the same duty sweep (raw_data_*.csv)
+ * and ranks them:
+ *
+ *   fo        K/(τs+1)                          τ, K
+ *   fopdt     K e^(-θs)/(τs+1)                  τ, K, θ
+ *   so        K/((τs+1)(τ_e s+1))               τ, K, τ_e   (electrical pole)
+ *   friction  fo with Coulomb offset per direction (stiction = Coulomb)
+ *                                               τ, K, c_fwd, c_rev
+ *
+ * Every model is simulated with MotorSim::MotorModel (1 ms steps, duty held
+ * between samples) and compared on what the firmware measures: the encoder
+ * angle difference over each sample interval. Parameters minimize the sum of
+ * squared velocity errors (Nelder-Mead on log-parameters). The velocity
+ * sign is aligned with the duty first, whatever the encoder wiring.
+ *
+ * Ranking:
+ *   AIC = n ln(SSE/n) + 2k,   BIC = n ln(SSE/n) + k ln n
+ *   CV  = blocked cross-validation: the capture is cut into contiguous folds;
+ *         each fold is predicted by a fit to the others (the simulation still
+ *         runs through the whole capture, only the cost is masked)
+ * The model with the lowest CV RMSE is selected; a simpler model within 2%
+ * of it wins the tie.
+ *
+ * The selection is saved as data/<task>/model_<timestamp>.json and loaded
+ * back into the simulator with load_latest_model().
+ *
+ * IMPORTANT:
+ * - This is a HEADER-ONLY library for PC-side tools (DO NOT include in Arduino code)
+ *
+ * Requirements:
+ * - C++17 or higher
+ *
+ * Usage:
+ *   #include "plant_models.hpp"
+ *
+ *   auto data = DataLoader::load_latest_raw_data("1-3");
+ *   auto fits = PlantModels::fit_all(data);
+ *   auto& best = fits[PlantModels::select(fits)];
+ *   MotorSim::MotorModel motor = best.params.make_motor(0.001);
+ */
+
+#ifndef PLANT_MODELS_HPP
+#define PLANT_MODELS_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <limits>
+#include <string>
+#include <thread>
+#include <vector>
+#include "data_loader.hpp"
+#include "friction_id.hpp"
+#include "motor_sim.hpp"
+
+namespace PlantModels {
+
+enum class ModelType { FirstOrder, DeadTime, SecondOrder, Friction };
+
+inline const char* model_name(ModelType type) {
+    switch (type) {
+        case ModelType::FirstOrder: return "fo";
+        case ModelType::DeadTime: return "fopdt";
+        case ModelType::SecondOrder: return "so";
+        default: return "friction";
+    }
+}
+
+inline ModelType parse_model_name(const std::string& name) {
+    if (name == "fo") return ModelType::FirstOrder;
+    if (name == "fopdt") return ModelType::DeadTime;
+    if (name == "so") return ModelType::SecondOrder;
+    if (name == "friction") return ModelType::Friction;
+    throw std::runtime_error("Unknown model: " + name);
+}
+
+/**
+ * One member of the family with its parameters
+ */
+struct ModelParams {
+    ModelType type = ModelType::FirstOrder;
+    double tau = 0.1;
+    double K = 10.0;
+    double dead_time = 0.0;   // s (fopdt)
+    double tau_e = 0.0;       // s (so)
+    double coulomb_fwd = 0.0; // PWM (friction)
+    double coulomb_rev = 0.0;
+
+    int n_params() const {
+        return type == ModelType::Friction ? 4 : (type == ModelType::FirstOrder ? 2 : 3);
+    }
+
+    MotorSim::FrictionParams friction() const {
+        MotorSim::FrictionParams f;
+        if (type == ModelType::Friction) {
+            f.coulomb_fwd = f.stiction_fwd = coulomb_fwd;
+            f.coulomb_rev = f.stiction_rev = coulomb_rev;
+        }
+        return f;
+    }
+
+    /**
+     * Simulator configured for this model
+     */
+    MotorSim::MotorModel make_motor(double dt) const {
+        MotorSim::MotorModel motor(tau, K, dt, friction());
+        if (type == ModelType::DeadTime) {
+            motor.set_dead_time(dead_time);
+        }
+        if (type == ModelType::SecondOrder) {
+            motor.set_electrical_pole(tau_e);
+        }
+        return motor;
+    }
+
+    /**
+     * Free parameters <-> optimizer vector (log scale for positive values)
+     */
+    std::vector<double> to_vector() const {
+        std::vector<double> x = {std::log(tau), std::log(K)};
+        if (type == ModelType::DeadTime) x.push_back(std::log(dead_time + 1e-4));
+        if (type == ModelType::SecondOrder) x.push_back(std::log(tau_e + 1e-4));
+        if (type == ModelType::Friction) {
+            x.push_back(coulomb_fwd);
+            x.push_back(coulomb_rev);
+        }
+        return x;
+    }
+
+    ModelParams from_vector(const std::vector<double>& x) const {
+        ModelParams p = *this;
+        p.tau = std::exp(x[0]);
+        p.K = std::exp(x[1]);
+        if (type == ModelType::DeadTime) p.dead_time = std::max(0.0, std::exp(x[2]) - 1e-4);
+        if (type == ModelType::SecondOrder) p.tau_e = std::max(0.0, std::exp(x[2]) - 1e-4);
+        if (type == ModelType::Friction) {
+            p.coulomb_fwd = std::fabs(x[2]);
+            p.coulomb_rev = std::fabs(x[3]);
+        }
+        return p;
+    }
+};
+
+/**
+ * Predicted sample velocities: angle difference over each sample interval,
+ * with duty[k] applied during (t[k-1], t[k]] as logged by p1-3.cpp
+ */
+inline std::vector<double> predict(const ModelParams& p, const DataLoader::RawData& data,
+                                   double sim_dt = 0.001) {
+    size_t n = data.time.size();
+    std::vector<double> v(n, 0.0);
+    if (n == 0) {
+        return v;
+    }
+    MotorSim::MotorModel motor = p.make_motor(sim_dt);
+    for (size_t k = 1; k < n; ++k) {
+        double interval = data.time[k] - data.time[k - 1];
+        double start = motor.get_position();
+        int steps = std::max(1, static_cast<int>(std::lround(interval / sim_dt)));
+        for (int s = 0; s < steps; ++s) {
+            motor.update(data.duty[k]);
+        }
+        v[k] = (motor.get_position() - start) / interval;
+    }
+    return v;
+}
+
+/**
+ * Sum of squared velocity errors over the samples where mask is true
+ */
+inline double sse(const ModelParams& p, const DataLoader::RawData& data,
+                  const std::vector<bool>& mask, size_t* count = nullptr) {
+    auto v = predict(p, data);
+    double sum = 0.0;
+    size_t n = 0;
+    for (size_t k = 1; k < v.size(); ++k) {
+        if (mask[k]) {
+            double r = data.velocity[k] - v[k];
+            sum += r * r;
+            ++n;
+        }
+    }
+    if (count) {
+        *count = n;
+    }
+    return sum;
+}
+
+/**
+ * Nelder-Mead simplex minimization
+ */
+inline std::vector<double> nelder_mead(const std::function<double(const std::vector<double>&)>& f,
+                                       std::vector<double> x0, double step,
+                                       int max_evals, double tolerance, int* evals_used = nullptr) {
+    size_t n = x0.size();
+    std::vector<std::vector<double>> simplex(n + 1, x0);
+    std::vector<double> values(n + 1);
+    for (size_t i = 0; i < n; ++i) {
+        simplex[i + 1][i] += step;
+    }
+    int evals = 0;
+    for (size_t i = 0; i <= n; ++i) {
+        values[i] = f(simplex[i]);
+        ++evals;
+    }
+
+    auto combine = [&](const std::vector<double>& a, const std::vector<double>& b, double w) {
+        std::vector<double> out(n);
+        for (size_t j = 0; j < n; ++j) {
+            out[j] = a[j] + w * (b[j] - a[j]);
+        }
+        return out;
+    };
+
+    while (evals < max_evals) {
+        std::vector<size_t> order(n + 1);
+        for (size_t i = 0; i <= n; ++i) order[i] = i;
+        std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return values[a] < values[b]; });
+        size_t best = order[0], worst = order[n], second = order[n - 1];
+        if (std::fabs(values[worst] - values[best]) <= tolerance * (std::fabs(values[best]) + 1e-12)) {
+            break;
+        }
+
+        std::vector<double> centroid(n, 0.0);
+        for (size_t i = 0; i <= n; ++i) {
+            if (i == worst) continue;
+            for (size_t j = 0; j < n; ++j) centroid[j] += simplex[i][j] / n;
+        }
+
+        auto reflected = combine(centroid, simplex[worst], -1.0);
+        double fr = f(reflected);
+        ++evals;
+        if (fr < values[best]) {
+            auto expanded = combine(centroid, simplex[worst], -2.0);
+            double fe = f(expanded);
+            ++evals;
+            if (fe < fr) {
+                simplex[worst] = expanded;
+                values[worst] = fe;
+            } else {
+                simplex[worst] = reflected;
+                values[worst] = fr;
+            }
+        } else if (fr < values[second]) {
+            simplex[worst] = reflected;
+            values[worst] = fr;
+        } else {
+            auto contracted = combine(centroid, fr < values[worst] ? reflected : simplex[worst], 0.5);
+            double fc = f(contracted);
+            ++evals;
+            if (fc < std::min(fr, values[worst])) {
+                simplex[worst] = contracted;
+                values[worst] = fc;
+            } else {
+                // Shrink towards the best vertex
+                for (size_t i = 0; i <= n; ++i) {
+                    if (i == best) continue;
+                    simplex[i] = combine(simplex[best], simplex[i], 0.5);
+                    values[i] = f(simplex[i]);
+                    ++evals;
+                }
+            }
+        }
+    }
+
+    size_t best = std::min_element(values.begin(), values.end()) - values.begin();
+    if (evals_used) {
+        *evals_used = evals;
+    }
+    return simplex[best];
+}
+
+struct Options {
+    int folds = 5;             // contiguous CV folds
+    int max_evals = 400;       // Nelder-Mead evaluations per fit
+    double tolerance = 1e-6;
+    double tie_margin = 0.02;  // simpler model wins within 2% CV RMSE
+};
+
+struct FitResult {
+    ModelParams params;
+    size_t samples = 0;
+    double sse = 0.0;
+    double rms = 0.0;          // deg/s
+    double aic = 0.0;
+    double bic = 0.0;
+    double cv_rmse = 0.0;      // deg/s
+    int evaluations = 0;
+};
+
+inline ModelParams fit_model(const ModelParams& start, const DataLoader::RawData& data,
+                             const std::vector<bool>& mask, const Options& opt,
+                             int* evals = nullptr) {
+    auto cost = [&](const std::vector<double>& x) { return sse(start.from_vector(x), data, mask); };
+    auto x = nelder_mead(cost, start.to_vector(), 0.3, opt.max_evals, opt.tolerance, evals);
+    return start.from_vector(x);
+}
+
+/**
+ * Fit one model to the whole capture and cross-validate it
+ */
+inline FitResult evaluate(const ModelParams& start, const DataLoader::RawData& data,
+                          const Options& opt = {}) {
+    size_t n = data.time.size();
+    if (n < 10) {
+        throw std::runtime_error("Not enough samples for model identification");
+    }
+
+    FitResult r;
+    std::vector<bool> all(n, true);
+    all[0] = false;
+    r.params = fit_model(start, data, all, opt, &r.evaluations);
+    r.sse = sse(r.params, data, all, &r.samples);
+    double ns = static_cast<double>(r.samples);
+    double k = r.params.n_params();
+    double mse = std::max(r.sse / ns, 1e-12);
+    r.rms = std::sqrt(mse);
+    r.aic = ns * std::log(mse) + 2.0 * k;
+    r.bic = ns * std::log(mse) + k * std::log(ns);
+
+    // Blocked cross-validation (warm-started from the full fit)
+    int folds = std::max(2, opt.folds);
+    double val_sse = 0.0;
+    size_t val_n = 0;
+    for (int f = 0; f < folds; ++f) {
+        size_t lo = 1 + (n - 1) * f / folds;
+        size_t hi = 1 + (n - 1) * (f + 1) / folds;
+        std::vector<bool> train(n, false), test(n, false);
+        for (size_t i = 1; i < n; ++i) {
+            (i >= lo && i < hi ? test : train)[i] = true;
+        }
+        ModelParams p = fit_model(r.params, data, train, opt);
+        size_t count = 0;
+        val_sse += sse(p, data, test, &count);
+        val_n += count;
+    }
+    r.cv_rmse = std::sqrt(val_sse / std::max<size_t>(1, val_n));
+    return r;
+}
+
+/**
+ * Starting points for the family from a first-order guess (τ, K)
+ */
+inline std::vector<ModelParams> family(double tau, double K, const DataLoader::RawData& data) {
+    ModelParams fo;
+    fo.tau = tau;
+    fo.K = K;
+
+    ModelParams fopdt = fo;
+    fopdt.type = ModelType::DeadTime;
+    fopdt.dead_time = 0.01;
+
+    ModelParams so = fo;
+    so.type = ModelType::SecondOrder;
+    so.tau_e = 0.01;
+
+    ModelParams fr = fo;
+    fr.type = ModelType::Friction;
+    fr.coulomb_fwd = fr.coulomb_rev = 20.0;
+    try {
+        auto friction = FrictionId::identify(data).params();
+        fr.coulomb_fwd = friction.coulomb_fwd;
+        fr.coulomb_rev = friction.coulomb_rev;
+    } catch (const std::exception&) {
+        // Not a friction sweep: keep the generic guess
+    }
+
+    return {fo, fopdt, so, fr};
+}
+
+/**
+ * Flip the velocity sign if it runs against the duty (encoder wiring)
+ */
+inline DataLoader::RawData align_direction(DataLoader::RawData data) {
+    double correlation = 0.0;
+    for (size_t i = 0; i < data.time.size(); ++i) {
+        correlation += data.duty[i] * data.velocity[i];
+    }
+    if (correlation < 0) {
+        for (double& v : data.velocity) {
+            v = -v;
+        }
+    }
+    return data;
+}
+
+/**
+ * Fit and cross-validate every model (one thread per model)
+ */
+inline std::vector<FitResult> fit_all(const DataLoader::RawData& raw, double tau = 0.1,
+                                      double K = 10.0, const Options& opt = {}) {
+    DataLoader::RawData data = align_direction(raw);
+    auto starts = family(tau, K, data);
+
+    // The extended models nest the first-order one: start them from its fit
+    ModelParams fo = fit_model(starts[0], data, std::vector<bool>(data.time.size(), true), opt);
+    for (auto& s : starts) {
+        s.tau = fo.tau;
+        s.K = fo.K;
+    }
+
+    std::vector<FitResult> results(starts.size());
+    std::vector<std::string> errors(starts.size());
+    std::vector<std::thread> workers;
+    for (size_t i = 0; i < starts.size(); ++i) {
+        workers.emplace_back([&, i]() {
+            try {
+                results[i] = evaluate(starts[i], data, opt);
+            } catch (const std::exception& e) {
+                errors[i] = e.what();
+            }
+        });
+    }
+    for (auto& w : workers) {
+        w.join();
+    }
+    for (const auto& e : errors) {
+        if (!e.empty()) {
+            throw std::runtime_error(e);
+        }
+    }
+    return results;
+}
+
+/**
+ * Index of the selected model: lowest CV RMSE, simpler model on a near tie
+ */
+inline size_t select(const std::vector<FitResult>& results, double tie_margin = 0.02) {
+    size_t best = 0;
+    for (size_t i = 1; i < results.size(); ++i) {
+        if (results[i].cv_rmse < results[best].cv_rmse) {
+            best = i;
+        }
+    }
+    size_t chosen = best;
+    for (size_t i = 0; i < results.size(); ++i) {
+        const auto& r = results[i];
+        if (r.cv_rmse <= results[best].cv_rmse * (1.0 + tie_margin) &&
+            r.params.n_params() < results[chosen].params.n_params()) {
+            chosen = i;
+        }
+    }
+    return chosen;
+}
+
+/**
+ * Save the selected model as data/<task>/model_<timestamp>.json
+ */
+inline fs::path save_model(const std::string& task_name, const FitResult& r,
+                           const std::string& source = "") {
+    fs::path data_dir = DataLoader::get_task_data_dir(task_name);
+    fs::create_directories(data_dir);
+
+    std::string timestamp = FrictionId::make_timestamp();
+    fs::path filename = data_dir / ("model_" + timestamp + ".json");
+
+    std::ofstream out(filename);
+    if (!out.is_open()) {
+        throw std::runtime_error("Failed to open file: " + filename.string());
+    }
+    const auto& p = r.params;
+    out << std::setprecision(6);
+    out << "{\n";
+    out << "  \"timestamp\": \"" << timestamp << "\",\n";
+    out << "  \"task\": \"" << task_name << "\",\n";
+    out << "  \"source\": \"" << source << "\",\n";
+    out << "  \"model\": \"" << model_name(p.type) << "\",\n";
+    out << "  \"tau\": " << p.tau << ",\n";
+    out << "  \"K\": " << p.K << ",\n";
+    out << "  \"dead_time\": " << p.dead_time << ",\n";
+    out << "  \"tau_e\": " << p.tau_e << ",\n";
+    out << "  \"coulomb_fwd\": " << p.coulomb_fwd << ",\n";
+    out << "  \"coulomb_rev\": " << p.coulomb_rev << ",\n";
+    out << "  \"rms_dps\": " << r.rms << ",\n";
+    out << "  \"aic\": " << r.aic << ",\n";
+    out << "  \"bic\": " << r.bic << ",\n";
+    out << "  \"cv_rmse_dps\": " << r.cv_rmse << ",\n";
+    out << "  \"samples\": " << r.samples << "\n";
+    out << "}\n";
+
+    return filename;
+}
+
+/**
+ * Load the latest model_*.json of a task
+ */
+inline ModelParams load_latest_model(const std::string& task_name = "1-3", bool verbose = true) {
+    fs::path latest_file = DataLoader::find_latest_file(
+        DataLoader::get_task_data_dir(task_name), "model_");
+
+    std::ifstream file(latest_file);
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to open file: " + latest_file.string());
+    }
+    std::string json((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    ModelParams p;
+    p.type = parse_model_name(DataLoader::extract_json_string(json, "model"));
+    p.tau = DataLoader::extract_json_number(json, "tau");
+    p.K = DataLoader::extract_json_number(json, "K");
+    p.dead_time = DataLoader::extract_json_number(json, "dead_time");
+    p.tau_e = DataLoader::extract_json_number(json, "tau_e");
+    p.coulomb_fwd = DataLoader::extract_json_number(json, "coulomb_fwd");
+    p.coulomb_rev = DataLoader::extract_json_number(json, "coulomb_rev");
+
+    if (verbose) {
+        std::cout << "=== Plant model loaded from " << latest_file.filename().string() << " ===" << std::endl;
+        std::cout << "Model: " << model_name(p.type) << " (τ = " << p.tau << " s, K = " << p.K;
+        if (p.type == ModelType::DeadTime) std::cout << ", θ = " << p.dead_time << " s";
+        if (p.type == ModelType::SecondOrder) std::cout << ", τ_e = " << p.tau_e << " s";
+        if (p.type == ModelType::Friction) {
+            std::cout << ", Coulomb " << p.coulomb_fwd << "/" << p.coulomb_rev << " PWM";
+        }
+        std::cout << ")" << std::endl << std::endl;
+    }
+    return p;
+}
+
+} // namespace PlantModels
+
+#endif // PLANT_MODELS_HPP
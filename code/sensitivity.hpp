@@ -0,0 +1,544 @@
+/**
+ * Global Sensitivity Analysis - Header-Only C++ Version
+ *
+ * Ranks uncertain inputs of the p2-1 position loop by their influence on
+ * the step metrics, so identification effort goes to the inputs that
+ * actually move the predictions.
+ *
+ * Inputs (factors), sampled uniformly over a range each:
+ * - tau, K      plant model (around the identified values)
+ * - deadzone    PWM deadzone of the firmware
+ * - alpha       derivative low-pass coefficient
+ * - jitter      lateness of the 10 ms control tick (0..jitter, uniform)
+ *
+ * Outputs: overshoot (%), settling time (s, the simulated duration if the
+ * loop never settles) and steady-state error (deg) from step_metrics.hpp.
+ *
+ * Two methods:
+ * - Sobol (Saltelli sampling on a Sobol quasi-random sequence): first-order
+ *   index S1 (Saltelli 2010) and total index ST (Jansen) per input with
+ *   bootstrap 95% intervals; N (d + 2) evaluations
+ * - Morris elementary effects: mu* (mean |EE|) and sigma over r one-at-a-time
+ *   trajectories on a 4-level grid; r (d + 1) evaluations, for screening
+ *
+ * Evaluations are spread over all cores. The jitter sequence is the same
+ * for every evaluation (common random numbers), so a model evaluation is a
+ * deterministic function of its inputs.
+ *
+ * IMPORTANT:
+ * - This is a HEADER-ONLY library for PC-side tools (DO NOT include in Arduino code)
+ *
+ * Requirements:
+ * - C++17 or higher
+ *
+ * Usage:
+ *   #include "sensitivity.hpp"
+ *
+ *   auto factors = Sensitivity::default_factors(0.1, 12.0);
+ *   Sensitivity::LoopConfig loop;
+ *   auto model = [&](const std::vector<double>& x) { return Sensitivity::simulate(x, loop); };
+ *   auto s = Sensitivity::sobol(factors, Sensitivity::OUTPUT_COUNT, model, 1024);
+ *   double st_tau = s.indices[Sensitivity::OUT_OVERSHOOT][Sensitivity::TAU].total;
+ */
+
+#ifndef SENSITIVITY_HPP
+#define SENSITIVITY_HPP
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <numeric>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "data_loader.hpp"
+#include "friction_id.hpp"
+#include "motor_sim.hpp"
+#include "step_metrics.hpp"
+
+namespace Sensitivity {
+
+// Factors of the p2-1 loop
+constexpr size_t TAU = 0;
+constexpr size_t GAIN = 1;
+constexpr size_t DEADZONE = 2;
+constexpr size_t ALPHA = 3;
+constexpr size_t JITTER = 4;
+constexpr size_t FACTOR_COUNT = 5;
+
+// Outputs
+constexpr size_t OUT_OVERSHOOT = 0;
+constexpr size_t OUT_SETTLING = 1;
+constexpr size_t OUT_STEADY_STATE = 2;
+constexpr size_t OUTPUT_COUNT = 3;
+
+inline const char* output_name(size_t output) {
+    switch (output) {
+        case OUT_OVERSHOOT: return "overshoot";
+        case OUT_SETTLING: return "settling_time";
+        case OUT_STEADY_STATE: return "steady_state_error";
+        default: return "?";
+    }
+}
+
+/**
+ * An uncertain input and its range
+ */
+struct Factor {
+    std::string name;
+    double low;
+    double high;
+    std::string unit;
+
+    double scale(double u) const { return low + u * (high - low); }
+};
+
+/**
+ * Ranges around an identified model
+ *
+ * @param spread relative half-width for tau and K (0.2 = ±20%)
+ */
+inline std::vector<Factor> default_factors(double tau, double K, double spread = 0.2) {
+    return {
+        {"tau", tau * (1 - spread), tau * (1 + spread), "s"},
+        {"K", K * (1 - spread), K * (1 + spread), "(deg/s)/PWM"},
+        {"deadzone", 30.0, 70.0, "PWM"},
+        {"alpha", 0.05, 0.5, ""},
+        {"jitter", 0.0, 0.002, "s"},
+    };
+}
+
+/**
+ * Closed-loop step of the p2-1 firmware
+ */
+struct LoopConfig {
+    double Kp = 10.0;
+    double Ki = 0.0;
+    double Kd = 0.0;
+    double reference = 200.0;
+    double duration = 2.0;        // s
+    double tick = 0.01;           // p2-1.cpp interval
+    double plant_dt = 0.0002;     // Jitter resolution
+    unsigned jitter_seed = 1;
+};
+
+/**
+ * Step metrics of one parameter set (factors in physical units, FACTOR_COUNT long)
+ */
+inline std::vector<double> simulate(const std::vector<double>& x, const LoopConfig& loop) {
+    MotorSim::MotorModel motor(x[TAU], x[GAIN], loop.plant_dt);
+    MotorSim::PIDController pid(loop.Kp, loop.Ki, loop.Kd, loop.tick, x[ALPHA]);
+    std::mt19937 rng(loop.jitter_seed);
+    std::uniform_real_distribution<double> late(0.0, 1.0);
+
+    size_t steps = static_cast<size_t>(loop.duration / loop.plant_dt);
+    std::vector<double> t, y;
+    t.reserve(static_cast<size_t>(loop.duration / loop.tick) + 1);
+    y.reserve(t.capacity());
+
+    double pwm = 0.0;
+    double next_tick = 0.0;
+    for (size_t k = 0; k < steps; ++k) {
+        double now = k * loop.plant_dt;
+        if (now >= next_tick) {
+            // Same order as the firmware: read, compute, write
+            double position = motor.get_position();
+            pwm = MotorSim::apply_pwm_limits(pid.update(loop.reference - position), x[DEADZONE]);
+            t.push_back(now);
+            y.push_back(position);
+            // millis() scheduling: the next tick is due one interval after this
+            // one ran, plus whatever delays it this time
+            next_tick = now + loop.tick + x[JITTER] * late(rng) - loop.plant_dt / 2;
+        }
+        motor.update(pwm);
+    }
+
+    auto m = StepMetrics::compute(t.data(), y.data(), t.size(), loop.reference);
+    double settling = std::isnan(m.settling_time) ? loop.duration : m.settling_time;
+    return {m.overshoot, settling, m.steady_state_error};
+}
+
+using Model = std::function<std::vector<double>(const std::vector<double>&)>;
+
+/**
+ * Evaluate the model at every point, spread over `threads` workers (0 = all cores)
+ */
+inline std::vector<std::vector<double>> evaluate_all(const std::vector<std::vector<double>>& points,
+                                                     const Model& model, size_t threads = 0) {
+    std::vector<std::vector<double>> results(points.size());
+    std::atomic<size_t> next{0};
+    auto worker = [&]() {
+        for (size_t i = next++; i < points.size(); i = next++) {
+            results[i] = model(points[i]);
+        }
+    };
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    threads = std::min(threads, std::max<size_t>(1, points.size()));
+    std::vector<std::thread> pool;
+    for (size_t i = 1; i < threads; ++i) {
+        pool.emplace_back(worker);
+    }
+    worker();
+    for (auto& th : pool) {
+        th.join();
+    }
+    return results;
+}
+
+/**
+ * Sobol low-discrepancy sequence (Joe-Kuo direction numbers, up to 16 dimensions)
+ *
+ * The all-zero first point is skipped.
+ */
+class SobolSequence {
+public:
+    static constexpr size_t MAX_DIMS = 16;
+
+    explicit SobolSequence(size_t dims) : dims_(dims), x_(dims, 0), v_(dims) {
+        if (dims == 0 || dims > MAX_DIMS) {
+            throw std::runtime_error("Sobol sequence supports 1-16 dimensions");
+        }
+        // s, a, m_1..m_s for dimensions 2..16 (new-joe-kuo-6.21201)
+        static const uint32_t params[MAX_DIMS - 1][8] = {
+            {1, 0, 1},             {2, 1, 1, 3},          {3, 1, 1, 3, 1},
+            {3, 2, 1, 1, 1},       {4, 1, 1, 1, 3, 3},    {4, 4, 1, 3, 5, 13},
+            {5, 2, 1, 1, 5, 5, 17}, {5, 4, 1, 1, 5, 5, 5}, {5, 7, 1, 1, 7, 11, 19},
+            {5, 11, 1, 1, 5, 1, 1}, {5, 13, 1, 1, 1, 3, 11}, {5, 14, 1, 3, 5, 5, 31},
+            {6, 1, 1, 3, 3, 9, 7, 49}, {6, 13, 1, 1, 1, 15, 21, 21}, {6, 16, 1, 3, 1, 13, 27, 49},
+        };
+        for (int i = 0; i < BITS; ++i) {
+            v_[0][i] = 1u << (BITS - 1 - i);
+        }
+        for (size_t j = 1; j < dims; ++j) {
+            const uint32_t* p = params[j - 1];
+            int s = static_cast<int>(p[0]);
+            uint32_t a = p[1];
+            for (int i = 0; i < s; ++i) {
+                v_[j][i] = p[2 + i] << (BITS - 1 - i);
+            }
+            for (int i = s; i < BITS; ++i) {
+                uint32_t v = v_[j][i - s] ^ (v_[j][i - s] >> s);
+                for (int k = 1; k < s; ++k) {
+                    v ^= ((a >> (s - 1 - k)) & 1u) * v_[j][i - k];
+                }
+                v_[j][i] = v;
+            }
+        }
+    }
+
+    std::vector<double> next() {
+        // Gray code order: flip the direction number of the lowest zero bit
+        int c = 0;
+        for (uint32_t n = index_; n & 1u; n >>= 1) {
+            ++c;
+        }
+        ++index_;
+        std::vector<double> point(dims_);
+        for (size_t j = 0; j < dims_; ++j) {
+            x_[j] ^= v_[j][c];
+            point[j] = x_[j] / 4294967296.0;
+        }
+        return point;
+    }
+
+private:
+    static constexpr int BITS = 32;
+    size_t dims_;
+    uint32_t index_ = 0;
+    std::vector<uint32_t> x_;
+    std::vector<std::array<uint32_t, BITS>> v_;
+};
+
+inline std::vector<double> to_physical(const std::vector<Factor>& factors, const double* u) {
+    std::vector<double> x(factors.size());
+    for (size_t i = 0; i < factors.size(); ++i) {
+        x[i] = factors[i].scale(u[i]);
+    }
+    return x;
+}
+
+struct SobolIndex {
+    double first = 0.0;       // S1
+    double total = 0.0;       // ST
+    double first_ci = 0.0;    // 95% half-width (bootstrap)
+    double total_ci = 0.0;
+};
+
+struct SobolResult {
+    size_t samples = 0;                              // N
+    size_t evaluations = 0;                          // N (d + 2)
+    std::vector<double> mean;                        // per output
+    std::vector<double> variance;                    // per output
+    std::vector<std::vector<SobolIndex>> indices;    // [output][factor]
+};
+
+namespace detail {
+
+// S1 and ST of one factor from the rows in `rows`
+inline void sobol_estimate(const std::vector<double>& fA, const std::vector<double>& fB,
+                           const std::vector<double>& fAB, const std::vector<size_t>& rows,
+                           double& first, double& total) {
+    double mean = 0.0;
+    for (size_t r : rows) {
+        mean += fA[r] + fB[r];
+    }
+    mean /= 2.0 * rows.size();
+    double var = 0.0, s1 = 0.0, st = 0.0;
+    for (size_t r : rows) {
+        var += (fA[r] - mean) * (fA[r] - mean) + (fB[r] - mean) * (fB[r] - mean);
+        s1 += fB[r] * (fAB[r] - fA[r]);
+        st += (fA[r] - fAB[r]) * (fA[r] - fAB[r]);
+    }
+    var /= 2.0 * rows.size();
+    if (var <= 0.0) {
+        first = total = 0.0;
+        return;
+    }
+    first = s1 / rows.size() / var;
+    total = 0.5 * st / rows.size() / var;
+}
+
+} // namespace detail
+
+/**
+ * Sobol indices with Saltelli sampling
+ *
+ * @param n base sample count (rounded up to a power of two)
+ * @param bootstrap resamples for the confidence intervals (0 = none)
+ */
+inline SobolResult sobol(const std::vector<Factor>& factors, size_t outputs, const Model& model,
+                         size_t n = 1024, size_t threads = 0, size_t bootstrap = 200,
+                         unsigned seed = 1) {
+    size_t d = factors.size();
+    if (2 * d > SobolSequence::MAX_DIMS) {
+        throw std::runtime_error("Too many factors for the Sobol sequence (max 8)");
+    }
+    size_t pow2 = 1;
+    while (pow2 < n) {
+        pow2 <<= 1;
+    }
+    n = pow2;
+
+    // Rows: A (n), B (n), then AB_i (n each): A with column i from B
+    SobolSequence seq(2 * d);
+    std::vector<std::vector<double>> points(n * (d + 2));
+    for (size_t r = 0; r < n; ++r) {
+        auto u = seq.next();
+        points[r] = to_physical(factors, u.data());
+        points[n + r] = to_physical(factors, u.data() + d);
+        for (size_t i = 0; i < d; ++i) {
+            std::vector<double> ab(u.begin(), u.begin() + d);
+            ab[i] = u[d + i];
+            points[(2 + i) * n + r] = to_physical(factors, ab.data());
+        }
+    }
+    auto values = evaluate_all(points, model, threads);
+
+    SobolResult result;
+    result.samples = n;
+    result.evaluations = points.size();
+    result.mean.assign(outputs, 0.0);
+    result.variance.assign(outputs, 0.0);
+    result.indices.assign(outputs, std::vector<SobolIndex>(d));
+
+    std::vector<size_t> all(n);
+    std::iota(all.begin(), all.end(), 0);
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<size_t> pick(0, n - 1);
+    std::vector<std::vector<size_t>> resamples(bootstrap, std::vector<size_t>(n));
+    for (auto& rows : resamples) {
+        for (auto& r : rows) {
+            r = pick(rng);
+        }
+    }
+
+    std::vector<double> fA(n), fB(n), fAB(n);
+    for (size_t o = 0; o < outputs; ++o) {
+        for (size_t r = 0; r < n; ++r) {
+            fA[r] = values[r][o];
+            fB[r] = values[n + r][o];
+        }
+        double mean = 0.0, var = 0.0;
+        for (size_t r = 0; r < n; ++r) {
+            mean += fA[r] + fB[r];
+        }
+        mean /= 2.0 * n;
+        for (size_t r = 0; r < n; ++r) {
+            var += (fA[r] - mean) * (fA[r] - mean) + (fB[r] - mean) * (fB[r] - mean);
+        }
+        result.mean[o] = mean;
+        result.variance[o] = var / (2.0 * n);
+
+        for (size_t i = 0; i < d; ++i) {
+            for (size_t r = 0; r < n; ++r) {
+                fAB[r] = values[(2 + i) * n + r][o];
+            }
+            SobolIndex& idx = result.indices[o][i];
+            detail::sobol_estimate(fA, fB, fAB, all, idx.first, idx.total);
+
+            if (bootstrap > 1) {
+                std::vector<double> firsts(bootstrap), totals(bootstrap);
+                for (size_t b = 0; b < bootstrap; ++b) {
+                    detail::sobol_estimate(fA, fB, fAB, resamples[b], firsts[b], totals[b]);
+                }
+                auto half_width = [](std::vector<double>& v) {
+                    std::sort(v.begin(), v.end());
+                    size_t lo = static_cast<size_t>(0.025 * (v.size() - 1));
+                    size_t hi = static_cast<size_t>(0.975 * (v.size() - 1));
+                    return (v[hi] - v[lo]) / 2.0;
+                };
+                idx.first_ci = half_width(firsts);
+                idx.total_ci = half_width(totals);
+            }
+        }
+    }
+    return result;
+}
+
+struct MorrisIndex {
+    double mu = 0.0;          // Mean elementary effect (sign shows direction)
+    double mu_star = 0.0;     // Mean |EE|: overall influence
+    double sigma = 0.0;       // Spread of EE: nonlinearity / interactions
+};
+
+struct MorrisResult {
+    size_t trajectories = 0;
+    size_t evaluations = 0;                          // r (d + 1)
+    std::vector<std::vector<MorrisIndex>> indices;   // [output][factor]
+};
+
+/**
+ * Morris elementary effects on a `levels`-level grid
+ *
+ * Effects are per full factor range, so mu* compares across factors.
+ */
+inline MorrisResult morris(const std::vector<Factor>& factors, size_t outputs, const Model& model,
+                           size_t trajectories = 50, size_t levels = 4, size_t threads = 0,
+                           unsigned seed = 1) {
+    size_t d = factors.size();
+    double delta = levels / (2.0 * (levels - 1));
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<size_t> level(0, levels - 1);
+
+    // Each trajectory: base point, then one factor moved by ±delta per step
+    std::vector<std::vector<double>> points;
+    std::vector<std::vector<size_t>> orders(trajectories);
+    std::vector<std::vector<double>> steps(trajectories, std::vector<double>(d));
+    points.reserve(trajectories * (d + 1));
+    for (size_t r = 0; r < trajectories; ++r) {
+        std::vector<double> u(d);
+        for (size_t i = 0; i < d; ++i) {
+            u[i] = static_cast<double>(level(rng)) / (levels - 1);
+            steps[r][i] = (u[i] + delta <= 1.0 + 1e-12) ? delta : -delta;
+        }
+        orders[r].resize(d);
+        std::iota(orders[r].begin(), orders[r].end(), 0);
+        std::shuffle(orders[r].begin(), orders[r].end(), rng);
+
+        points.push_back(to_physical(factors, u.data()));
+        for (size_t i : orders[r]) {
+            u[i] += steps[r][i];
+            points.push_back(to_physical(factors, u.data()));
+        }
+    }
+    auto values = evaluate_all(points, model, threads);
+
+    MorrisResult result;
+    result.trajectories = trajectories;
+    result.evaluations = points.size();
+    result.indices.assign(outputs, std::vector<MorrisIndex>(d));
+    for (size_t o = 0; o < outputs; ++o) {
+        std::vector<std::vector<double>> effects(d);
+        for (size_t r = 0; r < trajectories; ++r) {
+            size_t base = r * (d + 1);
+            for (size_t k = 0; k < d; ++k) {
+                size_t i = orders[r][k];
+                double ee = (values[base + k + 1][o] - values[base + k][o]) / steps[r][i];
+                effects[i].push_back(ee);
+            }
+        }
+        for (size_t i = 0; i < d; ++i) {
+            MorrisIndex& m = result.indices[o][i];
+            for (double ee : effects[i]) {
+                m.mu += ee;
+                m.mu_star += std::fabs(ee);
+            }
+            m.mu /= effects[i].size();
+            m.mu_star /= effects[i].size();
+            for (double ee : effects[i]) {
+                m.sigma += (ee - m.mu) * (ee - m.mu);
+            }
+            m.sigma = effects[i].size() > 1 ? std::sqrt(m.sigma / (effects[i].size() - 1)) : 0.0;
+        }
+    }
+    return result;
+}
+
+/**
+ * Factor indices of one output, most influential first (by ST, or mu* for Morris)
+ */
+inline std::vector<size_t> ranking(const std::vector<SobolIndex>& indices) {
+    std::vector<size_t> order(indices.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(),
+                     [&](size_t a, size_t b) { return indices[a].total > indices[b].total; });
+    return order;
+}
+
+inline std::vector<size_t> ranking(const std::vector<MorrisIndex>& indices) {
+    std::vector<size_t> order(indices.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(),
+                     [&](size_t a, size_t b) { return indices[a].mu_star > indices[b].mu_star; });
+    return order;
+}
+
+/**
+ * Save indices as data/<task>/sensitivity_<timestamp>.csv
+ *
+ * One row per (method, output, factor); empty results are skipped.
+ */
+inline fs::path save_results(const std::string& task_name, const std::vector<Factor>& factors,
+                             const SobolResult* sobol_result, const MorrisResult* morris_result) {
+    fs::path data_dir = DataLoader::get_task_data_dir(task_name);
+    fs::create_directories(data_dir);
+    fs::path filename = data_dir / ("sensitivity_" + FrictionId::make_timestamp() + ".csv");
+
+    std::ofstream out(filename);
+    if (!out.is_open()) {
+        throw std::runtime_error("Failed to open file: " + filename.string());
+    }
+    out << "Method,Output,Factor,Low,High,S1,S1_ci,ST,ST_ci,Mu,MuStar,Sigma\n";
+    if (sobol_result) {
+        for (size_t o = 0; o < sobol_result->indices.size(); ++o) {
+            for (size_t i = 0; i < factors.size(); ++i) {
+                const auto& s = sobol_result->indices[o][i];
+                out << "sobol," << output_name(o) << "," << factors[i].name << ","
+                    << factors[i].low << "," << factors[i].high << "," << s.first << ","
+                    << s.first_ci << "," << s.total << "," << s.total_ci << ",,,\n";
+            }
+        }
+    }
+    if (morris_result) {
+        for (size_t o = 0; o < morris_result->indices.size(); ++o) {
+            for (size_t i = 0; i < factors.size(); ++i) {
+                const auto& m = morris_result->indices[o][i];
+                out << "morris," << output_name(o) << "," << factors[i].name << ","
+                    << factors[i].low << "," << factors[i].high << ",,,,," << m.mu << ","
+                    << m.mu_star << "," << m.sigma << "\n";
+            }
+        }
+    }
+    return filename;
+}
+
+} // namespace Sensitivity
+
+#endif // SENSITIVITY_HPP
@@ -0,0 +1,382 @@
+/**
+ * Serial Port - Header-Only C++ Version
+ *
+ * Minimal line-oriented serial port for PC-side tools that talk to the
+ * sketches' command interface ("R:", "G:", "S", ...).
+ *
+ * IMPORTANT:
+ * - This is a HEADER-ONLY library for PC-side tools (DO NOT include in Arduino code)
+ * - POSIX only (Linux/Mac, e.g. /dev/ttyACM0); on Windows use the Python tools
+ * - Opening the port toggles DTR, which resets the Mega. Pass
+ *   reset_on_open = false to keep HUPCL cleared so later opens don't reset it
+ *   (the first open after boot may still reset, depending on the driver)
+ * - If a device server (device_server.cpp) owns the board, default_port_name()
+ *   returns its Unix socket and Port talks to the server instead: no reset,
+ *   no 2 s wait, and the board keeps its state between tool runs
+ *
+ * Requirements:
+ * - C++17 or higher
+ *
+ * Usage:
+ *   #include "serial_port.hpp"
+ *
+ *   SerialPort::Port port(SerialPort::default_port_name(), 115200);
+ *   port.write_line("G:10,0,0");
+ *   std::string line;
+ *   if (port.read_line(line, 100)) { ... }
+ */
+
+#ifndef SERIAL_PORT_HPP
+#define SERIAL_PORT_HPP
+
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <termios.h>
+#include <unistd.h>
+#endif
+
+namespace SerialPort {
+
+/**
+ * Device name from the COM_MEGA2560 environment variable (same as the Python tools)
+ */
+inline std::string device_name() {
+    const char* env = std::getenv("COM_MEGA2560");
+    if (!env || !*env) {
+        throw std::runtime_error("COM_MEGA2560 environment variable not set");
+    }
+    return env;
+}
+
+/**
+ * Unix socket of the device server for a device
+ *
+ * MOTOR_SERVER_SOCKET overrides the default /tmp/motor_<device>.sock
+ * (src/device_link.py uses the same rule).
+ */
+inline std::string server_socket_path(const std::string& device) {
+    const char* env = std::getenv("MOTOR_SERVER_SOCKET");
+    if (env && *env) {
+        return env;
+    }
+    return "/tmp/motor_" + device.substr(device.find_last_of("/\\") + 1) + ".sock";
+}
+
+#ifndef _WIN32
+
+/**
+ * Connect to a Unix stream socket; -1 if nothing is listening there
+ */
+inline int connect_unix(const std::string& path) {
+    sockaddr_un addr{};
+    if (path.size() >= sizeof(addr.sun_path)) {
+        return -1;
+    }
+    addr.sun_family = AF_UNIX;
+    std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+    int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+inline bool is_socket(const std::string& path) {
+    struct stat st{};
+    return ::stat(path.c_str(), &st) == 0 && S_ISSOCK(st.st_mode);
+}
+
+/**
+ * Port for the tools: the device server's socket when one is running, else the device
+ */
+inline std::string default_port_name() {
+    std::string device = device_name();
+    std::string socket_path = server_socket_path(device);
+    if (is_socket(socket_path)) {
+        int fd = connect_unix(socket_path);
+        if (fd >= 0) {
+            ::close(fd);
+            return socket_path;
+        }
+    }
+    return device;
+}
+
+inline speed_t to_speed(long baud) {
+    switch (baud) {
+        case 9600: return B9600;
+        case 19200: return B19200;
+        case 38400: return B38400;
+        case 57600: return B57600;
+        case 115200: return B115200;
+        case 230400: return B230400;
+#ifdef B500000
+        case 500000: return B500000;
+#endif
+#ifdef B1000000
+        case 1000000: return B1000000;
+#endif
+        default:
+            throw std::runtime_error("Unsupported baud rate: " + std::to_string(baud));
+    }
+}
+
+/**
+ * Raw 8N1 serial port with a line buffer
+ */
+class Port {
+public:
+    Port(const std::string& name, long baud, bool reset_on_open = true) : name_(name) {
+        if (is_socket(name)) {
+            // Device server: lines in both directions, the server owns the baud rate
+            fd_ = connect_unix(name);
+            if (fd_ < 0) {
+                throw std::runtime_error("Device server not running at " + name);
+            }
+            ::fcntl(fd_, F_SETFL, ::fcntl(fd_, F_GETFL) | O_NONBLOCK);
+            server_ = true;
+            return;
+        }
+
+        fd_ = ::open(name.c_str(), O_RDWR | O_NOCTTY | O_NONBLOCK);
+        if (fd_ < 0) {
+            throw std::runtime_error("Failed to open " + name + ": " + std::strerror(errno));
+        }
+
+        termios tio{};
+        if (tcgetattr(fd_, &tio) != 0) {
+            ::close(fd_);
+            throw std::runtime_error("Failed to configure " + name + ": " + std::strerror(errno));
+        }
+        cfmakeraw(&tio);
+        cfsetispeed(&tio, to_speed(baud));
+        cfsetospeed(&tio, to_speed(baud));
+        tio.c_cflag |= CLOCAL | CREAD;
+        if (reset_on_open) {
+            tio.c_cflag |= HUPCL;
+        } else {
+            tio.c_cflag &= ~HUPCL;
+        }
+        tio.c_cc[VMIN] = 0;
+        tio.c_cc[VTIME] = 0;
+        tcsetattr(fd_, TCSANOW, &tio);
+    }
+
+    ~Port() { close(); }
+
+    Port(const Port&) = delete;
+    Port& operator=(const Port&) = delete;
+
+    void close() {
+        if (fd_ >= 0) {
+            ::close(fd_);
+            fd_ = -1;
+        }
+    }
+
+    int fd() const { return fd_; }
+    const std::string& name() const { return name_; }
+
+    /**
+     * Connected through the device server rather than to the device itself
+     */
+    bool is_server() const { return server_; }
+
+    /**
+     * Wait for the sketch to boot after an open that reset it
+     */
+    void wait_for_reset() {
+        if (!server_) {
+            std::this_thread::sleep_for(std::chrono::seconds(2));
+        }
+    }
+
+    /**
+     * Restart the sketch by pulsing DTR (the server pulses it on "#reset")
+     */
+    void pulse_dtr() {
+        if (server_) {
+            write_line("#reset");
+            return;
+        }
+        int dtr = TIOCM_DTR;
+        ::ioctl(fd_, TIOCMBIC, &dtr);
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        ::ioctl(fd_, TIOCMBIS, &dtr);
+    }
+
+    /**
+     * Change the baud rate without closing (closing would reset the Mega)
+     */
+    void set_baud(long baud) {
+        if (server_) {
+            write_line("#baud " + std::to_string(baud));
+            return;
+        }
+        termios tio{};
+        if (tcgetattr(fd_, &tio) != 0) {
+            throw std::runtime_error("Failed to configure " + name_ + ": " + std::strerror(errno));
+        }
+        cfsetispeed(&tio, to_speed(baud));
+        cfsetospeed(&tio, to_speed(baud));
+        tcsetattr(fd_, TCSADRAIN, &tio);
+    }
+
+    /**
+     * Write raw bytes (blocks until all are queued)
+     */
+    void write(const std::string& data) {
+        size_t sent = 0;
+        while (sent < data.size()) {
+            ssize_t n = server_ ? ::send(fd_, data.data() + sent, data.size() - sent, MSG_NOSIGNAL)
+                                : ::write(fd_, data.data() + sent, data.size() - sent);
+            if (n > 0) {
+                sent += static_cast<size_t>(n);
+            } else if (n < 0 && errno != EAGAIN && errno != EINTR) {
+                throw std::runtime_error("Write failed on " + name_ + ": " + std::strerror(errno));
+            } else {
+                pollfd p{fd_, POLLOUT, 0};
+                ::poll(&p, 1, 100);
+            }
+        }
+    }
+
+    void write_line(const std::string& line) { write(line + "\n"); }
+
+    /**
+     * Read whatever is available into the internal buffer
+     *
+     * @return false if the port was closed or failed
+     */
+    bool fill(int timeout_ms) {
+        pollfd p{fd_, POLLIN, 0};
+        int r = ::poll(&p, 1, timeout_ms);
+        if (r < 0) {
+            return errno == EINTR;
+        }
+        if (r == 0) {
+            return true;
+        }
+        if (p.revents & (POLLERR | POLLHUP | POLLNVAL)) {
+            return false;
+        }
+        char chunk[512];
+        ssize_t n = ::read(fd_, chunk, sizeof(chunk));
+        if (n > 0) {
+            buffer_.append(chunk, static_cast<size_t>(n));
+        } else if (n == 0 || (errno != EAGAIN && errno != EINTR)) {
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * Pop one complete line (without "\r\n") from the buffer, waiting up to timeout_ms
+     */
+    bool read_line(std::string& line, int timeout_ms) {
+        if (take_line(line)) {
+            return true;
+        }
+        if (!fill(timeout_ms)) {
+            throw std::runtime_error("Serial port closed: " + name_);
+        }
+        return take_line(line);
+    }
+
+    /**
+     * Drop everything received so far (like pyserial reset_input_buffer())
+     */
+    void reset_input_buffer() {
+        if (server_) {
+            char chunk[512];
+            while (::read(fd_, chunk, sizeof(chunk)) > 0) {
+            }
+        } else {
+            tcflush(fd_, TCIFLUSH);
+        }
+        buffer_.clear();
+    }
+
+    /**
+     * Bytes received but not yet returned as a line
+     */
+    std::string& buffer() { return buffer_; }
+
+private:
+    bool take_line(std::string& line) {
+        while (true) {
+            size_t pos = buffer_.find('\n');
+            if (pos == std::string::npos) {
+                return false;
+            }
+            line.assign(buffer_, 0, pos);
+            buffer_.erase(0, pos + 1);
+            while (!line.empty() && (line.back() == '\r' || line.back() == '\n')) {
+                line.pop_back();
+            }
+            // Server replies start with '#'; sketch output never does
+            if (!server_ || line.empty() || line[0] != '#') {
+                return true;
+            }
+        }
+    }
+
+    std::string name_;
+    int fd_ = -1;
+    bool server_ = false;
+    std::string buffer_;
+};
+
+#else
+
+inline std::string default_port_name() {
+    return device_name();
+}
+
+class Port {
+public:
+    Port(const std::string& name, long, bool = true) : name_(name) {
+        throw std::runtime_error("SerialPort::Port is POSIX only; use the Python tools on Windows");
+    }
+    void close() {}
+    int fd() const { return -1; }
+    const std::string& name() const { return name_; }
+    bool is_server() const { return false; }
+    void wait_for_reset() {}
+    void pulse_dtr() {}
+    void write(const std::string&) {}
+    void write_line(const std::string&) {}
+    void set_baud(long) {}
+    bool fill(int) { return false; }
+    bool read_line(std::string&, int) { return false; }
+    void reset_input_buffer() {}
+    std::string& buffer() { return buffer_; }
+    bool take_line(std::string&) { return false; }
+
+private:
+    std::string name_;
+    std::string buffer_;
+};
+
+#endif
+
+} // namespace SerialPort
+
+#endif // SERIAL_PORT_HPP
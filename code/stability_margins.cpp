@@ -0,0 +1,192 @@
+/**
+ * Batch Stability Margins using stability_margins.hpp
+ *
+ * Screens a grid of PID gains for the p2-1 loop in the frequency domain:
+ * gain, phase and delay margins, sensitivity peak Ms and closed-loop
+ * stability for every set, then lists the fastest sets (highest crossover)
+ * that meet the robustness requirements. All sets are saved to
+ * data/2-1/margins_<timestamp>.csv (NOT for Arduino).
+ *
+ * Compilation:
+ *   g++ -std=c++17 -O2 stability_margins.cpp -o stability_margins -pthread
+ *
+ * Usage:
+ *   ./stability_margins                                  (τ, K from data/1-3)
+ *   ./stability_margins --kp 1,30,60 --ki 0,20,40 --kd 0,2,20 --delay 0.02
+ *   ./stability_margins --check 10,2,0.5                 (one set in detail)
+ *   ./stability_margins --min-pm 50 --min-gm 8 --max-ms 1.8 --top 20
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include "stability_margins.hpp"
+
+namespace {
+
+bool parse_range(const char* text, StabilityMargins::Range& range) {
+    double low, high;
+    int n;
+    if (std::sscanf(text, "%lf,%lf,%d", &low, &high, &n) != 3 || n < 1 || high < low) {
+        return false;
+    }
+    range = {low, high, static_cast<size_t>(n)};
+    return true;
+}
+
+void print_margins(const StabilityMargins::Gains& g, const StabilityMargins::Margins& m) {
+    std::printf("%8.3f %8.3f %8.3f  %-6s %8.2f %8.2f %8.2f %9.4f %6.2f %6.2f\n", g.Kp, g.Ki, g.Kd,
+                m.stable ? "yes" : "NO", m.gain_margin_db(), m.phase_margin, m.crossover,
+                m.delay_margin, m.Ms, m.Mt);
+}
+
+void print_header() {
+    std::printf("%8s %8s %8s  %-6s %8s %8s %8s %9s %6s %6s\n", "Kp", "Ki", "Kd", "Stable", "GM(dB)",
+                "PM(deg)", "wc(r/s)", "DM(s)", "Ms", "Mt");
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    StabilityMargins::LoopModel model;
+    StabilityMargins::Range kp{0.5, 20.0, 40}, ki{0.0, 10.0, 21}, kd{0.0, 1.0, 21};
+    StabilityMargins::Requirements req;
+    bool tau_given = false, K_given = false;
+    bool check_only = false;
+    StabilityMargins::Gains check;
+    size_t points = 400;
+    size_t threads = 0;
+    size_t top = 10;
+
+    for (int i = 1; i < argc; ++i) {
+        bool has_value = i + 1 < argc;
+        if (std::strcmp(argv[i], "--tau") == 0 && has_value) {
+            model.tau = std::atof(argv[++i]);
+            tau_given = true;
+        } else if (std::strcmp(argv[i], "--K") == 0 && has_value) {
+            model.K = std::atof(argv[++i]);
+            K_given = true;
+        } else if (std::strcmp(argv[i], "--delay") == 0 && has_value) {
+            model.dead_time = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--alpha") == 0 && has_value) {
+            model.alpha = std::atof(argv[++i]);
+        } else if ((std::strcmp(argv[i], "--kp") == 0 || std::strcmp(argv[i], "--ki") == 0 ||
+                    std::strcmp(argv[i], "--kd") == 0) && has_value) {
+            auto& range = argv[i][3] == 'p' ? kp : argv[i][3] == 'i' ? ki : kd;
+            if (!parse_range(argv[++i], range)) {
+                std::cerr << "Expected " << argv[i - 1] << " <low>,<high>,<count>" << std::endl;
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--check") == 0 && has_value) {
+            if (std::sscanf(argv[++i], "%lf,%lf,%lf", &check.Kp, &check.Ki, &check.Kd) != 3) {
+                std::cerr << "Expected --check <Kp>,<Ki>,<Kd>" << std::endl;
+                return 1;
+            }
+            check_only = true;
+        } else if (std::strcmp(argv[i], "--min-pm") == 0 && has_value) {
+            req.min_phase_margin = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--min-gm") == 0 && has_value) {
+            req.min_gain_margin_db = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--max-ms") == 0 && has_value) {
+            req.max_Ms = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--points") == 0 && has_value) {
+            points = static_cast<size_t>(std::max(16, std::atoi(argv[++i])));
+        } else if (std::strcmp(argv[i], "--threads") == 0 && has_value) {
+            threads = static_cast<size_t>(std::max(1, std::atoi(argv[++i])));
+        } else if (std::strcmp(argv[i], "--top") == 0 && has_value) {
+            top = static_cast<size_t>(std::max(1, std::atoi(argv[++i])));
+        } else {
+            std::cerr << "Unknown option: " << argv[i] << std::endl;
+            return 1;
+        }
+    }
+
+    std::cout << "========================================" << std::endl;
+    std::cout << "Stability Margins (p2-1 PID loop)" << std::endl;
+    std::cout << "========================================" << std::endl;
+    std::cout << std::endl;
+
+    if (!tau_given || !K_given) {
+        try {
+            auto [tau, K] = DataLoader::load_system_parameters("1-3", false);
+            model.tau = tau_given ? model.tau : tau;
+            model.K = K_given ? model.K : K;
+        } catch (const std::exception&) {
+            std::cout << "No 1-3 summary, using tau = " << model.tau << " s, K = " << model.K
+                      << std::endl;
+        }
+    }
+    if (!(model.tau > 0) || !(model.K > 0)) {
+        std::cerr << "Error: tau and K must be positive" << std::endl;
+        return 1;
+    }
+
+    std::printf("Plant: K/(s(tau s+1)), tau=%.4g s, K=%.4g (deg/s)/PWM, dead time %.3g s\n", model.tau,
+                model.K, model.dead_time);
+    std::printf("PID: T=%.3g s, derivative alpha=%.3g; %zu frequencies up to Nyquist\n", model.T,
+                model.alpha, points);
+    std::printf("Robust: stable, PM >= %.1f deg, GM >= %.1f dB, Ms <= %.2f\n", req.min_phase_margin,
+                req.min_gain_margin_db, req.max_Ms);
+    std::cout << std::endl;
+
+    try {
+        StabilityMargins::Analyzer analyzer(model, points);
+
+        if (check_only) {
+            auto m = analyzer.analyze(check);
+            print_header();
+            print_margins(check, m);
+            if (m.gain_margin_low > 0) {
+                std::printf("Conditionally stable: gain may drop only to %.2fx\n", m.gain_margin_low);
+            }
+            std::cout << (req.met(m) ? "Meets" : "Does NOT meet") << " the robustness requirements"
+                      << std::endl;
+            return 0;
+        }
+
+        auto sets = StabilityMargins::grid(kp, ki, kd);
+        auto start = std::chrono::steady_clock::now();
+        auto margins = analyzer.analyze(sets, threads);
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        size_t stable = 0;
+        std::vector<size_t> robust;
+        for (size_t i = 0; i < sets.size(); ++i) {
+            stable += margins[i].stable ? 1 : 0;
+            if (req.met(margins[i])) {
+                robust.push_back(i);
+            }
+        }
+        std::printf("%zu gain sets in %.3f s (%.0f sets/s)\n", sets.size(), elapsed,
+                    elapsed > 0 ? sets.size() / elapsed : 0.0);
+        std::printf("Stable: %zu, robust: %zu\n", stable, robust.size());
+        std::cout << std::endl;
+
+        // Fastest robust loops first
+        std::sort(robust.begin(), robust.end(), [&](size_t a, size_t b) {
+            return margins[a].crossover > margins[b].crossover;
+        });
+        if (!robust.empty()) {
+            std::cout << "--- Fastest robust gain sets ---" << std::endl;
+            print_header();
+            for (size_t i = 0; i < std::min(top, robust.size()); ++i) {
+                print_margins(sets[robust[i]], margins[robust[i]]);
+            }
+            const auto& best = sets[robust[0]];
+            std::printf("\nSend: G:%.3f,%.3f,%.3f\n", best.Kp, best.Ki, best.Kd);
+        } else {
+            std::cout << "No gain set meets the requirements; widen the grid or relax them" << std::endl;
+        }
+
+        auto path = StabilityMargins::save_results("2-1", model, sets, margins, req);
+        std::cout << std::endl << "Saved: " << path.string() << std::endl;
+
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
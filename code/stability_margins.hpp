@@ -0,0 +1,458 @@
+/**
+ * Stability Margins - Header-Only C++ Version
+ *
+ * Frequency-domain robustness of the p2-1 position loop for many PID gain
+ * sets at once, without a time simulation.
+ *
+ * Open loop L(z) = C(z) G(z) e^(-jω θ) at z = e^(jωT), T = 10 ms:
+ * - G(z): position plant K/(s(τs+1)) discretized with a zero-order hold
+ *         (the PWM is held for one tick), same matrices as the p2-1 observer
+ * - θ:    dead time beyond the hold (dead_time_id.cpp)
+ * - C(z): the firmware PID, backward-Euler integral and filtered difference
+ *         derivative with coefficient alpha:
+ *           C = Kp + Ki T z/(z-1) + Kd α (z-1) / (T (z - (1-α)))
+ *
+ * Per gain set:
+ * - gain margin    1/|L| where L crosses the negative real axis with |L| < 1
+ *                  (the lowest one); gain_margin_low is the largest 1/|L| of
+ *                  crossings with |L| > 1 (how far the gain may drop)
+ * - phase margin   180° + ∠L at the lowest |L| = 1 crossing
+ * - delay margin   extra dead time the loop tolerates: min over crossovers
+ *                  of PM / ω_c
+ * - Ms, Mt         peaks of |1/(1+L)| and |L/(1+L)|
+ * - stable         closed-loop poles inside the unit circle (Schur-Cohn test
+ *                  on the characteristic polynomial, θ rounded to ticks)
+ *
+ * The deadzone and PWM saturation are not part of this linear analysis.
+ *
+ * L is linear in the gains, L = Kp·A + Ki·B + Kd·D with A, B, D fixed per
+ * frequency, so a batch precomputes A, B, D once and evaluates gain sets in
+ * blocks laid out for the compiler's vectorizer, spread over all cores.
+ *
+ * IMPORTANT:
+ * - This is a HEADER-ONLY library for PC-side tools (DO NOT include in Arduino code)
+ *
+ * Requirements:
+ * - C++17 or higher
+ *
+ * Usage:
+ *   #include "stability_margins.hpp"
+ *
+ *   StabilityMargins::LoopModel model{0.1, 12.0};
+ *   StabilityMargins::Analyzer analyzer(model);
+ *   auto m = analyzer.analyze({10.0, 2.0, 0.5});
+ *   auto all = analyzer.analyze(StabilityMargins::grid({2, 20, 10}, {0, 10, 10}, {0, 2, 10}));
+ */
+
+#ifndef STABILITY_MARGINS_HPP
+#define STABILITY_MARGINS_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <complex>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "data_loader.hpp"
+#include "friction_id.hpp"
+#include "output_writer.hpp"
+
+namespace StabilityMargins {
+
+constexpr double PI = 3.14159265358979323846;
+constexpr double INF = std::numeric_limits<double>::infinity();
+
+/**
+ * Plant and firmware constants of the loop
+ */
+struct LoopModel {
+    double tau = 0.1;         // s
+    double K = 10.0;          // (deg/s)/PWM
+    double T = 0.01;          // s, control tick (p2-1.cpp interval)
+    double alpha = 0.2;       // derivative filter (p2-1.cpp alpha)
+    double dead_time = 0.0;   // s, beyond the zero-order hold
+};
+
+struct Gains {
+    double Kp = 0.0;
+    double Ki = 0.0;
+    double Kd = 0.0;
+};
+
+struct Margins {
+    bool stable = false;
+    double gain_margin = INF;       // ratio, INF if |L| never crosses -1 from inside
+    double gain_margin_low = 0.0;   // ratio < 1, 0 if none
+    double phase_margin = INF;      // deg, INF if |L| never reaches 1
+    double crossover = 0.0;         // rad/s, lowest gain crossover
+    double delay_margin = INF;      // s
+    double Ms = 0.0;                // sensitivity peak
+    double Mt = 0.0;                // complementary sensitivity peak
+
+    double gain_margin_db() const { return 20.0 * std::log10(gain_margin); }
+};
+
+/**
+ * Gains as a 1-D range: n values from low to high (n = 1 -> low)
+ */
+struct Range {
+    double low = 0.0;
+    double high = 0.0;
+    size_t n = 1;
+
+    double at(size_t i) const {
+        return n > 1 ? low + (high - low) * static_cast<double>(i) / static_cast<double>(n - 1) : low;
+    }
+};
+
+/**
+ * Full factorial grid of gain sets (Kp fastest)
+ */
+inline std::vector<Gains> grid(const Range& kp, const Range& ki, const Range& kd) {
+    std::vector<Gains> sets;
+    sets.reserve(kp.n * ki.n * kd.n);
+    for (size_t c = 0; c < kd.n; ++c) {
+        for (size_t b = 0; b < ki.n; ++b) {
+            for (size_t a = 0; a < kp.n; ++a) {
+                sets.push_back({kp.at(a), ki.at(b), kd.at(c)});
+            }
+        }
+    }
+    return sets;
+}
+
+// ============================================================================
+// Closed-loop stability (Schur-Cohn)
+// ============================================================================
+
+using Poly = std::vector<double>;  // Coefficients, lowest power first
+
+inline Poly poly_mul(const Poly& a, const Poly& b) {
+    Poly c(a.size() + b.size() - 1, 0.0);
+    for (size_t i = 0; i < a.size(); ++i) {
+        for (size_t j = 0; j < b.size(); ++j) {
+            c[i + j] += a[i] * b[j];
+        }
+    }
+    return c;
+}
+
+inline Poly poly_add(Poly a, const Poly& b, double scale = 1.0) {
+    if (a.size() < b.size()) {
+        a.resize(b.size(), 0.0);
+    }
+    for (size_t i = 0; i < b.size(); ++i) {
+        a[i] += scale * b[i];
+    }
+    return a;
+}
+
+/**
+ * True if every root of p lies strictly inside the unit circle
+ *
+ * Schur-Cohn recursion: with k = p0/pn, (p - k·reverse(p))/z has one degree
+ * less and the same number of roots outside the circle as long as |k| < 1.
+ */
+inline bool schur_stable(Poly p) {
+    while (p.size() > 1 && std::fabs(p.back()) < 1e-300) {
+        p.pop_back();
+    }
+    double scale = 0.0;
+    for (double c : p) {
+        scale = std::max(scale, std::fabs(c));
+    }
+    while (p.size() > 1) {
+        size_t n = p.size() - 1;
+        double k = p[0] / p[n];
+        if (!(std::fabs(k) < 1.0 - 1e-12)) {
+            return false;
+        }
+        Poly next(n);
+        for (size_t i = 0; i < n; ++i) {
+            next[i] = p[i + 1] - k * p[n - 1 - i];
+        }
+        p.swap(next);
+        if (std::fabs(p.back()) < 1e-14 * scale) {
+            return false;  // Root on the circle
+        }
+    }
+    return true;
+}
+
+// ============================================================================
+// Analyzer
+// ============================================================================
+
+class Analyzer {
+public:
+    /**
+     * @param points frequencies, log-spaced from w_min to just below Nyquist
+     */
+    explicit Analyzer(const LoopModel& model, size_t points = 400, double w_min = 0.1)
+        : model_(model) {
+        double T = model.T;
+        double w_max = 0.999 * PI / T;
+        points = std::max<size_t>(points, 16);
+
+        double a22 = std::exp(-T / model.tau);
+        double a12 = model.tau * (1.0 - a22);
+        b1_ = model.K * (T - a12);
+        b2_ = model.K * (1.0 - a22);
+        a22_ = a22;
+        a12_ = a12;
+
+        w_.resize(points);
+        A_re_.resize(points); A_im_.resize(points);
+        B_re_.resize(points); B_im_.resize(points);
+        D_re_.resize(points); D_im_.resize(points);
+        using C = std::complex<double>;
+        double c = 1.0 - model.alpha;
+        for (size_t k = 0; k < points; ++k) {
+            double w = w_min * std::pow(w_max / w_min, static_cast<double>(k) / (points - 1));
+            w_[k] = w;
+            C z = std::polar(1.0, w * T);
+            C G = plant(z) * std::polar(1.0, -w * model.dead_time);
+            C I = T * z / (z - 1.0);
+            C D = model.alpha * (z - 1.0) / (T * (z - c));
+            A_re_[k] = G.real(); A_im_[k] = G.imag();
+            B_re_[k] = (I * G).real(); B_im_[k] = (I * G).imag();
+            D_re_[k] = (D * G).real(); D_im_[k] = (D * G).imag();
+        }
+    }
+
+    const LoopModel& model() const { return model_; }
+    const std::vector<double>& frequencies() const { return w_; }
+
+    /**
+     * ZOH position plant: θ = b1 u + a12 ω, ω' = a22 ω + b2 u
+     *   G(z) = (b1 z + a12 b2 - a22 b1) / ((z - 1)(z - a22))
+     */
+    std::complex<double> plant(std::complex<double> z) const {
+        return (b1_ * z + (a12_ * b2_ - a22_ * b1_)) / ((z - 1.0) * (z - a22_));
+    }
+
+    /**
+     * Open loop at grid point k
+     */
+    std::complex<double> open_loop(const Gains& g, size_t k) const {
+        return {g.Kp * A_re_[k] + g.Ki * B_re_[k] + g.Kd * D_re_[k],
+                g.Kp * A_im_[k] + g.Ki * B_im_[k] + g.Kd * D_im_[k]};
+    }
+
+    /**
+     * Closed-loop characteristic polynomial with θ rounded to whole ticks
+     */
+    Poly characteristic(const Gains& g) const {
+        double T = model_.T;
+        double c = 1.0 - model_.alpha;
+        int d = static_cast<int>(std::lround(model_.dead_time / T));
+        Poly num_G = {a12_ * b2_ - a22_ * b1_, b1_};
+        Poly den_G = poly_mul({-1.0, 1.0}, {-a22_, 1.0});
+
+        // C = N / Q; without an integral the (z - 1) factor cancels
+        Poly N, Q;
+        if (g.Ki != 0.0) {
+            N = poly_mul({-1.0, 1.0}, {-c, 1.0});
+            for (double& x : N) x *= g.Kp;
+            N = poly_add(N, poly_mul({0.0, g.Ki * T}, {-c, 1.0}));
+            N = poly_add(N, poly_mul({-1.0, 1.0}, {-1.0, 1.0}), g.Kd * model_.alpha / T);
+            Q = poly_mul({-1.0, 1.0}, {-c, 1.0});
+        } else {
+            N = {-c * g.Kp, g.Kp};
+            N = poly_add(N, {-1.0, 1.0}, g.Kd * model_.alpha / T);
+            Q = {-c, 1.0};
+        }
+        Poly delay(d + 1, 0.0);
+        delay[d] = 1.0;
+        return poly_add(poly_mul(poly_mul(delay, Q), den_G), poly_mul(N, num_G));
+    }
+
+    /**
+     * Margins of one gain set
+     */
+    Margins analyze(const Gains& g) const {
+        std::vector<Margins> out(1);
+        analyze_block(&g, 1, out.data());
+        return out[0];
+    }
+
+    /**
+     * Margins of every gain set, over `threads` workers (0 = all cores)
+     */
+    std::vector<Margins> analyze(const std::vector<Gains>& sets, size_t threads = 0) const {
+        std::vector<Margins> out(sets.size());
+        size_t blocks = (sets.size() + BLOCK - 1) / BLOCK;
+        std::atomic<size_t> next{0};
+        auto worker = [&]() {
+            for (size_t b = next++; b < blocks; b = next++) {
+                size_t begin = b * BLOCK;
+                size_t n = std::min(BLOCK, sets.size() - begin);
+                analyze_block(sets.data() + begin, n, out.data() + begin);
+            }
+        };
+        if (threads == 0) {
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        }
+        threads = std::min(threads, std::max<size_t>(1, blocks));
+        std::vector<std::thread> pool;
+        for (size_t i = 1; i < threads; ++i) {
+            pool.emplace_back(worker);
+        }
+        worker();
+        for (auto& th : pool) {
+            th.join();
+        }
+        return out;
+    }
+
+private:
+    static constexpr size_t BLOCK = 64;
+
+    /**
+     * Sweep the grid once for up to BLOCK gain sets
+     *
+     * The per-frequency evaluation runs over contiguous arrays (vectorized);
+     * crossings are rare and handled per set.
+     */
+    void analyze_block(const Gains* sets, size_t n, Margins* out) const {
+        double kp[BLOCK], ki[BLOCK], kd[BLOCK];
+        double re[BLOCK], im[BLOCK], mag2[BLOCK], s_inv2[BLOCK];
+        double prev_re[BLOCK], prev_im[BLOCK], prev_mag2[BLOCK];
+        double min_s2[BLOCK], max_t2[BLOCK];
+        for (size_t i = 0; i < n; ++i) {
+            kp[i] = sets[i].Kp;
+            ki[i] = sets[i].Ki;
+            kd[i] = sets[i].Kd;
+            min_s2[i] = INF;   // min |1+L|²
+            max_t2[i] = 0.0;   // max |L/(1+L)|²
+            out[i] = Margins{};
+        }
+
+        for (size_t k = 0; k < w_.size(); ++k) {
+            const double ar = A_re_[k], ai = A_im_[k];
+            const double br = B_re_[k], bi = B_im_[k];
+            const double dr = D_re_[k], di = D_im_[k];
+            for (size_t i = 0; i < n; ++i) {
+                double r = kp[i] * ar + ki[i] * br + kd[i] * dr;
+                double m = kp[i] * ai + ki[i] * bi + kd[i] * di;
+                re[i] = r;
+                im[i] = m;
+                mag2[i] = r * r + m * m;
+                s_inv2[i] = (1.0 + r) * (1.0 + r) + m * m;
+                min_s2[i] = std::min(min_s2[i], s_inv2[i]);
+                max_t2[i] = std::max(max_t2[i], mag2[i] / s_inv2[i]);
+            }
+            if (k > 0) {
+                for (size_t i = 0; i < n; ++i) {
+                    bool gain_cross = (prev_mag2[i] - 1.0) * (mag2[i] - 1.0) <= 0.0 && prev_mag2[i] != mag2[i];
+                    bool axis_cross = (prev_im[i] <= 0.0) != (im[i] <= 0.0);
+                    if (gain_cross || axis_cross) {
+                        crossings(k, prev_re[i], prev_im[i], prev_mag2[i], re[i], im[i], mag2[i],
+                                  gain_cross, axis_cross, out[i]);
+                    }
+                }
+            }
+            std::copy(re, re + n, prev_re);
+            std::copy(im, im + n, prev_im);
+            std::copy(mag2, mag2 + n, prev_mag2);
+        }
+
+        for (size_t i = 0; i < n; ++i) {
+            out[i].Ms = 1.0 / std::sqrt(min_s2[i]);
+            out[i].Mt = std::sqrt(max_t2[i]);
+            out[i].stable = schur_stable(characteristic(sets[i]));
+        }
+    }
+
+    /**
+     * Interpolate crossings between grid points k-1 and k (linear in log ω)
+     */
+    void crossings(size_t k, double r0, double i0, double m0, double r1, double i1, double m1,
+                   bool gain_cross, bool axis_cross, Margins& out) const {
+        double lw0 = std::log(w_[k - 1]), lw1 = std::log(w_[k]);
+        if (gain_cross) {
+            // |L| = 1 on a log-magnitude line
+            double l0 = 0.5 * std::log(m0), l1 = 0.5 * std::log(m1);
+            double f = (l1 != l0) ? l0 / (l0 - l1) : 0.0;
+            double re = r0 + f * (r1 - r0), im = i0 + f * (i1 - i0);
+            double w = std::exp(lw0 + f * (lw1 - lw0));
+            double pm = std::atan2(im, re) * 180.0 / PI + 180.0;  // Angle from the -1 direction
+            if (pm > 180.0) {
+                pm -= 360.0;
+            }
+            if (out.crossover == 0.0) {
+                out.crossover = w;
+                out.phase_margin = pm;
+            }
+            double dm = pm > 0 ? pm * PI / 180.0 / w : 0.0;
+            out.delay_margin = std::min(out.delay_margin, dm);
+        }
+        if (axis_cross) {
+            double f = (i1 != i0) ? i0 / (i0 - i1) : 0.0;
+            double re = r0 + f * (r1 - r0);
+            if (re < 0.0) {
+                double gm = -1.0 / re;
+                if (gm > 1.0) {
+                    out.gain_margin = std::min(out.gain_margin, gm);
+                } else {
+                    out.gain_margin_low = std::max(out.gain_margin_low, gm);
+                }
+            }
+        }
+    }
+
+    LoopModel model_;
+    double a22_ = 0.0, a12_ = 0.0, b1_ = 0.0, b2_ = 0.0;
+    std::vector<double> w_;
+    std::vector<double> A_re_, A_im_, B_re_, B_im_, D_re_, D_im_;
+};
+
+/**
+ * Robustness requirements for screening
+ */
+struct Requirements {
+    double min_phase_margin = 45.0;   // deg
+    double min_gain_margin_db = 6.0;
+    double max_Ms = 2.0;
+
+    bool met(const Margins& m) const {
+        return m.stable && m.phase_margin >= min_phase_margin &&
+               m.gain_margin_db() >= min_gain_margin_db && m.Ms <= max_Ms;
+    }
+};
+
+/**
+ * Save every gain set as data/<task>/margins_<timestamp>.csv
+ */
+inline fs::path save_results(const std::string& task_name, const LoopModel& model,
+                             const std::vector<Gains>& sets, const std::vector<Margins>& margins,
+                             const Requirements& req) {
+    fs::path data_dir = DataLoader::get_task_data_dir(task_name);
+    fs::create_directories(data_dir);
+    fs::path filename = data_dir / ("margins_" + FrictionId::make_timestamp() + ".csv");
+
+    // Large grids: block-buffered, 6 significant digits like the old stream output
+    OutputWriter::CsvWriter out(filename, {}, 6);
+    std::ostringstream comment;
+    comment << "tau=" << model.tau << " K=" << model.K << " T=" << model.T << " alpha=" << model.alpha
+            << " dead_time=" << model.dead_time;
+    out.comment(comment.str());
+    out.row("Kp", "Ki", "Kd", "Stable", "GainMargin_dB", "PhaseMargin_deg", "Crossover_rad_s",
+            "DelayMargin_s", "Ms", "Mt", "Robust");
+    for (size_t i = 0; i < sets.size(); ++i) {
+        const auto& g = sets[i];
+        const auto& m = margins[i];
+        out.row(g.Kp, g.Ki, g.Kd, m.stable ? 1 : 0, m.gain_margin_db(), m.phase_margin, m.crossover,
+                m.delay_margin, m.Ms, m.Mt, req.met(m) ? 1 : 0);
+    }
+    out.close();
+    return filename;
+}
+
+} // namespace StabilityMargins
+
+#endif // STABILITY_MARGINS_HPP
@@ -0,0 +1,113 @@
+/**
+ * Step Response Metrics - Header-Only C++ Version
+ *
+ * Same definitions as the Python tools:
+ * - overshoot:      (peak - reference) / reference * 100   (plotter_pid.py)
+ * - settling time:  time after the last sample outside the ±2% band
+ *                   (plotter_pid.py; the Python simulation uses first entry)
+ * - rise time:      10% -> 90% of the reference (tune_kp.py)
+ * - steady-state error: reference - mean of the last 10% of samples (tune_kp.py)
+ *
+ * Times are relative to the first sample.
+ *
+ * IMPORTANT:
+ * - This is a HEADER-ONLY library for PC-side tools (DO NOT include in Arduino code)
+ *
+ * Requirements:
+ * - C++17 or higher
+ *
+ * Usage:
+ *   #include "step_metrics.hpp"
+ *
+ *   auto m = StepMetrics::compute(t.data(), y.data(), t.size(), 200.0);
+ */
+
+#ifndef STEP_METRICS_HPP
+#define STEP_METRICS_HPP
+
+#include <cmath>
+#include <cstddef>
+#include <limits>
+
+namespace StepMetrics {
+
+struct Metrics {
+    double overshoot = 0.0;            // %
+    double settling_time = std::numeric_limits<double>::quiet_NaN();  // s, NaN if never settled
+    double rise_time = std::numeric_limits<double>::quiet_NaN();      // s
+    double steady_state_error = 0.0;   // same unit as y
+    double peak = 0.0;
+};
+
+/**
+ * Compute step metrics of y(t) towards `reference` (reference != 0)
+ *
+ * @param band settling band as a fraction of the reference (0.02 = 2%)
+ */
+inline Metrics compute(const double* t, const double* y, size_t n, double reference,
+                       double band = 0.02) {
+    Metrics m;
+    if (n == 0 || reference == 0.0) {
+        return m;
+    }
+
+    double sign = reference > 0 ? 1.0 : -1.0;
+    double peak = y[0];
+    for (size_t i = 1; i < n; ++i) {
+        if (sign * y[i] > sign * peak) {
+            peak = y[i];
+        }
+    }
+    m.peak = peak;
+    if (sign * (peak - reference) > 0) {
+        m.overshoot = (peak - reference) / reference * 100.0;
+    }
+
+    // Settling: last sample outside the band
+    double threshold = band * std::fabs(reference);
+    size_t last_outside = n;
+    for (size_t i = n; i-- > 0;) {
+        if (std::fabs(y[i] - reference) > threshold) {
+            last_outside = i;
+            break;
+        }
+    }
+    if (last_outside == n) {
+        m.settling_time = 0.0;
+    } else if (last_outside + 1 < n) {
+        m.settling_time = t[last_outside + 1] - t[0];
+    }
+
+    // Rise time: 10% -> 90%
+    double t10 = -1, t90 = -1;
+    for (size_t i = 0; i < n; ++i) {
+        double frac = y[i] / reference;
+        if (t10 < 0 && frac >= 0.1) {
+            t10 = t[i];
+        }
+        if (frac >= 0.9) {
+            t90 = t[i];
+            break;
+        }
+    }
+    if (t10 >= 0 && t90 >= 0) {
+        m.rise_time = t90 - t10;
+    }
+
+    // Steady-state error: mean of the last 10%
+    size_t start = static_cast<size_t>(n * 0.9);
+    if (start >= n) {
+        start = n - 1;
+    }
+    double sum = 0.0;
+    for (size_t i = start; i < n; ++i) {
+        sum += y[i];
+    }
+    m.steady_state_error = reference - sum / (n - start);
+
+    return m;
+}
+
+} // namespace StepMetrics
+
+#endif // STEP_METRICS_HPP
@@ -0,0 +1,293 @@
+// Serial Link Throughput Self-Benchmark
+// Emits synthetic telemetry in the line layouts of the sketches at a
+// commanded rate while a dummy 10 ms control task runs, and reports how
+// many control deadlines were missed. Driven by code/link_bench.cpp.
+//
+// Usage:
+//   - Upload this code with: python run.py link
+//   - Run the host side: ./link_bench --bauds 57600,115200,230400
+//
+// Commands:
+//   B:<baud>  - Switch baud rate (acknowledged at the old rate)
+//   X:<format>,<lines_per_s>,<duration_ms> - Run one benchmark step
+//               format: 0 = p2-1 Data:, 1 = p1-3 Data:, 2 = kp Data:,
+//                       3 = p2-1 Stat:
+//   S         - Abort the running step
+//
+// Benchmark lines replace the Time field by "<seq>,<t_us>" so the host can
+// detect lost lines and measure latency:
+//   Data:<seq>,<t_us>,<fields of the format>
+// Each step ends with
+//   Bench:<format>,<rate>,<sent>,<ticks>,<misses>,<max_late_us>,<max_tick_us>
+
+#include <Arduino.h>
+
+// Dummy control task (10 ms tick, CPU time of the p2-1 PID/encoder path)
+const unsigned long TICK_US = 10000;
+const unsigned long CONTROL_US = 450;
+const unsigned long DEADLINE_SLACK_US = 1000;  // Later than this = missed
+
+// Formats
+const int FORMAT_P2_1 = 0;
+const int FORMAT_P1_3 = 1;
+const int FORMAT_KP = 2;
+const int FORMAT_STAT = 3;
+
+// Benchmark state
+bool running = false;
+int format = FORMAT_P2_1;
+long rate = 0;                  // lines per second
+unsigned long linePeriodUs = 0;
+unsigned long stepStartMs = 0;
+unsigned long durationMs = 0;
+unsigned long nextTickUs = 0;
+unsigned long nextLineUs = 0;
+unsigned long seq = 0;
+unsigned long ticks = 0;
+unsigned long misses = 0;
+unsigned long maxLateUs = 0;
+unsigned long maxTickUs = 0;
+volatile float dummyState = 0.0;
+
+// Serial command parsing
+String inputString = "";
+bool stringComplete = false;
+
+// Function declarations
+void processSerialCommand();
+void controlTask();
+void sendLine(unsigned long now);
+void finishStep();
+
+void setup() {
+  Serial.begin(115200);
+  delay(2000);
+
+  // Send task identifier
+  Serial.println("TASK:link");
+
+  Serial.println("Link Benchmark Started");
+  Serial.println("Commands:");
+  Serial.println("  B:<baud> - Switch baud rate");
+  Serial.println("  X:<format>,<lines_per_s>,<duration_ms> - Run one step");
+  Serial.println("  S - Abort");
+  Serial.println("");
+
+  inputString.reserve(50);
+}
+
+void loop() {
+  if (stringComplete) {
+    processSerialCommand();
+    inputString = "";
+    stringComplete = false;
+  }
+
+  if (!running) {
+    return;
+  }
+
+  unsigned long now = micros();
+
+  // Control task first: it has the deadline
+  if ((long)(now - nextTickUs) >= 0) {
+    unsigned long late = now - nextTickUs;
+    if (late > maxLateUs) {
+      maxLateUs = late;
+    }
+    if (late > DEADLINE_SLACK_US) {
+      misses++;
+    }
+    // Skipped ticks count as missed too; realign instead of bursting
+    unsigned long skipped = late / TICK_US;
+    misses += skipped;
+    nextTickUs += (skipped + 1) * TICK_US;
+
+    controlTask();
+    ticks++;
+    unsigned long tickUs = micros() - now;
+    if (tickUs > maxTickUs) {
+      maxTickUs = tickUs;
+    }
+  }
+
+  now = micros();
+  if ((long)(now - nextLineUs) >= 0) {
+    sendLine(now);
+    nextLineUs += linePeriodUs;
+    // Behind by more than a period: the link is saturated, don't burst
+    if ((long)(micros() - nextLineUs) > (long)linePeriodUs) {
+      nextLineUs = micros() + linePeriodUs;
+    }
+  }
+
+  if (millis() - stepStartMs >= durationMs) {
+    finishStep();
+  }
+}
+
+void controlTask() {
+  // Float work standing in for the encoder read, PID and PWM update
+  unsigned long start = micros();
+  float x = dummyState;
+  while (micros() - start < CONTROL_US) {
+    x = x * 0.999 + 0.1;
+  }
+  dummyState = x;
+}
+
+void sendLine(unsigned long now) {
+  // Values in the ranges the real sketches print (digit counts matter)
+  float position = 180.0 + (seq % 400) * 0.1;
+  float error = 20.0 - (seq % 400) * 0.1;
+
+  if (format == FORMAT_STAT) {
+    Serial.print("Stat:");
+  } else {
+    Serial.print("Data:");
+  }
+  Serial.print(seq);
+  Serial.print(",");
+  Serial.print(now);
+
+  if (format == FORMAT_P2_1) {
+    // Position,Reference,Error,ControlSignal,Ref+15%,Ref+2%,Ref-2%
+    Serial.print(",");
+    Serial.print(position, 2);
+    Serial.print(",");
+    Serial.print(200.0, 2);
+    Serial.print(",");
+    Serial.print(error, 2);
+    Serial.print(",");
+    Serial.print(error * 10.0, 2);
+    Serial.print(",");
+    Serial.print(230.0, 2);
+    Serial.print(",");
+    Serial.print(204.0, 2);
+    Serial.print(",");
+    Serial.print(196.0, 2);
+  } else if (format == FORMAT_P1_3) {
+    // Duty,Velocity
+    Serial.print(",");
+    Serial.print(200);
+    Serial.print(",");
+    Serial.print(position * 8.0, 2);
+  } else if (format == FORMAT_KP) {
+    // Position,Reference
+    Serial.print(",");
+    Serial.print(position, 2);
+    Serial.print(",");
+    Serial.print(200.0, 2);
+  } else {
+    // <t_end>,<n>, then min,max,mean,var of position, velocity, error, control
+    Serial.print(",");
+    Serial.print(now + 1000000UL);
+    Serial.print(",");
+    Serial.print(100);
+    float signals[4] = {position, position * 8.0f, error, error * 10.0f};
+    for (int i = 0; i < 4; i++) {
+      Serial.print(",");
+      Serial.print(signals[i] - 5.0, 2);
+      Serial.print(",");
+      Serial.print(signals[i] + 5.0, 2);
+      Serial.print(",");
+      Serial.print(signals[i], 2);
+      Serial.print(",");
+      Serial.print(2.5, 3);
+    }
+  }
+  Serial.println();
+  seq++;
+}
+
+void finishStep() {
+  running = false;
+  Serial.flush();  // Summary must not be stuck behind a full TX ring
+  Serial.print("Bench:");
+  Serial.print(format);
+  Serial.print(",");
+  Serial.print(rate);
+  Serial.print(",");
+  Serial.print(seq);
+  Serial.print(",");
+  Serial.print(ticks);
+  Serial.print(",");
+  Serial.print(misses);
+  Serial.print(",");
+  Serial.print(maxLateUs);
+  Serial.print(",");
+  Serial.println(maxTickUs);
+}
+
+void serialEvent() {
+  while (Serial.available()) {
+    char inChar = (char)Serial.read();
+    if (inChar == '\n') {
+      stringComplete = true;
+    } else {
+      inputString += inChar;
+    }
+  }
+}
+
+void processSerialCommand() {
+  inputString.trim();
+
+  if (inputString.startsWith("B:")) {
+    long baud = inputString.substring(2).toInt();
+
+    if (baud >= 9600 && baud <= 1000000) {
+      running = false;
+      Serial.print("Baud:");
+      Serial.println(baud);
+      Serial.flush();
+      Serial.end();
+      Serial.begin(baud);
+    } else {
+      Serial.println("Error: Invalid baud rate");
+    }
+
+  } else if (inputString.startsWith("X:")) {
+    String args = inputString.substring(2);
+    int comma1 = args.indexOf(',');
+    int comma2 = args.indexOf(',', comma1 + 1);
+    int fmt = args.substring(0, comma1).toInt();
+    long lines = args.substring(comma1 + 1, comma2).toInt();
+    long duration = args.substring(comma2 + 1).toInt();
+
+    if (comma1 > 0 && comma2 > 0 && fmt >= FORMAT_P2_1 && fmt <= FORMAT_STAT &&
+        lines > 0 && lines <= 10000 && duration > 0) {
+      format = fmt;
+      rate = lines;
+      linePeriodUs = 1000000UL / lines;
+      durationMs = duration;
+      seq = 0;
+      ticks = 0;
+      misses = 0;
+      maxLateUs = 0;
+      maxTickUs = 0;
+
+      Serial.print("Start:");
+      Serial.print(format);
+      Serial.print(",");
+      Serial.println(rate);
+      Serial.flush();
+
+      stepStartMs = millis();
+      nextTickUs = micros();
+      nextLineUs = nextTickUs;
+      running = true;
+    } else {
+      Serial.println("Error: Use X:<0-3>,<1-10000>,<duration_ms>");
+    }
+
+  } else if (inputString.equals("S")) {
+    if (running) {
+      finishStep();
+    }
+    Serial.println("Stopped");
+
+  } else {
+    Serial.println("Unknown command");
+  }
+}
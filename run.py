@@ -13,9 +13,11 @@ import os
 import shutil
 import subprocess
 import time
-import serial
 from pathlib import Path
 
+sys.path.insert(0, str(Path(__file__).parent / "src"))
+from device_link import open_port, server_request
+
 try:
     import psutil
     HAS_PSUTIL = True
@@ -87,6 +89,7 @@ def main():
         print("       python run.py kd    (Kd Tuning Automation)")
         print("       python run.py test  (Encoder Debug)")
         print("       python run.py inputs (Input Debug)")
+        print("       python run.py link  (Serial Link Benchmark)")
         print("Example: python run.py 1-1")
         sys.exit(1)
 
@@ -116,6 +119,9 @@ def main():
     # Special case: "analog" command (Analog Debug)
     elif arg.lower() == "analog":
         source_file = code_dir / "test_analog.cpp"
+    # Special case: "link" command (Serial Link Benchmark)
+    elif arg.lower() == "link":
+        source_file = code_dir / "test_link.cpp"
     else:
         # Parse n-m format
         if '-' not in arg:
@@ -173,6 +179,12 @@ def main():
     print("Building and uploading to Arduino...")
     print("="*60 + "\n")
 
+    # A running device server (code/device_server.cpp) must let go of the port
+    device = os.environ.get('COM_MEGA2560')
+    released = device and server_request(device, "#release")
+    if released:
+        print("Device server released the port for the upload")
+
     try:
         result = subprocess.run(
             [pio_cmd, "run", "-t", "upload"],
@@ -189,6 +201,9 @@ def main():
         print("Make sure Arduino is connected and no other program is using the port.")
         print("="*60)
         sys.exit(1)
+    finally:
+        if released:
+            print(f"Device server: {server_request(device, '#attach')}")
 
     # Clean up
     print("\nCleaning up...")
@@ -203,6 +218,14 @@ def main():
         print("\nDone!")
         return
 
+    # Link benchmark is driven by the C++ host tool
+    if arg.lower() == "link":
+        print("\n" + "="*60)
+        print("Link benchmark firmware uploaded.")
+        print("Run the host side: ./code/link_bench (see code/link_bench.cpp)")
+        print("="*60)
+        return
+
     # Automation script for KP tuning
     if arg.lower() == "kp":
         print("\n" + "="*60)
@@ -246,8 +269,7 @@ def main():
         port = os.environ.get('COM_MEGA2560', 'COM3')
         
         try:
-            ser = serial.Serial(port, 115200, timeout=1)
-            time.sleep(2) # Wait for reset
+            ser = open_port(port, 115200, timeout=1, wait_reset=True)
             while True:
                 if ser.in_waiting:
                     line = ser.readline().decode('utf-8', errors='replace').strip()
@@ -273,8 +295,7 @@ def main():
         port = os.environ.get('COM_MEGA2560', 'COM3')
         
         try:
-            ser = serial.Serial(port, 115200, timeout=1)
-            time.sleep(2) # Wait for reset
+            ser = open_port(port, 115200, timeout=1, wait_reset=True)
             while True:
                 if ser.in_waiting:
                     line = ser.readline().decode('utf-8', errors='replace').strip()
@@ -300,8 +321,7 @@ def main():
         port = os.environ.get('COM_MEGA2560', 'COM3')
         
         try:
-            ser = serial.Serial(port, 115200, timeout=1)
-            time.sleep(2) # Wait for reset
+            ser = open_port(port, 115200, timeout=1, wait_reset=True)
             while True:
                 if ser.in_waiting:
                     line = ser.readline().decode('utf-8', errors='replace').strip()
@@ -0,0 +1,161 @@
+#!/usr/bin/env python3
+"""
+Device Link - serial port or device server
+
+When code/device_server.cpp is running for COM_MEGA2560, the tools talk to
+it over its Unix socket instead of opening the port themselves: no DTR
+reset, no 2 s boot wait, the sketch keeps its state between runs, and
+several tools can listen at once. Without a server (or on Windows) this is
+plain pyserial.
+
+Usage:
+    from device_link import open_port
+
+    ser = open_port(PORT, 115200, timeout=1, wait_reset=True)
+    ser.write(b"R:200\\n")
+    line = ser.readline()
+"""
+
+import os
+import select
+import socket
+import time
+
+import serial
+
+RESET_WAIT = 2.0  # s, sketch boot after a DTR reset
+
+
+def server_socket_path(port):
+    """Socket of the device server for a port (same rule as serial_port.hpp)"""
+    env = os.environ.get('MOTOR_SERVER_SOCKET')
+    if env:
+        return env
+    name = port.replace('\\', '/').rsplit('/', 1)[-1]
+    return f"/tmp/motor_{name}.sock"
+
+
+class ServerPort:
+    """
+    pyserial-like connection to the device server
+
+    Implements the subset the tools use: write, readline, in_waiting,
+    reset_input_buffer, close. Server replies ('#' lines) are not returned
+    by readline; use request() for those.
+    """
+
+    is_server = True
+
+    def __init__(self, path, timeout=1.0):
+        self.port = path
+        self.timeout = timeout
+        self._sock = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+        self._sock.connect(path)
+        self._sock.setblocking(False)
+        self._raw = b''
+        self._buf = b''
+        self._replies = []
+
+    def _receive(self, wait):
+        """Read what is available, waiting up to `wait` seconds for the first bytes"""
+        ready, _, _ = select.select([self._sock], [], [], max(0.0, wait))
+        if not ready:
+            return
+        while True:
+            try:
+                chunk = self._sock.recv(4096)
+            except BlockingIOError:
+                break
+            if not chunk:
+                raise OSError("Device server closed the connection")
+            self._raw += chunk
+        # Complete lines only; '#' lines are server replies, the rest is the board
+        *lines, self._raw = self._raw.split(b'\n')
+        for line in lines:
+            if line.startswith(b'#'):
+                self._replies.append(line.decode(errors='replace').strip())
+            else:
+                self._buf += line + b'\n'
+
+    @property
+    def in_waiting(self):
+        self._receive(0)
+        return len(self._buf)
+
+    def readline(self):
+        deadline = time.monotonic() + (self.timeout if self.timeout is not None else 1e9)
+        while b'\n' not in self._buf:
+            remaining = deadline - time.monotonic()
+            if remaining <= 0:
+                return b''
+            self._receive(remaining)
+        line, self._buf = self._buf.split(b'\n', 1)
+        return line + b'\n'
+
+    def write(self, data):
+        self._sock.setblocking(True)
+        try:
+            self._sock.sendall(data)
+        finally:
+            self._sock.setblocking(False)
+        return len(data)
+
+    def reset_input_buffer(self):
+        self._receive(0)
+        self._raw = b''
+        self._buf = b''
+
+    def request(self, command, timeout=2.0):
+        """Send a '#' command to the server and return its reply line"""
+        self._replies = [r for r in self._replies if not r.startswith(('#ok', '#error', '#status'))]
+        self.write((command + '\n').encode())
+        deadline = time.monotonic() + timeout
+        while time.monotonic() < deadline:
+            for reply in self._replies:
+                if reply.startswith(('#ok', '#error', '#status')):
+                    self._replies.remove(reply)
+                    return reply
+            self._receive(deadline - time.monotonic())
+        raise OSError(f"No reply from device server to {command}")
+
+    def close(self):
+        self._sock.close()
+
+
+def server_running(port):
+    """True if a device server for `port` accepts connections"""
+    if not hasattr(socket, 'AF_UNIX'):
+        return False
+    path = server_socket_path(port)
+    if not os.path.exists(path):
+        return False
+    try:
+        with socket.socket(socket.AF_UNIX, socket.SOCK_STREAM) as s:
+            s.connect(path)
+        return True
+    except OSError:
+        return False
+
+
+def open_port(port, baud, timeout=1, wait_reset=False):
+    """
+    Connect to the board: through the device server if one is running,
+    else by opening the serial port (waiting for the reset if asked)
+    """
+    if server_running(port):
+        return ServerPort(server_socket_path(port), timeout)
+    ser = serial.Serial(port, baud, timeout=timeout)
+    if wait_reset:
+        time.sleep(RESET_WAIT)
+    return ser
+
+
+def server_request(port, command):
+    """One '#' command to the server for `port`; None if no server runs"""
+    if not server_running(port):
+        return None
+    conn = ServerPort(server_socket_path(port))
+    try:
+        return conn.request(command)
+    finally:
+        conn.close()
@@ -0,0 +1,377 @@
+#!/usr/bin/env python3
+"""
+Device Registry
+
+Per-board parameter sets keyed by the device id each board keeps in EEPROM
+(p2-1.cpp "U:<id>", reported as "DEVICE:<id>" at startup and on "U").
+
+Each device has one file, data/devices/device_<id>.json, holding its name
+and parameters:
+
+    tau, K            plant model          -> T:<tau>,<K>
+    Kp, Ki, Kd        PID gains            -> G:<Kp>,<Ki>,<Kd>
+    lqr_gains         [k_e, k_w, k_z]      -> L:...
+    observer_gains    [l_theta, l_omega]   -> O:...
+    dead_ticks        Smith predictor      -> D:<ticks>
+    dob               [hz, order]          -> Q:<hz>,<order>
+
+plotter.py files the tau/K of every saved 1-3 summary under the connected
+board; plotter_pid.py uploads the stored set once the board has reported
+its id and finished its startup banner, checks each command's reply, and
+gives a board without an id a new one. Other results (tuned
+gains, dead time) are stored with the command line below.
+
+Usage:
+    python src/device_registry.py list
+    python src/device_registry.py show <id>
+    python src/device_registry.py set <id> Kp=12 Ki=1.5 Kd=0.4 name=bench-A
+    python src/device_registry.py import <id>     (tau/K of the latest data/1-3 summary)
+    python src/device_registry.py upload          (board on $COM_MEGA2560)
+
+    from device_registry import provision
+    device_id = provision(ser)
+"""
+
+import json
+import os
+import random
+import sys
+import time
+from datetime import datetime
+from pathlib import Path
+
+REGISTRY_DIR = Path(__file__).parent.parent / "data" / "devices"
+MAX_ID = 2147483647
+REPLY_TIMEOUT = 1.0  # s per command
+READY_IDLE = 0.5     # s without a non-telemetry line: startup banner is over
+READY_TIMEOUT = 5.0  # s to wait for the banner to end
+
+TELEMETRY = ("Data:", "Stat:", "ILC:", "TimeOpt:")
+
+# Command prefix -> start of the reply p2-1.cpp sends when it applies it
+EXPECTED_REPLY = {
+    'T:': "Model updated",
+    'G:': "Gains updated",
+    'L:': "LQR gains updated",
+    'O:': "Observer gains updated",
+    'D:': "Smith predictor:",
+    'Q:': "Disturbance observer:",
+}
+
+# Parameter name -> number of values (1 = scalar)
+PARAMS = {
+    'tau': 1, 'K': 1, 'Kp': 1, 'Ki': 1, 'Kd': 1,
+    'lqr_gains': 3, 'observer_gains': 2, 'dead_ticks': 1, 'dob': 2,
+}
+
+
+def _timestamp():
+    return datetime.now().strftime("%Y%m%d_%H%M%S")
+
+
+def device_path(device_id):
+    return REGISTRY_DIR / f"device_{device_id}.json"
+
+
+def parse_device_line(line):
+    """Id from a "DEVICE:<id>" line: int, 0 for "DEVICE:none", None otherwise"""
+    if not line.startswith("DEVICE:"):
+        return None
+    value = line.split(":", 1)[1].strip()
+    return int(value) if value.isdigit() else 0
+
+
+def load_device(device_id):
+    """Registry record of a device, or None if it is not registered"""
+    path = device_path(device_id)
+    if not path.exists():
+        return None
+    with open(path) as f:
+        return json.load(f)
+
+
+def save_device(record):
+    """Write a record atomically (a crash never leaves half a file)"""
+    REGISTRY_DIR.mkdir(parents=True, exist_ok=True)
+    record['updated'] = _timestamp()
+    path = device_path(record['id'])
+    tmp = path.with_suffix(".tmp")
+    with open(tmp, 'w') as f:
+        json.dump(record, f, indent=2)
+    os.replace(tmp, path)
+    return path
+
+
+def register_device(device_id, name=""):
+    """Existing record of a device, or a new empty one"""
+    record = load_device(device_id)
+    if record is None:
+        record = {'id': device_id, 'name': name, 'created': _timestamp(),
+                  'params': {}, 'sources': {}}
+        save_device(record)
+        print(f"Registered new device {device_id} in {device_path(device_id)}")
+    return record
+
+
+def list_devices():
+    if not REGISTRY_DIR.exists():
+        return []
+    records = []
+    for path in sorted(REGISTRY_DIR.glob("device_*.json")):
+        with open(path) as f:
+            records.append(json.load(f))
+    return records
+
+
+def new_device_id():
+    """Random id not in the registry (boards provisioned on other hosts rarely collide)"""
+    taken = {r['id'] for r in list_devices()}
+    while True:
+        device_id = random.randint(1, MAX_ID)
+        if device_id not in taken:
+            return device_id
+
+
+def update_params(device_id, params, source=""):
+    """Merge parameters into a device's record; `source` says where they came from"""
+    for key, value in params.items():
+        if key not in PARAMS:
+            raise ValueError(f"Unknown parameter: {key} (known: {', '.join(PARAMS)})")
+        count = PARAMS[key]
+        if count > 1 and (not isinstance(value, (list, tuple)) or len(value) != count):
+            raise ValueError(f"{key} needs {count} values")
+    record = register_device(device_id)
+    record['params'].update(params)
+    for key in params:
+        record['sources'][key] = source or "manual"
+    save_device(record)
+    return record
+
+
+def _num(value):
+    return f"{value:.6g}"
+
+
+def commands_for(params):
+    """Serial commands for p2-1.cpp in dependency order (T: before D:/Q:)"""
+    commands = []
+    if 'tau' in params and 'K' in params:
+        commands.append(f"T:{_num(params['tau'])},{_num(params['K'])}")
+    if 'Kp' in params:
+        commands.append("G:" + ",".join(_num(params.get(k, 0.0)) for k in ('Kp', 'Ki', 'Kd')))
+    if 'lqr_gains' in params:
+        commands.append("L:" + ",".join(_num(v) for v in params['lqr_gains']))
+    if 'observer_gains' in params:
+        commands.append("O:" + ",".join(_num(v) for v in params['observer_gains']))
+    if 'dead_ticks' in params:
+        commands.append(f"D:{int(params['dead_ticks'])}")
+    if 'dob' in params:
+        hz, order = params['dob']
+        commands.append(f"Q:{_num(hz)},{int(order)}")
+    return commands
+
+
+def _reply(ser, timeout=REPLY_TIMEOUT):
+    """Next line that is not telemetry, or None"""
+    deadline = time.monotonic() + timeout
+    while time.monotonic() < deadline:
+        line = ser.readline().decode('utf-8', errors='ignore').strip()
+        if line and not line.startswith(TELEMETRY):
+            return line
+    return None
+
+
+def wait_ready(ser, idle=READY_IDLE, timeout=READY_TIMEOUT):
+    """
+    Skip the startup banner, then check the board takes commands
+
+    setup() prints "DEVICE:<id>" before ~25 banner lines and reads no input
+    until it is done, so commands sent on the DEVICE: line pile up and get
+    merged. Waits until no non-telemetry line has arrived for `idle` s,
+    then asks "U". Returns the id from the reply, None if there is none.
+    """
+    deadline = time.monotonic() + timeout
+    quiet_since = time.monotonic()
+    while time.monotonic() - quiet_since < idle and time.monotonic() < deadline:
+        line = ser.readline().decode('utf-8', errors='ignore').strip()
+        if line and not line.startswith(TELEMETRY):
+            quiet_since = time.monotonic()
+    return query_device(ser)
+
+
+def send_commands(ser, commands):
+    """
+    Send commands one at a time, each after the previous reply (the sketch
+    reads everything waiting into one command line). A reply that is an
+    Error:, missing or not the one the command produces counts as failed.
+    Returns the commands that failed.
+    """
+    failed = []
+    for command in commands:
+        ser.write((command + "\n").encode())
+        reply = _reply(ser)
+        expected = EXPECTED_REPLY.get(command[:2])
+        ok = reply is not None and (expected is None or reply.startswith(expected))
+        if not ok:
+            failed.append(command)
+        print(f"  {command} -> {reply if reply is not None else '(no reply)'}"
+              f"{'' if ok else '  FAILED'}")
+    return failed
+
+
+def query_device(ser, timeout=REPLY_TIMEOUT):
+    """Ask the board for its id ("U"); None if it does not answer"""
+    ser.write(b"U\n")
+    deadline = time.monotonic() + timeout
+    while time.monotonic() < deadline:
+        line = ser.readline().decode('utf-8', errors='ignore').strip()
+        device_id = parse_device_line(line)
+        if device_id is not None:
+            return device_id
+    return None
+
+
+def assign_device(ser, device_id=None):
+    """Store an id on the board (a new one by default) and register it"""
+    device_id = device_id or new_device_id()
+    ser.write(f"U:{device_id}\n".encode())
+    deadline = time.monotonic() + REPLY_TIMEOUT
+    while time.monotonic() < deadline:
+        line = ser.readline().decode('utf-8', errors='ignore').strip()
+        if parse_device_line(line) == device_id:
+            register_device(device_id)
+            return device_id
+        if line.startswith("Error:"):
+            break
+    raise OSError(f"Board did not store device id {device_id}")
+
+
+def provision(ser, device_id=None):
+    """
+    Give the board its registered parameters
+
+    `device_id` is the id the board reported at startup (None: not seen);
+    the upload waits for the startup banner to end and the board to answer
+    "U" first. A board without an id gets a new one. Returns the id, or
+    None if the board does not report ids (older firmware).
+    """
+    reported = wait_ready(ser)
+    if reported is None:
+        if device_id is None:
+            print("Board does not report a device id (firmware without U:)")
+        else:
+            print(f"Error: Device {device_id} did not answer U; stored parameters not uploaded")
+        return device_id
+    device_id = reported
+    if device_id == 0:
+        device_id = assign_device(ser)
+        print(f"Board had no device id; assigned {device_id}")
+
+    record = register_device(device_id)
+    label = f"{device_id}" + (f" ({record['name']})" if record.get('name') else "")
+    commands = commands_for(record['params'])
+    if not commands:
+        print(f"Device {label}: no stored parameters yet "
+              f"(characterize with python run.py 1-3, or use device_registry.py set)")
+        return device_id
+
+    print(f"Device {label}: uploading stored parameters")
+    failed = send_commands(ser, commands)
+    if failed:
+        print(f"Error: Upload failed for {len(failed)} of {len(commands)} command(s): "
+              f"{', '.join(failed)}")
+    return device_id
+
+
+def _parse_assignment(text):
+    key, _, value = text.partition("=")
+    if not value:
+        raise ValueError(f"Expected key=value, got {text}")
+    if key == 'name':
+        return key, value
+    values = [float(v) for v in value.split(",")]
+    if key == 'dead_ticks':
+        values = [int(v) for v in values]
+    return key, values[0] if len(values) == 1 else values
+
+
+def _latest_summary():
+    data_dir = Path(__file__).parent.parent / "data" / "1-3"
+    files = sorted(data_dir.glob("summary_*.json"), key=lambda p: p.stat().st_mtime)
+    if not files:
+        raise FileNotFoundError(f"No summary_*.json in {data_dir}")
+    with open(files[-1]) as f:
+        return files[-1], json.load(f)
+
+
+def main():
+    args = sys.argv[1:]
+    if not args:
+        print(__doc__)
+        sys.exit(1)
+    command = args[0]
+
+    if command == "list":
+        records = list_devices()
+        if not records:
+            print(f"No devices in {REGISTRY_DIR}")
+        for r in records:
+            params = ", ".join(f"{k}={v}" for k, v in r['params'].items()) or "no parameters"
+            print(f"{r['id']:>10}  {r.get('name', ''):<12}  {params}  (updated {r.get('updated', '?')})")
+
+    elif command == "show" and len(args) == 2:
+        record = load_device(int(args[1]))
+        if record is None:
+            print(f"Error: Device {args[1]} is not registered")
+            sys.exit(1)
+        print(json.dumps(record, indent=2))
+        print("\nCommands:")
+        for c in commands_for(record['params']):
+            print(f"  {c}")
+
+    elif command == "set" and len(args) >= 3:
+        device_id = int(args[1])
+        params = {}
+        name = None
+        for text in args[2:]:
+            key, value = _parse_assignment(text)
+            if key == 'name':
+                name = value
+            else:
+                params[key] = value
+        record = update_params(device_id, params, source="device_registry.py set")
+        if name is not None:
+            record['name'] = name
+            save_device(record)
+        print(f"Saved {device_path(device_id)}")
+
+    elif command == "import" and len(args) == 2:
+        path, summary = _latest_summary()
+        if summary.get('tau_average') is None or summary.get('K_average') is None:
+            print(f"Error: {path.name} has no tau/K")
+            sys.exit(1)
+        update_params(int(args[1]), {'tau': summary['tau_average'], 'K': summary['K_average']},
+                      source=f"data/1-3/{path.name}")
+        print(f"Device {args[1]}: tau={summary['tau_average']:.4g}, K={summary['K_average']:.4g} "
+              f"from {path.name}")
+
+    elif command == "upload":
+        from device_link import open_port
+        port = os.environ.get('COM_MEGA2560')
+        if not port:
+            print("Error: COM_MEGA2560 environment variable not set.")
+            sys.exit(1)
+        ser = open_port(port, 115200, timeout=0.1, wait_reset=True)
+        try:
+            ser.reset_input_buffer()
+            provision(ser)
+        finally:
+            ser.close()
+
+    else:
+        print(__doc__)
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,312 @@
+#!/usr/bin/env python3
+"""
+Native Engine Bindings
+
+ctypes bindings for code/libmotor_capi.so (code/motor_capi.h): the batched
+PID simulator, step metrics, "Data:" line parser and data/ loaders of the
+C++ tools, with numpy arrays passed to and from the library without copying.
+
+Build the library once (from code/):
+    g++ -std=c++17 -O2 -shared -fPIC motor_capi.cpp -o libmotor_capi.so -pthread
+
+Set MOTOR_NATIVE_LIB to use a library elsewhere. When the library is not
+found, available() is False and the callers fall back to their Python code.
+
+Usage:
+    import motor_native
+
+    if motor_native.available():
+        gains = np.array([[10.0, 5.0, 2.0], [12.0, 4.0, 1.5]])
+        position, control, metrics = motor_native.simulate_pid_batch(gains, tau, K)
+        table, header = motor_native.load_latest_table("1-3", "raw_data_")
+"""
+
+import ctypes
+import os
+import sys
+from pathlib import Path
+
+import numpy as np
+
+CAPI_VERSION = 1
+
+METRIC_NAMES = ('overshoot', 'settling_time', 'rise_time', 'steady_state_error', 'peak')
+
+PROJECT_ROOT = Path(__file__).parent.parent
+
+
+class SimConfig(ctypes.Structure):
+    """Mirror of motor_sim_config"""
+    _fields_ = [
+        ('tau', ctypes.c_double),
+        ('K', ctypes.c_double),
+        ('reference', ctypes.c_double),
+        ('t_max', ctypes.c_double),
+        ('sim_dt', ctypes.c_double),
+        ('control_dt', ctypes.c_double),
+        ('deadzone', ctypes.c_double),
+        ('firmware_limits', ctypes.c_int),
+        ('friction', ctypes.c_double * 6),
+    ]
+
+
+class Summary(ctypes.Structure):
+    """Mirror of motor_summary"""
+    _fields_ = [
+        ('tau_average', ctypes.c_double),
+        ('K_average', ctypes.c_double),
+        ('tau_std', ctypes.c_double),
+        ('K_std', ctypes.c_double),
+        ('data_points', ctypes.c_int),
+        ('timestamp', ctypes.c_char * 32),
+        ('task', ctypes.c_char * 16),
+    ]
+
+
+_DOUBLE_P = ctypes.POINTER(ctypes.c_double)
+_lib = None
+_load_error = None
+
+
+def _library_path():
+    env = os.environ.get('MOTOR_NATIVE_LIB')
+    if env:
+        return Path(env)
+    if sys.platform.startswith('win'):
+        name = 'motor_capi.dll'
+    elif sys.platform == 'darwin':
+        name = 'libmotor_capi.dylib'
+    else:
+        name = 'libmotor_capi.so'
+    return PROJECT_ROOT / 'code' / name
+
+
+def _declare(lib):
+    lib.motor_capi_version.restype = ctypes.c_int
+    lib.motor_last_error.restype = ctypes.c_char_p
+    lib.motor_set_project_root.argtypes = [ctypes.c_char_p]
+    lib.motor_sim_samples.argtypes = [ctypes.POINTER(SimConfig)]
+    lib.motor_sim_samples.restype = ctypes.c_size_t
+    lib.motor_simulate_pid_batch.argtypes = [ctypes.POINTER(SimConfig), _DOUBLE_P, ctypes.c_size_t,
+                                             _DOUBLE_P, _DOUBLE_P, _DOUBLE_P, ctypes.c_int]
+    lib.motor_step_metrics_batch.argtypes = [_DOUBLE_P, _DOUBLE_P, ctypes.c_size_t, ctypes.c_size_t,
+                                             ctypes.c_double, ctypes.c_double, _DOUBLE_P]
+    lib.motor_parse_data_lines.argtypes = [ctypes.c_char_p, ctypes.c_size_t, ctypes.c_size_t,
+                                           _DOUBLE_P, ctypes.c_size_t, ctypes.POINTER(ctypes.c_size_t)]
+    lib.motor_parse_data_lines.restype = ctypes.c_long
+    lib.motor_load_latest_summary.argtypes = [ctypes.c_char_p, ctypes.POINTER(Summary)]
+    lib.motor_load_latest_table.argtypes = [ctypes.c_char_p, ctypes.c_char_p]
+    lib.motor_load_latest_table.restype = ctypes.c_void_p
+    lib.motor_load_table.argtypes = [ctypes.c_char_p]
+    lib.motor_load_table.restype = ctypes.c_void_p
+    for name in ('motor_table_rows', 'motor_table_cols'):
+        getattr(lib, name).argtypes = [ctypes.c_void_p]
+        getattr(lib, name).restype = ctypes.c_size_t
+    lib.motor_table_data.argtypes = [ctypes.c_void_p]
+    lib.motor_table_data.restype = _DOUBLE_P
+    lib.motor_table_header.argtypes = [ctypes.c_void_p]
+    lib.motor_table_header.restype = ctypes.c_char_p
+    lib.motor_table_path.argtypes = [ctypes.c_void_p]
+    lib.motor_table_path.restype = ctypes.c_char_p
+    lib.motor_table_free.argtypes = [ctypes.c_void_p]
+    lib.motor_table_free.restype = None
+
+
+def _get_lib():
+    global _lib, _load_error
+    if _lib is None and _load_error is None:
+        path = _library_path()
+        try:
+            lib = ctypes.CDLL(str(path))
+            _declare(lib)
+            version = lib.motor_capi_version()
+            if version != CAPI_VERSION:
+                raise OSError(f"{path.name} has C API version {version}, expected {CAPI_VERSION}; rebuild it")
+            lib.motor_set_project_root(str(PROJECT_ROOT).encode())
+            _lib = lib
+        except OSError as e:
+            _load_error = str(e)
+    return _lib
+
+
+def available():
+    """True if the native library could be loaded"""
+    return _get_lib() is not None
+
+
+def load_error():
+    """Why the library could not be loaded (None if it was)"""
+    _get_lib()
+    return _load_error
+
+
+def _require():
+    lib = _get_lib()
+    if lib is None:
+        raise RuntimeError(f"Native library not available: {_load_error}")
+    return lib
+
+
+def _check(lib, status):
+    if status != 0:
+        raise RuntimeError(lib.motor_last_error().decode(errors='replace'))
+
+
+def _ptr(array):
+    return array.ctypes.data_as(_DOUBLE_P) if array is not None else None
+
+
+def simulate_pid_batch(gains, tau, K, reference=200.0, t_max=2.0, dt=0.001, control_dt=None,
+                       firmware_limits=False, deadzone=50.0, friction=None,
+                       return_position=True, return_control=True, threads=0):
+    """
+    Simulate closed-loop step responses for many gain sets in parallel.
+
+    Args:
+        gains: (n, 3) array of [Kp, Ki, Kd]
+        tau, K: Plant parameters
+        reference, t_max, dt: Step target (deg), duration and plant step (s)
+        control_dt: Controller period (default dt, as in p2-1_pid_simulation.py;
+                    0.01 for the firmware rate)
+        firmware_limits: Apply the p2-1.cpp deadzone and ±255 saturation
+        friction: Optional dict with coulomb_fwd, coulomb_rev, stiction_fwd,
+                  stiction_rev, gain_fwd, gain_rev (MotorSim::FrictionParams)
+        threads: Worker threads (0 = all cores)
+
+    Returns:
+        position (n, N) or None, control (n, N) or None, metrics (n, 5)
+        with columns METRIC_NAMES (step_metrics.hpp definitions)
+    """
+    lib = _require()
+    gains = np.ascontiguousarray(np.atleast_2d(gains), dtype=np.float64)
+    if gains.shape[1] != 3:
+        raise ValueError("gains must have shape (n, 3)")
+    n = gains.shape[0]
+
+    config = SimConfig(tau=tau, K=K, reference=reference, t_max=t_max, sim_dt=dt,
+                       control_dt=control_dt if control_dt else dt, deadzone=deadzone,
+                       firmware_limits=1 if firmware_limits else 0)
+    if friction:
+        keys = ('coulomb_fwd', 'coulomb_rev', 'stiction_fwd', 'stiction_rev', 'gain_fwd', 'gain_rev')
+        for i, key in enumerate(keys):
+            config.friction[i] = float(friction.get(key, 0.0))
+
+    samples = lib.motor_sim_samples(ctypes.byref(config))
+    position = np.empty((n, samples)) if return_position else None
+    control = np.empty((n, samples)) if return_control else None
+    metrics = np.empty((n, len(METRIC_NAMES)))
+
+    _check(lib, lib.motor_simulate_pid_batch(ctypes.byref(config), _ptr(gains), n,
+                                             _ptr(position), _ptr(control), _ptr(metrics), threads))
+    return position, control, metrics
+
+
+def step_metrics(t, y, reference, band=0.02):
+    """
+    Step metrics of one response (1-D y) or of several responses sharing t
+    (2-D y, one per row). Returns an array with columns METRIC_NAMES.
+    """
+    lib = _require()
+    t = np.ascontiguousarray(t, dtype=np.float64)
+    y = np.ascontiguousarray(y, dtype=np.float64)
+    rows = 1 if y.ndim == 1 else y.shape[0]
+    if y.shape[-1] != t.shape[0]:
+        raise ValueError("y and t must have the same number of samples")
+    out = np.empty((rows, len(METRIC_NAMES)))
+    _check(lib, lib.motor_step_metrics_batch(_ptr(t), _ptr(y), rows, t.shape[0],
+                                             reference, band, _ptr(out)))
+    return out[0] if y.ndim == 1 else out
+
+
+def parse_data_lines(data, n_fields):
+    """
+    Parse "Data:v1,v2,..." lines from raw serial bytes.
+
+    Returns:
+        (rows, n_fields) array and the unparsed tail (an incomplete last line)
+    """
+    lib = _require()
+    if isinstance(data, str):
+        data = data.encode()
+    max_rows = data.count(b'\n')
+    out = np.empty((max_rows, n_fields))
+    consumed = ctypes.c_size_t(0)
+    rows = lib.motor_parse_data_lines(data, len(data), n_fields, _ptr(out), max_rows,
+                                      ctypes.byref(consumed))
+    if rows < 0:
+        raise RuntimeError(lib.motor_last_error().decode(errors='replace'))
+    return out[:rows], data[consumed.value:]
+
+
+def load_latest_summary(task_name):
+    """Same fields as data_loader.load_latest_summary()'s metadata dict"""
+    lib = _require()
+    s = Summary()
+    status = lib.motor_load_latest_summary(task_name.encode(), ctypes.byref(s))
+    if status != 0:
+        raise FileNotFoundError(lib.motor_last_error().decode(errors='replace'))
+    return {
+        'tau_average': s.tau_average,
+        'K_average': s.K_average,
+        'tau_std': s.tau_std,
+        'K_std': s.K_std,
+        'data_points': s.data_points,
+        'timestamp': s.timestamp.decode(),
+        'task': s.task.decode(),
+    }
+
+
+class _TableOwner:
+    """Frees the C++ table when the last numpy view of it is gone"""
+
+    def __init__(self, lib, handle):
+        self.lib = lib
+        self.handle = handle
+
+    def __del__(self):
+        if self.handle:
+            self.lib.motor_table_free(self.handle)
+            self.handle = None
+
+
+def _wrap_table(lib, handle):
+    if not handle:
+        raise FileNotFoundError(lib.motor_last_error().decode(errors='replace'))
+    owner = _TableOwner(lib, handle)
+    rows = lib.motor_table_rows(handle)
+    cols = lib.motor_table_cols(handle)
+    header = lib.motor_table_header(handle).decode().split(',')
+    if rows == 0:
+        return np.empty((0, cols)), header
+
+    # Zero-copy: the array's base is a ctypes buffer over the C++ vector
+    buffer = (ctypes.c_double * (rows * cols)).from_address(
+        ctypes.addressof(lib.motor_table_data(handle).contents))
+    buffer._owner = owner
+    table = np.frombuffer(buffer, dtype=np.float64).reshape(rows, cols)
+    table.flags.writeable = False
+    return table, header
+
+
+def load_latest_table(task_name, prefix="raw_data_"):
+    """
+    Load the latest data/<task_name>/<prefix>*.csv as a read-only (rows, cols)
+    array that views the C++ buffer, plus the header names.
+    """
+    lib = _require()
+    return _wrap_table(lib, lib.motor_load_latest_table(task_name.encode(), prefix.encode()))
+
+
+def load_table(path):
+    """Load any numeric CSV with a header row (see load_latest_table)"""
+    lib = _require()
+    return _wrap_table(lib, lib.motor_load_table(str(path).encode()))
+
+
+if __name__ == "__main__":
+    if not available():
+        print(f"Native library not available: {load_error()}")
+        sys.exit(1)
+    print(f"Loaded {_library_path()}")
+    _, _, m = simulate_pid_batch([[10.0, 5.0, 2.0]], 0.4, 12.4)
+    print(dict(zip(METRIC_NAMES, m[0])))
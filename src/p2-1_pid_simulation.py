@@ -11,6 +11,7 @@ Features:
 - Optimizes PID gains using scipy.optimize
 - Visualizes step response and performance metrics
 - Exports results compatible with Matlab analysis
+- Uses the C++ simulator (src/motor_native.py) when code/libmotor_capi.so is built
 
 Requirements:
 - pip install numpy scipy matplotlib control
@@ -22,6 +23,12 @@ from scipy.optimize import minimize
 from pathlib import Path
 import json
 
+try:
+    import motor_native
+    HAS_NATIVE = motor_native.available()
+except ImportError:
+    HAS_NATIVE = False
+
 try:
     import control as ct
     HAS_CONTROL = True
@@ -110,6 +117,16 @@ def simulate_pid_response(Kp, Ki, Kd, tau, K, reference=200, t_max=2.0, dt=0.001
         error: Tracking error
         control: Control signal
     """
+    if HAS_NATIVE:
+        # Same model and update order, run by code/libmotor_capi.so
+        t = np.arange(0, t_max, dt)
+        position, control, _ = motor_native.simulate_pid_batch(
+            [[Kp, Ki, Kd]], tau, K, reference=reference, t_max=t_max, dt=dt)
+        position, control = position[0], control[0]
+        error = np.zeros_like(position)
+        error[1:] = reference - position[:-1]
+        return t, position, error, control
+
     # Time array
     t = np.arange(0, t_max, dt)
     N = len(t)
@@ -2,7 +2,8 @@
 # Universal plotter for motor control experiments
 # Reads "Data:Duty,Time,Velocity" format from Arduino
 
-import serial
+from device_link import open_port
+import device_registry
 import matplotlib.pyplot as plt
 from matplotlib.animation import FuncAnimation
 import os
@@ -26,7 +27,7 @@ BAUD_RATE = 115200
 
 # --- Connect to Arduino ---
 try:
-    ser = serial.Serial(PORT, BAUD_RATE, timeout=0.1)
+    ser = open_port(PORT, BAUD_RATE, timeout=0.1)
     ser.reset_input_buffer()
     print(f"Connected to {PORT}")
     print("Reading data from Arduino...")
@@ -43,6 +44,7 @@ tau_labels = []  # Store tau annotations: [(time, tau_value, duty, annotation_ob
 K_labels = []    # Store K annotations: [(time, K_value, duty, annotation_object)]
 paused = False  # Flag to pause updating
 task_name = None  # Store task identifier (e.g., "1-1", "1-2", "1-3")
+device_id = None  # Board id from "DEVICE:<id>" (0 = not provisioned)
 
 # --- Setup plot ---
 fig, ax = plt.subplots(figsize=(12, 6))
@@ -166,6 +168,13 @@ def save_calculated_values(save_task, tau_vals, K_vals, time_vals):
         json.dump(summary, f, indent=2)
     print(f"Summary saved: {summary_file}")
 
+    # File the plant model under the board it was measured on
+    if device_id and summary['tau_average'] is not None and summary['K_average'] is not None:
+        device_registry.update_params(
+            device_id, {'tau': summary['tau_average'], 'K': summary['K_average']},
+            source=f"data/{save_task}/{summary_file.name}")
+        print(f"Device {device_id}: tau/K stored in {device_registry.device_path(device_id)}")
+
 def on_key(event):
     """Handle keyboard events"""
     global paused
@@ -245,6 +254,12 @@ def update_plot(frame):
                 task_name = raw_data.split(":")[1]
                 print(f"Task detected: {task_name}")
 
+            # Parse board id: "DEVICE:<id>" or "DEVICE:none"
+            elif raw_data.startswith("DEVICE:"):
+                global device_id
+                device_id = device_registry.parse_device_line(raw_data)
+                print(f"Device: {device_id if device_id else 'no id (set one with python src/device_registry.py upload)'}")
+
             # Parse data format: "Data:Duty,Time,Velocity"
             elif raw_data.startswith("Data:"):
                 print(f"[DEBUG] Raw data received: {raw_data}")  # DEBUG
@@ -1,8 +1,10 @@
 #!/usr/bin/env python3
 # PID Controller Plotter for P#2-1
 # Reads "Data:Time,Position,Reference,Error,ControlSignal,LimitOv,LimitUp,LimitLow" format from Arduino
+# and, in windowed telemetry mode (W:<ticks>), "Stat:" aggregate lines
 
-import serial
+from device_link import open_port
+import device_registry
 import matplotlib.pyplot as plt
 from matplotlib.animation import FuncAnimation
 import os
@@ -26,8 +28,9 @@ BAUD_RATE = 115200
 
 # --- Connect to Arduino ---
 try:
-    ser = serial.Serial(PORT, BAUD_RATE, timeout=0.1)
+    ser = open_port(PORT, BAUD_RATE, timeout=0.1)
     ser.reset_input_buffer()
+    ser.write(b"U\n")  # Ask for the device id (a board that resets on open also prints it at startup)
     print(f"Connected to {PORT}")
     print("Reading PID data from Arduino...")
 except Exception as e:
@@ -44,8 +47,10 @@ control_data = []
 limit_ov_data = []
 limit_up_data = []
 limit_low_data = []
+stat_records = []  # One row per Stat: window (see STAT_COLUMNS)
 paused = False
 task_name = None
+device_id = None  # Board id, once its registered parameters have been uploaded
 
 # --- Setup plot ---
 fig, axes = plt.subplots(3, 1, figsize=(12, 10))
@@ -83,6 +88,22 @@ ax3.grid(True)
 
 plt.tight_layout()
 
+# Stat:<t_start>,<t_end>,<n>, then min/max/mean/var per signal
+STAT_SIGNALS = ['position', 'velocity', 'error', 'control']
+STAT_COLUMNS = ['t_start', 't_end', 'samples'] + [
+    f"{sig}_{stat}" for sig in STAT_SIGNALS for stat in ('min', 'max', 'mean', 'var')]
+
+# Min/max envelopes of the windows (drawn only in windowed mode)
+line_pos_min, = ax1.plot([], [], 'b:', linewidth=0.8)
+line_pos_max, = ax1.plot([], [], 'b:', linewidth=0.8)
+line_err_min, = ax2.plot([], [], 'r:', linewidth=0.8)
+line_err_max, = ax2.plot([], [], 'r:', linewidth=0.8)
+line_ctrl_min, = ax3.plot([], [], 'g:', linewidth=0.8)
+line_ctrl_max, = ax3.plot([], [], 'g:', linewidth=0.8)
+envelope_lines = [(line_pos_min, 'position_min'), (line_pos_max, 'position_max'),
+                  (line_err_min, 'error_min'), (line_err_max, 'error_max'),
+                  (line_ctrl_min, 'control_min'), (line_ctrl_max, 'control_max')]
+
 # --- Save functions ---
 def save_plot(save_task):
     """Save current plot as image"""
@@ -192,6 +213,25 @@ def save_performance_metrics(save_task, time_vals, pos_vals, ref_vals):
 
     return filename
 
+def save_stat_data(save_task, records):
+    """Save windowed telemetry records to CSV"""
+    timestamp = datetime.now().strftime("%Y%m%d_%H%M%S")
+
+    # Create directory
+    project_root = Path(__file__).parent.parent
+    data_dir = project_root / "data" / save_task
+    data_dir.mkdir(parents=True, exist_ok=True)
+
+    filename = data_dir / f"stat_data_{timestamp}.csv"
+
+    with open(filename, 'w', newline='') as f:
+        writer = csv.writer(f)
+        writer.writerow(STAT_COLUMNS)
+        writer.writerows(records)
+
+    print(f"Window statistics saved: {filename}")
+    return filename
+
 def on_key(event):
     """Handle keyboard events"""
     global paused
@@ -205,6 +245,7 @@ def on_key(event):
         limit_ov_data.clear()
         limit_up_data.clear()
         limit_low_data.clear()
+        stat_records.clear()
         print("Data cleared")
 
     elif event.key == 'p':
@@ -232,9 +273,13 @@ def on_key(event):
                 # 3. Calculate and save performance metrics
                 metrics_file = save_performance_metrics(save_task, time_data,
                                                         position_data, reference_data)
-            else:
+            elif not stat_records:
                 print("No data to save")
 
+            # 4. Save windowed statistics
+            if stat_records:
+                save_stat_data(save_task, stat_records)
+
             print("\n=== All data saved successfully ===")
             print("Close window to exit.")
 
@@ -246,7 +291,7 @@ fig.canvas.mpl_connect('key_press_event', on_key)
 
 def update_plot(frame):
     """Read serial data and update plot"""
-    global task_name
+    global task_name, device_id
 
     # If paused, clear buffer but don't update
     if paused:
@@ -267,6 +312,11 @@ def update_plot(frame):
                 task_name = raw_data.split(":")[1]
                 print(f"Task detected: {task_name}")
 
+            # Board id: upload its registered parameters (once per session)
+            elif raw_data.startswith("DEVICE:"):
+                if device_id is None:
+                    device_id = device_registry.provision(ser, device_registry.parse_device_line(raw_data))
+
             # Parse data format
             elif raw_data.startswith("Data:"):
                 values = raw_data.split(":")[1].split(",")
@@ -295,6 +345,12 @@ def update_plot(frame):
                         limit_up_data.append(reference * 1.02)
                         limit_low_data.append(reference * 0.98)
 
+            # Parse windowed statistics (W:<ticks> mode)
+            elif raw_data.startswith("Stat:"):
+                values = [float(v) for v in raw_data.split(":")[1].split(",")]
+                if len(values) == len(STAT_COLUMNS):
+                    stat_records.append(values)
+
             else:
                 # Print status messages
                 print(raw_data)
@@ -302,6 +358,20 @@ def update_plot(frame):
         except (ValueError, IndexError) as e:
             continue
 
+    # Windowed mode: plot the window means with their min/max envelopes
+    if stat_records and not time_data:
+        col = {name: i for i, name in enumerate(STAT_COLUMNS)}
+        t = [r[col['t_end']] for r in stat_records]
+        line_position.set_data(t, [r[col['position_mean']] for r in stat_records])
+        line_error.set_data(t, [r[col['error_mean']] for r in stat_records])
+        line_control.set_data(t, [r[col['control_mean']] for r in stat_records])
+        for line, name in envelope_lines:
+            line.set_data(t, [r[col[name]] for r in stat_records])
+        for ax, sig, margin in ((ax1, 'position', 10), (ax2, 'error', 5), (ax3, 'control', 10)):
+            ax.set_xlim(min(t) - 0.1, max(t) + 0.1)
+            ax.set_ylim(min(r[col[sig + '_min']] for r in stat_records) - margin,
+                        max(r[col[sig + '_max']] for r in stat_records) + margin)
+
     # Update plot
     if len(time_data) > 0:
         # Position plot
@@ -0,0 +1,177 @@
+#!/usr/bin/env python3
+"""
+Sweep Journal
+
+Append-only journal for long hardware tuning sweeps (tune_kp.py, tune_kd.py).
+
+Each completed experiment is written as one JSON line and flushed to disk
+before the next one starts. Re-running the same sweep (same values and
+settings) resumes after the last completed experiment instead of redoing
+motor time; a fully completed sweep is just re-plotted.
+
+Journals live in data/tuning/<name>_<config hash>.jsonl. Delete the file to
+start the sweep over.
+
+Usage:
+    from sweep_journal import run_sweep
+
+    def run_one(ser, kp):
+        ...
+        return t_data, p_data
+
+    def metrics(t_data, p_data):
+        return {'overshoot': ...}
+
+    records = run_sweep("kp", KP_VALUES, config, run_one, port=PORT, baud=BAUD,
+                        metrics=metrics)
+"""
+
+import hashlib
+import json
+import os
+import time
+from datetime import datetime
+from pathlib import Path
+
+import serial
+
+from device_link import open_port
+
+RECONNECT_ATTEMPTS = 10
+RECONNECT_DELAY = 3.0  # seconds between attempts
+
+
+def journal_path(name, config):
+    """Journal file for a sweep; the hash ties it to the exact sweep settings"""
+    project_root = Path(__file__).parent.parent
+    digest = hashlib.sha1(json.dumps(config, sort_keys=True).encode()).hexdigest()[:10]
+    return project_root / "data" / "tuning" / f"{name}_{digest}.jsonl"
+
+
+class SweepJournal:
+    """Append-only JSON-lines log of completed experiments"""
+
+    def __init__(self, path, config):
+        self.path = Path(path)
+        self.config = config
+        self.records = {}
+
+        self.path.parent.mkdir(parents=True, exist_ok=True)
+        if self.path.exists():
+            self._load()
+        else:
+            self._append({'type': 'header', 'config': config,
+                          'created': datetime.now().strftime("%Y%m%d_%H%M%S")})
+
+    def _load(self):
+        with open(self.path, 'r') as f:
+            for line in f:
+                try:
+                    entry = json.loads(line)
+                except json.JSONDecodeError:
+                    # Torn last line from an interrupted write: ignore it
+                    continue
+                if entry.get('type') == 'header':
+                    if entry.get('config') != self.config:
+                        raise ValueError(f"Journal {self.path} belongs to a different sweep")
+                elif entry.get('type') == 'result':
+                    self.records[entry['index']] = entry
+
+    def _append(self, entry):
+        with open(self.path, 'a') as f:
+            f.write(json.dumps(entry) + "\n")
+            f.flush()
+            os.fsync(f.fileno())
+
+    def is_done(self, index):
+        return index in self.records
+
+    def record(self, index, value, result, response):
+        entry = {
+            'type': 'result',
+            'index': index,
+            'value': value,
+            'result': result,
+            'response': response,
+            'completed': datetime.now().strftime("%Y%m%d_%H%M%S"),
+        }
+        self._append(entry)
+        self.records[index] = entry
+
+    def ordered(self):
+        """Completed records in sweep order"""
+        return [self.records[i] for i in sorted(self.records)]
+
+
+def connect(port, baud):
+    """Open the port, retrying while the board is unplugged or busy"""
+    for attempt in range(1, RECONNECT_ATTEMPTS + 1):
+        try:
+            ser = open_port(port, baud, timeout=1, wait_reset=True)
+            print(f"Connected to {port}")
+            return ser
+        except serial.SerialException as e:
+            print(f"Connection error ({attempt}/{RECONNECT_ATTEMPTS}): {e}")
+            time.sleep(RECONNECT_DELAY)
+    return None
+
+
+def run_sweep(name, values, config, run_one, port, baud, metrics):
+    """
+    Run (or resume) a sweep over `values` in their given order.
+
+    Args:
+        name: Sweep name used for the journal file (e.g. "kp")
+        values: Swept values; their order defines the experiment order
+        config: Everything else that defines the sweep (target, duration, ...)
+        run_one: run_one(ser, value) -> (t_data, p_data) for one experiment
+        port, baud: Serial settings
+        metrics: metrics(t_data, p_data) -> dict stored with the result
+
+    Returns:
+        List of completed records in sweep order
+    """
+    journal = SweepJournal(journal_path(name, dict(config, values=list(values))),
+                           dict(config, values=list(values)))
+    done = len(journal.records)
+    print(f"Journal: {journal.path}")
+    if done:
+        print(f"Resuming: {done}/{len(values)} experiments already completed")
+
+    ser = None
+    try:
+        for index, value in enumerate(values):
+            if journal.is_done(index):
+                continue
+
+            while True:
+                if ser is None:
+                    ser = connect(port, baud)
+                    if ser is None:
+                        print("Giving up; rerun to resume from the journal.")
+                        return journal.ordered()
+                try:
+                    t_data, p_data = run_one(ser, value)
+                    break
+                except (serial.SerialException, OSError) as e:
+                    # Port dropped mid-experiment: reconnect and redo this point only
+                    print(f"Serial error during {name}={value}: {e}")
+                    try:
+                        ser.close()
+                    except Exception:
+                        pass
+                    ser = None
+
+            journal.record(index, value, metrics(t_data, p_data),
+                           {'t': t_data, 'p': p_data})
+    except KeyboardInterrupt:
+        print("\nInterrupted; rerun to resume from the journal.")
+    finally:
+        if ser is not None:
+            try:
+                ser.write(b"S\n")
+                ser.close()
+            except Exception:
+                pass
+
+    return journal.ordered()
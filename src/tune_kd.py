@@ -6,6 +6,8 @@ import numpy as np
 import os
 import sys
 
+from sweep_journal import run_sweep
+
 # Configuration
 PORT = os.environ.get('COM_MEGA2560')
 if not PORT:
@@ -54,75 +56,70 @@ def calculate_metrics(time_data, pos_data, target):
     
     return rt, overshoot, sse
 
+def run_experiment(ser, kd):
+    """One step experiment at the given Kd; returns (time, position) samples"""
+    print(f"\nTesting Kd = {kd}...")
+
+    # 1. Reset
+    ser.write(b"S\n")
+    time.sleep(0.1)
+    ser.write(b"Z\n")
+    time.sleep(0.5)
+
+    # 2. Set Gain (Kp Fixed, Kd Sweeping)
+    cmd = f"G:{FIXED_KP},0,{kd}\n"
+    ser.write(cmd.encode())
+    time.sleep(0.1)
+
+    # 3. Start Step
+    ser.reset_input_buffer()
+    ser.write(f"R:{TARGET_POS}\n".encode())
+
+    # 4. Record Data
+    start_time = time.time()
+    t_data = []
+    p_data = []
+
+    while time.time() - start_time < TEST_DURATION:
+        if ser.in_waiting:
+            try:
+                line = ser.readline().decode().strip()
+                if line.startswith("Data:"):
+                    parts = line.split(":")[1].split(",")
+                    t_data.append(float(parts[0]))
+                    p_data.append(float(parts[1]))
+            except (ValueError, IndexError, UnicodeDecodeError):
+                continue
+
+    # 5. Return to 0
+    ser.write(b"R:0\n")
+    time.sleep(1.5)
+
+    return t_data, p_data
+
+def experiment_metrics(t_data, p_data):
+    """Metrics stored in the sweep journal"""
+    rt, ov, sse = calculate_metrics(t_data, p_data, TARGET_POS)
+    print(f"  -> Rise Time: {rt:.3f} s" if rt else "  -> Rise Time: N/A")
+    print(f"  -> Overshoot: {ov:.1f} %" if ov is not None else "  -> Overshoot: N/A")
+    return {'RiseTime': rt, 'Overshoot': ov, 'SSE': sse}
+
 def main():
-    try:
-        ser = serial.Serial(PORT, BAUD, timeout=1)
-        time.sleep(2)
-        print(f"Connected to {PORT}")
-    except Exception as e:
-        print(f"Connection error: {e}")
-        return
+    print(f"Starting Kd Tuning Sweep (Fixed Kp={FIXED_KP})...")
+
+    # Completed experiments are journaled, so an interrupted sweep resumes
+    config = {'target': TARGET_POS, 'duration': TEST_DURATION, 'fixed': [FIXED_KP, 0]}
+    records = run_sweep("kd", KD_VALUES, config, run_experiment,
+                        port=PORT, baud=BAUD, metrics=experiment_metrics)
 
     results = []
     all_responses = {}
+    for rec in records:
+        kd = rec['value']
+        results.append(dict(rec['result'], Kd=kd))
+        if rec['response']['t']:
+            all_responses[kd] = (rec['response']['t'], rec['response']['p'])
 
-    print(f"Starting Kd Tuning Sweep (Fixed Kp={FIXED_KP})...")
-    
-    for kd in KD_VALUES:
-        print(f"\nTesting Kd = {kd}...")
-        
-        # 1. Reset
-        ser.write(b"S\n")
-        time.sleep(0.1)
-        ser.write(b"Z\n")
-        time.sleep(0.5)
-        
-        # 2. Set Gain (Kp Fixed, Kd Sweeping)
-        cmd = f"G:{FIXED_KP},0,{kd}\n"
-        ser.write(cmd.encode())
-        time.sleep(0.1)
-        
-        # 3. Start Step
-        ser.reset_input_buffer()
-        ser.write(f"R:{TARGET_POS}\n".encode())
-        
-        # 4. Record Data
-        start_time = time.time()
-        t_data = []
-        p_data = []
-        
-        while time.time() - start_time < TEST_DURATION:
-            if ser.in_waiting:
-                try:
-                    line = ser.readline().decode().strip()
-                    if line.startswith("Data:"):
-                        parts = line.split(":")[1].split(",")
-                        t_data.append(float(parts[0]))
-                        p_data.append(float(parts[1]))
-                except:
-                    continue
-        
-        # 5. Process
-        rt, ov, sse = calculate_metrics(t_data, p_data, TARGET_POS)
-        print(f"  -> Rise Time: {rt:.3f} s" if rt else "  -> Rise Time: N/A")
-        print(f"  -> Overshoot: {ov:.1f} %")
-        
-        results.append({
-            'Kd': kd, 
-            'RiseTime': rt, 
-            'Overshoot': ov, 
-            'SSE': sse
-        })
-        if t_data:
-            all_responses[kd] = (t_data, p_data)
-            
-        # 6. Return to 0
-        ser.write(b"R:0\n")
-        time.sleep(1.5)
-
-    ser.write(b"S\n")
-    ser.close()
-    
     # --- Plotting ---
     if not results:
         print("No valid data collected.")
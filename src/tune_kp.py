@@ -5,6 +5,8 @@ import numpy as np
 import os
 import sys
 
+from sweep_journal import run_sweep
+
 # Configuration
 PORT = os.environ.get('COM_MEGA2560')
 if not PORT:
@@ -48,76 +50,71 @@ def calculate_metrics(time_data, pos_data, target):
     
     return rt, overshoot, sse
 
+def run_experiment(ser, kp):
+    """One step experiment at the given Kp; returns (time, position) samples"""
+    print(f"\nTesting Kp = {kp}...")
+
+    # 1. Reset
+    ser.write(b"S\n")
+    time.sleep(0.1)
+    ser.write(b"Z\n") # Zero position
+    time.sleep(0.5)
+
+    # 2. Set Gain
+    cmd = f"G:{kp},0,0\n"
+    ser.write(cmd.encode())
+    time.sleep(0.1)
+
+    # 3. Start Step
+    ser.reset_input_buffer()
+    ser.write(f"R:{TARGET_POS}\n".encode())
+
+    # 4. Record Data
+    start_time = time.time()
+    t_data = []
+    p_data = []
+
+    while time.time() - start_time < TEST_DURATION:
+        if ser.in_waiting:
+            try:
+                line = ser.readline().decode().strip()
+                if line.startswith("Data:"):
+                    parts = line.split(":")[1].split(",")
+                    t_data.append(float(parts[0]))
+                    p_data.append(float(parts[1]))
+            except (ValueError, IndexError, UnicodeDecodeError):
+                continue
+
+    # 5. Return to 0 (Softly)
+    ser.write(b"R:0\n")
+    time.sleep(1.5) # Wait to settle back to 0
+
+    return t_data, p_data
+
+def experiment_metrics(t_data, p_data):
+    """Metrics stored in the sweep journal"""
+    rt, ov, sse = calculate_metrics(t_data, p_data, TARGET_POS)
+    print(f"  -> Rise Time: {rt:.3f} s" if rt else "  -> Rise Time: N/A")
+    print(f"  -> Overshoot: {ov:.1f} %" if ov is not None else "  -> Overshoot: N/A")
+    print(f"  -> SS Error:  {sse:.1f} deg" if sse is not None else "  -> SS Error:  N/A")
+    return {'RiseTime': rt, 'Overshoot': ov, 'SSE': sse}
+
 def main():
-    try:
-        ser = serial.Serial(PORT, BAUD, timeout=1)
-        time.sleep(2) # Wait for reset
-        print(f"Connected to {PORT}")
-    except Exception as e:
-        print(f"Connection error: {e}")
-        return
+    print("Starting Kp Tuning Sweep...")
+
+    # Completed experiments are journaled, so an interrupted sweep resumes
+    config = {'target': TARGET_POS, 'duration': TEST_DURATION, 'fixed': [0, 0]}
+    records = run_sweep("kp", KP_VALUES, config, run_experiment,
+                        port=PORT, baud=BAUD, metrics=experiment_metrics)
 
     results = []
     all_responses = {}
+    for rec in records:
+        kp = rec['value']
+        results.append(dict(rec['result'], Kp=kp))
+        if rec['response']['t']:
+            all_responses[kp] = (rec['response']['t'], rec['response']['p'])
 
-    print("Starting Kp Tuning Sweep...")
-    
-    for kp in KP_VALUES:
-        print(f"\nTesting Kp = {kp}...")
-        
-        # 1. Reset
-        ser.write(b"S\n")
-        time.sleep(0.1)
-        ser.write(b"Z\n") # Zero position
-        time.sleep(0.5)
-        
-        # 2. Set Gain
-        cmd = f"G:{kp},0,0\n"
-        ser.write(cmd.encode())
-        time.sleep(0.1)
-        
-        # 3. Start Step
-        ser.reset_input_buffer()
-        ser.write(f"R:{TARGET_POS}\n".encode())
-        
-        # 4. Record Data
-        start_time = time.time()
-        t_data = []
-        p_data = []
-        
-        while time.time() - start_time < TEST_DURATION:
-            if ser.in_waiting:
-                try:
-                    line = ser.readline().decode().strip()
-                    if line.startswith("Data:"):
-                        parts = line.split(":")[1].split(",")
-                        t_data.append(float(parts[0]))
-                        p_data.append(float(parts[1]))
-                except:
-                    continue
-        
-        # 5. Process
-        rt, ov, sse = calculate_metrics(t_data, p_data, TARGET_POS)
-        print(f"  -> Rise Time: {rt:.3f} s" if rt else "  -> Rise Time: N/A")
-        print(f"  -> Overshoot: {ov:.1f} %")
-        print(f"  -> SS Error:  {sse:.1f} deg")
-        
-        results.append({
-            'Kp': kp, 
-            'RiseTime': rt, 
-            'Overshoot': ov, 
-            'SSE': sse
-        })
-        if t_data:
-            all_responses[kp] = (t_data, p_data)
-            
-        # 6. Return to 0 (Softly)
-        ser.write(b"R:0\n")
-        time.sleep(1.5) # Wait to settle back to 0
-
-    ser.write(b"S\n")
-    ser.close()
-    
     # --- Plotting ---
     if not results:
         print("No valid data collected.")